@@ -1,5 +1,6 @@
 #include "Base.h"
 #include "Animation.h"
+#include "EncoderArguments.h"
 
 namespace gameplay
 {
@@ -27,12 +28,50 @@ void Animation::writeBinary(FILE* file)
     // Animation writes its ID because it is not listed in the ref table.
     write(getId(), file);
     write((unsigned int)_channels.size(), file);
+    if (EncoderArguments::getInstance()->compressAnimationsEnabled())
+    {
+        writeCompressedBinary(file);
+        return;
+    }
     for (std::vector<AnimationChannel*>::iterator i = _channels.begin(); i != _channels.end(); ++i)
     {
         (*i)->writeBinary(file);
     }
 }
 
+void Animation::writeCompressedBinary(FILE* file)
+{
+    // Channels that have the same key times share a key time track.
+    std::vector<std::vector<unsigned int> > tracks;
+    std::vector<unsigned int> channelTracks;
+    for (std::vector<AnimationChannel*>::iterator i = _channels.begin(); i != _channels.end(); ++i)
+    {
+        const std::vector<float>& keyTimes = (*i)->getKeyTimes();
+        std::vector<unsigned int> track;
+        for (std::vector<float>::const_iterator j = keyTimes.begin(); j != keyTimes.end(); ++j)
+        {
+            track.push_back((unsigned int)*j);
+        }
+        std::vector<std::vector<unsigned int> >::iterator it = std::find(tracks.begin(), tracks.end(), track);
+        if (it == tracks.end())
+        {
+            it = tracks.insert(tracks.end(), track);
+        }
+        channelTracks.push_back((unsigned int)(it - tracks.begin()));
+    }
+    LOG(3, "    Animation %s: %lu channels share %lu key time tracks.\n", getId().c_str(), _channels.size(), tracks.size());
+
+    write((unsigned int)tracks.size(), file);
+    for (std::vector<std::vector<unsigned int> >::const_iterator i = tracks.begin(); i != tracks.end(); ++i)
+    {
+        write(*i, file);
+    }
+    for (size_t i = 0, count = _channels.size(); i < count; ++i)
+    {
+        _channels[i]->writeCompressedBinary(file, channelTracks[i]);
+    }
+}
+
 void Animation::writeText(FILE* file)
 {
     fprintElementStart(file);
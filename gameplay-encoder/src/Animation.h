@@ -58,6 +58,11 @@ public:
 
 private:
 
+    /**
+     * Writes the key time tracks and the channels of this animation in compressed form.
+     */
+    void writeCompressedBinary(FILE* file);
+
     std::vector<AnimationChannel*> _channels;
 };
 
@@ -39,6 +39,143 @@ void AnimationChannel::writeBinary(FILE* file)
     write(_interpolations, file);
 }
 
+void AnimationChannel::writeCompressedBinary(FILE* file, unsigned int keyTimeTrack)
+{
+    // Components whose range is within this tolerance are written as a constant.
+    const float CONSTANT_TOLERANCE = 0.00001f;
+    const unsigned int NO_QUATERNION = 0xFFFFFFFF;
+
+    Object::writeBinary(file);
+    write(_targetId, file);
+    write(_targetAttrib, file);
+
+    const unsigned int componentCount = Transform::getPropertySize(_targetAttrib);
+    const size_t keyCount = _keytimes.size();
+    assert(componentCount > 0 && _keyValues.size() == keyCount * componentCount);
+
+    unsigned int quaternionOffset = NO_QUATERNION;
+    switch (_targetAttrib)
+    {
+    case Transform::ANIMATE_ROTATE:
+    case Transform::ANIMATE_ROTATE_TRANSLATE:
+        quaternionOffset = 0;
+        break;
+    case Transform::ANIMATE_SCALE_ROTATE:
+    case Transform::ANIMATE_SCALE_ROTATE_TRANSLATE:
+        quaternionOffset = 3;
+        break;
+    default:
+        break;
+    }
+
+    for (std::vector<unsigned int>::const_iterator i = _interpolations.begin(); i != _interpolations.end(); ++i)
+    {
+        if (*i != LINEAR)
+        {
+            LOG(1, "Warning: Compressed animation channel for '%s' is interpolated linearly.\n", _targetId.c_str());
+            break;
+        }
+    }
+
+    write(keyTimeTrack, file);
+    write(componentCount, file);
+    write(quaternionOffset, file);
+
+    // Write the encoding of each component, with its constant value or its range.
+    std::vector<unsigned char> encodings(componentCount, COMPRESSED_CONSTANT);
+    std::vector<float> minimums(componentCount, 0.0f);
+    std::vector<float> steps(componentCount, 0.0f);
+    for (unsigned int i = 0; i < componentCount; )
+    {
+        unsigned int size = (i == quaternionOffset) ? 4 : 1;
+        bool constant = true;
+        for (unsigned int j = i; j < i + size; ++j)
+        {
+            float minimum = _keyValues[j];
+            float maximum = _keyValues[j];
+            for (size_t k = 1; k < keyCount; ++k)
+            {
+                minimum = std::min(minimum, _keyValues[k * componentCount + j]);
+                maximum = std::max(maximum, _keyValues[k * componentCount + j]);
+            }
+            minimums[j] = minimum;
+            steps[j] = (maximum - minimum) / 65535.0f;
+            constant = constant && maximum - minimum <= CONSTANT_TOLERANCE;
+        }
+
+        if (constant)
+        {
+            write((unsigned char)COMPRESSED_CONSTANT, file);
+            write(&_keyValues[i], size, file);
+        }
+        else if (size == 4)
+        {
+            write((unsigned char)COMPRESSED_QUATERNION, file);
+            for (unsigned int j = i; j < i + size; ++j)
+            {
+                encodings[j] = COMPRESSED_QUATERNION;
+            }
+        }
+        else
+        {
+            write((unsigned char)COMPRESSED_QUANTIZED, file);
+            write(minimums[i], file);
+            write(steps[i], file);
+            encodings[i] = COMPRESSED_QUANTIZED;
+        }
+        i += size;
+    }
+
+    // Write the quantized values of each key frame.
+    std::vector<unsigned short> values;
+    for (size_t k = 0; k < keyCount; ++k)
+    {
+        const float* keyValue = &_keyValues[k * componentCount];
+        for (unsigned int i = 0; i < componentCount; )
+        {
+            if (encodings[i] == COMPRESSED_QUANTIZED)
+            {
+                float value = steps[i] > 0.0f ? (keyValue[i] - minimums[i]) / steps[i] : 0.0f;
+                values.push_back((unsigned short)std::min(std::max(value + 0.5f, 0.0f), 65535.0f));
+                i++;
+            }
+            else if (encodings[i] == COMPRESSED_QUATERNION)
+            {
+                // Store the smallest three components, with the largest component made positive
+                // so that it can be computed from the other three.
+                float q[4];
+                float length = sqrt(keyValue[i] * keyValue[i] + keyValue[i + 1] * keyValue[i + 1] +
+                    keyValue[i + 2] * keyValue[i + 2] + keyValue[i + 3] * keyValue[i + 3]);
+                unsigned int largest = 0;
+                for (unsigned int j = 0; j < 4; ++j)
+                {
+                    q[j] = length > 0.0f ? keyValue[i + j] / length : (j == 3 ? 1.0f : 0.0f);
+                    if (fabs(q[j]) > fabs(q[largest]))
+                        largest = j;
+                }
+                float sign = q[largest] < 0.0f ? -1.0f : 1.0f;
+                unsigned short smallest[3];
+                for (unsigned int j = 0, n = 0; j < 4; ++j)
+                {
+                    if (j == largest)
+                        continue;
+                    float value = (q[j] * sign + 0.707106781f) / 1.414213562f * 32767.0f;
+                    smallest[n++] = (unsigned short)std::min(std::max(value + 0.5f, 0.0f), 32767.0f);
+                }
+                smallest[0] |= (unsigned short)((largest & 2) << 14);
+                smallest[1] |= (unsigned short)((largest & 1) << 15);
+                values.insert(values.end(), smallest, smallest + 3);
+                i += 4;
+            }
+            else
+            {
+                i++;
+            }
+        }
+    }
+    write(values, file);
+}
+
 void AnimationChannel::writeText(FILE* file)
 {
     fprintElementStart(file);
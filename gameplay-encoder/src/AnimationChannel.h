@@ -35,6 +35,18 @@ public:
     virtual void writeBinary(FILE* file);
     virtual void writeText(FILE* file);
 
+    /**
+     * Writes this channel in compressed form.
+     *
+     * Rotations are stored as the smallest three components of the quaternion, other
+     * components as 16-bit fixed point numbers in the range of the component, and
+     * components that do not change as a single value.
+     *
+     * @param file The binary file stream.
+     * @param keyTimeTrack The index of the key time track of this channel in its animation.
+     */
+    void writeCompressedBinary(FILE* file, unsigned int keyTimeTrack);
+
     const std::string& getTargetId() const;
 
     /**
@@ -77,6 +89,16 @@ public:
 
 private:
 
+    /**
+     * The encodings of the components of compressed channels.
+     */
+    enum CompressedEncoding
+    {
+        COMPRESSED_CONSTANT = 0,
+        COMPRESSED_QUANTIZED = 1,
+        COMPRESSED_QUATERNION = 2
+    };
+
     /**
      * Deletes all key frames from key time index begin to key time index end (exclusive).
      * 
@@ -0,0 +1,246 @@
+#include "Base.h"
+#include "ArchiveEncoder.h"
+#include <zlib.h>
+
+#ifdef WIN32
+    #include <windows.h>
+#else
+    #include <dirent.h>
+#endif
+
+// The size of the header of an archive: the identifier, the version, one byte of padding,
+// the number of entries and the size of the names.
+#define ARCHIVE_HEADER_SIZE 20
+
+// Files are compressed when that makes them at least this fraction (1/n) smaller.
+#define ARCHIVE_MIN_COMPRESSION 8
+
+namespace gameplay
+{
+
+// The identifier and version of archives, which must match FileSystem.cpp of the runtime.
+static const char __archiveIdentifier[9] = { '\xAB', 'G', 'P', 'K', '\xBB', '\r', '\n', '\x1A', '\n' };
+static const char __archiveVersion[2] = { 1, 0 };
+
+/**
+ * An entry in the directory of an archive, as it is read by the runtime.
+ */
+struct ArchiveEntry
+{
+    unsigned int hash;
+    unsigned int nameOffset;
+    unsigned int nameLength;
+    unsigned int offset;
+    unsigned int size;
+    unsigned int storedSize;
+};
+
+/**
+ * A file to pack and its entry in the directory of the archive.
+ */
+struct ArchiveFile
+{
+    std::string path;
+    std::string name;
+    ArchiveEntry entry;
+
+    bool operator<(const ArchiveFile& file) const
+    {
+        return entry.hash < file.entry.hash || (entry.hash == file.entry.hash && name < file.name);
+    }
+};
+
+/**
+ * Returns the FNV-1a hash of the path of a file, as it is computed by the runtime.
+ */
+static unsigned int hashArchivePath(const std::string& path)
+{
+    unsigned int hash = 2166136261u;
+    for (size_t i = 0; i < path.length(); ++i)
+    {
+        hash ^= (unsigned char)path[i];
+        hash *= 16777619u;
+    }
+    return hash;
+}
+
+/**
+ * Adds the files of a directory and its subdirectories to the list of files to pack.
+ */
+static bool listArchiveFiles(const std::string& dirPath, const std::string& name, std::vector<ArchiveFile>& files)
+{
+#ifdef WIN32
+    WIN32_FIND_DATAA findData;
+    HANDLE find = FindFirstFileA((dirPath + "/*").c_str(), &findData);
+    if (find == INVALID_HANDLE_VALUE)
+        return false;
+    do
+    {
+        std::string filename(findData.cFileName);
+        if (filename == "." || filename == "..")
+            continue;
+        if ((findData.dwFileAttributes & FILE_ATTRIBUTE_DIRECTORY) != 0)
+        {
+            listArchiveFiles(dirPath + "/" + filename, name + "/" + filename, files);
+        }
+        else
+        {
+            ArchiveFile file;
+            file.path = dirPath + "/" + filename;
+            file.name = name + "/" + filename;
+            files.push_back(file);
+        }
+    } while (FindNextFileA(find, &findData) != 0);
+    FindClose(find);
+#else
+    DIR* dir = opendir(dirPath.c_str());
+    if (!dir)
+        return false;
+    struct dirent* dp;
+    while ((dp = readdir(dir)) != NULL)
+    {
+        std::string filename(dp->d_name);
+        if (filename == "." || filename == "..")
+            continue;
+        std::string path = dirPath + "/" + filename;
+        struct stat buf;
+        if (stat(path.c_str(), &buf) != 0)
+            continue;
+        if (S_ISDIR(buf.st_mode))
+        {
+            listArchiveFiles(path, name + "/" + filename, files);
+        }
+        else
+        {
+            ArchiveFile file;
+            file.path = path;
+            file.name = name + "/" + filename;
+            files.push_back(file);
+        }
+    }
+    closedir(dir);
+#endif
+    return true;
+}
+
+static bool readFile(const char* path, std::vector<unsigned char>& data)
+{
+    FILE* file = fopen(path, "rb");
+    if (!file)
+        return false;
+    fseek(file, 0, SEEK_END);
+    long size = ftell(file);
+    fseek(file, 0, SEEK_SET);
+    data.resize(size);
+    bool result = size >= 0 && (size == 0 || fread(&data[0], 1, size, file) == (size_t)size);
+    fclose(file);
+    return result;
+}
+
+int writeArchive(const char* dirPath, const char* outFilePath, bool compress)
+{
+    std::string path(dirPath);
+    while (path.length() > 1 && (path[path.length() - 1] == '/' || path[path.length() - 1] == '\\'))
+        path.erase(path.length() - 1);
+
+    size_t separator = path.find_last_of("/\\");
+    std::string name = separator == std::string::npos ? path : path.substr(separator + 1);
+
+    std::vector<ArchiveFile> files;
+    if (!listArchiveFiles(path, name, files))
+    {
+        LOG(1, "Error: Failed to list the files of directory: %s\n", dirPath);
+        return -1;
+    }
+
+    // The runtime searches the entries by the hash of their paths.
+    std::string names;
+    for (size_t i = 0; i < files.size(); ++i)
+    {
+        ArchiveEntry& entry = files[i].entry;
+        entry.hash = hashArchivePath(files[i].name);
+        entry.nameLength = (unsigned int)files[i].name.length();
+    }
+    std::sort(files.begin(), files.end());
+    for (size_t i = 0; i < files.size(); ++i)
+    {
+        files[i].entry.nameOffset = (unsigned int)names.length();
+        names += files[i].name;
+    }
+
+    FILE* file = fopen(outFilePath, "wb");
+    if (!file)
+    {
+        LOG(1, "Error: Failed to create archive: %s\n", outFilePath);
+        return -1;
+    }
+
+    // Write the header, then the directory once the offsets of the files are known.
+    unsigned int entryCount = (unsigned int)files.size();
+    unsigned int namesSize = (unsigned int)names.length();
+    char padding = 0;
+    fwrite(__archiveIdentifier, 1, sizeof(__archiveIdentifier), file);
+    fwrite(__archiveVersion, 1, sizeof(__archiveVersion), file);
+    fwrite(&padding, 1, 1, file);
+    fwrite(&entryCount, sizeof(unsigned int), 1, file);
+    fwrite(&namesSize, sizeof(unsigned int), 1, file);
+    long directoryOffset = ftell(file);
+    std::vector<ArchiveEntry> entries(files.size());
+    if (!entries.empty())
+        fwrite(&entries[0], sizeof(ArchiveEntry), entries.size(), file);
+    fwrite(names.c_str(), 1, names.length(), file);
+
+    size_t totalSize = 0;
+    size_t totalStoredSize = 0;
+    std::vector<unsigned char> data;
+    std::vector<unsigned char> compressed;
+    for (size_t i = 0; i < files.size(); ++i)
+    {
+        ArchiveEntry& entry = files[i].entry;
+        if (!readFile(files[i].path.c_str(), data))
+        {
+            LOG(1, "Error: Failed to read file: %s\n", files[i].path.c_str());
+            fclose(file);
+            return -1;
+        }
+        entry.offset = (unsigned int)ftell(file);
+        entry.size = (unsigned int)data.size();
+        entry.storedSize = entry.size;
+
+        // Files that are already compressed, such as PNG images, are stored as they are, since
+        // decompressing them again when they are read would save little space.
+        const unsigned char* stored = data.empty() ? NULL : &data[0];
+        if (compress && !data.empty())
+        {
+            uLongf compressedSize = compressBound(data.size());
+            compressed.resize(compressedSize);
+            if (compress2(&compressed[0], &compressedSize, &data[0], data.size(), Z_BEST_COMPRESSION) == Z_OK &&
+                compressedSize <= data.size() - data.size() / ARCHIVE_MIN_COMPRESSION)
+            {
+                entry.storedSize = (unsigned int)compressedSize;
+                stored = &compressed[0];
+            }
+        }
+        if (entry.storedSize > 0)
+            fwrite(stored, 1, entry.storedSize, file);
+        entries[i] = entry;
+
+        totalSize += entry.size;
+        totalStoredSize += entry.storedSize;
+        LOG(2, "%s: %u bytes%s\n", files[i].name.c_str(), entry.size, entry.storedSize < entry.size ? " (compressed)" : "");
+    }
+
+    fseek(file, directoryOffset, SEEK_SET);
+    if (!entries.empty())
+        fwrite(&entries[0], sizeof(ArchiveEntry), entries.size(), file);
+    if (ferror(file) != 0 || fclose(file) != 0)
+    {
+        LOG(1, "Error: Failed to write archive: %s\n", outFilePath);
+        return -1;
+    }
+
+    LOG(1, "Packed %u files (%u bytes) into %u bytes.\n", entryCount, (unsigned int)totalSize, (unsigned int)(ARCHIVE_HEADER_SIZE + entries.size() * sizeof(ArchiveEntry) + names.length() + totalStoredSize));
+    return 0;
+}
+
+}
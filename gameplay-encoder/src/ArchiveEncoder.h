@@ -0,0 +1,24 @@
+#ifndef ARCHIVEENCODER_H_
+#define ARCHIVEENCODER_H_
+
+namespace gameplay
+{
+
+/**
+ * Writes an archive of the files in a directory, which the runtime mounts with FileSystem::mountArchive.
+ *
+ * The files are stored with their paths relative to the parent of the directory, so an archive
+ * of the "res" directory of a game stores the files as they are opened by the game.
+ *
+ * @param dirPath Path to the directory to pack, including its subdirectories.
+ * @param outFilePath Output file path to write the archive to.
+ * @param compress True to compress the files with zlib when that makes them an eighth smaller. Files
+ *      that are not compressed can be mapped into memory by the runtime.
+ *
+ * @return 0 if successful, -1 if error.
+ */
+int writeArchive(const char* dirPath, const char* outFilePath, bool compress);
+
+}
+
+#endif
@@ -24,7 +24,10 @@ EncoderArguments::EncoderArguments(size_t argc, const char** argv) :
     _fontPreview(false),
     _textOutput(false),
     _daeOutput(false),
-    _optimizeAnimations(false)
+    _optimizeAnimations(false),
+    _compressAnimations(false),
+    _pack(false),
+    _packCompression(true)
 {
     __instance = this;
 
@@ -98,6 +101,9 @@ std::string EncoderArguments::getOutputDirPath() const
 
 std::string EncoderArguments::getOutputFileExtension() const
 {
+    if (_pack)
+        return ".gpk";
+
     switch (getFileFormat())
     {
     case FILEFORMAT_PNG:
@@ -227,6 +233,7 @@ void EncoderArguments::printUsage() const
     LOG(1, "  .dae\t(COLLADA)\n");
     LOG(1, "  .fbx\t(FBX)\n");
     LOG(1, "  .ttf\t(TrueType Font)\n");
+    LOG(1, "  <directory>\t(with -pack or -ps)\n");
     LOG(1, "\n");
     LOG(1, "General Options:\n");
     LOG(1, "  -v <verbosity>\tVerbosity level (0-4).\n");
@@ -241,6 +248,13 @@ void EncoderArguments::printUsage() const
         "\t\tremoving any channels that contain default/identity values\n" \
         "\t\tand removing any duplicate contiguous keyframes, which are common\n" \
         "\t\twhen exporting baked animation data.\n");
+    LOG(1, "  -ca\n" \
+        "\t\tCompresses animations by storing rotations as quantized quaternions,\n" \
+        "\t\tother values as 16-bit fixed point numbers in the range of each\n" \
+        "\t\tcomponent, constant components as a single value and the key times\n" \
+        "\t\tthat are shared by channels only once. Channels are interpolated\n" \
+        "\t\tlinearly. Compressed animations are written as version 1.3 of the\n" \
+        "\t\tfile format.\n");
     LOG(1, "  -h <size> \"<node ids>\" <filename>\n" \
         "\t\tGenerates a single heightmap image using meshes from the specified\n" \
         "\t\tnodes. <size> should be two comma-separated numbers in the format\n" \
@@ -267,6 +281,17 @@ void EncoderArguments::printUsage() const
     LOG(1, "  -s <size>\tSize of the font.\n");
     LOG(1, "  -p\t\tOutput font preview.\n");
     LOG(1, "\n");
+    LOG(1, "Archive options:\n");
+    LOG(1, "  -pack\n" \
+        "\t\tPacks the files of the input directory and its subdirectories\n" \
+        "\t\tinto a .gpk archive, which games mount with FileSystem::mountArchive.\n" \
+        "\t\tFiles are stored with paths that start with the name of the\n" \
+        "\t\tdirectory, such as res/common/box.gpb when packing res, and are\n" \
+        "\t\tcompressed with zlib when that makes them an eighth smaller.\n");
+    LOG(1, "  -ps\n" \
+        "\t\tPacks a directory like -pack without compressing the files, so\n" \
+        "\t\tthat they are mapped into memory when they are read.\n");
+    LOG(1, "\n");
     exit(8);
 }
 
@@ -290,6 +315,21 @@ bool EncoderArguments::optimizeAnimationsEnabled() const
     return _optimizeAnimations;
 }
 
+bool EncoderArguments::compressAnimationsEnabled() const
+{
+    return _compressAnimations;
+}
+
+bool EncoderArguments::packEnabled() const
+{
+    return _pack;
+}
+
+bool EncoderArguments::packCompressionEnabled() const
+{
+    return _packCompression;
+}
+
 const char* EncoderArguments::getNodeId() const
 {
     if (_nodeId.length() == 0)
@@ -411,6 +451,13 @@ void EncoderArguments::readOption(const std::vector<std::string>& options, size_
             _optimizeAnimations = true;
         }
         break;
+    case 'c':
+        if (str == "-ca")
+        {
+            // Compress animations
+            _compressAnimations = true;
+        }
+        break;
     case 'h':
         {
             bool isHighPrecision = str.compare("-hp") == 0;
@@ -510,7 +557,21 @@ void EncoderArguments::readOption(const std::vector<std::string>& options, size_
         }
         break;
     case 'p':
-        _fontPreview = true;
+        if (str == "-pack")
+        {
+            // Pack a directory into an archive
+            _pack = true;
+        }
+        else if (str == "-ps")
+        {
+            // Pack a directory into an archive without compression
+            _pack = true;
+            _packCompression = false;
+        }
+        else
+        {
+            _fontPreview = true;
+        }
         break;
     case 's':
         if (_normalMap)
@@ -140,6 +140,9 @@ public:
     bool textOutputEnabled() const;
     bool DAEOutputEnabled() const;
     bool optimizeAnimationsEnabled() const;
+    bool compressAnimationsEnabled() const;
+    bool packEnabled() const;
+    bool packCompressionEnabled() const;
 
     const char* getNodeId() const;
     unsigned int getFontSize() const;
@@ -189,6 +192,9 @@ private:
     bool _textOutput;
     bool _daeOutput;
     bool _optimizeAnimations;
+    bool _compressAnimations;
+    bool _pack;
+    bool _packCompression;
 
     std::vector<std::string> _groupAnimationNodeId;
     std::vector<std::string> _groupAnimationAnimationId;
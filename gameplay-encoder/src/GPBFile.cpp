@@ -76,7 +76,8 @@ bool GPBFile::saveBinary(const std::string& filepath)
     }
 
     // version
-    n = fwrite(GPB_VERSION, 1, sizeof(GPB_VERSION), _file);
+    const unsigned char* version = EncoderArguments::getInstance()->compressAnimationsEnabled() ? GPB_VERSION_COMPRESSED_ANIMATIONS : GPB_VERSION;
+    n = fwrite(version, 1, sizeof(GPB_VERSION), _file);
     if (n != sizeof(GPB_VERSION))
     {
         fclose(_file);
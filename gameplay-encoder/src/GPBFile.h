@@ -23,6 +23,11 @@ namespace gameplay
  */
 const unsigned char GPB_VERSION[2] = {1, 2};
 
+/**
+ * The version of files that store animations in compressed form (see the -ca option).
+ */
+const unsigned char GPB_VERSION_COMPRESSED_ANIMATIONS[2] = {1, 3};
+
 /**
  * The GamePlay Binary file class handles writing the GamePlay Binary file.
  */
@@ -5,6 +5,7 @@
 #include "GPBDecoder.h"
 #include "EncoderArguments.h"
 #include "NormalMapGenerator.h"
+#include "ArchiveEncoder.h"
 
 using namespace gameplay;
 
@@ -61,6 +62,12 @@ int main(int argc, const char** argv)
         return -1;
     }
 
+    if (arguments.packEnabled())
+    {
+        LOG(1, "Packing directory: %s\n", arguments.getFilePathPointer());
+        return writeArchive(arguments.getFilePath().c_str(), arguments.getOutputFilePath().c_str(), arguments.packCompressionEnabled());
+    }
+
     // File exists
     LOG(1, "Encoding file: %s\n", arguments.getFilePathPointer());
 
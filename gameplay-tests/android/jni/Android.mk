@@ -76,8 +76,14 @@ include $(CLEAR_VARS)
 
 LOCAL_MODULE    := gameplay-tests
 LOCAL_SRC_FILES := ../../../GamePlay/gameplay/src/gameplay-main-android.cpp \
+    AnimationBenchmarkTest.cpp \
+    BenchmarkTest.cpp \
+    BundleBenchmarkTest.cpp \
+    FileSystemBenchmarkTest.cpp \
     FirstPersonCamera.cpp \
     Grid.cpp \
+    MathBenchmarkTest.cpp \
+    SkinningBenchmarkTest.cpp \
     Test.cpp \
     TestsGame.cpp \
     Audio3DTest.cpp \
@@ -93,9 +99,11 @@ LOCAL_SRC_FILES := ../../../GamePlay/gameplay/src/gameplay-main-android.cpp \
     MeshPrimitiveTest.cpp \
 	PhysicsCollisionObjectTest.cpp \
     PostProcessTest.cpp \
+    SceneBenchmarkTest.cpp \
 	SpriteBatchTest.cpp \
 	TerrainTest.cpp \
     TextTest.cpp \
+    TextureBenchmarkTest.cpp \
     TextureTest.cpp \
 	TriangleTest.cpp
 
@@ -0,0 +1,648 @@
+#include "AnimationBenchmarkTest.h"
+#include "TestsGame.h"
+
+#if defined(ADD_TEST)
+    ADD_TEST("Benchmark", "Animation", AnimationBenchmarkTest, 4);
+#endif
+
+#define BENCHMARK_FRAMES 120
+
+// The frames that the clips run before each scaling pass is timed.
+#define SCALING_WARMUP_FRAMES 10
+
+// The largest number of workers that the clips are updated with.
+#define SCALING_MAX_WORKERS 8
+
+// The scale, rotation and translation channels of each joint.
+#define CHANNEL_COUNT 3
+
+static const unsigned int __componentCounts[CHANNEL_COUNT] = { 3, 4, 3 };
+
+/**
+ * Counts the events of clips.
+ */
+class EventListener : public AnimationClip::Listener
+{
+public:
+
+    EventListener() : eventCount(0)
+    {
+    }
+
+    void animationEvent(AnimationClip* clip, EventType type)
+    {
+        eventCount++;
+    }
+
+    unsigned int eventCount;
+};
+
+static EventListener __eventListener;
+
+/**
+ * Stores the time events of a clip in a list, as clips did before they kept them in a sorted
+ * array, so that the event benchmarks can compare the two.
+ */
+class ListenerList
+{
+public:
+
+    ListenerList() : _repeat(0)
+    {
+        _next = _events.end();
+    }
+
+    ~ListenerList()
+    {
+        for (std::list<Event*>::iterator itr = _events.begin(); itr != _events.end(); ++itr)
+            delete *itr;
+    }
+
+    void add(AnimationClip::Listener* listener, unsigned long eventTime)
+    {
+        // Scan the list for the position of the event.
+        Event* event = new Event();
+        event->listener = listener;
+        event->eventTime = eventTime;
+        std::list<Event*>::iterator itr = _events.begin();
+        while (itr != _events.end() && (*itr)->eventTime <= eventTime)
+            ++itr;
+        _events.insert(itr, event);
+    }
+
+    void start()
+    {
+        _next = _events.begin();
+        _repeat = 0;
+    }
+
+    void notify(AnimationClip* clip)
+    {
+        // Trigger the events that the clip passed, in every repetition as the clips do.
+        float elapsedTime = clip->getElaspedTime();
+        unsigned long duration = clip->getDuration();
+        unsigned long repeat = (unsigned long)(elapsedTime / duration);
+        while (_repeat < repeat)
+        {
+            for (; _next != _events.end(); ++_next)
+                (*_next)->listener->animationEvent(clip, AnimationClip::Listener::TIME);
+            _next = _events.begin();
+            _repeat++;
+        }
+
+        float time = elapsedTime - (float)repeat * duration;
+        for (; _next != _events.end() && time >= (float)(*_next)->eventTime; ++_next)
+            (*_next)->listener->animationEvent(clip, AnimationClip::Listener::TIME);
+    }
+
+private:
+
+    struct Event
+    {
+        AnimationClip::Listener* listener;
+        unsigned long eventTime;
+    };
+
+    std::list<Event*> _events;
+    std::list<Event*>::iterator _next;
+    unsigned long _repeat;
+};
+
+/**
+ * Creates a linear curve for a joint channel with random keys at the given times.
+ */
+Curve* AnimationBenchmarkTest::createChannelCurve(unsigned int channel, unsigned int keyCount, const float* keyTimes)
+{
+    unsigned int componentCount = __componentCounts[channel];
+    Curve* curve = Curve::create(keyCount, componentCount);
+    if (channel == 1)
+        curve->setQuaternionOffset(0);
+
+    for (unsigned int i = 0; i < keyCount; ++i)
+    {
+        float value[4];
+        if (channel == 1)
+        {
+            Quaternion rotation(MATH_RANDOM_MINUS1_1(), MATH_RANDOM_MINUS1_1(), MATH_RANDOM_MINUS1_1(), 1.0f);
+            rotation.normalize();
+            value[0] = rotation.x;
+            value[1] = rotation.y;
+            value[2] = rotation.z;
+            value[3] = rotation.w;
+        }
+        else
+        {
+            for (unsigned int j = 0; j < componentCount; ++j)
+                value[j] = MATH_RANDOM_MINUS1_1();
+        }
+        curve->setPoint(i, keyTimes[i], value, Curve::LINEAR);
+    }
+    return curve;
+}
+
+/**
+ * Creates a character whose joints are animated by their scale, rotation and translation,
+ * with an animation and a few clips per joint.
+ */
+static Node* createCharacter(unsigned int jointCount, unsigned int keyCount)
+{
+    std::vector<unsigned int> keyTimes(keyCount);
+    std::vector<float> keyValues(keyCount * 10);
+    for (unsigned int i = 0; i < keyCount; ++i)
+        keyTimes[i] = i * 33;
+
+    Node* character = Node::create("character");
+    for (unsigned int joint = 0; joint < jointCount; ++joint)
+    {
+        for (unsigned int i = 0; i < keyCount; ++i)
+        {
+            Quaternion rotation(MATH_RANDOM_MINUS1_1(), MATH_RANDOM_MINUS1_1(), MATH_RANDOM_MINUS1_1(), 1.0f);
+            rotation.normalize();
+            float* value = &keyValues[i * 10];
+            value[0] = value[1] = value[2] = 1.0f;
+            value[3] = rotation.x;
+            value[4] = rotation.y;
+            value[5] = rotation.z;
+            value[6] = rotation.w;
+            value[7] = MATH_RANDOM_MINUS1_1();
+            value[8] = (float)joint;
+            value[9] = 0.0f;
+        }
+
+        Node* node = Node::create();
+        Animation* animation = node->createAnimation("walk", Transform::ANIMATE_SCALE_ROTATE_TRANSLATE, keyCount, &keyTimes[0], &keyValues[0], Curve::LINEAR);
+        animation->createClip("idle", 0, keyTimes[keyCount / 2]);
+        animation->createClip("run", keyTimes[keyCount / 2], keyTimes[keyCount - 1]);
+        character->addChild(node);
+        SAFE_RELEASE(node);
+    }
+    return character;
+}
+
+/**
+ * Gathers the first animation of each node in a hierarchy, in the order of a traversal.
+ */
+static void gatherAnimations(Node* node, std::vector<Animation*>& animations)
+{
+    for (; node; node = node->getNextSibling())
+    {
+        Animation* animation = node->getAnimation();
+        if (animation)
+            animations.push_back(animation);
+        gatherAnimations(node->getFirstChild(), animations);
+    }
+}
+
+/**
+ * Returns the largest difference between the curves of two animations with the same channels,
+ * sampled across their duration.
+ */
+float AnimationBenchmarkTest::compareCurves(Animation* a, Animation* b)
+{
+    Animation::CurveSet* curveSets[2] = { a->getCurveSet(), b->getCurveSet() };
+    if (curveSets[0] == NULL || curveSets[1] == NULL || curveSets[0]->curves.size() != curveSets[1]->curves.size())
+        return FLT_MAX;
+
+    float difference = 0.0f;
+    for (size_t i = 0, count = curveSets[0]->curves.size(); i < count; ++i)
+    {
+        Curve* curves[2] = { curveSets[0]->curves[i], curveSets[1]->curves[i] };
+        unsigned int componentCount = curves[0]->getComponentCount();
+        if (componentCount != curves[1]->getComponentCount() || curves[0]->getPointCount() != curves[1]->getPointCount())
+            return FLT_MAX;
+
+        std::vector<float> values[2] = { std::vector<float>(componentCount), std::vector<float>(componentCount) };
+        for (unsigned int sample = 0; sample <= 10; ++sample)
+        {
+            curves[0]->evaluate(sample * 0.1f, &values[0][0]);
+            curves[1]->evaluate(sample * 0.1f, &values[1][0]);
+            for (unsigned int j = 0; j < componentCount; ++j)
+                difference = std::max(difference, fabs(values[0][j] - values[1][j]));
+        }
+    }
+    return difference;
+}
+
+AnimationBenchmarkTest::AnimationBenchmarkTest()
+    : _scalingWorkerCount(0), _scalingFrame(0), _scalingStartTime(0.0), _workerCount(1), _vsync(true)
+{
+}
+
+void AnimationBenchmarkTest::benchmark()
+{
+    benchmarkRig("1 character", 1, 200, 30);
+    benchmarkRig("20 characters", 20, 200, 30);
+    benchmarkClones("100 clones", 100, 60, 30);
+    benchmarkClones("1000 clones", 1000, 60, 30);
+    benchmarkEvents("100 clips", 100, 1000);
+    benchmarkDispatch("100 clips", 100, 10, 1000);
+    benchmarkDispatch("100 clips", 100, 1000, 100);
+    benchmarkDeferredLoad("res/common/spaceship.gpb");
+
+    startScaling(40, 30, 30);
+}
+
+void AnimationBenchmarkTest::finalize()
+{
+    stopScaling();
+    BenchmarkTest::finalize();
+}
+
+void AnimationBenchmarkTest::update(float elapsedTime)
+{
+    if (_scalingWorkerCount == 0)
+        return;
+
+    // The clips are updated by the animation controller before each call, so the time
+    // between calls measures whole frames that are dominated by updating the clips.
+    _scalingFrame++;
+    if (_scalingFrame == SCALING_WARMUP_FRAMES)
+    {
+        _scalingStartTime = Game::getAbsoluteTime();
+    }
+    else if (_scalingFrame == SCALING_WARMUP_FRAMES + BENCHMARK_FRAMES)
+    {
+        appendResult("%s%u %s %.3f ms", _scalingWorkerCount == 1 ? "" : ", ", _scalingWorkerCount,
+            _scalingWorkerCount == 1 ? "thread" : "threads", (Game::getAbsoluteTime() - _scalingStartTime) / BENCHMARK_FRAMES);
+
+        _scalingFrame = 0;
+        _scalingWorkerCount *= 2;
+        if (_scalingWorkerCount > SCALING_MAX_WORKERS)
+            stopScaling();
+        else
+            Game::getInstance()->getJobSystem()->setWorkerCount(_scalingWorkerCount);
+    }
+}
+
+void AnimationBenchmarkTest::benchmarkRig(const char* name, unsigned int characterCount, unsigned int jointCount, unsigned int keyCount)
+{
+    // All channels of a rig share the key times, as exported from a skeleton that is
+    // sampled at a fixed rate.
+    std::vector<float> keyTimes(keyCount);
+    for (unsigned int i = 0; i < keyCount; ++i)
+        keyTimes[i] = (float)i / (float)(keyCount - 1);
+
+    // The curves and values of each channel, for each character, with the joints of a channel next to each other.
+    unsigned int batchCount = characterCount * CHANNEL_COUNT;
+    std::vector<Curve*> curves(batchCount * jointCount);
+    std::vector<float> values(batchCount * jointCount * 4);
+    std::vector<float*> dst(curves.size());
+    for (unsigned int batch = 0; batch < batchCount; ++batch)
+    {
+        for (unsigned int joint = 0; joint < jointCount; ++joint)
+        {
+            unsigned int index = batch * jointCount + joint;
+            curves[index] = createChannelCurve(batch % CHANNEL_COUNT, keyCount, &keyTimes[0]);
+            dst[index] = &values[index * 4];
+        }
+    }
+
+    double times[3];
+    for (unsigned int pass = 0; pass < 3; ++pass)
+    {
+        std::vector<unsigned int> pointIndices(curves.size(), 0);
+
+        double start = Game::getAbsoluteTime();
+        for (unsigned int frame = 0; frame < BENCHMARK_FRAMES; ++frame)
+        {
+            float time = (float)frame / (float)(BENCHMARK_FRAMES - 1);
+            if (pass == 0)
+            {
+                for (size_t i = 0, count = curves.size(); i < count; ++i)
+                    curves[i]->evaluate(time, dst[i]);
+            }
+            else if (pass == 1)
+            {
+                for (size_t i = 0, count = curves.size(); i < count; ++i)
+                    curves[i]->evaluate(time, dst[i], &pointIndices[i]);
+            }
+            else
+            {
+                for (unsigned int batch = 0; batch < batchCount; ++batch)
+                {
+                    unsigned int first = batch * jointCount;
+                    Curve::evaluateLinear(&curves[first], jointCount, time, &dst[first], &pointIndices[batch]);
+                }
+            }
+        }
+        times[pass] = (Game::getAbsoluteTime() - start) / BENCHMARK_FRAMES;
+    }
+
+    // Check the cursors and the batches against searching the keys, at times between the frames.
+    float maxError = 0.0f;
+    std::vector<float> expected(values.size());
+    std::vector<unsigned int> pointIndices[2] = { std::vector<unsigned int>(curves.size(), 0), std::vector<unsigned int>(curves.size(), 0) };
+    for (unsigned int sample = 0; sample < 10; ++sample)
+    {
+        float time = (sample + 0.5f) / 10.0f;
+        for (size_t i = 0, count = curves.size(); i < count; ++i)
+            curves[i]->evaluate(time, &expected[i * 4]);
+        for (unsigned int pass = 0; pass < 2; ++pass)
+        {
+            if (pass == 0)
+            {
+                for (size_t i = 0, count = curves.size(); i < count; ++i)
+                    curves[i]->evaluate(time, dst[i], &pointIndices[0][i]);
+            }
+            else
+            {
+                for (unsigned int batch = 0; batch < batchCount; ++batch)
+                {
+                    unsigned int first = batch * jointCount;
+                    Curve::evaluateLinear(&curves[first], jointCount, time, &dst[first], &pointIndices[1][batch]);
+                }
+            }
+            for (size_t i = 0, count = curves.size(); i < count; ++i)
+            {
+                for (unsigned int j = 0, componentCount = curves[i]->getComponentCount(); j < componentCount; ++j)
+                    maxError = std::max(maxError, fabs(dst[i][j] - expected[i * 4 + j]));
+            }
+        }
+    }
+
+    for (size_t i = 0, count = curves.size(); i < count; ++i)
+        SAFE_RELEASE(curves[i]);
+
+    addResult("%s: search %.3f ms, cursor %.3f ms, batch %.3f ms per frame (%u joints x %u channels)",
+        name, times[0], times[1], times[2], jointCount, CHANNEL_COUNT);
+    check(maxError < 0.0001f, "%s: the cursors and batches differ from searching the keys by %g", name, maxError);
+}
+
+void AnimationBenchmarkTest::benchmarkClones(const char* name, unsigned int cloneCount, unsigned int jointCount, unsigned int keyCount)
+{
+    Node* character = createCharacter(jointCount, keyCount);
+
+    std::vector<Node*> clones(cloneCount);
+    double start = Game::getAbsoluteTime();
+    for (unsigned int i = 0; i < cloneCount; ++i)
+        clones[i] = character->clone();
+    double time = (Game::getAbsoluteTime() - start) / cloneCount;
+
+    // The memory of a clone is computed from its animations: the animation, channel and clip
+    // records that each clone owns, and the values and point cursors that its clips allocate
+    // while they play. The curves are not counted since a clone shares the curve set of the
+    // character.
+    unsigned int stateBytes = 0;
+    unsigned int valueBytes = 0;
+    unsigned int sharedCount = 0;
+    unsigned int animationCount = 0;
+    for (Node* joint = clones[0]->getFirstChild(), *source = character->getFirstChild(); joint && source;
+        joint = joint->getNextSibling(), source = source->getNextSibling())
+    {
+        Animation* animation = joint->getAnimation("walk");
+        if (animation == NULL)
+            continue;
+        Animation::CurveSet* curveSet = animation->getCurveSet();
+        unsigned int channelCount = (unsigned int)animation->_channels.size();
+        stateBytes += sizeof(Animation) + channelCount * sizeof(Animation::Channel) + animation->getClipCount() * sizeof(AnimationClip);
+        if (curveSet)
+            valueBytes += curveSet->valueCount * sizeof(float) + channelCount * (sizeof(unsigned int) + sizeof(float*));
+        if (curveSet && curveSet == source->getAnimation("walk")->getCurveSet())
+            sharedCount++;
+        animationCount++;
+    }
+
+    addResult("%s: %.3f ms, %u bytes per clone and %u bytes per playing clip (%u joints)",
+        name, time, stateBytes, valueBytes, jointCount);
+    check(sharedCount == animationCount, "%s: only %u of %u curve sets are shared with the character", name, sharedCount, animationCount);
+
+    for (unsigned int i = 0; i < cloneCount; ++i)
+        SAFE_RELEASE(clones[i]);
+    SAFE_RELEASE(character);
+}
+
+void AnimationBenchmarkTest::benchmarkEvents(const char* name, unsigned int clipCount, unsigned int eventCount)
+{
+    Node* character = createCharacter(clipCount, 2);
+    std::vector<AnimationClip*> clips;
+    for (Node* joint = character->getFirstChild(); joint; joint = joint->getNextSibling())
+        clips.push_back(joint->getAnimation("walk")->getClip());
+
+    // Events are added at random times, as footsteps and sounds are authored out of order.
+    std::vector<unsigned long> eventTimes(eventCount);
+    for (unsigned int i = 0; i < eventCount; ++i)
+        eventTimes[i] = rand() % (clips[0]->getDuration() + 1);
+
+    double start = Game::getAbsoluteTime();
+    for (size_t i = 0, count = clips.size(); i < count; ++i)
+    {
+        for (unsigned int j = 0; j < eventCount; ++j)
+            clips[i]->addListener(&__eventListener, eventTimes[j]);
+    }
+    double time = (Game::getAbsoluteTime() - start) / clips.size();
+
+    std::vector<ListenerList*> lists(clips.size());
+    start = Game::getAbsoluteTime();
+    for (size_t i = 0, count = clips.size(); i < count; ++i)
+    {
+        lists[i] = new ListenerList();
+        for (unsigned int j = 0; j < eventCount; ++j)
+            lists[i]->add(&__eventListener, eventTimes[j]);
+    }
+    double listTime = (Game::getAbsoluteTime() - start) / clips.size();
+
+    addResult("%s: %.3f ms to add %u events per clip, %.3f ms with a list", name, time, eventCount, listTime);
+
+    for (size_t i = 0, count = lists.size(); i < count; ++i)
+        SAFE_DELETE(lists[i]);
+    SAFE_RELEASE(character);
+}
+
+void AnimationBenchmarkTest::benchmarkDispatch(const char* name, unsigned int clipCount, unsigned int eventCount, unsigned int frameCount)
+{
+    // The clips of one character store their events, and those of the other character are
+    // updated the same way with their events stored in lists.
+    Node* characters[2] = { createCharacter(clipCount, 2), createCharacter(clipCount, 2) };
+    std::vector<AnimationClip*> clips[2];
+    for (unsigned int c = 0; c < 2; ++c)
+    {
+        for (Node* joint = characters[c]->getFirstChild(); joint; joint = joint->getNextSibling())
+        {
+            AnimationClip* clip = joint->getAnimation("walk")->getClip();
+            clip->setRepeatCount(AnimationClip::REPEAT_INDEFINITE);
+            clip->_timeStarted = Game::getGameTime();
+            clips[c].push_back(clip);
+        }
+    }
+
+    // The events that the clips of the first character trigger are checked against lists
+    // that are notified once the clips are no longer updated, which triggers all of the
+    // events that the clips passed.
+    EventListener listener;
+    EventListener expected;
+    std::vector<ListenerList*> lists(clipCount);
+    std::vector<ListenerList*> expectedLists(clipCount);
+    for (unsigned int i = 0; i < clipCount; ++i)
+    {
+        lists[i] = new ListenerList();
+        expectedLists[i] = new ListenerList();
+        for (unsigned int j = 0; j < eventCount; ++j)
+        {
+            unsigned long eventTime = rand() % clips[0][i]->getDuration();
+            clips[0][i]->addListener(&listener, eventTime);
+            lists[i]->add(&__eventListener, eventTime);
+            expectedLists[i]->add(&expected, eventTime);
+        }
+        lists[i]->start();
+    }
+
+    // Update the clips directly, so that only the clips of each character are updated.
+    double times[2];
+    for (unsigned int c = 0; c < 2; ++c)
+    {
+        double start = Game::getAbsoluteTime();
+        for (unsigned int frame = 0; frame < frameCount; ++frame)
+        {
+            for (unsigned int i = 0; i < clipCount; ++i)
+            {
+                clips[c][i]->update(16.0f);
+                if (c == 1)
+                    lists[i]->notify(clips[c][i]);
+            }
+        }
+        times[c] = (Game::getAbsoluteTime() - start) / frameCount;
+    }
+
+    for (unsigned int i = 0; i < clipCount; ++i)
+    {
+        expectedLists[i]->start();
+        expectedLists[i]->notify(clips[0][i]);
+    }
+
+    addResult("%s: %.3f ms per frame with %u events per clip, %.3f ms with lists", name, times[0], eventCount, times[1]);
+    check(listener.eventCount == expected.eventCount, "%s: the clips triggered %u events instead of %u",
+        name, listener.eventCount, expected.eventCount);
+
+    for (unsigned int i = 0; i < clipCount; ++i)
+    {
+        SAFE_DELETE(lists[i]);
+        SAFE_DELETE(expectedLists[i]);
+    }
+    SAFE_RELEASE(characters[0]);
+    SAFE_RELEASE(characters[1]);
+}
+
+void AnimationBenchmarkTest::benchmarkDeferredLoad(const char* path)
+{
+    // Load the scene of the bundle with the curves of its animations, and with the curves
+    // loaded on demand. The file is read once up front so that both loads find it in the
+    // same (warm) cache, and the bundle is released from the resource cache in between, so
+    // that both loads open it.
+    int size = 0;
+    char* data = FileSystem::readAll(path, &size);
+    SAFE_DELETE_ARRAY(data);
+    bool deferred = Bundle::isAnimationLoadingDeferred();
+    Scene* scenes[2] = { NULL, NULL };
+    double times[2];
+    for (unsigned int pass = 0; pass < 2; ++pass)
+    {
+        Bundle::setAnimationLoadingDeferred(pass == 1);
+        double start = Game::getAbsoluteTime();
+        Bundle* bundle = Bundle::create(path);
+        if (bundle)
+            scenes[pass] = bundle->loadScene();
+        times[pass] = Game::getAbsoluteTime() - start;
+        SAFE_RELEASE(bundle);
+        ResourceManager::releaseUnreferenced();
+    }
+    Bundle::setAnimationLoadingDeferred(deferred);
+
+    std::vector<Animation*> animations[2];
+    for (unsigned int pass = 0; pass < 2; ++pass)
+    {
+        if (scenes[pass])
+            gatherAnimations(scenes[pass]->getFirstNode(), animations[pass]);
+    }
+    if (!check(!animations[0].empty() && animations[0].size() == animations[1].size(), "%s: loaded %u animations, %u on demand",
+        path, (unsigned int)animations[0].size(), (unsigned int)animations[1].size()))
+    {
+        SAFE_RELEASE(scenes[0]);
+        SAFE_RELEASE(scenes[1]);
+        return;
+    }
+
+    // The curves loaded on demand, and loaded again after they were evicted, have to be the
+    // same as the curves that were loaded with the scene.
+    unsigned int loadedCount = 0;
+    for (size_t i = 0, count = animations[1].size(); i < count; ++i)
+    {
+        if (animations[1][i]->isLoaded())
+            loadedCount++;
+    }
+
+    double start = Game::getAbsoluteTime();
+    for (size_t i = 0, count = animations[1].size(); i < count; ++i)
+        animations[1][i]->prefetch();
+    double prefetchTime = Game::getAbsoluteTime() - start;
+
+    float errors[2] = { 0.0f, 0.0f };
+    for (size_t i = 0, count = animations[1].size(); i < count; ++i)
+        errors[0] = std::max(errors[0], compareCurves(animations[0][i], animations[1][i]));
+
+    Game::getInstance()->getAnimationController()->evictAnimations(0);
+    unsigned int evictedCount = 0;
+    for (size_t i = 0, count = animations[1].size(); i < count; ++i)
+    {
+        if (!animations[1][i]->isLoaded())
+            evictedCount++;
+        animations[1][i]->prefetch();
+        errors[1] = std::max(errors[1], compareCurves(animations[0][i], animations[1][i]));
+    }
+
+    SAFE_RELEASE(scenes[0]);
+    SAFE_RELEASE(scenes[1]);
+
+    addResult("%s: %.3f ms to load, %.3f ms with curves on demand and %.3f ms to prefetch them (%u animations)",
+        path, times[0], times[1], prefetchTime, (unsigned int)animations[1].size());
+    check(loadedCount == 0, "%s: %u animations loaded their curves before they were needed", path, loadedCount);
+    check(errors[0] == 0.0f, "%s: the curves loaded on demand differ by %g", path, errors[0]);
+    check(evictedCount == animations[1].size(), "%s: only %u of %u animations were evicted", path, evictedCount, (unsigned int)animations[1].size());
+    check(errors[1] == 0.0f, "%s: the curves loaded again after eviction differ by %g", path, errors[1]);
+}
+
+void AnimationBenchmarkTest::startScaling(unsigned int characterCount, unsigned int jointCount, unsigned int keyCount)
+{
+    // Play a clip on each joint of clones of a character, as a crowd would.
+    Node* character = createCharacter(jointCount, keyCount);
+    for (unsigned int i = 0; i < characterCount; ++i)
+    {
+        Node* clone = character->clone();
+        for (Node* joint = clone->getFirstChild(); joint; joint = joint->getNextSibling())
+        {
+            AnimationClip* clip = joint->getAnimation("walk")->getClip("run");
+            clip->setRepeatCount(AnimationClip::REPEAT_INDEFINITE);
+            clip->play();
+        }
+        _characters.push_back(clone);
+    }
+    SAFE_RELEASE(character);
+
+    // The processor count is reported since more workers than processors cannot scale.
+    addResult("%u clips per frame on %u processors: ", characterCount * jointCount, JobSystem::getProcessorCount());
+
+    // Update the clips on one worker first, without waiting for the display.
+    _workerCount = Game::getInstance()->getJobSystem()->getWorkerCount();
+    _vsync = isVsync();
+    setVsync(false);
+    Game::getInstance()->getJobSystem()->setWorkerCount(1);
+    _scalingWorkerCount = 1;
+    _scalingFrame = 0;
+}
+
+void AnimationBenchmarkTest::stopScaling()
+{
+    for (size_t i = 0, count = _characters.size(); i < count; ++i)
+    {
+        for (Node* joint = _characters[i]->getFirstChild(); joint; joint = joint->getNextSibling())
+            joint->getAnimation("walk")->stop();
+        SAFE_RELEASE(_characters[i]);
+    }
+    _characters.clear();
+
+    if (_scalingWorkerCount > 0)
+    {
+        Game::getInstance()->getJobSystem()->setWorkerCount(_workerCount);
+        setVsync(_vsync);
+        _scalingWorkerCount = 0;
+    }
+}
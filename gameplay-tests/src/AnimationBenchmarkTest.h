@@ -0,0 +1,59 @@
+#ifndef ANIMATIONBENCHMARKTEST_H_
+#define ANIMATIONBENCHMARKTEST_H_
+
+#include "gameplay.h"
+#include "BenchmarkTest.h"
+
+using namespace gameplay;
+
+/**
+ * Benchmarks evaluating the curves of animated characters one at a time and in batches,
+ * the memory of cloning an animated character, adding and dispatching events of clips
+ * against the list that clips stored their events in before, loading the curves of a
+ * bundle on demand, and how updating a crowd of clips scales with the number of workers.
+ * The batches, events and curves loaded on demand are checked against the paths that they
+ * replaced.
+ */
+class AnimationBenchmarkTest : public BenchmarkTest
+{
+public:
+
+    AnimationBenchmarkTest();
+
+protected:
+
+    void finalize();
+
+    void update(float elapsedTime);
+
+    void benchmark();
+
+private:
+
+    static Curve* createChannelCurve(unsigned int channel, unsigned int keyCount, const float* keyTimes);
+
+    static float compareCurves(Animation* a, Animation* b);
+
+    void benchmarkRig(const char* name, unsigned int characterCount, unsigned int jointCount, unsigned int keyCount);
+
+    void benchmarkClones(const char* name, unsigned int cloneCount, unsigned int jointCount, unsigned int keyCount);
+
+    void benchmarkEvents(const char* name, unsigned int clipCount, unsigned int eventCount);
+
+    void benchmarkDispatch(const char* name, unsigned int clipCount, unsigned int eventCount, unsigned int frameCount);
+
+    void benchmarkDeferredLoad(const char* path);
+
+    void startScaling(unsigned int characterCount, unsigned int jointCount, unsigned int keyCount);
+
+    void stopScaling();
+
+    std::vector<Node*> _characters;
+    unsigned int _scalingWorkerCount;
+    unsigned int _scalingFrame;
+    double _scalingStartTime;
+    unsigned int _workerCount;
+    bool _vsync;
+};
+
+#endif
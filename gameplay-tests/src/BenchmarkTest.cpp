@@ -0,0 +1,87 @@
+#include "BenchmarkTest.h"
+
+BenchmarkTest::BenchmarkTest()
+    : _font(NULL), _checkCount(0), _failureCount(0)
+{
+}
+
+void BenchmarkTest::initialize()
+{
+    _font = Font::create("res/common/arial18.gpb");
+
+    benchmark();
+
+    if (_failureCount > 0)
+        addResult("%u of %u checks failed", _failureCount, _checkCount);
+    else if (_checkCount > 0)
+        addResult("All %u checks passed", _checkCount);
+}
+
+void BenchmarkTest::finalize()
+{
+    SAFE_RELEASE(_font);
+}
+
+void BenchmarkTest::update(float elapsedTime)
+{
+}
+
+void BenchmarkTest::render(float elapsedTime)
+{
+    clear(CLEAR_COLOR_DEPTH, Vector4::zero(), 1.0f, 0);
+
+    _font->start();
+    unsigned int y = 10;
+    for (size_t i = 0, count = _results.size(); i < count; ++i)
+    {
+        _font->drawText(_results[i].text.c_str(), 10, y, _results[i].failed ? Vector4(1, 0, 0, 1) : Vector4::one(), _font->getSize());
+        y += _font->getSize();
+    }
+    _font->finish();
+}
+
+void BenchmarkTest::addResult(const char* format, ...)
+{
+    va_list arguments;
+    va_start(arguments, format);
+    pushResult(format, arguments, false);
+    va_end(arguments);
+}
+
+void BenchmarkTest::appendResult(const char* format, ...)
+{
+    if (_results.empty())
+        return;
+
+    char buffer[256];
+    va_list arguments;
+    va_start(arguments, format);
+    vsnprintf(buffer, sizeof(buffer), format, arguments);
+    va_end(arguments);
+    _results.back().text += buffer;
+}
+
+bool BenchmarkTest::check(bool passed, const char* format, ...)
+{
+    ++_checkCount;
+    if (passed)
+        return true;
+
+    ++_failureCount;
+    va_list arguments;
+    va_start(arguments, format);
+    pushResult(format, arguments, true);
+    va_end(arguments);
+    GP_WARN("Benchmark check failed: %s", _results.back().text.c_str());
+    return false;
+}
+
+void BenchmarkTest::pushResult(const char* format, va_list arguments, bool failed)
+{
+    char buffer[256];
+    vsnprintf(buffer, sizeof(buffer), format, arguments);
+    Result result;
+    result.text = buffer;
+    result.failed = failed;
+    _results.push_back(result);
+}
@@ -0,0 +1,77 @@
+#ifndef BENCHMARKTEST_H_
+#define BENCHMARKTEST_H_
+
+#include "gameplay.h"
+#include "Test.h"
+
+using namespace gameplay;
+
+/**
+ * Base class for the benchmark tests.
+ *
+ * The benchmarks run once when the test is initialized, and add lines of results that are
+ * drawn every frame. Benchmarks that time a path against the path that it replaced also check
+ * that both give the same results. Failed checks are logged and drawn in red.
+ */
+class BenchmarkTest : public Test
+{
+public:
+
+    BenchmarkTest();
+
+protected:
+
+    void initialize();
+
+    void finalize();
+
+    void update(float elapsedTime);
+
+    void render(float elapsedTime);
+
+    /**
+     * Runs the benchmarks of the test.
+     */
+    virtual void benchmark() = 0;
+
+    /**
+     * Adds a line of results.
+     *
+     * @param format The format of the line, as for printf.
+     */
+    void addResult(const char* format, ...);
+
+    /**
+     * Appends to the last line of results.
+     *
+     * @param format The format of the text, as for printf.
+     */
+    void appendResult(const char* format, ...);
+
+    /**
+     * Checks a result of a benchmark, and adds a line that describes the check if it fails.
+     *
+     * @param passed Whether the check passed.
+     * @param format The description of the check, as for printf.
+     *
+     * @return <code>passed</code>.
+     */
+    bool check(bool passed, const char* format, ...);
+
+private:
+
+    struct Result
+    {
+        std::string text;
+        bool failed;
+    };
+
+    void pushResult(const char* format, va_list arguments, bool failed);
+
+    Font* _font;
+    std::vector<Result> _results;
+    unsigned int _checkCount;
+    unsigned int _failureCount;
+};
+
+#endif
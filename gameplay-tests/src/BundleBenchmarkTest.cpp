@@ -0,0 +1,129 @@
+#include "BundleBenchmarkTest.h"
+#include "TestsGame.h"
+
+#if defined(ADD_TEST)
+    ADD_TEST("Benchmark", "Bundle", BundleBenchmarkTest, 3);
+#endif
+
+#define BENCHMARK_ITERATIONS 10
+
+/**
+ * Reads a file through a stream opened with the given mode, from the mapping of the stream
+ * if it is mapped and the stream supports mapping.
+ */
+static std::string readFile(const char* path, size_t mode, bool mapped)
+{
+    std::string data;
+    Stream* stream = FileSystem::open(path, mode);
+    if (stream == NULL)
+        return data;
+
+    size_t length = stream->length();
+    const char* mapping = mapped ? static_cast<const char*>(stream->map(length)) : NULL;
+    if (mapping)
+    {
+        data.assign(mapping, length);
+    }
+    else
+    {
+        data.resize(length);
+        if (length > 0)
+            data.resize(stream->read(&data[0], 1, length));
+    }
+    SAFE_DELETE(stream);
+    return data;
+}
+
+/**
+ * Determines whether two lists of sibling nodes that were loaded from the same bundle
+ * have the same transforms and meshes, along with their descendants.
+ */
+static bool compareNodes(Node* a, Node* b)
+{
+    for (; a && b; a = a->getNextSibling(), b = b->getNextSibling())
+    {
+        if (strcmp(a->getId(), b->getId()) != 0 || memcmp(a->getMatrix().m, b->getMatrix().m, sizeof(Matrix)) != 0)
+            return false;
+
+        Model* models[2] = { a->getModel(), b->getModel() };
+        if ((models[0] == NULL) != (models[1] == NULL))
+            return false;
+        if (models[0])
+        {
+            Mesh* meshes[2] = { models[0]->getMesh(), models[1]->getMesh() };
+            if (meshes[0]->getVertexCount() != meshes[1]->getVertexCount() || meshes[0]->getVertexSize() != meshes[1]->getVertexSize() ||
+                meshes[0]->getPartCount() != meshes[1]->getPartCount() ||
+                memcmp(&meshes[0]->getBoundingBox(), &meshes[1]->getBoundingBox(), sizeof(BoundingBox)) != 0)
+                return false;
+            for (unsigned int i = 0, count = meshes[0]->getPartCount(); i < count; ++i)
+            {
+                if (meshes[0]->getPart(i)->getIndexCount() != meshes[1]->getPart(i)->getIndexCount())
+                    return false;
+            }
+        }
+
+        if (!compareNodes(a->getFirstChild(), b->getFirstChild()))
+            return false;
+    }
+    return a == b;
+}
+
+BundleBenchmarkTest::BundleBenchmarkTest()
+{
+}
+
+void BundleBenchmarkTest::benchmark()
+{
+    benchmarkLoad("res/common/duck.gpb");
+    benchmarkLoad("res/common/scene.gpb");
+    benchmarkLoad("res/common/physics.gpb");
+}
+
+void BundleBenchmarkTest::benchmarkLoad(const char* path)
+{
+    bool mappingEnabled = Bundle::isMappingEnabled();
+
+    // Load once up front so that both passes read the file from the same (warm) cache.
+    double times[2];
+    Scene* scenes[2] = { NULL, NULL };
+    load(path, false, NULL);
+    times[0] = load(path, false, &scenes[0]);
+    times[1] = load(path, true, &scenes[1]);
+
+    Bundle::setMappingEnabled(mappingEnabled);
+
+    addResult("%s: stream %.3f ms, mapped %.3f ms", path, times[0], times[1]);
+
+    std::string data = readFile(path, FileSystem::READ, false);
+    check(!data.empty() && readFile(path, FileSystem::READ | FileSystem::MAP, true) == data,
+        "%s: the mapping differs from the file", path);
+    check(scenes[0] && scenes[1] && compareNodes(scenes[0]->getFirstNode(), scenes[1]->getFirstNode()),
+        "%s: the scenes loaded through the stream and the mapping differ", path);
+
+    SAFE_RELEASE(scenes[0]);
+    SAFE_RELEASE(scenes[1]);
+}
+
+double BundleBenchmarkTest::load(const char* path, bool mapped, Scene** scene)
+{
+    Bundle::setMappingEnabled(mapped);
+
+    // The bundles are released from the resource cache after each load, so that each load
+    // opens the file again.
+    double start = Game::getAbsoluteTime();
+    for (unsigned int iteration = 0; iteration < BENCHMARK_ITERATIONS; ++iteration)
+    {
+        Bundle* bundle = Bundle::create(path);
+        if (bundle == NULL)
+            return 0.0;
+
+        Scene* loaded = bundle->loadScene();
+        if (scene && iteration == BENCHMARK_ITERATIONS - 1)
+            *scene = loaded;
+        else
+            SAFE_RELEASE(loaded);
+        SAFE_RELEASE(bundle);
+        ResourceManager::releaseUnreferenced();
+    }
+    return (Game::getAbsoluteTime() - start) / BENCHMARK_ITERATIONS;
+}
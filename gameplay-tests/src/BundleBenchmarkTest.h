@@ -0,0 +1,30 @@
+#ifndef BUNDLEBENCHMARKTEST_H_
+#define BUNDLEBENCHMARKTEST_H_
+
+#include "gameplay.h"
+#include "BenchmarkTest.h"
+
+using namespace gameplay;
+
+/**
+ * Benchmarks loading bundles through a file stream and through a memory mapping, checking
+ * that both read the same data and load the same scene.
+ */
+class BundleBenchmarkTest : public BenchmarkTest
+{
+public:
+
+    BundleBenchmarkTest();
+
+protected:
+
+    void benchmark();
+
+private:
+
+    void benchmarkLoad(const char* path);
+
+    double load(const char* path, bool mapped, Scene** scene);
+};
+
+#endif
@@ -0,0 +1,182 @@
+#include "FileSystemBenchmarkTest.h"
+#include "TestsGame.h"
+
+#if defined(ADD_TEST)
+    ADD_TEST("Benchmark", "File System", FileSystemBenchmarkTest, 6);
+#endif
+
+#define BENCHMARK_ITERATIONS 10
+
+// The directories of the resources that are loaded.
+static const char* __directories[] = { "res/common", "res/common/forms", "res/common/postprocess", "res/common/terrain", "res/png" };
+
+/**
+ * Computes the FNV-1a hash of the given data.
+ */
+static unsigned int checksum(const char* data, int size)
+{
+    unsigned int hash = 2166136261u;
+    for (int i = 0; i < size; ++i)
+        hash = (hash ^ (unsigned char)data[i]) * 16777619u;
+    return hash;
+}
+
+/**
+ * Writes the namespaces and properties of the given properties to a string.
+ */
+static void describe(Properties* properties, std::string& description)
+{
+    description += properties->getNamespace();
+    description += " ";
+    description += properties->getId();
+    description += "\n{\n";
+    for (const char* name = properties->getNextProperty(); name; name = properties->getNextProperty())
+    {
+        description += name;
+        description += " = ";
+        description += properties->getString(name);
+        description += "\n";
+    }
+    for (Properties* space = properties->getNextNamespace(); space; space = properties->getNextNamespace())
+        describe(space, description);
+    description += "}\n";
+}
+
+FileSystemBenchmarkTest::FileSystemBenchmarkTest()
+{
+}
+
+void FileSystemBenchmarkTest::benchmark()
+{
+    for (size_t i = 0; i < sizeof(__directories) / sizeof(__directories[0]); ++i)
+    {
+        std::vector<std::string> files;
+        FileSystem::listFiles(__directories[i], files);
+        for (size_t j = 0; j < files.size(); ++j)
+            _files.push_back(std::string(__directories[i]) + "/" + files[j]);
+    }
+
+    // The archives are created from the res directory with gameplay-encoder, with and
+    // without compression.
+    benchmarkLoad(NULL);
+    benchmarkLoad("res.gpk");
+    benchmarkLoad("res-stored.gpk");
+
+    benchmarkProperties("benchmark.scene", 5000);
+}
+
+void FileSystemBenchmarkTest::benchmarkLoad(const char* archivePath)
+{
+    if (archivePath && !FileSystem::fileExists(archivePath))
+    {
+        addResult("%s: not found, create it with gameplay-encoder %s res %s", archivePath,
+            strstr(archivePath, "stored") ? "-ps" : "-pack", archivePath);
+        return;
+    }
+
+    // The first load reads files that are not in memory yet, unless they were read recently,
+    // and includes mounting the archive.
+    size_t size = 0;
+    double start = Game::getAbsoluteTime();
+    if (archivePath && !FileSystem::mountArchive(archivePath))
+        return;
+    load(&size, NULL);
+    double cold = Game::getAbsoluteTime() - start;
+    double warm = load(&size, NULL);
+
+    // The loose files are loaded first, and the files in the archives are checked against them.
+    std::vector<unsigned int> checksums;
+    load(&size, &checksums);
+    if (archivePath)
+        FileSystem::unmountArchive(archivePath);
+
+    addResult("%s: first %.3f ms, again %.3f ms (%u files, %u KB)", archivePath ? archivePath : "loose files",
+        cold, warm, (unsigned int)_files.size(), (unsigned int)(size / 1024));
+    if (archivePath == NULL)
+    {
+        _checksums = checksums;
+        return;
+    }
+    unsigned int mismatches = 0;
+    for (size_t i = 0, count = _files.size(); i < count; ++i)
+    {
+        if (checksums[i] != _checksums[i])
+        {
+            GP_WARN("%s differs from the loose file in %s.", _files[i].c_str(), archivePath);
+            ++mismatches;
+        }
+    }
+    check(mismatches == 0, "%s: %u of %u files differ from the loose files", archivePath, mismatches, (unsigned int)_files.size());
+}
+
+void FileSystemBenchmarkTest::benchmarkProperties(const char* path, unsigned int nodeCount)
+{
+    // Write a scene with many nodes, as exported from a level editor.
+    Stream* stream = FileSystem::open(path, FileSystem::WRITE);
+    if (!stream)
+        return;
+    char buffer[256];
+    const char* header = "scene\n{\n    path = res/common/box.gpb\n\n";
+    stream->write(header, 1, strlen(header));
+    for (unsigned int i = 0; i < nodeCount; ++i)
+    {
+        int length = sprintf(buffer, "    node box%u\n    {\n        url = res/common/box.gpb#box\n"
+            "        material = res/common/box.material\n        translate = %u, 0, %u\n"
+            "        tags\n        {\n            dynamic = true\n        }\n    }\n\n", i, i % 100, i / 100);
+        stream->write(buffer, 1, length);
+    }
+    stream->write("}\n", 1, 2);
+    size_t size = stream->position();
+    SAFE_DELETE(stream);
+
+    // Parse the scene without the compiled properties cache, then load it from the cache.
+    const char* cachePath = Properties::getCachePath();
+    std::string previousCachePath = cachePath ? cachePath : "";
+    std::string descriptions[2];
+    for (unsigned int cached = 0; cached < 2; ++cached)
+    {
+        Properties::setCachePath(cached ? "." : NULL);
+        Properties* properties = Properties::create(path);
+        if (properties)
+            describe(properties, descriptions[cached]);
+        SAFE_DELETE(properties);
+
+        double start = Game::getAbsoluteTime();
+        for (unsigned int iteration = 0; iteration < BENCHMARK_ITERATIONS; ++iteration)
+        {
+            properties = Properties::create(path);
+            SAFE_DELETE(properties);
+        }
+        double time = (Game::getAbsoluteTime() - start) / BENCHMARK_ITERATIONS;
+
+        addResult("%s: %.3f ms to %s (%u nodes, %u KB)", path, time, cached ? "load from the cache" : "parse",
+            nodeCount, (unsigned int)(size / 1024));
+    }
+    Properties::setCachePath(previousCachePath.empty() ? NULL : previousCachePath.c_str());
+
+    check(!descriptions[0].empty() && descriptions[0] == descriptions[1], "%s: the cached properties differ from the parsed ones", path);
+}
+
+double FileSystemBenchmarkTest::load(size_t* size, std::vector<unsigned int>* checksums)
+{
+    *size = 0;
+    double start = Game::getAbsoluteTime();
+    for (size_t i = 0, count = _files.size(); i < count; ++i)
+    {
+        // Loaders check that files exist before they open them.
+        if (!FileSystem::fileExists(_files[i].c_str()))
+        {
+            if (checksums)
+                checksums->push_back(0);
+            continue;
+        }
+
+        int fileSize = 0;
+        char* data = FileSystem::readAll(_files[i].c_str(), &fileSize);
+        if (checksums)
+            checksums->push_back(checksum(data, data ? fileSize : 0));
+        SAFE_DELETE_ARRAY(data);
+        *size += fileSize;
+    }
+    return Game::getAbsoluteTime() - start;
+}
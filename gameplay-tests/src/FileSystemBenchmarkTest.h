@@ -0,0 +1,36 @@
+#ifndef FILESYSTEMBENCHMARKTEST_H_
+#define FILESYSTEMBENCHMARKTEST_H_
+
+#include "gameplay.h"
+#include "BenchmarkTest.h"
+
+using namespace gameplay;
+
+/**
+ * Benchmarks loading the resources of the tests as loose files and from mounted archives,
+ * and parsing a large scene file, checking that the archives and the compiled properties
+ * cache give the same contents as the files.
+ */
+class FileSystemBenchmarkTest : public BenchmarkTest
+{
+public:
+
+    FileSystemBenchmarkTest();
+
+protected:
+
+    void benchmark();
+
+private:
+
+    void benchmarkLoad(const char* archivePath);
+
+    double load(size_t* size, std::vector<unsigned int>* checksums);
+
+    void benchmarkProperties(const char* path, unsigned int nodeCount);
+
+    std::vector<std::string> _files;
+    std::vector<unsigned int> _checksums;
+};
+
+#endif
@@ -0,0 +1,217 @@
+#include "MathBenchmarkTest.h"
+#include "TestsGame.h"
+
+#if defined(ADD_TEST)
+    ADD_TEST("Benchmark", "Math", MathBenchmarkTest, 2);
+#endif
+
+#define BENCHMARK_ITERATIONS 100
+
+#if defined(USE_NEON)
+    #define MATH_BACKEND "neon"
+#elif defined(USE_SSE)
+    #define MATH_BACKEND "sse"
+#else
+    #define MATH_BACKEND "scalar"
+#endif
+
+/**
+ * Multiplies two matrices with plain scalar code, as a reference for the math library.
+ */
+static void multiplyScalar(const float* m1, const float* m2, float* dst)
+{
+    float product[16];
+    for (unsigned int column = 0; column < 4; ++column)
+    {
+        for (unsigned int row = 0; row < 4; ++row)
+        {
+            product[column * 4 + row] = m1[row] * m2[column * 4] + m1[row + 4] * m2[column * 4 + 1] +
+                m1[row + 8] * m2[column * 4 + 2] + m1[row + 12] * m2[column * 4 + 3];
+        }
+    }
+    memcpy(dst, product, sizeof(product));
+}
+
+/**
+ * Transforms a point with plain scalar code, as a reference for the math library.
+ */
+static void transformScalar(const float* m, const Vector3& point, Vector3* dst)
+{
+    float x = point.x * m[0] + point.y * m[4] + point.z * m[8] + m[12];
+    float y = point.x * m[1] + point.y * m[5] + point.z * m[9] + m[13];
+    float z = point.x * m[2] + point.y * m[6] + point.z * m[10] + m[14];
+    dst->set(x, y, z);
+}
+
+/**
+ * Returns the largest difference between the given arrays of floats.
+ */
+static float maxDifference(const float* a, const float* b, size_t count)
+{
+    float difference = 0.0f;
+    for (size_t i = 0; i < count; ++i)
+        difference = std::max(difference, fabs(a[i] - b[i]));
+    return difference;
+}
+
+static void createRandomMatrix(Matrix* dst)
+{
+    Quaternion rotation(MATH_RANDOM_MINUS1_1(), MATH_RANDOM_MINUS1_1(), MATH_RANDOM_MINUS1_1(), 1.0f);
+    rotation.normalize();
+    Matrix::createRotation(rotation, dst);
+    dst->translate(MATH_RANDOM_MINUS1_1() * 10.0f, MATH_RANDOM_MINUS1_1() * 10.0f, MATH_RANDOM_MINUS1_1() * 10.0f);
+}
+
+MathBenchmarkTest::MathBenchmarkTest()
+{
+}
+
+void MathBenchmarkTest::benchmark()
+{
+    addResult("Backend: " MATH_BACKEND);
+    benchmarkMultiply("Matrix multiply", 10000);
+    benchmarkTransform("Point transform", 100000);
+    benchmarkBounds("Bounds transform", 10000);
+}
+
+void MathBenchmarkTest::benchmarkMultiply(const char* name, unsigned int count)
+{
+    std::vector<Matrix> parents(count);
+    std::vector<Matrix> locals(count);
+    std::vector<Matrix> worlds(count);
+    for (unsigned int i = 0; i < count; ++i)
+    {
+        createRandomMatrix(&parents[i]);
+        createRandomMatrix(&locals[i]);
+    }
+
+    // The single and batched products are checked against the scalar ones.
+    double times[3];
+    float errors[3] = { 0.0f, 0.0f, 0.0f };
+    std::vector<Matrix> expected;
+    for (unsigned int pass = 0; pass < 3; ++pass)
+    {
+        double start = Game::getAbsoluteTime();
+        for (unsigned int iteration = 0; iteration < BENCHMARK_ITERATIONS; ++iteration)
+        {
+            if (pass == 0)
+            {
+                for (unsigned int i = 0; i < count; ++i)
+                    multiplyScalar(parents[i].m, locals[i].m, worlds[i].m);
+            }
+            else if (pass == 1)
+            {
+                for (unsigned int i = 0; i < count; ++i)
+                    Matrix::multiply(parents[i], locals[i], &worlds[i]);
+            }
+            else
+            {
+                Matrix::multiply(&parents[0], &locals[0], count, &worlds[0]);
+            }
+        }
+        times[pass] = (Game::getAbsoluteTime() - start) / BENCHMARK_ITERATIONS;
+
+        if (pass == 0)
+            expected = worlds;
+        else
+            errors[pass] = maxDifference(worlds[0].m, expected[0].m, count * 16);
+    }
+
+    addResult("%s: scalar %.3f ms, " MATH_BACKEND " %.3f ms, batch %.3f ms (%u matrices)", name, times[0], times[1], times[2], count);
+    check(errors[1] < 0.0001f && errors[2] < 0.0001f, "%s: " MATH_BACKEND " differs from scalar by %g, batch by %g", name, errors[1], errors[2]);
+}
+
+void MathBenchmarkTest::benchmarkTransform(const char* name, unsigned int count)
+{
+    Matrix matrix;
+    createRandomMatrix(&matrix);
+    std::vector<Vector3> points(count);
+    std::vector<Vector3> results(count);
+    for (unsigned int i = 0; i < count; ++i)
+    {
+        points[i].set(MATH_RANDOM_MINUS1_1(), MATH_RANDOM_MINUS1_1(), MATH_RANDOM_MINUS1_1());
+    }
+
+    double times[3];
+    float errors[3] = { 0.0f, 0.0f, 0.0f };
+    std::vector<Vector3> expected;
+    for (unsigned int pass = 0; pass < 3; ++pass)
+    {
+        double start = Game::getAbsoluteTime();
+        for (unsigned int iteration = 0; iteration < BENCHMARK_ITERATIONS; ++iteration)
+        {
+            if (pass == 0)
+            {
+                for (unsigned int i = 0; i < count; ++i)
+                    transformScalar(matrix.m, points[i], &results[i]);
+            }
+            else if (pass == 1)
+            {
+                for (unsigned int i = 0; i < count; ++i)
+                    matrix.transformPoint(points[i], &results[i]);
+            }
+            else
+            {
+                matrix.transformPoints(&points[0], count, &results[0]);
+            }
+        }
+        times[pass] = (Game::getAbsoluteTime() - start) / BENCHMARK_ITERATIONS;
+
+        if (pass == 0)
+            expected = results;
+        else
+            errors[pass] = maxDifference(&results[0].x, &expected[0].x, count * 3);
+    }
+
+    addResult("%s: scalar %.3f ms, " MATH_BACKEND " %.3f ms, batch %.3f ms (%u points)", name, times[0], times[1], times[2], count);
+    check(errors[1] < 0.0001f && errors[2] < 0.0001f, "%s: " MATH_BACKEND " differs from scalar by %g, batch by %g", name, errors[1], errors[2]);
+}
+
+void MathBenchmarkTest::benchmarkBounds(const char* name, unsigned int count)
+{
+    Matrix matrix;
+    createRandomMatrix(&matrix);
+    std::vector<BoundingBox> boxes(count);
+    std::vector<BoundingBox> results(count);
+    for (unsigned int i = 0; i < count; ++i)
+    {
+        Vector3 center(MATH_RANDOM_MINUS1_1() * 100.0f, MATH_RANDOM_MINUS1_1() * 100.0f, MATH_RANDOM_MINUS1_1() * 100.0f);
+        boxes[i].set(center - Vector3::one(), center + Vector3::one());
+    }
+
+    // Transforming each box's corners one at a time, then the whole array at once.
+    double times[2];
+    float error = 0.0f;
+    std::vector<BoundingBox> expected;
+    for (unsigned int pass = 0; pass < 2; ++pass)
+    {
+        double start = Game::getAbsoluteTime();
+        for (unsigned int iteration = 0; iteration < BENCHMARK_ITERATIONS; ++iteration)
+        {
+            if (pass == 0)
+            {
+                for (unsigned int i = 0; i < count; ++i)
+                {
+                    results[i] = boxes[i];
+                    results[i].transform(matrix);
+                }
+            }
+            else
+            {
+                BoundingBox::transform(matrix, &boxes[0], count, &results[0]);
+            }
+        }
+        times[pass] = (Game::getAbsoluteTime() - start) / BENCHMARK_ITERATIONS;
+
+        if (pass == 0)
+            expected = results;
+    }
+    for (unsigned int i = 0; i < count; ++i)
+    {
+        error = std::max(error, maxDifference(&results[i].min.x, &expected[i].min.x, 3));
+        error = std::max(error, maxDifference(&results[i].max.x, &expected[i].max.x, 3));
+    }
+
+    addResult("%s: corners %.3f ms, batch %.3f ms (%u boxes)", name, times[0], times[1], count);
+    check(error < 0.001f, "%s: batch differs from corners by %g", name, error);
+}
@@ -0,0 +1,32 @@
+#ifndef MATHBENCHMARKTEST_H_
+#define MATHBENCHMARKTEST_H_
+
+#include "gameplay.h"
+#include "BenchmarkTest.h"
+
+using namespace gameplay;
+
+/**
+ * Benchmarks the scalar, single and batched paths of the math library, checking that they
+ * give the same results.
+ */
+class MathBenchmarkTest : public BenchmarkTest
+{
+public:
+
+    MathBenchmarkTest();
+
+protected:
+
+    void benchmark();
+
+private:
+
+    void benchmarkMultiply(const char* name, unsigned int count);
+
+    void benchmarkTransform(const char* name, unsigned int count);
+
+    void benchmarkBounds(const char* name, unsigned int count);
+};
+
+#endif
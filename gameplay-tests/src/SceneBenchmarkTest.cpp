@@ -0,0 +1,401 @@
+#include "SceneBenchmarkTest.h"
+#include "TestsGame.h"
+
+#if defined(ADD_TEST)
+    ADD_TEST("Benchmark", "Scene", SceneBenchmarkTest, 1);
+#endif
+
+#define BENCHMARK_FRAMES 100
+
+/**
+ * Creates a tree of nodes below the given parent with the specified depth and number of children per node.
+ */
+static void createHierarchy(Node* parent, unsigned int depth, unsigned int breadth, std::vector<Node*>& nodes)
+{
+    if (depth == 0)
+        return;
+
+    char id[32];
+    for (unsigned int i = 0; i < breadth; ++i)
+    {
+        sprintf(id, "node%u", (unsigned int)nodes.size());
+        Node* node = Node::create(id);
+        node->setTranslation(1.0f, 0.0f, 0.0f);
+        node->rotateY(0.01f);
+        parent->addChild(node);
+        node->release();
+        nodes.push_back(node);
+        createHierarchy(node, depth - 1, breadth, nodes);
+    }
+}
+
+SceneBenchmarkTest::SceneBenchmarkTest()
+{
+}
+
+void SceneBenchmarkTest::benchmark()
+{
+    // A single deep chain and a shallow tree with the same order of node count.
+    benchmarkTransforms("Transforms (deep)", 2000, 1);
+    benchmarkTransforms("Transforms (wide)", 3, 20);
+
+    benchmarkCulling("Culling", 50000);
+
+    // Roughly 100k nodes.
+    benchmarkLookup("Lookup", 5, 10);
+    benchmarkInterleavedLookup("Lookup while adding", 2000);
+    benchmarkInterleavedLookup("Lookup while adding", 8000);
+
+    benchmarkParticles("Particles", 200);
+
+    benchmarkLoad("res/common/physics.scene");
+}
+
+void SceneBenchmarkTest::benchmarkTransforms(const char* name, unsigned int depth, unsigned int breadth)
+{
+    // Both passes animate the same hierarchy, so the flat hierarchy has to end up with the same
+    // world matrices as the recursive one.
+    double times[2];
+    std::vector<Matrix> worlds;
+    float maxError = 0.0f;
+    for (unsigned int pass = 0; pass < 2; ++pass)
+    {
+        Scene* scene = Scene::create();
+        scene->setTransformHierarchyEnabled(pass == 1);
+        Node* root = scene->addNode("root");
+        std::vector<Node*> nodes;
+        createHierarchy(root, depth, breadth, nodes);
+        scene->updateTransforms();
+
+        double start = Game::getAbsoluteTime();
+        for (unsigned int frame = 0; frame < BENCHMARK_FRAMES; ++frame)
+        {
+            // Animate the root and a handful of interior nodes, then read back every world matrix.
+            root->setTranslation((float)frame, 0.0f, 0.0f);
+            for (size_t i = frame % 16; i < nodes.size(); i += nodes.size() / 16 + 1)
+            {
+                nodes[i]->rotateY(0.01f);
+            }
+            scene->updateTransforms();
+            for (size_t i = 0, count = nodes.size(); i < count; ++i)
+            {
+                nodes[i]->getWorldMatrix();
+            }
+        }
+        times[pass] = (Game::getAbsoluteTime() - start) / BENCHMARK_FRAMES;
+
+        for (size_t i = 0, count = nodes.size(); i < count; ++i)
+        {
+            const Matrix& world = nodes[i]->getWorldMatrix();
+            if (pass == 0)
+            {
+                worlds.push_back(world);
+                continue;
+            }
+            for (unsigned int j = 0; j < 16; ++j)
+                maxError = std::max(maxError, fabs(world.m[j] - worlds[i].m[j]) / std::max(1.0f, fabs(worlds[i].m[j])));
+        }
+
+        SAFE_RELEASE(scene);
+    }
+
+    addResult("%s: recursive %.3f ms, flat %.3f ms per frame", name, times[0], times[1]);
+    check(maxError < 0.0001f, "%s: flat world matrices differ from recursive ones by %g", name, maxError);
+}
+
+void SceneBenchmarkTest::benchmarkCulling(const char* name, unsigned int nodeCount)
+{
+    // Scatter small models over a large area, of which only a fraction is visible.
+    Scene* scene = Scene::create();
+    Mesh* mesh = Mesh::createBoundingBox(BoundingBox(-1.0f, -1.0f, -1.0f, 1.0f, 1.0f, 1.0f));
+    std::vector<Node*> nodes;
+    for (unsigned int i = 0; i < nodeCount; ++i)
+    {
+        Node* node = scene->addNode();
+        Model* model = Model::create(mesh);
+        node->setModel(model);
+        SAFE_RELEASE(model);
+        node->setTranslation(MATH_RANDOM_MINUS1_1() * 1000.0f, 0.0f, MATH_RANDOM_MINUS1_1() * 1000.0f);
+        nodes.push_back(node);
+    }
+    SAFE_RELEASE(mesh);
+
+    Camera* camera = Camera::createPerspective(45.0f, getAspectRatio(), 1.0f, 200.0f);
+    Node* cameraNode = scene->addNode("camera");
+    cameraNode->setCamera(camera);
+    camera->release();
+
+    double times[2];
+    unsigned int visible[2];
+    std::vector<Node*> results;
+    for (unsigned int pass = 0; pass < 2; ++pass)
+    {
+        double start = Game::getAbsoluteTime();
+        for (unsigned int frame = 0; frame < BENCHMARK_FRAMES; ++frame)
+        {
+            // Turn the camera and move a few nodes, then gather the visible nodes.
+            cameraNode->setRotation(Vector3::unitY(), frame * 0.05f);
+            for (size_t i = frame; i < nodes.size(); i += nodes.size() / 100)
+            {
+                nodes[i]->translateX(0.5f);
+            }
+
+            results.clear();
+            const Frustum& frustum = camera->getFrustum();
+            if (pass == 0)
+            {
+                for (size_t i = 0, count = nodes.size(); i < count; ++i)
+                {
+                    if (nodes[i]->getBoundingSphere().intersects(frustum))
+                        results.push_back(nodes[i]);
+                }
+            }
+            else
+            {
+                scene->queryFrustum(frustum, results);
+            }
+        }
+        times[pass] = (Game::getAbsoluteTime() - start) / BENCHMARK_FRAMES;
+        visible[pass] = (unsigned int)results.size();
+    }
+
+    // The nodes kept moving during the second pass, so test the last frame linearly again.
+    const Frustum& frustum = camera->getFrustum();
+    std::set<Node*> expected;
+    for (size_t i = 0, count = nodes.size(); i < count; ++i)
+    {
+        if (nodes[i]->getBoundingSphere().intersects(frustum))
+            expected.insert(nodes[i]);
+    }
+    bool matched = expected.size() == results.size();
+    for (size_t i = 0, count = results.size(); matched && i < count; ++i)
+        matched = expected.find(results[i]) != expected.end();
+
+    SAFE_RELEASE(scene);
+
+    addResult("%s: linear %.3f ms, bvh %.3f ms per frame (%u/%u of %u visible)", name, times[0], times[1], visible[0], visible[1], nodeCount);
+    check(matched, "%s: the bvh found %u nodes, the linear test %u", name, visible[1], (unsigned int)expected.size());
+}
+
+void SceneBenchmarkTest::benchmarkLookup(const char* name, unsigned int depth, unsigned int breadth)
+{
+    const unsigned int lookupCount = 100;
+
+    Node* root = Node::create("root");
+    std::vector<Node*> nodes;
+    createHierarchy(root, depth, breadth, nodes);
+
+    std::vector<std::string> ids;
+    for (unsigned int i = 0; i < lookupCount; ++i)
+    {
+        ids.push_back(nodes[rand() % nodes.size()]->getId());
+    }
+
+    // Search the hierarchy on its own first, then again once it is part of a scene.
+    double times[2];
+    unsigned int found[2];
+    unsigned int mismatches = 0;
+    std::vector<Node*> matches(lookupCount);
+    Scene* scene = Scene::create();
+    for (unsigned int pass = 0; pass < 2; ++pass)
+    {
+        if (pass == 1)
+            scene->addNode(root);
+
+        found[pass] = 0;
+        double start = Game::getAbsoluteTime();
+        for (unsigned int i = 0; i < lookupCount; ++i)
+        {
+            Node* match = root->findNode(ids[i].c_str());
+            if (match)
+                ++found[pass];
+            if (pass == 0)
+                matches[i] = match;
+            else if (match != matches[i])
+                ++mismatches;
+        }
+        times[pass] = (Game::getAbsoluteTime() - start) / lookupCount;
+    }
+
+    SAFE_RELEASE(scene);
+    SAFE_RELEASE(root);
+
+    addResult("%s: traversal %.4f ms, index %.4f ms per findNode (%u/%u of %u found, %u nodes)",
+        name, times[0], times[1], found[0], found[1], lookupCount, (unsigned int)nodes.size());
+    check(mismatches == 0, "%s: the index found other nodes than traversal for %u of %u ids", name, mismatches, lookupCount);
+}
+
+void SceneBenchmarkTest::benchmarkInterleavedLookup(const char* name, unsigned int nodeCount)
+{
+    // Build a scene the way the scene loader does, searching it after every node that is added or
+    // renamed. A copy of the hierarchy that is not part of a scene is searched by traversal, which
+    // the results of the index are checked against.
+    Scene* scene = Scene::create();
+    Node* root = scene->addNode("root");
+    Node* copyRoot = Node::create("root");
+    std::vector<Node*> nodes(1, root);
+    std::vector<Node*> copies(1, copyRoot);
+    std::map<Node*, Node*> originals;
+    originals[copyRoot] = root;
+
+    double times[2] = { 0.0, 0.0 };
+    unsigned int mismatches = 0;
+    std::vector<Node*> matches[2];
+    char id[32];
+    for (unsigned int i = 0; i < nodeCount; ++i)
+    {
+        // Share each id between several nodes, so that searches have to pick the first match.
+        sprintf(id, "node%u", rand() % (nodeCount / 4));
+        if (i % 4 == 3)
+        {
+            unsigned int renamed = 1 + rand() % (nodes.size() - 1);
+            nodes[renamed]->setId(id);
+            copies[renamed]->setId(id);
+        }
+        else
+        {
+            unsigned int parent = rand() % nodes.size();
+            Node* node = Node::create(id);
+            nodes[parent]->addChild(node);
+            node->release();
+            nodes.push_back(node);
+            Node* copy = Node::create(id);
+            copies[parent]->addChild(copy);
+            copy->release();
+            copies.push_back(copy);
+            originals[copy] = node;
+        }
+
+        sprintf(id, "node%u", rand() % (nodeCount / 4));
+        Node* match[2];
+        for (unsigned int pass = 0; pass < 2; ++pass)
+        {
+            Node* searched = pass == 0 ? copyRoot : root;
+            matches[pass].clear();
+            double start = Game::getAbsoluteTime();
+            match[pass] = searched->findNode(id);
+            searched->findNodes(id, matches[pass], true, false);
+            times[pass] += Game::getAbsoluteTime() - start;
+        }
+
+        bool matched = match[1] == (match[0] ? originals[match[0]] : NULL) && matches[0].size() == matches[1].size();
+        for (size_t j = 0, count = matches[0].size(); matched && j < count; ++j)
+        {
+            matched = originals[matches[0][j]] == matches[1][j];
+        }
+        if (!matched)
+            ++mismatches;
+    }
+
+    SAFE_RELEASE(copyRoot);
+    SAFE_RELEASE(scene);
+
+    addResult("%s: traversal %.4f ms, index %.4f ms per search (%u nodes)",
+        name, times[0] / nodeCount, times[1] / nodeCount, (unsigned int)nodes.size());
+    check(mismatches == 0, "%s: the index found other nodes than traversal in %u of %u searches", name, mismatches, nodeCount);
+}
+
+void SceneBenchmarkTest::benchmarkParticles(const char* name, unsigned int emitterCount)
+{
+    // Both passes seed the random number generator the same way, so the batched update has to
+    // emit and move exactly the same particles as updating each emitter on its own.
+    double times[2];
+    unsigned int particleCounts[2];
+    std::vector<ParticleEmitter::Particle> particles;
+    unsigned int mismatches = 0;
+    for (unsigned int pass = 0; pass < 2; ++pass)
+    {
+        Scene* scene = Scene::create();
+        Camera* camera = Camera::createPerspective(45.0f, getAspectRatio(), 1.0f, 200.0f);
+        Node* cameraNode = scene->addNode("camera");
+        cameraNode->setCamera(camera);
+        cameraNode->setTranslation(0.0f, 0.0f, 100.0f);
+        scene->setActiveCamera(camera);
+        camera->release();
+
+        srand(1);
+        std::vector<ParticleEmitter*> emitters;
+        for (unsigned int i = 0; i < emitterCount; ++i)
+        {
+            ParticleEmitter* emitter = ParticleEmitter::create("res/png/light-point.png", ParticleEmitter::BLEND_ADDITIVE, 500);
+            emitter->setEmissionRate(250);
+            emitter->setEnergy(1000, 2000);
+            emitter->setVelocity(Vector3(0.0f, 10.0f, 0.0f), Vector3(5.0f, 5.0f, 5.0f));
+            emitter->setAcceleration(Vector3(0.0f, -9.8f, 0.0f), Vector3::zero());
+            emitter->setRotationPerParticle(-1.0f, 1.0f);
+            Node* node = scene->addNode();
+            node->setTranslation(MATH_RANDOM_MINUS1_1() * 100.0f, 0.0f, 0.0f);
+            node->setParticleEmitter(emitter);
+            emitter->release();
+            emitter->start();
+            emitters.push_back(emitter);
+        }
+
+        double start = Game::getAbsoluteTime();
+        for (unsigned int frame = 0; frame < BENCHMARK_FRAMES; ++frame)
+        {
+            if (pass == 0)
+            {
+                for (size_t i = 0, count = emitters.size(); i < count; ++i)
+                {
+                    emitters[i]->update(16.0f);
+                }
+            }
+            else
+            {
+                scene->updateParticleEmitters(16.0f);
+            }
+        }
+        times[pass] = (Game::getAbsoluteTime() - start) / BENCHMARK_FRAMES;
+
+        particleCounts[pass] = 0;
+        for (size_t i = 0, count = emitters.size(); i < count; ++i)
+        {
+            for (unsigned int j = 0; j < emitters[i]->_particleCount; ++j)
+            {
+                const ParticleEmitter::Particle& particle = emitters[i]->_particles[j];
+                unsigned int index = particleCounts[pass]++;
+                if (pass == 0)
+                {
+                    particles.push_back(particle);
+                }
+                else if (index >= particles.size() ||
+                    particle._position != particles[index]._position ||
+                    particle._color != particles[index]._color ||
+                    particle._size != particles[index]._size ||
+                    particle._energy != particles[index]._energy ||
+                    particle._visible != particles[index]._visible)
+                {
+                    ++mismatches;
+                }
+            }
+        }
+
+        SAFE_RELEASE(scene);
+    }
+
+    addResult("%s: serial %.3f ms, batched %.3f ms per frame (%u emitters, %u particles)", name, times[0], times[1], emitterCount, particleCounts[1]);
+    check(particleCounts[0] == particleCounts[1] && mismatches == 0, "%s: the batched update left %u particles, %u differing from the %u of the serial update",
+        name, particleCounts[1], mismatches, particleCounts[0]);
+}
+
+void SceneBenchmarkTest::benchmarkLoad(const char* path)
+{
+    // The referenced files are read in parallel, so their times add up to more than the time
+    // spent reading them.
+    double start = Game::getAbsoluteTime();
+    Scene* scene = Scene::load(path);
+    double time = Game::getAbsoluteTime() - start;
+    if (scene == NULL)
+        return;
+
+    addResult("%s: %.3f ms to load", path, time);
+
+    const std::vector<Scene::FileLoadTime>& files = scene->getFileLoadTimes();
+    for (size_t i = 0, count = files.size(); i < count; ++i)
+    {
+        addResult("    %s: %.3f ms%s", files[i].path.c_str(), files[i].time, files[i].loaded ? "" : " (failed)");
+    }
+
+    SAFE_RELEASE(scene);
+}
@@ -0,0 +1,39 @@
+#ifndef SCENEBENCHMARKTEST_H_
+#define SCENEBENCHMARKTEST_H_
+
+#include "gameplay.h"
+#include "BenchmarkTest.h"
+
+using namespace gameplay;
+
+/**
+ * Benchmarks scene graph operations on large node hierarchies and batched particle emitter
+ * updates, checking that they give the same results as the paths that they replaced, and
+ * loading a scene file.
+ */
+class SceneBenchmarkTest : public BenchmarkTest
+{
+public:
+
+    SceneBenchmarkTest();
+
+protected:
+
+    void benchmark();
+
+private:
+
+    void benchmarkTransforms(const char* name, unsigned int depth, unsigned int breadth);
+
+    void benchmarkCulling(const char* name, unsigned int nodeCount);
+
+    void benchmarkLookup(const char* name, unsigned int depth, unsigned int breadth);
+
+    void benchmarkInterleavedLookup(const char* name, unsigned int nodeCount);
+
+    void benchmarkParticles(const char* name, unsigned int emitterCount);
+
+    void benchmarkLoad(const char* path);
+};
+
+#endif
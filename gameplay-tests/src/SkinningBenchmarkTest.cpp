@@ -0,0 +1,160 @@
+#include "SkinningBenchmarkTest.h"
+#include "TestsGame.h"
+
+#if defined(ADD_TEST)
+    ADD_TEST("Benchmark", "Skinning", SkinningBenchmarkTest, 5);
+#endif
+
+#define BENCHMARK_ITERATIONS 20
+
+// The elements of the benchmark vertices: a position, a normal, texture coordinates,
+// four blend weights and four blend indices.
+#define VERTEX_SIZE 16
+#define NORMAL_OFFSET 3
+#define WEIGHT_OFFSET 8
+#define INDEX_OFFSET 12
+
+/**
+ * Skins the position and normal of a vertex the same way as skinning.vert, as a reference
+ * for the skin deformer.
+ */
+static void skinScalar(const Vector4* matrixPalette, const float* vertex, float* dst)
+{
+    float position[3] = { 0.0f, 0.0f, 0.0f };
+    float normal[3] = { 0.0f, 0.0f, 0.0f };
+    for (unsigned int k = 0; k < 4; ++k)
+    {
+        const Vector4* m = &matrixPalette[(unsigned int)vertex[INDEX_OFFSET + k] * 3];
+        float weight = vertex[WEIGHT_OFFSET + k];
+        for (unsigned int row = 0; row < 3; ++row)
+        {
+            position[row] += weight * (m[row].x * vertex[0] + m[row].y * vertex[1] + m[row].z * vertex[2] + m[row].w);
+            normal[row] += weight * (m[row].x * vertex[NORMAL_OFFSET] + m[row].y * vertex[NORMAL_OFFSET + 1] + m[row].z * vertex[NORMAL_OFFSET + 2]);
+        }
+    }
+    memcpy(dst, position, sizeof(position));
+    memcpy(dst + NORMAL_OFFSET, normal, sizeof(normal));
+}
+
+SkinningBenchmarkTest::SkinningBenchmarkTest()
+    : _deformer(NULL), _matrixPalette(NULL), _vertexData(NULL)
+{
+}
+
+void SkinningBenchmarkTest::benchmark()
+{
+    benchmarkRig("Character", 60, 5000);
+    benchmarkRig("Large rig", 200, 50000);
+}
+
+void SkinningBenchmarkTest::benchmarkRig(const char* name, unsigned int jointCount, unsigned int vertexCount)
+{
+    // A palette of random rigid joint transforms, stored as rows like MeshSkin::getMatrixPalette.
+    std::vector<Vector4> matrixPalette(jointCount * 3);
+    for (unsigned int i = 0; i < jointCount; ++i)
+    {
+        Quaternion rotation(MATH_RANDOM_MINUS1_1(), MATH_RANDOM_MINUS1_1(), MATH_RANDOM_MINUS1_1(), 1.0f);
+        rotation.normalize();
+        Matrix m;
+        Matrix::createRotation(rotation, &m);
+        m.translate(MATH_RANDOM_MINUS1_1(), MATH_RANDOM_MINUS1_1(), MATH_RANDOM_MINUS1_1());
+        for (unsigned int row = 0; row < 3; ++row)
+            matrixPalette[i * 3 + row].set(m.m[row], m.m[row + 4], m.m[row + 8], m.m[row + 12]);
+    }
+
+    std::vector<float> vertices(vertexCount * VERTEX_SIZE);
+    for (unsigned int i = 0; i < vertexCount; ++i)
+    {
+        float* vertex = &vertices[i * VERTEX_SIZE];
+        for (unsigned int j = 0; j < WEIGHT_OFFSET; ++j)
+            vertex[j] = MATH_RANDOM_MINUS1_1();
+
+        float weightSum = 0.0f;
+        for (unsigned int k = 0; k < 4; ++k)
+        {
+            vertex[WEIGHT_OFFSET + k] = MATH_RANDOM_0_1();
+            vertex[INDEX_OFFSET + k] = (float)(rand() % jointCount);
+            weightSum += vertex[WEIGHT_OFFSET + k];
+        }
+        for (unsigned int k = 0; k < 4; ++k)
+            vertex[WEIGHT_OFFSET + k] /= weightSum;
+    }
+
+    VertexFormat::Element elements[] =
+    {
+        VertexFormat::Element(VertexFormat::POSITION, 3),
+        VertexFormat::Element(VertexFormat::NORMAL, 3),
+        VertexFormat::Element(VertexFormat::TEXCOORD0, 2),
+        VertexFormat::Element(VertexFormat::BLENDWEIGHTS, 4),
+        VertexFormat::Element(VertexFormat::BLENDINDICES, 4)
+    };
+    _deformer = SkinDeformer::create(VertexFormat(elements, 5), &vertices[0], vertexCount);
+    std::vector<float> expected(vertices);
+    std::vector<float> skinned(vertices);
+    _matrixPalette = &matrixPalette[0];
+    _vertexData = &skinned[0];
+
+    // Skinning like the vertex shader, with the deformer and with the deformer on all workers.
+    double times[3];
+    for (unsigned int pass = 0; pass < 3; ++pass)
+    {
+        double start = Game::getAbsoluteTime();
+        for (unsigned int iteration = 0; iteration < BENCHMARK_ITERATIONS; ++iteration)
+        {
+            if (pass == 0)
+            {
+                for (unsigned int i = 0; i < vertexCount; ++i)
+                    skinScalar(_matrixPalette, &vertices[i * VERTEX_SIZE], &expected[i * VERTEX_SIZE]);
+            }
+            else if (pass == 1)
+            {
+                _deformer->deform(_matrixPalette, 0, vertexCount, _vertexData);
+            }
+            else
+            {
+                Game::getInstance()->getJobSystem()->parallelFor(vertexCount, this, &SkinningBenchmarkTest::deformRange, 1024);
+            }
+        }
+        times[pass] = (Game::getAbsoluteTime() - start) / BENCHMARK_ITERATIONS;
+    }
+
+    float maxError = 0.0f;
+    BoundingBox exactBounds;
+    exactBounds.set(Vector3(&skinned[0]), Vector3(&skinned[0]));
+    for (unsigned int i = 0; i < vertexCount; ++i)
+    {
+        const float* vertex = &skinned[i * VERTEX_SIZE];
+        for (unsigned int j = 0; j < WEIGHT_OFFSET; ++j)
+            maxError = std::max(maxError, fabs(vertex[j] - expected[i * VERTEX_SIZE + j]));
+        exactBounds.merge(BoundingBox(Vector3(vertex), Vector3(vertex)));
+    }
+
+    // Bounds from the skinned vertices, and from the bounds of the vertices of each joint.
+    std::vector<BoundingBox> jointBounds(_deformer->getJointCount());
+    _deformer->computeJointBounds(&jointBounds[0]);
+    BoundingBox bounds;
+    double start = Game::getAbsoluteTime();
+    for (unsigned int iteration = 0; iteration < BENCHMARK_ITERATIONS; ++iteration)
+    {
+        SkinDeformer::computeBounds(_matrixPalette, &jointBounds[0], (unsigned int)jointBounds.size(), &bounds);
+    }
+    double boundsTime = (Game::getAbsoluteTime() - start) / BENCHMARK_ITERATIONS;
+    const float epsilon = 0.001f;
+    bool enclosed = bounds.min.x <= exactBounds.min.x + epsilon && bounds.min.y <= exactBounds.min.y + epsilon && bounds.min.z <= exactBounds.min.z + epsilon &&
+        bounds.max.x >= exactBounds.max.x - epsilon && bounds.max.y >= exactBounds.max.y - epsilon && bounds.max.z >= exactBounds.max.z - epsilon;
+
+    SAFE_RELEASE(_deformer);
+    _matrixPalette = NULL;
+    _vertexData = NULL;
+
+    addResult("%s: scalar %.3f ms, deformer %.3f ms, parallel %.3f ms (%u vertices, %u joints)",
+        name, times[0], times[1], times[2], vertexCount, jointCount);
+    check(maxError < 0.0001f, "%s: the deformer differs from the vertex shader by %g", name, maxError);
+    addResult("%s bounds: %.4f ms", name, boundsTime);
+    check(enclosed, "%s bounds: do not enclose the skinned vertices", name);
+}
+
+void SkinningBenchmarkTest::deformRange(unsigned int start, unsigned int end)
+{
+    _deformer->deform(_matrixPalette, start, end - start, _vertexData);
+}
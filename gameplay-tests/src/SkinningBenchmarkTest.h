@@ -0,0 +1,34 @@
+#ifndef SKINNINGBENCHMARKTEST_H_
+#define SKINNINGBENCHMARKTEST_H_
+
+#include "gameplay.h"
+#include "BenchmarkTest.h"
+
+using namespace gameplay;
+
+/**
+ * Benchmarks skinning vertices and computing skinned bounds on the CPU, and checks the
+ * results against the skinning of the vertex shaders.
+ */
+class SkinningBenchmarkTest : public BenchmarkTest
+{
+public:
+
+    SkinningBenchmarkTest();
+
+protected:
+
+    void benchmark();
+
+private:
+
+    void benchmarkRig(const char* name, unsigned int jointCount, unsigned int vertexCount);
+
+    void deformRange(unsigned int start, unsigned int end);
+
+    SkinDeformer* _deformer;
+    const Vector4* _matrixPalette;
+    float* _vertexData;
+};
+
+#endif
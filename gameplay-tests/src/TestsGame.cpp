@@ -115,6 +115,11 @@ void TestsGame::render(float elapsedTime)
         _font->start();
         _font->drawText("<<", getWidth() - 40, 20, Vector4::one(), 28);
         _font->finish();
+
+#ifdef GAMEPLAY_PROFILER
+        // Draw the per-scope profiler summary.
+        Profiler::drawSummary(_font, getWidth() / 2, 60);
+#endif
         return;
     }
     // Clear the color and depth buffers
@@ -148,6 +153,13 @@ void TestsGame::keyEvent(Keyboard::KeyEvent evt, int key)
             // Pressing escape exits the active test
             exitActiveTest();
         }
+#ifdef GAMEPLAY_PROFILER
+        else if (evt == Keyboard::KEY_PRESS && key == Keyboard::KEY_F12)
+        {
+            // Save the profiler capture for chrome://tracing.
+            Profiler::saveTrace("profile.json");
+        }
+#endif
         else
         {
             getScriptController()->executeFunction<void>("camera_keyEvent", "[Keyboard::KeyEvent][Keyboard::Key]", evt, key);
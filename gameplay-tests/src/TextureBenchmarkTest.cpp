@@ -0,0 +1,127 @@
+#include "TextureBenchmarkTest.h"
+#include "TestsGame.h"
+
+#if defined(ADD_TEST)
+    ADD_TEST("Benchmark", "Texture", TextureBenchmarkTest, 7);
+#endif
+
+// The number of textures in the scene.
+#define BENCHMARK_TEXTURES 300
+
+// The largest number of workers that the batch is decoded with.
+#define BENCHMARK_MAX_WORKERS 8
+
+// The images that the textures are copied from.
+static const char* __images[] = { "res/png/dirt.png", "res/png/duck-diffuse.png", "res/png/grass.png", "res/png/box-diffuse.png" };
+
+/**
+ * Describes the size and format of a texture.
+ */
+static std::string describe(Texture* texture)
+{
+    if (texture == NULL)
+        return "not loaded";
+
+    char buffer[64];
+    sprintf(buffer, "%ux%u, format %d%s", texture->getWidth(), texture->getHeight(), (int)texture->getFormat(),
+        texture->isMipmapped() ? ", mipmapped" : "");
+    return buffer;
+}
+
+TextureBenchmarkTest::TextureBenchmarkTest()
+{
+}
+
+void TextureBenchmarkTest::benchmark()
+{
+    writeTextures(BENCHMARK_TEXTURES);
+    benchmarkCreate();
+
+    JobSystem* jobSystem = Game::getInstance()->getJobSystem();
+    unsigned int workerCount = jobSystem->getWorkerCount();
+    for (unsigned int workers = 1; workers <= BENCHMARK_MAX_WORKERS; workers *= 2)
+    {
+        jobSystem->setWorkerCount(workers);
+        benchmarkBatch(workers);
+    }
+    jobSystem->setWorkerCount(workerCount);
+}
+
+void TextureBenchmarkTest::writeTextures(unsigned int textureCount)
+{
+    // Each texture has its own file, so that none of them are taken from the texture cache.
+    std::vector<std::string> images;
+    for (size_t i = 0; i < sizeof(__images) / sizeof(__images[0]); ++i)
+    {
+        int size = 0;
+        char* data = FileSystem::readAll(__images[i], &size);
+        if (data)
+            images.push_back(std::string(data, size));
+        SAFE_DELETE_ARRAY(data);
+    }
+    if (images.empty())
+        return;
+
+    char path[64];
+    for (unsigned int i = 0; i < textureCount; ++i)
+    {
+        sprintf(path, "benchmark-texture%u.png", i);
+        Stream* stream = FileSystem::open(path, FileSystem::WRITE);
+        if (!stream)
+            return;
+        const std::string& image = images[i % images.size()];
+        stream->write(image.data(), 1, image.size());
+        SAFE_DELETE(stream);
+        _paths.push_back(path);
+    }
+}
+
+void TextureBenchmarkTest::benchmarkCreate()
+{
+    std::vector<Texture*> textures(_paths.size());
+    double start = Game::getAbsoluteTime();
+    for (size_t i = 0, count = _paths.size(); i < count; ++i)
+        textures[i] = Texture::create(_paths[i].c_str(), true);
+    double time = Game::getAbsoluteTime() - start;
+
+    // The textures of the batches are checked against these.
+    unsigned int failures = 0;
+    for (size_t i = 0, count = textures.size(); i < count; ++i)
+    {
+        _textures.push_back(describe(textures[i]));
+        if (textures[i] == NULL)
+            ++failures;
+        SAFE_RELEASE(textures[i]);
+    }
+    ResourceManager::releaseUnreferenced();
+
+    addResult("Texture::create: %.3f ms (%u textures)", time, (unsigned int)_paths.size());
+    check(failures == 0, "Texture::create: %u of %u textures failed to load", failures, (unsigned int)_paths.size());
+}
+
+void TextureBenchmarkTest::benchmarkBatch(unsigned int workerCount)
+{
+    TextureBatch* batch = TextureBatch::create();
+    for (size_t i = 0, count = _paths.size(); i < count; ++i)
+        batch->add(_paths[i].c_str(), true);
+
+    double start = Game::getAbsoluteTime();
+    batch->load();
+    batch->wait();
+    double time = Game::getAbsoluteTime() - start;
+
+    unsigned int mismatches = 0;
+    for (unsigned int i = 0, count = batch->getTextureCount(); i < count; ++i)
+    {
+        if (describe(batch->getTexture(i)) != _textures[i])
+            ++mismatches;
+    }
+
+    SAFE_RELEASE(batch);
+    ResourceManager::releaseUnreferenced();
+
+    addResult("TextureBatch, %u %s: %.3f ms (%u textures)", workerCount, workerCount == 1 ? "worker" : "workers",
+        time, (unsigned int)_paths.size());
+    check(mismatches == 0, "TextureBatch, %u %s: %u of %u textures differ from Texture::create", workerCount,
+        workerCount == 1 ? "worker" : "workers", mismatches, (unsigned int)_paths.size());
+}
@@ -0,0 +1,36 @@
+#ifndef TEXTUREBENCHMARKTEST_H_
+#define TEXTUREBENCHMARKTEST_H_
+
+#include "gameplay.h"
+#include "BenchmarkTest.h"
+
+using namespace gameplay;
+
+/**
+ * Benchmarks loading the textures of a scene one at a time and as a texture batch that is
+ * decoded by an increasing number of workers, checking that the batch creates the same
+ * textures.
+ */
+class TextureBenchmarkTest : public BenchmarkTest
+{
+public:
+
+    TextureBenchmarkTest();
+
+protected:
+
+    void benchmark();
+
+private:
+
+    void writeTextures(unsigned int textureCount);
+
+    void benchmarkCreate();
+
+    void benchmarkBatch(unsigned int workerCount);
+
+    std::vector<std::string> _paths;
+    std::vector<std::string> _textures;
+};
+
+#endif
@@ -26,14 +26,17 @@ LOCAL_SRC_FILES := \
     Animation.cpp \
     AnimationClip.cpp \
     AnimationController.cpp \
+    AnimationPose.cpp \
     AnimationTarget.cpp \
     AnimationValue.cpp \
+    AsyncLoad.cpp \
     AudioBuffer.cpp \
     AudioController.cpp \
     AudioListener.cpp \
     AudioSource.cpp \
     BoundingBox.cpp \
     BoundingSphere.cpp \
+    BoundingVolumeHierarchy.cpp \
     Bundle.cpp \
     Button.cpp \
     Camera.cpp \
@@ -54,6 +57,7 @@ LOCAL_SRC_FILES := \
     Gamepad.cpp \
     HeightField.cpp \
     Image.cpp \
+    JobSystem.cpp \
     Joint.cpp \
     Joystick.cpp \
     Label.cpp \
@@ -70,6 +74,7 @@ LOCAL_SRC_FILES := \
     MeshSkin.cpp \
     Model.cpp \
     Node.cpp \
+    NodeIndex.cpp \
     ParticleEmitter.cpp \
     Pass.cpp \
     PhysicsCharacter.cpp \
@@ -88,6 +93,7 @@ LOCAL_SRC_FILES := \
     PhysicsVehicleWheel.cpp \
     Plane.cpp \
     PlatformAndroid.cpp \
+    Profiler.cpp \
     Properties.cpp \
     Quaternion.cpp \
     RadioButton.cpp \
@@ -96,11 +102,13 @@ LOCAL_SRC_FILES := \
     Ref.cpp \
     RenderState.cpp \
     RenderTarget.cpp \
+    ResourceManager.cpp \
     Scene.cpp \
     SceneLoader.cpp \
     ScreenDisplayer.cpp \
     ScriptController.cpp \
     ScriptTarget.cpp \
+    SkinDeformer.cpp \
     Slider.cpp \
     SpriteBatch.cpp \
     Technique.cpp \
@@ -108,9 +116,11 @@ LOCAL_SRC_FILES := \
     TerrainPatch.cpp \
     TextBox.cpp \
     Texture.cpp \
+    TextureBatch.cpp \
     Theme.cpp \
     ThemeStyle.cpp \
     Transform.cpp \
+    TransformHierarchy.cpp \
     Vector2.cpp \
     Vector3.cpp \
     Vector4.cpp \
@@ -98,6 +98,8 @@ void AIController::update(float elapsedTime)
     if (_paused)
         return;
 
+    GP_PROFILE_SCOPE("AIController::update");
+
     static Game* game = Game::getInstance();
 
     // Send all pending messages that have expired
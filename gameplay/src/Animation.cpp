@@ -6,6 +6,7 @@
 #include "Game.h"
 #include "Transform.h"
 #include "Properties.h"
+#include "Bundle.h"
 
 #define ANIMATION_INDEFINITE_STR "INDEFINITE"
 #define ANIMATION_DEFAULT_CLIP 0
@@ -16,7 +17,8 @@ namespace gameplay
 {
 
 Animation::Animation(const char* id, AnimationTarget* target, int propertyId, unsigned int keyCount, unsigned int* keyTimes, float* keyValues, unsigned int type)
-    : _controller(Game::getInstance()->getAnimationController()), _id(id), _duration(0L), _defaultClip(NULL), _clips(NULL)
+    : _controller(Game::getInstance()->getAnimationController()), _id(id), _duration(0L), _curveSet(NULL), _curveSetDirty(true), _defaultClip(NULL), _clips(NULL), _lodNode(NULL),
+      _bundle(NULL), _bundlePosition(0), _curvesLoaded(true), _lastPlayedTime(0.0)
 {
     createChannel(target, propertyId, keyCount, keyTimes, keyValues, type);
 
@@ -26,7 +28,8 @@ Animation::Animation(const char* id, AnimationTarget* target, int propertyId, un
 }
 
 Animation::Animation(const char* id, AnimationTarget* target, int propertyId, unsigned int keyCount, unsigned int* keyTimes, float* keyValues, float* keyInValue, float* keyOutValue, unsigned int type)
-    : _controller(Game::getInstance()->getAnimationController()), _id(id), _duration(0L), _defaultClip(NULL), _clips(NULL)
+    : _controller(Game::getInstance()->getAnimationController()), _id(id), _duration(0L), _curveSet(NULL), _curveSetDirty(true), _defaultClip(NULL), _clips(NULL), _lodNode(NULL),
+      _bundle(NULL), _bundlePosition(0), _curvesLoaded(true), _lastPlayedTime(0.0)
 {
     createChannel(target, propertyId, keyCount, keyTimes, keyValues, keyInValue, keyOutValue, type);
     // Release the animation because a newly created animation has a ref count of 1 and the channels hold the ref to animation.
@@ -35,7 +38,8 @@ Animation::Animation(const char* id, AnimationTarget* target, int propertyId, un
 }
 
 Animation::Animation(const char* id)
-    : _controller(Game::getInstance()->getAnimationController()), _id(id), _duration(0L), _defaultClip(NULL), _clips(NULL)
+    : _controller(Game::getInstance()->getAnimationController()), _id(id), _duration(0L), _curveSet(NULL), _curveSetDirty(true), _defaultClip(NULL), _clips(NULL), _lodNode(NULL),
+      _bundle(NULL), _bundlePosition(0), _curvesLoaded(true), _lastPlayedTime(0.0)
 {
 }
 
@@ -72,6 +76,14 @@ Animation::~Animation()
         _clips->clear();
     }
     SAFE_DELETE(_clips);
+    SAFE_RELEASE(_curveSet);
+
+    if (_bundle)
+    {
+        if (_controller)
+            _controller->_bundleAnimations.remove(this);
+        SAFE_RELEASE(_bundle);
+    }
 }
 
 Animation::Channel::Channel(Animation* animation, AnimationTarget* target, int propertyId, Curve* curve, unsigned long duration)
@@ -79,11 +91,11 @@ Animation::Channel::Channel(Animation* animation, AnimationTarget* target, int p
 {
     GP_ASSERT(_animation);
     GP_ASSERT(_target);
-    GP_ASSERT(_curve);
 
     // get property component count, and ensure the property exists on the AnimationTarget by getting the property component count.
     GP_ASSERT(_target->getAnimationPropertyComponentCount(propertyId));
-    _curve->addRef();
+    if (_curve)
+        _curve->addRef();
     _target->addChannel(this);
     _animation->addRef();
 }
@@ -111,6 +123,59 @@ Curve* Animation::Channel::getCurve() const
     return _curve;
 }
 
+Animation::CurveSet::CurveSet(const std::vector<Channel*>& channels)
+    : valueCount(0)
+{
+    size_t channelCount = channels.size();
+    curves.resize(channelCount);
+    offsets.resize(channelCount);
+    for (size_t i = 0; i < channelCount; i++)
+    {
+        GP_ASSERT(channels[i]);
+        Curve* curve = channels[i]->getCurve();
+        GP_ASSERT(curve);
+        curve->addRef();
+        curves[i] = curve;
+        offsets[i] = valueCount;
+        valueCount += curve->getComponentCount();
+
+        // Add the channel to a batch of linear curves with the same point times, or to a batch of its own.
+        bool linear = curve->isLinear();
+        ChannelBatch* batch = NULL;
+        if (linear)
+        {
+            for (size_t j = 0, batchCount = batches.size(); j < batchCount; j++)
+            {
+                if (batches[j]->linear && batches[j]->curves[0]->hasSameLayout(curve))
+                {
+                    batch = batches[j];
+                    break;
+                }
+            }
+        }
+        if (batch == NULL)
+        {
+            batch = new ChannelBatch();
+            batch->linear = linear;
+            batches.push_back(batch);
+        }
+        batch->channels.push_back((unsigned int)i);
+        batch->curves.push_back(curve);
+    }
+}
+
+Animation::CurveSet::~CurveSet()
+{
+    for (size_t i = 0, count = batches.size(); i < count; i++)
+    {
+        SAFE_DELETE(batches[i]);
+    }
+    for (size_t i = 0, count = curves.size(); i < count; i++)
+    {
+        SAFE_RELEASE(curves[i]);
+    }
+}
+
 const char* Animation::getId() const
 {
     return _id.c_str();
@@ -312,6 +377,19 @@ AnimationClip* Animation::findClip(const char* id) const
 }
 
 Animation::Channel* Animation::createChannel(AnimationTarget* target, int propertyId, unsigned int keyCount, unsigned int* keyTimes, float* keyValues, unsigned int type)
+{
+    GP_ASSERT(keyTimes);
+
+    Curve* curve = createCurve(target, propertyId, keyCount, keyTimes, keyValues, type);
+    unsigned long duration = keyTimes[keyCount-1] - keyTimes[0];
+
+    Channel* channel = new Channel(this, target, propertyId, curve, duration);
+    curve->release();
+    addChannel(channel);
+    return channel;
+}
+
+Curve* Animation::createCurve(AnimationTarget* target, int propertyId, unsigned int keyCount, unsigned int* keyTimes, float* keyValues, unsigned int type)
 {
     GP_ASSERT(target);
     GP_ASSERT(keyTimes);
@@ -347,10 +425,7 @@ Animation::Channel* Animation::createChannel(AnimationTarget* target, int proper
 
     SAFE_DELETE_ARRAY(normalizedKeyTimes);
 
-    Channel* channel = new Channel(this, target, propertyId, curve, duration);
-    curve->release();
-    addChannel(channel);
-    return channel;
+    return curve;
 }
 
 Animation::Channel* Animation::createChannel(AnimationTarget* target, int propertyId, unsigned int keyCount, unsigned int* keyTimes, float* keyValues, float* keyInValue, float* keyOutValue, unsigned int type)
@@ -395,10 +470,108 @@ Animation::Channel* Animation::createChannel(AnimationTarget* target, int proper
     return channel;
 }
 
+Animation::Channel* Animation::createChannel(AnimationTarget* target, int propertyId, Curve* curve, unsigned long duration)
+{
+    GP_ASSERT(target);
+
+    if (curve && target->_targetType == AnimationTarget::TRANSFORM)
+        setTransformRotationOffset(curve, propertyId);
+
+    Channel* channel = new Channel(this, target, propertyId, curve, duration);
+    addChannel(channel);
+    return channel;
+}
+
+void Animation::setChannelCurve(Channel* channel, Curve* curve)
+{
+    GP_ASSERT(channel);
+    GP_ASSERT(channel->_target);
+    GP_ASSERT(curve);
+
+    if (channel->_target->_targetType == AnimationTarget::TRANSFORM)
+        setTransformRotationOffset(curve, channel->_propertyId);
+
+    curve->addRef();
+    SAFE_RELEASE(channel->_curve);
+    channel->_curve = curve;
+    _curveSetDirty = true;
+}
+
+void Animation::setLodNode(Node* node)
+{
+    _lodNode = node;
+}
+
+Node* Animation::getLodNode() const
+{
+    return _lodNode;
+}
+
+void Animation::prefetch()
+{
+    loadCurves();
+}
+
+bool Animation::isLoaded() const
+{
+    return _curvesLoaded;
+}
+
+void Animation::deferCurve(Bundle* bundle, long position, Channel* channel, long channelPosition)
+{
+    GP_ASSERT(bundle);
+    GP_ASSERT(channel && channel->_curve == NULL);
+
+    if (_bundle == NULL)
+    {
+        _bundle = bundle;
+        _bundle->addRef();
+        _bundlePosition = position;
+        if (_controller)
+            _controller->_bundleAnimations.push_back(this);
+    }
+    GP_ASSERT(_bundle == bundle && _bundlePosition == position);
+
+    _bundleChannels.push_back(std::make_pair(channel, channelPosition));
+    _curvesLoaded = false;
+}
+
+bool Animation::loadCurves()
+{
+    if (_curvesLoaded)
+        return true;
+
+    GP_ASSERT(_bundle);
+    if (!_bundle->readAnimationCurves(this))
+    {
+        GP_ERROR("Failed to load the curves of animation '%s'.", _id.c_str());
+        return false;
+    }
+    _curvesLoaded = true;
+    _lastPlayedTime = Game::getGameTime();
+    return true;
+}
+
+void Animation::unloadCurves()
+{
+    if (!_curvesLoaded || _bundle == NULL)
+        return;
+
+    // Clones keep their own references to the curves and the curve set.
+    for (size_t i = 0, count = _bundleChannels.size(); i < count; i++)
+    {
+        SAFE_RELEASE(_bundleChannels[i].first->_curve);
+    }
+    SAFE_RELEASE(_curveSet);
+    _curveSetDirty = true;
+    _curvesLoaded = false;
+}
+
 void Animation::addChannel(Channel* channel)
 {
     GP_ASSERT(channel);
     _channels.push_back(channel);
+    _curveSetDirty = true;
 
     if (channel->_duration > _duration)
         _duration = channel->_duration;
@@ -413,6 +586,15 @@ void Animation::removeChannel(Channel* channel)
         if (channel == chan)
         {
             _channels.erase(itr);
+            _curveSetDirty = true;
+            for (size_t i = 0, bundleChannelCount = _bundleChannels.size(); i < bundleChannelCount; i++)
+            {
+                if (_bundleChannels[i].first == channel)
+                {
+                    _bundleChannels.erase(_bundleChannels.begin() + i);
+                    break;
+                }
+            }
             return;
         }
         else
@@ -422,6 +604,62 @@ void Animation::removeChannel(Channel* channel)
     }
 }
 
+Animation::CurveSet* Animation::getCurveSet()
+{
+    if (!loadCurves())
+        return NULL;
+
+    if (_curveSetDirty)
+    {
+        // Keep the curve set if the channels still evaluate its curves, such as when all
+        // the channels of a clone have been added.
+        if (_curveSet == NULL || !sortChannels(_curveSet))
+        {
+            SAFE_RELEASE(_curveSet);
+            _curveSet = new CurveSet(_channels);
+        }
+        _curveSetDirty = false;
+    }
+    return _curveSet;
+}
+
+bool Animation::sortChannels(const CurveSet* curveSet)
+{
+    GP_ASSERT(curveSet);
+
+    size_t count = _channels.size();
+    if (curveSet->curves.size() != count)
+        return false;
+
+    size_t i = 0;
+    while (i < count && _channels[i]->_curve == curveSet->curves[i])
+        i++;
+    if (i == count)
+        return true;
+
+    // The channels of a clone are added in the order that its targets are cloned in, so
+    // match them to the curves by sorting both.
+    std::vector<std::pair<Curve*, Channel*> > channels(count);
+    std::vector<std::pair<Curve*, unsigned int> > curves(count);
+    for (i = 0; i < count; i++)
+    {
+        channels[i] = std::make_pair(_channels[i]->_curve, _channels[i]);
+        curves[i] = std::make_pair(curveSet->curves[i], (unsigned int)i);
+    }
+    std::sort(channels.begin(), channels.end());
+    std::sort(curves.begin(), curves.end());
+    for (i = 0; i < count; i++)
+    {
+        if (channels[i].first != curves[i].first)
+            return false;
+    }
+    for (i = 0; i < count; i++)
+    {
+        _channels[curves[i].second] = channels[i].second;
+    }
+    return true;
+}
+
 void Animation::setTransformRotationOffset(Curve* curve, unsigned int propertyId)
 {
     GP_ASSERT(curve);
@@ -446,6 +684,11 @@ Animation* Animation::clone(Channel* channel, AnimationTarget* target)
 
     Animation* animation = new Animation(getId());
 
+    // Share the curve set with the clone, which keeps it once all of its channels are added.
+    animation->_curveSet = getCurveSet();
+    if (animation->_curveSet)
+        animation->_curveSet->addRef();
+
     Animation::Channel* channelCopy = new Animation::Channel(*channel, animation, target);
     animation->addChannel(channelCopy);
     // Release the animation because a newly created animation has a ref count of 1 and the channels hold the ref to animation.
@@ -5,12 +5,16 @@
 #include "Properties.h"
 #include "Curve.h"
 
+class AnimationBenchmarkTest;
+
 namespace gameplay
 {
 
 class AnimationTarget;
 class AnimationController;
 class AnimationClip;
+class Node;
+class Bundle;
 
 /**
  * Defines a generic property animation.
@@ -23,8 +27,10 @@ class AnimationClip;
 class Animation : public Ref
 {
     friend class AnimationClip;
+    friend class AnimationController;
     friend class AnimationTarget;
     friend class Bundle;
+    friend class ::AnimationBenchmarkTest;
 
 public:
 
@@ -110,6 +116,51 @@ public:
      */
     bool targets(AnimationTarget* target) const;
 
+    /**
+     * Sets the node whose bounds determine the level of detail of this animation,
+     * such as the root node of an animated character.
+     *
+     * When the AnimationController has a level of detail camera, the clips of this
+     * animation are updated at a reduced rate or frozen while the node is outside the
+     * view of the camera or small on the screen (see AnimationController::setLodCamera).
+     * The clips of animations without a level of detail node are always updated.
+     *
+     * The node is not referenced by the animation, so it must be reset if the node is
+     * destroyed before the animation. When the node is cloned along with the animation,
+     * the clone of the animation uses the clone of the node.
+     *
+     * @param node The node, or NULL to always update the clips of this animation.
+     * @script{ignore}
+     */
+    void setLodNode(Node* node);
+
+    /**
+     * Returns the node whose bounds determine the level of detail of this animation.
+     *
+     * @return The node, or NULL if the clips of this animation are always updated.
+     * @script{ignore}
+     */
+    Node* getLodNode() const;
+
+    /**
+     * Loads the curves of this animation, if it is loaded from a bundle on demand and its
+     * curves are not loaded.
+     *
+     * The curves of animations loaded from bundles are read when one of their clips is first
+     * played (see Bundle::setAnimationLoadingDeferred). Prefetching an animation, such as while
+     * a level is loading, avoids reading the curves during the first frame that it plays.
+     * @script{ignore}
+     */
+    void prefetch();
+
+    /**
+     * Determines whether the curves of this animation are loaded.
+     *
+     * @return true if the curves are loaded, false if they are read from a bundle when needed.
+     * @script{ignore}
+     */
+    bool isLoaded() const;
+
 private:
 
     /**
@@ -123,6 +174,7 @@ private:
         friend class AnimationClip;
         friend class Animation;
         friend class AnimationTarget;
+        friend class Bundle;
 
     private:
 
@@ -136,10 +188,47 @@ private:
         Animation* _animation;                // Reference to the animation this channel belongs to.
         AnimationTarget* _target;             // The target of this channel.
         int _propertyId;                      // The target property this channel targets.
-        Curve* _curve;                        // The curve used to represent the animation data.
+        Curve* _curve;                        // The curve used to represent the animation data, or NULL while it is not loaded.
         unsigned long _duration;              // The length of the animation (in milliseconds).
     };
 
+    /**
+     * Defines a set of channels that are evaluated together.
+     *
+     * The channels of a batch have linear curves with the same point times (see
+     * Curve::hasSameLayout), so the points to interpolate between are found once for
+     * all of them. Channels with other curves each have a batch of their own.
+     */
+    class ChannelBatch
+    {
+    public:
+        std::vector<unsigned int> channels;   // The indices of the channels in the batch.
+        std::vector<Curve*> curves;           // The curves of the channels in the batch.
+        bool linear;                          // Whether the curves are evaluated with Curve::evaluateLinear.
+    };
+
+    /**
+     * Defines the curves of the channels of an animation and how they are evaluated.
+     *
+     * A curve set only depends on the curves of the channels, so the clones of an animation
+     * share its curve set, instead of each clone batching the channels again. A curve set is
+     * not modified once it is created; when channels are added or removed, the animation
+     * creates another one.
+     */
+    class CurveSet : public Ref
+    {
+    public:
+        CurveSet(const std::vector<Channel*>& channels);
+        ~CurveSet();
+        std::vector<Curve*> curves;           // The curve of each channel.
+        std::vector<unsigned int> offsets;    // The offset of the values of each channel in the values of a clip.
+        std::vector<ChannelBatch*> batches;   // The channels grouped for evaluation.
+        unsigned int valueCount;              // The number of values of all channels.
+    private:
+        CurveSet(const CurveSet&); // Hidden copy constructor.
+        CurveSet& operator=(const CurveSet&); // Hidden copy assignment operator.
+    };
+
     /**
      * Hidden copy constructor.
      */
@@ -200,20 +289,72 @@ private:
      */
     Channel* createChannel(AnimationTarget* target, int propertyId, unsigned int keyCount, unsigned int* keyTimes, float* keyValues, float* keyInValue, float* keyOutValue, unsigned int type);
 
+    /**
+     * Creates a channel within this animation that evaluates the given curve, or whose curve
+     * is set when it is loaded if the curve is NULL.
+     */
+    Channel* createChannel(AnimationTarget* target, int propertyId, Curve* curve, unsigned long duration);
+
     /**
      * Adds a channel to the animation.
      */
     void addChannel(Channel* channel);
 
+    /**
+     * Creates the curve of a channel from the given keys.
+     */
+    static Curve* createCurve(AnimationTarget* target, int propertyId, unsigned int keyCount, unsigned int* keyTimes, float* keyValues, unsigned int type);
+
+    /**
+     * Sets the curve of a channel whose curve was not loaded.
+     */
+    void setChannelCurve(Channel* channel, Curve* curve);
+
+    /**
+     * Defers loading the curve of a channel until the curves of the animation are needed.
+     *
+     * @param bundle The bundle to load the curve from.
+     * @param position The position of the animation data in the bundle.
+     * @param channel The channel, whose curve is NULL.
+     * @param channelPosition The position of the key data of the channel in the bundle.
+     */
+    void deferCurve(Bundle* bundle, long position, Channel* channel, long channelPosition);
+
+    /**
+     * Loads the curves of the channels from the bundle, if they are not loaded.
+     *
+     * @return true if the curves are loaded, false otherwise.
+     */
+    bool loadCurves();
+
+    /**
+     * Releases the curves of the channels, if they can be loaded from the bundle again.
+     */
+    void unloadCurves();
+
     /**
      * Removes a channel from the animation.
      */
     void removeChannel(Channel* channel);
 
+    /**
+     * Returns the curve set of the channels, creating it if the channels have changed.
+     *
+     * @return The curve set, or NULL if the curves could not be loaded.
+     */
+    CurveSet* getCurveSet();
+
+    /**
+     * Orders the channels like the curves of the given curve set.
+     *
+     * @return true if the channels evaluate the curves of the curve set, false otherwise.
+     */
+    bool sortChannels(const CurveSet* curveSet);
+
     /**
      * Sets the rotation offset in a Curve representing a Transform's animation data.
      */
-    void setTransformRotationOffset(Curve* curve, unsigned int propertyId);
+    static void setTransformRotationOffset(Curve* curve, unsigned int propertyId);
 
     /**
      * Clones this animation.
@@ -229,8 +370,16 @@ private:
     std::string _id;                        // The Animation's ID.
     unsigned long _duration;              // the length of the animation (in milliseconds).
     std::vector<Channel*> _channels;        // The channels within this Animation.
+    CurveSet* _curveSet;                    // The curves of the channels, which may be shared with clones.
+    bool _curveSetDirty;                    // Whether the channels have changed since the curve set was created.
     AnimationClip* _defaultClip;            // The Animation's default clip.
     std::vector<AnimationClip*>* _clips;    // All the clips created from this Animation.
+    Node* _lodNode;                         // The node whose bounds determine the level of detail, if any.
+    Bundle* _bundle;                        // The bundle that the curves are loaded from on demand, if any.
+    long _bundlePosition;                   // The position of the animation data in the bundle.
+    std::vector<std::pair<Channel*, long> > _bundleChannels; // The channels and the positions of their key data in the bundle.
+    bool _curvesLoaded;                     // Whether the curves of the channels are loaded.
+    double _lastPlayedTime;                 // The game time when a clip last stopped playing or the curves were loaded.
 
 };
 
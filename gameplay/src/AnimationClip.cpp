@@ -2,6 +2,8 @@
 #include "AnimationClip.h"
 #include "Animation.h"
 #include "AnimationTarget.h"
+#include "AnimationPose.h"
+#include "Transform.h"
 #include "Game.h"
 #include "Quaternion.h"
 #include "ScriptController.h"
@@ -13,28 +15,17 @@ AnimationClip::AnimationClip(const char* id, Animation* animation, unsigned long
     : _id(id), _animation(animation), _startTime(startTime), _endTime(endTime), _duration(_endTime - _startTime), 
       _stateBits(0x00), _repeatCount(1.0f), _activeDuration(_duration * _repeatCount), _speed(1.0f), _timeStarted(0), 
       _elapsedTime(0), _crossFadeToClip(NULL), _crossFadeOutElapsed(0), _crossFadeOutDuration(0), _blendWeight(1.0f), 
-      _beginListeners(NULL), _endListeners(NULL), _listeners(NULL), _listenerItr(NULL), _scriptListeners(NULL)
+      _percentComplete(0.0f), _curveSet(NULL), _values(NULL), _pointIndices(NULL), _batchValues(NULL), _lodInterval(0), _lodFrame(0),
+      _beginListeners(NULL), _endListeners(NULL), _listeners(NULL), _listenerIndex(0), _listenerRepeat(0),
+      _beginPending(false), _wrapped(false), _scriptListeners(NULL)
 {
     GP_ASSERT(_animation);
     GP_ASSERT(0 <= startTime && startTime <= _animation->_duration && 0 <= endTime && endTime <= _animation->_duration);
-
-    for (size_t i = 0, count = _animation->_channels.size(); i < count; i++)
-    {
-        GP_ASSERT(_animation->_channels[i]);
-        GP_ASSERT(_animation->_channels[i]->getCurve());
-        _values.push_back(new AnimationValue(_animation->_channels[i]->getCurve()->getComponentCount()));
-    }
 }
 
 AnimationClip::~AnimationClip()
 {
-    std::vector<AnimationValue*>::iterator valueIter = _values.begin();
-    while (valueIter != _values.end())
-    {
-        SAFE_DELETE(*valueIter);
-        valueIter++;
-    }
-    _values.clear();
+    releaseValues();
 
     SAFE_RELEASE(_crossFadeToClip);
     SAFE_DELETE(_beginListeners);
@@ -49,18 +40,7 @@ AnimationClip::~AnimationClip()
         SAFE_DELETE(_scriptListeners);
     }
 
-    if (_listeners)
-    {
-        *_listenerItr = _listeners->begin();
-        while (*_listenerItr != _listeners->end())
-        {
-            ListenerEvent* lEvt = **_listenerItr;
-            SAFE_DELETE(lEvt);
-            ++*_listenerItr;
-        }
-        SAFE_DELETE(_listeners);
-    }
-    SAFE_DELETE(_listenerItr);
+    SAFE_DELETE(_listeners);
 }
 
 AnimationClip::ListenerEvent::ListenerEvent(Listener* listener, unsigned long eventTime)
@@ -69,8 +49,9 @@ AnimationClip::ListenerEvent::ListenerEvent(Listener* listener, unsigned long ev
     _eventTime = eventTime;
 }
 
-AnimationClip::ListenerEvent::~ListenerEvent()
+bool AnimationClip::ListenerEvent::operator<(const ListenerEvent& event) const
 {
+    return _eventTime < event._eventTime;
 }
 
 const char* AnimationClip::getId() const
@@ -191,9 +172,12 @@ void AnimationClip::play()
     }
     else
     {
-        setClipStateBit(CLIP_IS_PLAYING_BIT);
         GP_ASSERT(_animation);
         GP_ASSERT(_animation->_controller);
+        if (!_animation->loadCurves())
+            return;
+
+        setClipStateBit(CLIP_IS_PLAYING_BIT);
         _animation->_controller->schedule(this);
     }
     
@@ -267,40 +251,29 @@ void AnimationClip::addListener(AnimationClip::Listener* listener, unsigned long
     GP_ASSERT(listener);
     GP_ASSERT(eventTime < _activeDuration);
 
-    ListenerEvent* listenerEvent = new ListenerEvent(listener, eventTime);
-
     if (!_listeners)
-    {
-        _listeners = new std::list<ListenerEvent*>;
-        _listeners->push_front(listenerEvent);
+        _listeners = new std::vector<ListenerEvent>();
 
-        _listenerItr = new std::list<ListenerEvent*>::iterator;
-        if (isClipStateBitSet(CLIP_IS_PLAYING_BIT))
-            *_listenerItr = _listeners->begin();
-    }
-    else
+    // Insert the event after the events with the same time.
+    ListenerEvent listenerEvent(listener, eventTime);
+    _listeners->insert(std::upper_bound(_listeners->begin(), _listeners->end(), listenerEvent), listenerEvent);
+
+    // If the clip has started, keep the events that it has already passed behind the index.
+    // Otherwise, the index is set when the clip begins.
+    if (isClipStateBitSet(CLIP_IS_STARTED_BIT))
     {
-        for (std::list<ListenerEvent*>::iterator itr = _listeners->begin(); itr != _listeners->end(); itr++)
+        if (_speed >= 0.0f)
         {
-            GP_ASSERT(*itr);
-            if (eventTime < (*itr)->_eventTime)
-            {
-                itr = _listeners->insert(itr, listenerEvent);
-
-                // If playing, update the iterator if we need to.
-                // otherwise, it will just be set the next time the clip gets played.
-                if (isClipStateBitSet(CLIP_IS_PLAYING_BIT))
-                {
-                    float currentTime = fmodf(_elapsedTime, (float)_duration);
-                    GP_ASSERT(**_listenerItr || *_listenerItr == _listeners->end());
-                    if ((_speed >= 0.0f && currentTime < eventTime && (*_listenerItr == _listeners->end() || eventTime < (**_listenerItr)->_eventTime)) || 
-                        (_speed <= 0 && currentTime > eventTime && (*_listenerItr == _listeners->begin() || eventTime > (**_listenerItr)->_eventTime)))
-                        *_listenerItr = itr;
-                }
-                return;
-            }
+            float currentTime = _elapsedTime;
+            if (_repeatCount == REPEAT_INDEFINITE)
+                currentTime -= (float)_listenerRepeat * _duration;
+            if (currentTime >= eventTime)
+                _listenerIndex++;
+        }
+        else if (_elapsedTime > eventTime)
+        {
+            _listenerIndex++;
         }
-        _listeners->push_back(listenerEvent);
     }
 }
 
@@ -354,6 +327,27 @@ void AnimationClip::addListener(const char* function, unsigned long eventTime)
 
 bool AnimationClip::update(float elapsedTime)
 {
+    bool ended = false;
+    if (!beginUpdate(elapsedTime, &ended))
+    {
+        if (ended)
+            notifyEnd();
+        return ended;
+    }
+
+    notifyUpdate();
+    evaluate();
+    blend(NULL);
+    return endUpdate();
+}
+
+bool AnimationClip::beginUpdate(float elapsedTime, bool* ended)
+{
+    GP_ASSERT(ended);
+
+    *ended = false;
+    _beginPending = false;
+    _wrapped = false;
     if (isClipStateBitSet(CLIP_IS_PAUSED_BIT))
     {
         return false;
@@ -363,18 +357,29 @@ bool AnimationClip::update(float elapsedTime)
         // after the last update call. Reset the flag, and return true so the AnimationClip is removed from the 
         // running clips on the AnimationController.
         onEnd();
-        return true;
+        *ended = true;
+        return false;
+    }
+    else if (!allocateValues())
+    {   // The curves of the animation could not be loaded, so the clip cannot be evaluated.
+        onEnd();
+        *ended = true;
+        return false;
     }
     else if (!isClipStateBitSet(CLIP_IS_STARTED_BIT))
     {
         onBegin();
+        _beginPending = true;
     }
     else
     {
         _elapsedTime += elapsedTime * _speed;
 
         if (_repeatCount == REPEAT_INDEFINITE && _elapsedTime <= 0)
+        {
             _elapsedTime = _activeDuration + _elapsedTime;
+            _wrapped = true;
+        }
     }
 
     float currentTime = 0.0f;
@@ -411,37 +416,6 @@ bool AnimationClip::update(float elapsedTime)
             currentTime = fmodf(_elapsedTime, _duration);
     }
 
-    // Notify any listeners of Animation events.
-    if (_listeners)
-    {
-        GP_ASSERT(_listenerItr);
-
-        if (_speed >= 0.0f)
-        {
-            while (*_listenerItr != _listeners->end() && _elapsedTime >= (long) (**_listenerItr)->_eventTime)
-            {
-                GP_ASSERT(_listenerItr);
-                GP_ASSERT(**_listenerItr);
-                GP_ASSERT((**_listenerItr)->_listener);
-
-                (**_listenerItr)->_listener->animationEvent(this, Listener::TIME);
-                ++*_listenerItr;
-            }
-        }
-        else
-        {
-            while (*_listenerItr != _listeners->begin() && _elapsedTime <= (long) (**_listenerItr)->_eventTime)
-            {
-                GP_ASSERT(_listenerItr);
-                GP_ASSERT(**_listenerItr);
-                GP_ASSERT((**_listenerItr)->_listener);
-
-                (**_listenerItr)->_listener->animationEvent(this, Listener::TIME);
-                --*_listenerItr;
-            }
-        }
-    }
-
     // Add back in start time, and divide by the total animation's duration to get the actual percentage complete
     GP_ASSERT(_animation);
 
@@ -449,7 +423,7 @@ bool AnimationClip::update(float elapsedTime)
     // then prevent a divide by zero and set percentComplete = 1.
     float percentComplete = _animation->_duration == 0 ? 1 : ((float)_startTime + currentTime) / (float)_animation->_duration;
     
-    percentComplete = MATH_CLAMP(percentComplete, 0.0f, 1.0f);
+    _percentComplete = MATH_CLAMP(percentComplete, 0.0f, 1.0f);
 
     if (isClipStateBitSet(CLIP_IS_FADING_OUT_BIT))
     {
@@ -497,38 +471,265 @@ bool AnimationClip::update(float elapsedTime)
             SAFE_RELEASE(_crossFadeToClip);
         }
     }
-    
-    // Evaluate this clip.
-    Animation::Channel* channel = NULL;
-    AnimationValue* value = NULL;
-    AnimationTarget* target = NULL;
+
+    return true;
+}
+
+void AnimationClip::evaluate()
+{
+    GP_ASSERT(_curveSet);
+
+    // Evaluate the point on each Curve, continuing the search for the points from the last update.
+    float** batchValues = _batchValues;
+    for (size_t i = 0, batchCount = _curveSet->batches.size(); i < batchCount; i++)
+    {
+        const Animation::ChannelBatch* batch = _curveSet->batches[i];
+        GP_ASSERT(batch);
+        GP_ASSERT(!batch->channels.empty());
+        unsigned int first = batch->channels[0];
+        unsigned int channelCount = (unsigned int)batch->channels.size();
+
+        if (batch->linear)
+        {
+            Curve::evaluateLinear(&batch->curves[0], channelCount, _percentComplete, batchValues, &_pointIndices[first]);
+        }
+        else
+        {
+            GP_ASSERT(batch->curves[0]);
+            batch->curves[0]->evaluate(_percentComplete, batchValues[0], &_pointIndices[first]);
+        }
+        batchValues += channelCount;
+    }
+}
+
+bool AnimationClip::allocateValues()
+{
+    GP_ASSERT(_animation);
+
+    Animation::CurveSet* curveSet = _animation->getCurveSet();
+    if (curveSet == NULL)
+    {
+        releaseValues();
+        return false;
+    }
+    if (_curveSet == curveSet)
+        return true;
+
+    releaseValues();
+    _curveSet = curveSet;
+    _curveSet->addRef();
+
+    size_t channelCount = _curveSet->curves.size();
+    _values = new float[_curveSet->valueCount];
+    memset(_values, 0, _curveSet->valueCount * sizeof(float));
+    _pointIndices = new unsigned int[channelCount];
+    memset(_pointIndices, 0, channelCount * sizeof(unsigned int));
+
+    // Point to the values of the channels in the order that the batches evaluate them in.
+    _batchValues = new float*[channelCount];
+    float** batchValues = _batchValues;
+    for (size_t i = 0, batchCount = _curveSet->batches.size(); i < batchCount; i++)
+    {
+        const Animation::ChannelBatch* batch = _curveSet->batches[i];
+        for (size_t j = 0, count = batch->channels.size(); j < count; j++)
+        {
+            *batchValues++ = _values + _curveSet->offsets[batch->channels[j]];
+        }
+    }
+    return true;
+}
+
+void AnimationClip::releaseValues()
+{
+    SAFE_DELETE_ARRAY(_values);
+    SAFE_DELETE_ARRAY(_pointIndices);
+    SAFE_DELETE_ARRAY(_batchValues);
+    SAFE_RELEASE(_curveSet);
+    std::vector<float>().swap(_lodSamples);
+}
+
+void AnimationClip::evaluateReducedRate()
+{
+    GP_ASSERT(_lodInterval > 0);
+    GP_ASSERT(_curveSet);
+
+    unsigned int size = _curveSet->valueCount;
+    if (size == 0)
+        return;
+
+    // The samples hold the values interpolated from, followed by the values interpolated to.
+    if (_lodSamples.empty())
+    {
+        evaluate();
+        _lodSamples.resize(size * 2);
+        memcpy(&_lodSamples[0], _values, size * sizeof(float));
+        memcpy(&_lodSamples[size], _values, size * sizeof(float));
+        return;
+    }
+
+    float* from = &_lodSamples[0];
+    float* to = from + size;
+    if (_lodFrame >= _lodInterval)
+    {
+        _lodFrame = 0;
+        evaluate();
+        memcpy(from, to, size * sizeof(float));
+        memcpy(to, _values, size * sizeof(float));
+    }
+
+    float t = (float)_lodFrame / (float)_lodInterval;
+    for (unsigned int i = 0; i < size; i++)
+    {
+        _values[i] = from[i] + (to[i] - from[i]) * t;
+    }
+
+    // Interpolate rotations along the shorter arc and keep them normalized.
+    for (size_t i = 0, channelCount = _curveSet->curves.size(); i < channelCount; i++)
+    {
+        const Curve* curve = _curveSet->curves[i];
+        GP_ASSERT(curve);
+        if (curve->_quaternionOffset)
+        {
+            unsigned int q = _curveSet->offsets[i] + *curve->_quaternionOffset;
+            const float* a = from + q;
+            const float* b = to + q;
+            float* r = _values + q;
+            float s = (a[0] * b[0] + a[1] * b[1] + a[2] * b[2] + a[3] * b[3]) < 0.0f ? -1.0f : 1.0f;
+            float lengthSquared = 0.0f;
+            for (unsigned int j = 0; j < 4; j++)
+            {
+                r[j] = a[j] + (b[j] * s - a[j]) * t;
+                lengthSquared += r[j] * r[j];
+            }
+            if (lengthSquared > 0.0f)
+            {
+                float scale = 1.0f / sqrt(lengthSquared);
+                for (unsigned int j = 0; j < 4; j++)
+                {
+                    r[j] *= scale;
+                }
+            }
+        }
+    }
+}
+
+void AnimationClip::blend(AnimationPose* pose)
+{
+    GP_ASSERT(_curveSet);
+
+    // Set the animation values on the target properties, or blend them into the pose for transforms.
+    // The values of other targets are passed in an animation value that refers to the clip's values.
+    AnimationValue value;
     size_t channelCount = _animation->_channels.size();
+    GP_ASSERT(channelCount == _curveSet->curves.size());
     for (size_t i = 0; i < channelCount; i++)
     {
-        channel = _animation->_channels[i];
+        Animation::Channel* channel = _animation->_channels[i];
         GP_ASSERT(channel);
-        target = channel->_target;
-        GP_ASSERT(target);
-        value = _values[i];
-        GP_ASSERT(value);
+        GP_ASSERT(channel->_target);
+        float* values = _values + _curveSet->offsets[i];
+        if (pose && channel->_target->_targetType == AnimationTarget::TRANSFORM)
+        {
+            pose->blend(static_cast<Transform*>(channel->_target), channel->_propertyId, values, _blendWeight);
+        }
+        else
+        {
+            value._componentCount = _curveSet->curves[i]->getComponentCount();
+            value._componentSize = value._componentCount * sizeof(float);
+            value._value = values;
+            channel->_target->setAnimationPropertyValue(channel->_propertyId, &value, _blendWeight);
+        }
+    }
+    value._value = NULL;
+}
 
-        // Evaluate the point on Curve
-        GP_ASSERT(channel->getCurve());
-        channel->getCurve()->evaluate(percentComplete, value->_value);
-        // Set the animation value on the target property.
-        target->setAnimationPropertyValue(channel->_propertyId, value, _blendWeight);
+void AnimationClip::notifyUpdate()
+{
+    // A clip that was stopped by the listeners of another clip since it was advanced is only ended.
+    if (isClipStateBitSet(CLIP_IS_MARKED_FOR_REMOVAL_BIT))
+        return;
+
+    if (_beginPending)
+    {
+        _beginPending = false;
+        notifyBegin();
     }
 
+    // Notify any listeners of Animation events.
+    if (_listeners)
+        notifyListeners(_wrapped);
+    _wrapped = false;
+}
+
+bool AnimationClip::endUpdate()
+{
     // When ended. Probably should move to it's own method so we can call it when the clip is ended early.
     if (isClipStateBitSet(CLIP_IS_MARKED_FOR_REMOVAL_BIT) || !isClipStateBitSet(CLIP_IS_STARTED_BIT))
     {
         onEnd();
+        notifyEnd();
         return true;
     }
 
     return false;
 }
 
+void AnimationClip::notifyListeners(bool wrapped)
+{
+    GP_ASSERT(_listeners);
+
+    // The listener is copied before it is called, since it may add events to the clip.
+    if (_speed >= 0.0f)
+    {
+        float currentTime = _elapsedTime;
+        if (_repeatCount == REPEAT_INDEFINITE && _duration > 0)
+        {
+            // Finish the events of the repetitions that have passed since the last update.
+            unsigned long repeat = (unsigned long)(_elapsedTime / _duration);
+            while (_listenerRepeat < repeat)
+            {
+                while (_listenerIndex < _listeners->size())
+                {
+                    Listener* listener = (*_listeners)[_listenerIndex++]._listener;
+                    GP_ASSERT(listener);
+                    listener->animationEvent(this, Listener::TIME);
+                }
+                _listenerIndex = 0;
+                _listenerRepeat++;
+            }
+            currentTime -= (float)repeat * _duration;
+        }
+
+        while (_listenerIndex < _listeners->size() && currentTime >= (float)(*_listeners)[_listenerIndex]._eventTime)
+        {
+            Listener* listener = (*_listeners)[_listenerIndex++]._listener;
+            GP_ASSERT(listener);
+            listener->animationEvent(this, Listener::TIME);
+        }
+    }
+    else
+    {
+        if (wrapped)
+        {
+            // Finish the events of the repetition that has passed.
+            while (_listenerIndex > 0)
+            {
+                Listener* listener = (*_listeners)[--_listenerIndex]._listener;
+                GP_ASSERT(listener);
+                listener->animationEvent(this, Listener::TIME);
+            }
+            _listenerIndex = (unsigned int)_listeners->size();
+        }
+
+        while (_listenerIndex > 0 && _elapsedTime <= (float)(*_listeners)[_listenerIndex - 1]._eventTime)
+        {
+            Listener* listener = (*_listeners)[--_listenerIndex]._listener;
+            GP_ASSERT(listener);
+            listener->animationEvent(this, Listener::TIME);
+        }
+    }
+}
+
 void AnimationClip::onBegin()
 {
     // Initialize animation to play.
@@ -536,18 +737,18 @@ void AnimationClip::onBegin()
     if (_speed >= 0)
     {
         _elapsedTime = (Game::getGameTime() - _timeStarted) * _speed;
-
-        if (_listeners)
-            *_listenerItr = _listeners->begin();
+        _listenerIndex = 0;
     }
     else
     {
         _elapsedTime = _activeDuration + (Game::getGameTime() - _timeStarted) * _speed;
-
-        if (_listeners)
-            *_listenerItr = _listeners->end();
+        _listenerIndex = _listeners ? (unsigned int)_listeners->size() : 0;
     }
-    
+    _listenerRepeat = 0;
+}
+
+void AnimationClip::notifyBegin()
+{
     // Notify begin listeners if any.
     if (_beginListeners)
     {
@@ -565,7 +766,12 @@ void AnimationClip::onEnd()
 {
     _blendWeight = 1.0f;
     resetClipStateBit(CLIP_ALL_BITS);
+    releaseValues();
+    _animation->_lastPlayedTime = Game::getGameTime();
+}
 
+void AnimationClip::notifyEnd()
+{
     // Notify end listeners if any.
     if (_endListeners)
     {
@@ -579,6 +785,12 @@ void AnimationClip::onEnd()
     }
 }
 
+bool AnimationClip::hasListeners() const
+{
+    return (_beginListeners && !_beginListeners->empty()) || (_endListeners && !_endListeners->empty()) ||
+        (_listeners && !_listeners->empty());
+}
+
 bool AnimationClip::isClipStateBitSet(unsigned char bit) const
 {
     return (_stateBits & bit) == bit;
@@ -596,25 +808,11 @@ void AnimationClip::resetClipStateBit(unsigned char bit)
 
 AnimationClip* AnimationClip::clone(Animation* animation) const
 {
-    // Don't clone the elapsed time, listeners or crossfade information.
+    // Don't clone the elapsed time, listeners or crossfade information. The values are allocated when the clone plays.
     AnimationClip* newClip = new AnimationClip(getId(), animation, getStartTime(), getEndTime());
     newClip->setSpeed(getSpeed());
     newClip->setRepeatCount(getRepeatCount());
     newClip->setBlendWeight(getBlendWeight());
-    
-    size_t size = _values.size();
-    newClip->_values.resize(size, NULL);
-    for (size_t i = 0; i < size; ++i)
-    {
-        if (newClip->_values[i] == NULL)
-        {
-            newClip->_values[i] = new AnimationValue(*_values[i]);
-        }
-        else
-        {
-            *newClip->_values[i] = *_values[i];
-        }
-    }
     return newClip;
 }
 
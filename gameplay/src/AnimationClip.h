@@ -6,11 +6,14 @@
 #include "Curve.h"
 #include "Animation.h"
 
+class AnimationBenchmarkTest;
+
 namespace gameplay
 {
 
 class Animation;
 class AnimationValue;
+class AnimationPose;
 class ScriptListener;
 
 /**
@@ -20,6 +23,7 @@ class AnimationClip : public Ref
 {
     friend class AnimationController;
     friend class Animation;
+    friend class ::AnimationBenchmarkTest;
 
 public:
 
@@ -229,7 +233,8 @@ public:
      * @param listener The listener to be called when the AnimationClip reaches the 
      *      specified time in its playback.
      * @param eventTime The time the listener will be called during the playback of the AnimationClip. 
-     *      Must be between 0 and the duration of the AnimationClip.
+     *      Must be between 0 and the duration of the AnimationClip. Listeners of clips that repeat
+     *      indefinitely are called during each repetition.
      */
     void addListener(AnimationClip::Listener* listener, unsigned long eventTime);
 
@@ -289,14 +294,9 @@ private:
         ListenerEvent(Listener* listener, unsigned long eventTime);
 
         /**
-         * Destructor.
-         */
-        ~ListenerEvent();
-
-        /**
-         * Hidden copy assignment operator.
+         * Orders listener events by their event time.
          */
-        ListenerEvent& operator=(const ListenerEvent&);
+        bool operator<(const ListenerEvent& event) const;
 
         Listener* _listener;        // This listener to call back when this event is triggered.
         unsigned long _eventTime;   // The time at which the listener will be called back at during the playback of the AnimationClip.
@@ -348,19 +348,119 @@ private:
 
     /**
      * Updates the animation with the elapsed time.
+     *
+     * This is equivalent to calling beginUpdate, notifyUpdate, evaluate, blend and endUpdate
+     * in turn, setting the values on the animation targets directly.
+     *
+     * @return true if the clip has ended and should be removed from the controller.
      */
     bool update(float elapsedTime);
 
+    /**
+     * Advances the clip by the elapsed time and updates its blend weight.
+     *
+     * The begin and time events that the clip passes are not fired until notifyUpdate is
+     * called. If the clip was stopped, it is ended without firing its end event, which
+     * notifyEnd fires.
+     *
+     * @param elapsedTime The elapsed time.
+     * @param ended Set to true if the clip has ended and should be removed from the controller.
+     *
+     * @return true if the clip must be evaluated and applied this frame.
+     */
+    bool beginUpdate(float elapsedTime, bool* ended);
+
+    /**
+     * Evaluates the clip's curves at its current time into its animation values.
+     *
+     * This only writes to the clip's own values, so different clips can be
+     * evaluated concurrently.
+     */
+    void evaluate();
+
+    /**
+     * Allocates the animation values of the clip for the curve set of its animation, if
+     * they are not allocated for it yet.
+     *
+     * @return false if the curves of the animation could not be loaded.
+     */
+    bool allocateValues();
+
+    /**
+     * Frees the animation values of the clip, which are only kept while it is playing.
+     */
+    void releaseValues();
+
+    /**
+     * Evaluates the clip's curves every few frames, and interpolates its animation
+     * values from the last two evaluations in the frames between.
+     *
+     * The AnimationController sets the number of frames between evaluations and counts
+     * the frames since the last evaluation.
+     */
+    void evaluateReducedRate();
+
+    /**
+     * Blends the evaluated values of the clip into the animation targets.
+     *
+     * The values of transform targets are blended into the given pose, which must be
+     * applied to set them on the transforms. The values of other targets are set on
+     * the targets directly.
+     *
+     * @param pose The pose to blend transform values into, or NULL to set them directly.
+     */
+    void blend(AnimationPose* pose);
+
+    /**
+     * Fires the begin and time events that the clip passed in the last call to beginUpdate.
+     *
+     * The events are not fired if the clip was stopped since.
+     */
+    void notifyUpdate();
+
+    /**
+     * Ends the clip if it completed, firing its end event.
+     *
+     * @return true if the clip has ended and should be removed from the controller.
+     */
+    bool endUpdate();
+
+    /**
+     * Calls the listeners of the events that the clip passed since the last update.
+     *
+     * @param wrapped Whether a clip that repeats indefinitely in reverse started a new repetition.
+     */
+    void notifyListeners(bool wrapped);
+
     /**
      * Handles when the AnimationClip begins.
+     *
+     * The begin listeners are called by notifyBegin.
      */
     void onBegin();
 
+    /**
+     * Calls the begin listeners of the AnimationClip.
+     */
+    void notifyBegin();
+
     /**
      * Handles when the AnimationClip ends.
+     *
+     * The end listeners are called by notifyEnd.
      */
     void onEnd();
 
+    /**
+     * Calls the end listeners of the AnimationClip.
+     */
+    void notifyEnd();
+
+    /**
+     * Determines whether the AnimationClip has any begin, end or time listeners.
+     */
+    bool hasListeners() const;
+
     /**
      * Determines whether the given bit is set in the AnimationClip's state.
      */
@@ -400,11 +500,21 @@ private:
     float _crossFadeOutElapsed;                         // The amount of time that has elapsed for the crossfade.
     unsigned long _crossFadeOutDuration;                // The duration of the cross fade.
     float _blendWeight;                                 // The clip's blendweight.
-    std::vector<AnimationValue*> _values;               // AnimationValue holder.
+    float _percentComplete;                             // The position in the animation at which the clip is evaluated.
+    Animation::CurveSet* _curveSet;                     // The curve set that the values are allocated for, while playing.
+    float* _values;                                     // The values of all channels, while playing.
+    unsigned int* _pointIndices;                        // The curve point last evaluated for each channel, while playing.
+    float** _batchValues;                               // The values of each channel, in the order of the channel batches.
+    std::vector<float> _lodSamples;                     // The values of the last two evaluations at a reduced rate.
+    unsigned int _lodInterval;                          // The number of frames between evaluations at a reduced rate, or 0.
+    unsigned int _lodFrame;                             // The number of frames since the last evaluation at a reduced rate.
     std::vector<Listener*>* _beginListeners;            // Collection of begin listeners on the clip.
     std::vector<Listener*>* _endListeners;              // Collection of end listeners on the clip.
-    std::list<ListenerEvent*>* _listeners;              // Ordered collection of listeners on the clip.
-    std::list<ListenerEvent*>::iterator* _listenerItr;  // Iterator that points to the next listener event to be triggered.
+    std::vector<ListenerEvent>* _listeners;             // Collection of listener events on the clip, sorted by event time.
+    unsigned int _listenerIndex;                        // The index of the next listener event to be triggered, or one past it in reverse.
+    unsigned long _listenerRepeat;                      // The repetition whose listener events are being triggered, for clips that repeat indefinitely.
+    bool _beginPending;                                 // Whether the clip began in the last call to beginUpdate and its begin listeners are not called yet.
+    bool _wrapped;                                      // Whether the clip started a new repetition in reverse in the last call to beginUpdate.
     std::vector<ScriptListener*>* _scriptListeners;     // Collection of listeners that are bound to Lua script functions.
 };
 
@@ -2,12 +2,18 @@
 #include "AnimationController.h"
 #include "Game.h"
 #include "Curve.h"
+#include "Camera.h"
+#include "Node.h"
+
+// The smallest number of blended transforms that are resolved by each job.
+#define POSE_RESOLVE_GRAIN_SIZE 256
 
 namespace gameplay
 {
 
 AnimationController::AnimationController()
-    : _state(STOPPED)
+    : _state(STOPPED), _lodCamera(NULL), _offscreenLodPolicy(LOD_FROZEN), _distantLodPolicy(LOD_REDUCED_RATE),
+      _lodScreenSize(0.1f), _lodUpdateInterval(4), _lodPhase(0), _updating(false), _clipsUnscheduled(false)
 {
 }
 
@@ -21,12 +27,99 @@ void AnimationController::stopAllAnimations()
     while (clipIter != _runningClips.end())
     {
         AnimationClip* clip = *clipIter;
-        GP_ASSERT(clip);
-        clip->stop();
+        if (clip)
+            clip->stop();
         clipIter++;
     }
 }
 
+void AnimationController::setLodCamera(Camera* camera)
+{
+    if (_lodCamera != camera)
+    {
+        SAFE_RELEASE(_lodCamera);
+        _lodCamera = camera;
+        if (_lodCamera)
+            _lodCamera->addRef();
+    }
+}
+
+Camera* AnimationController::getLodCamera() const
+{
+    return _lodCamera;
+}
+
+void AnimationController::setOffscreenLodPolicy(LodPolicy policy)
+{
+    _offscreenLodPolicy = policy;
+}
+
+AnimationController::LodPolicy AnimationController::getOffscreenLodPolicy() const
+{
+    return _offscreenLodPolicy;
+}
+
+void AnimationController::setDistantLodPolicy(LodPolicy policy)
+{
+    _distantLodPolicy = policy;
+}
+
+AnimationController::LodPolicy AnimationController::getDistantLodPolicy() const
+{
+    return _distantLodPolicy;
+}
+
+void AnimationController::setLodScreenSize(float size)
+{
+    _lodScreenSize = size;
+}
+
+float AnimationController::getLodScreenSize() const
+{
+    return _lodScreenSize;
+}
+
+void AnimationController::setLodUpdateInterval(unsigned int frames)
+{
+    GP_ASSERT(frames > 0);
+    _lodUpdateInterval = frames;
+}
+
+unsigned int AnimationController::getLodUpdateInterval() const
+{
+    return _lodUpdateInterval;
+}
+
+unsigned int AnimationController::evictAnimations(unsigned long idleTime)
+{
+    double time = Game::getGameTime();
+    unsigned int count = 0;
+    for (std::list<Animation*>::iterator itr = _bundleAnimations.begin(); itr != _bundleAnimations.end(); itr++)
+    {
+        Animation* animation = *itr;
+        GP_ASSERT(animation);
+        if (!animation->_curvesLoaded)
+            continue;
+
+        // Paused clips keep the curves of their animation loaded.
+        bool playing = animation->_defaultClip && animation->_defaultClip->isClipStateBitSet(AnimationClip::CLIP_IS_PLAYING_BIT);
+        for (unsigned int i = 0, clipCount = animation->getClipCount(); i < clipCount && !playing; i++)
+        {
+            playing = animation->getClip(i)->isClipStateBitSet(AnimationClip::CLIP_IS_PLAYING_BIT);
+        }
+        if (playing)
+        {
+            animation->_lastPlayedTime = time;
+        }
+        else if (time - animation->_lastPlayedTime >= idleTime)
+        {
+            animation->unloadCurves();
+            count++;
+        }
+    }
+    return count;
+}
+
 AnimationController::State AnimationController::getState() const
 {
     return _state;
@@ -46,6 +139,7 @@ void AnimationController::finalize()
         SAFE_RELEASE(clip);
     }
     _runningClips.clear();
+    SAFE_RELEASE(_lodCamera);
     _state = STOPPED;
 }
 
@@ -76,17 +170,27 @@ void AnimationController::schedule(AnimationClip* clip)
 
 void AnimationController::unschedule(AnimationClip* clip)
 {
-    std::list<AnimationClip*>::iterator clipItr = _runningClips.begin();
-    while (clipItr != _runningClips.end())
+    // While the running clips are updated, the clip is set to NULL instead of being erased, and
+    // removed at the end of the update. A clip that ended during the update and was played again
+    // is in the running clips twice, so the running clips are searched from the back.
+    std::list<AnimationClip*>::iterator clipItr = _runningClips.end();
+    while (clipItr != _runningClips.begin())
     {
-        AnimationClip* rClip = (*clipItr);
-        if (rClip == clip)
+        clipItr--;
+        if ((*clipItr) == clip)
         {
-            _runningClips.erase(clipItr);
+            if (_updating)
+            {
+                *clipItr = NULL;
+                _clipsUnscheduled = true;
+            }
+            else
+            {
+                _runningClips.erase(clipItr);
+            }
             SAFE_RELEASE(clip);
             break;
         }
-        clipItr++;
     }
 
     if (_runningClips.empty())
@@ -98,15 +202,30 @@ void AnimationController::update(float elapsedTime)
     if (_state != RUNNING)
         return;
     
+    GP_PROFILE_SCOPE("AnimationController::update");
+
     Transform::suspendTransformChanged();
 
-    // Loop through running clips and call update() on them.
+    // Loop through running clips and update them in order. Clips without listeners are advanced
+    // into a batch, whose curves are evaluated in parallel and whose values are applied in order.
+    // A clip with listeners applies the batch first and is then updated on its own, so that its
+    // listeners see the clips before it updated and the clips after it not yet advanced.
+    _updating = true;
     std::list<AnimationClip*>::iterator clipIter = _runningClips.begin();
     while (clipIter != _runningClips.end())
     {
         AnimationClip* clip = (*clipIter);
-        GP_ASSERT(clip);
-        if (clip->isClipStateBitSet(AnimationClip::CLIP_IS_RESTARTED_BIT))
+        bool ended = false;
+        if (clip == NULL)
+        {   // The clip was unscheduled during this update.
+            clipIter++;
+        }
+        else if (clip->hasListeners())
+        {
+            updateBatch();
+            clipIter = updateClip(clipIter, elapsedTime);
+        }
+        else if (clip->isClipStateBitSet(AnimationClip::CLIP_IS_RESTARTED_BIT))
         {   // If the CLIP_IS_RESTARTED_BIT is set, we should end the clip and 
             // move it from where it is in the running clips list to the back.
             clip->onEnd();
@@ -114,7 +233,14 @@ void AnimationController::update(float elapsedTime)
             _runningClips.push_back(clip);
             clipIter = _runningClips.erase(clipIter);
         }
-        else if (clip->update(elapsedTime))
+        else if (clip->beginUpdate(elapsedTime, &ended))
+        {
+            clip->addRef();
+            _updatingClips.push_back(clip);
+            _updatingLods.push_back(updateLod(clip));
+            clipIter++;
+        }
+        else if (ended)
         {
             SAFE_RELEASE(clip);
             clipIter = _runningClips.erase(clipIter);
@@ -124,6 +250,9 @@ void AnimationController::update(float elapsedTime)
             clipIter++;
         }
     }
+    updateBatch();
+    removeEndedClips();
+    _updating = false;
 
     Transform::resumeTransformChanged();
 
@@ -131,4 +260,208 @@ void AnimationController::update(float elapsedTime)
         _state = IDLE;
 }
 
+void AnimationController::updateBatch()
+{
+    size_t count = _updatingClips.size();
+    if (count == 0)
+        return;
+
+    // Evaluate the curves of the clips on the job system, then blend the clips in order, so that
+    // the blended values do not depend on how the clips were evaluated. The blended transforms are
+    // resolved in parallel, since each is only written by one job, and then marked dirty once, in order.
+    JobSystem* jobSystem = Game::getInstance()->getJobSystem();
+    jobSystem->parallelFor((unsigned int)count, this, &AnimationController::evaluateClips);
+    for (size_t i = 0; i < count; i++)
+    {
+        if (_updatingLods[i] != LOD_FROZEN)
+            _updatingClips[i]->blend(&_pose);
+    }
+    jobSystem->parallelFor(_pose.getTargetCount(), &_pose, &AnimationPose::resolve, POSE_RESOLVE_GRAIN_SIZE);
+    _pose.apply();
+
+    // The clips have no listeners, so ending them calls no other code. The clips that ended are
+    // removed from the running clips after the update.
+    for (size_t i = 0; i < count; i++)
+    {
+        AnimationClip* clip = _updatingClips[i];
+        if (clip->endUpdate())
+            _endedClips.push_back(clip);
+        else
+            SAFE_RELEASE(clip);
+    }
+    _updatingClips.clear();
+    _updatingLods.clear();
+}
+
+std::list<AnimationClip*>::iterator AnimationController::updateClip(std::list<AnimationClip*>::iterator clipIter, float elapsedTime)
+{
+    // The clip is referenced while its listeners are called, and a listener that unschedules it
+    // sets it to NULL in the running clips. A clip that was unscheduled is not updated further,
+    // since its animation may have been destroyed.
+    AnimationClip* clip = (*clipIter);
+    GP_ASSERT(clip);
+    clip->addRef();
+
+    bool ended = false;
+    if (clip->isClipStateBitSet(AnimationClip::CLIP_IS_RESTARTED_BIT))
+    {
+        clip->onEnd();
+        clip->setClipStateBit(AnimationClip::CLIP_IS_PLAYING_BIT);
+        clip->notifyEnd();
+        if (*clipIter)
+            _runningClips.push_back(clip);
+        clipIter = _runningClips.erase(clipIter);
+    }
+    else if (clip->beginUpdate(elapsedTime, &ended))
+    {
+        LodPolicy policy = updateLod(clip);
+        clip->notifyUpdate();
+        if (*clipIter)
+        {
+            evaluateClip(clip, policy);
+            if (policy != LOD_FROZEN)
+                clip->blend(NULL);
+            ended = clip->endUpdate();
+        }
+        if (*clipIter == NULL)
+        {
+            clipIter = _runningClips.erase(clipIter);
+        }
+        else if (ended)
+        {
+            clip->release();
+            clipIter = _runningClips.erase(clipIter);
+        }
+        else
+        {
+            clipIter++;
+        }
+    }
+    else if (ended)
+    {
+        clip->notifyEnd();
+        if (*clipIter)
+            clip->release();
+        clipIter = _runningClips.erase(clipIter);
+    }
+    else
+    {
+        clipIter++;
+    }
+
+    SAFE_RELEASE(clip);
+    return clipIter;
+}
+
+void AnimationController::removeEndedClips()
+{
+    if (_endedClips.empty() && !_clipsUnscheduled)
+        return;
+
+    // The clips that ended in batches are in the order of the running clips. A clip that ended
+    // may have been played again, which adds it to the end of the running clips once more.
+    size_t ended = 0;
+    std::list<AnimationClip*>::iterator clipIter = _runningClips.begin();
+    while (clipIter != _runningClips.end())
+    {
+        AnimationClip* clip = (*clipIter);
+        if (clip == NULL)
+        {
+            clipIter = _runningClips.erase(clipIter);
+        }
+        else if (ended < _endedClips.size() && clip == _endedClips[ended])
+        {
+            // Release the references of the running clips and of the batch.
+            clip->release();
+            clip->release();
+            ended++;
+            clipIter = _runningClips.erase(clipIter);
+        }
+        else
+        {
+            clipIter++;
+        }
+    }
+    GP_ASSERT(ended == _endedClips.size());
+    _endedClips.clear();
+    _clipsUnscheduled = false;
+}
+
+void AnimationController::evaluateClips(unsigned int start, unsigned int end)
+{
+    for (unsigned int i = start; i < end; i++)
+    {
+        evaluateClip(_updatingClips[i], _updatingLods[i]);
+    }
+}
+
+void AnimationController::evaluateClip(AnimationClip* clip, LodPolicy policy)
+{
+    GP_ASSERT(clip);
+    switch (policy)
+    {
+    case LOD_REDUCED_RATE:
+        clip->evaluateReducedRate();
+        break;
+    case LOD_FROZEN:
+        break;
+    default:
+        clip->evaluate();
+        break;
+    }
+}
+
+AnimationController::LodPolicy AnimationController::updateLod(AnimationClip* clip)
+{
+    GP_ASSERT(clip);
+    GP_ASSERT(clip->_animation);
+
+    // Clips that ended this frame are evaluated at full rate so that they end on their final values.
+    LodPolicy policy = LOD_FULL_RATE;
+    Node* node = clip->_animation->getLodNode();
+    if (_lodCamera && node && clip->isClipStateBitSet(AnimationClip::CLIP_IS_STARTED_BIT))
+    {
+        const BoundingSphere& bounds = node->getBoundingSphere();
+        if (!bounds.intersects(_lodCamera->getFrustum()))
+        {
+            policy = _offscreenLodPolicy;
+        }
+        else
+        {
+            // Compare the diameter of the bounds on the screen to the height of the viewport.
+            float size;
+            if (_lodCamera->getCameraType() == Camera::PERSPECTIVE)
+            {
+                Node* cameraNode = _lodCamera->getNode();
+                float distance = cameraNode ? bounds.center.distance(cameraNode->getTranslationWorld()) : bounds.center.length();
+                size = distance > bounds.radius ? bounds.radius / (distance * tan(MATH_DEG_TO_RAD(_lodCamera->getFieldOfView()) * 0.5f)) : 1.0f;
+            }
+            else
+            {
+                size = 2.0f * bounds.radius / _lodCamera->getZoomY();
+            }
+            if (size < _lodScreenSize)
+                policy = _distantLodPolicy;
+        }
+    }
+
+    if (policy != LOD_REDUCED_RATE)
+    {
+        clip->_lodInterval = 0;
+    }
+    else if (clip->_lodInterval != _lodUpdateInterval)
+    {
+        // Start interpolating between evaluations, spreading the evaluations of the clips
+        // over the frames of the interval.
+        clip->_lodInterval = _lodUpdateInterval;
+        clip->_lodFrame = _lodPhase++ % _lodUpdateInterval;
+        clip->_lodSamples.clear();
+    }
+    else
+    {
+        clip->_lodFrame++;
+    }
+    return policy;
+}
+
 }
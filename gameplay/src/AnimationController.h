@@ -4,13 +4,21 @@
 #include "AnimationClip.h"
 #include "Animation.h"
 #include "AnimationTarget.h"
+#include "AnimationPose.h"
 #include "Properties.h"
 
 namespace gameplay
 {
 
+class Camera;
+
 /**
  * Defines a class for controlling game animation.
+ *
+ * When a level of detail camera is set, the clips of animations that have a level of
+ * detail node (see Animation::setLodNode) are updated at a reduced rate or frozen while
+ * the node is outside the view of the camera or small on the screen. This keeps large
+ * crowds of animated characters from evaluating every skeleton every frame.
  */
 class AnimationController
 {
@@ -21,11 +29,134 @@ class AnimationController
 
 public:
 
+    /**
+     * Defines how the clips of an animation are updated at a level of detail.
+     */
+    enum LodPolicy
+    {
+        /** The clips are evaluated and applied every frame. */
+        LOD_FULL_RATE,
+
+        /**
+         * The clips are evaluated every few frames (see setLodUpdateInterval). The values
+         * that are applied in the frames between are interpolated from the last two
+         * evaluations, so they lag behind the clip by up to one interval.
+         */
+        LOD_REDUCED_RATE,
+
+        /** The clips advance in time and notify their listeners, but are not evaluated or applied. */
+        LOD_FROZEN
+    };
+
     /** 
      * Stops all AnimationClips currently playing on the AnimationController.
      */
     void stopAllAnimations();
-       
+
+    /**
+     * Sets the camera that determines the level of detail of animations.
+     *
+     * @param camera The camera, usually the active camera of the scene, or NULL to
+     *      update all clips every frame. The default is NULL.
+     * @script{ignore}
+     */
+    void setLodCamera(Camera* camera);
+
+    /**
+     * Returns the camera that determines the level of detail of animations.
+     *
+     * @return The camera, or NULL if all clips are updated every frame.
+     * @script{ignore}
+     */
+    Camera* getLodCamera() const;
+
+    /**
+     * Sets how clips are updated while the level of detail node of their animation is
+     * outside the view frustum of the level of detail camera.
+     *
+     * @param policy The policy. The default is LOD_FROZEN.
+     * @script{ignore}
+     */
+    void setOffscreenLodPolicy(LodPolicy policy);
+
+    /**
+     * Returns how clips are updated while the level of detail node of their animation is
+     * outside the view frustum of the level of detail camera.
+     *
+     * @return The policy.
+     * @script{ignore}
+     */
+    LodPolicy getOffscreenLodPolicy() const;
+
+    /**
+     * Sets how clips are updated while the level of detail node of their animation is
+     * visible but smaller on the screen than the level of detail screen size.
+     *
+     * @param policy The policy. The default is LOD_REDUCED_RATE.
+     * @script{ignore}
+     */
+    void setDistantLodPolicy(LodPolicy policy);
+
+    /**
+     * Returns how clips are updated while the level of detail node of their animation is
+     * visible but smaller on the screen than the level of detail screen size.
+     *
+     * @return The policy.
+     * @script{ignore}
+     */
+    LodPolicy getDistantLodPolicy() const;
+
+    /**
+     * Sets the screen size below which the distant level of detail policy applies.
+     *
+     * @param size The diameter of the bounding sphere of the level of detail node, as a
+     *      fraction of the height of the viewport. The default is 0.1.
+     * @script{ignore}
+     */
+    void setLodScreenSize(float size);
+
+    /**
+     * Returns the screen size below which the distant level of detail policy applies.
+     *
+     * @return The diameter of the bounding sphere as a fraction of the height of the viewport.
+     * @script{ignore}
+     */
+    float getLodScreenSize() const;
+
+    /**
+     * Sets the number of frames between the evaluations of clips that are updated at a
+     * reduced rate.
+     *
+     * The evaluations of different clips are spread over the frames of the interval.
+     *
+     * @param frames The number of frames, which must be at least 1. The default is 4.
+     * @script{ignore}
+     */
+    void setLodUpdateInterval(unsigned int frames);
+
+    /**
+     * Returns the number of frames between the evaluations of clips that are updated at
+     * a reduced rate.
+     *
+     * @return The number of frames.
+     * @script{ignore}
+     */
+    unsigned int getLodUpdateInterval() const;
+
+    /**
+     * Unloads the curves of animations that are loaded from bundles on demand, and whose
+     * clips have not played for the given time.
+     *
+     * The curves are read from the bundle again when one of the clips is played. Clones
+     * of an animation keep their own curves.
+     *
+     * @param idleTime The time (in milliseconds) since the clips of an animation last played.
+     *
+     * @return The number of animations whose curves were unloaded.
+     * @script{ignore}
+     */
+    unsigned int evictAnimations(unsigned long idleTime);
+
 private:
 
     /**
@@ -95,9 +226,64 @@ private:
      * Callback for when the controller receives a frame update event.
      */
     void update(float elapsedTime);
+
+    /**
+     * Evaluates the curves of the batch of clips on the job system, applies their values
+     * in order and ends the clips that completed.
+     */
+    void updateBatch();
+
+    /**
+     * Updates a clip that has listeners on its own, after the batch has been applied.
+     *
+     * @param clipIter The position of the clip in the running clips.
+     * @param elapsedTime The elapsed time.
+     *
+     * @return The position of the next clip in the running clips.
+     */
+    std::list<AnimationClip*>::iterator updateClip(std::list<AnimationClip*>::iterator clipIter, float elapsedTime);
+
+    /**
+     * Removes the clips that ended in a batch, and the clips that were unscheduled during
+     * the update, from the running clips.
+     */
+    void removeEndedClips();
+
+    /**
+     * Evaluates a range of the batch of clips.
+     */
+    void evaluateClips(unsigned int start, unsigned int end);
+
+    /**
+     * Evaluates the curves of a clip at the given level of detail.
+     */
+    static void evaluateClip(AnimationClip* clip, LodPolicy policy);
+
+    /**
+     * Determines how a clip is updated this frame, and advances the clip's reduced
+     * rate updates.
+     *
+     * @param clip The clip, which has been advanced to this frame.
+     *
+     * @return The level of detail policy for the clip.
+     */
+    LodPolicy updateLod(AnimationClip* clip);
     
     State _state;                                 // The current state of the AnimationController.
     std::list<AnimationClip*> _runningClips;      // A list of running AnimationClips.
+    std::vector<AnimationClip*> _updatingClips;   // The batch of advanced clips without listeners, each referenced until it is applied.
+    std::vector<LodPolicy> _updatingLods;         // The level of detail policy of each clip in the batch.
+    std::vector<AnimationClip*> _endedClips;      // The clips that ended in a batch, in the order of the running clips.
+    bool _updating;                               // Whether the running clips are being updated.
+    bool _clipsUnscheduled;                       // Whether clips were unscheduled during the update.
+    AnimationPose _pose;                          // The pose that the updating clips blend the transforms they animate into.
+    Camera* _lodCamera;                           // The camera that determines the level of detail of animations.
+    LodPolicy _offscreenLodPolicy;                // The policy for clips animating nodes outside the view frustum.
+    LodPolicy _distantLodPolicy;                  // The policy for clips animating nodes small on the screen.
+    float _lodScreenSize;                         // The screen size below which the distant policy applies.
+    unsigned int _lodUpdateInterval;              // The number of frames between evaluations of reduced rate clips.
+    unsigned int _lodPhase;                       // Spreads the evaluations of reduced rate clips over the interval.
+    std::list<Animation*> _bundleAnimations;      // The animations whose curves are loaded from bundles on demand.
 };
 
 }
@@ -0,0 +1,234 @@
+#include "Base.h"
+#include "AnimationPose.h"
+#include "Transform.h"
+
+namespace gameplay
+{
+
+AnimationPose::AnimationPose()
+{
+}
+
+AnimationPose::~AnimationPose()
+{
+    GP_ASSERT(_targets.empty());
+}
+
+void AnimationPose::blend(Transform* target, int propertyId, const float* value, float blendWeight)
+{
+    GP_ASSERT(target);
+    GP_ASSERT(value);
+    GP_ASSERT(blendWeight >= 0.0f && blendWeight <= 1.0f);
+
+    // A value with no weight leaves the transform unchanged.
+    if (blendWeight == 0.0f)
+        return;
+
+    Target& entry = getTarget(target);
+    switch (propertyId)
+    {
+        case Transform::ANIMATE_SCALE_UNIT:
+            blendComponent(entry, SCALE_X, value[0], blendWeight);
+            blendComponent(entry, SCALE_Y, value[0], blendWeight);
+            blendComponent(entry, SCALE_Z, value[0], blendWeight);
+            break;
+        case Transform::ANIMATE_SCALE:
+            blendComponent(entry, SCALE_X, value[0], blendWeight);
+            blendComponent(entry, SCALE_Y, value[1], blendWeight);
+            blendComponent(entry, SCALE_Z, value[2], blendWeight);
+            break;
+        case Transform::ANIMATE_SCALE_X:
+            blendComponent(entry, SCALE_X, value[0], blendWeight);
+            break;
+        case Transform::ANIMATE_SCALE_Y:
+            blendComponent(entry, SCALE_Y, value[0], blendWeight);
+            break;
+        case Transform::ANIMATE_SCALE_Z:
+            blendComponent(entry, SCALE_Z, value[0], blendWeight);
+            break;
+        case Transform::ANIMATE_ROTATE:
+            blendRotation(entry, value, blendWeight);
+            break;
+        case Transform::ANIMATE_TRANSLATE:
+            blendComponent(entry, TRANSLATE_X, value[0], blendWeight);
+            blendComponent(entry, TRANSLATE_Y, value[1], blendWeight);
+            blendComponent(entry, TRANSLATE_Z, value[2], blendWeight);
+            break;
+        case Transform::ANIMATE_TRANSLATE_X:
+            blendComponent(entry, TRANSLATE_X, value[0], blendWeight);
+            break;
+        case Transform::ANIMATE_TRANSLATE_Y:
+            blendComponent(entry, TRANSLATE_Y, value[0], blendWeight);
+            break;
+        case Transform::ANIMATE_TRANSLATE_Z:
+            blendComponent(entry, TRANSLATE_Z, value[0], blendWeight);
+            break;
+        case Transform::ANIMATE_ROTATE_TRANSLATE:
+            blendRotation(entry, value, blendWeight);
+            blendComponent(entry, TRANSLATE_X, value[4], blendWeight);
+            blendComponent(entry, TRANSLATE_Y, value[5], blendWeight);
+            blendComponent(entry, TRANSLATE_Z, value[6], blendWeight);
+            break;
+        case Transform::ANIMATE_SCALE_ROTATE:
+            blendComponent(entry, SCALE_X, value[0], blendWeight);
+            blendComponent(entry, SCALE_Y, value[1], blendWeight);
+            blendComponent(entry, SCALE_Z, value[2], blendWeight);
+            blendRotation(entry, value + 3, blendWeight);
+            break;
+        case Transform::ANIMATE_SCALE_TRANSLATE:
+            blendComponent(entry, SCALE_X, value[0], blendWeight);
+            blendComponent(entry, SCALE_Y, value[1], blendWeight);
+            blendComponent(entry, SCALE_Z, value[2], blendWeight);
+            blendComponent(entry, TRANSLATE_X, value[3], blendWeight);
+            blendComponent(entry, TRANSLATE_Y, value[4], blendWeight);
+            blendComponent(entry, TRANSLATE_Z, value[5], blendWeight);
+            break;
+        case Transform::ANIMATE_SCALE_ROTATE_TRANSLATE:
+            blendComponent(entry, SCALE_X, value[0], blendWeight);
+            blendComponent(entry, SCALE_Y, value[1], blendWeight);
+            blendComponent(entry, SCALE_Z, value[2], blendWeight);
+            blendRotation(entry, value + 3, blendWeight);
+            blendComponent(entry, TRANSLATE_X, value[7], blendWeight);
+            blendComponent(entry, TRANSLATE_Y, value[8], blendWeight);
+            blendComponent(entry, TRANSLATE_Z, value[9], blendWeight);
+            break;
+        default:
+            break;
+    }
+}
+
+unsigned int AnimationPose::getTargetCount() const
+{
+    return (unsigned int)_targets.size();
+}
+
+void AnimationPose::resolve(unsigned int start, unsigned int end)
+{
+    GP_ASSERT(start <= end && end <= _targets.size());
+
+    for (unsigned int i = start; i < end; ++i)
+    {
+        Target& entry = _targets[i];
+        Transform* target = entry.transform;
+        GP_ASSERT(target);
+        char dirtyBits = 0;
+
+        if (entry.weights[SCALE_X] > 0.0f || entry.weights[SCALE_Y] > 0.0f || entry.weights[SCALE_Z] > 0.0f)
+        {
+            target->_scale.x = getComponent(entry, SCALE_X, target->_scale.x);
+            target->_scale.y = getComponent(entry, SCALE_Y, target->_scale.y);
+            target->_scale.z = getComponent(entry, SCALE_Z, target->_scale.z);
+            dirtyBits |= Transform::DIRTY_SCALE;
+        }
+
+        float weight = entry.weights[ROTATE_X];
+        if (weight > 0.0f)
+        {
+            Quaternion& rotation = target->_rotation;
+            float x = entry.values[ROTATE_X];
+            float y = entry.values[ROTATE_Y];
+            float z = entry.values[ROTATE_Z];
+            float w = entry.values[ROTATE_W];
+            if (entry.rotationCount == 1)
+            {
+                // A single rotation is interpolated from the current rotation exactly as
+                // when it is set on the transform directly.
+                GP_ASSERT(weight <= 1.0f);
+                Quaternion::slerp(rotation, Quaternion(x / weight, y / weight, z / weight, w / weight), weight, &rotation);
+            }
+            else
+            {
+                if (weight < 1.0f)
+                {
+                    float currentWeight = 1.0f - weight;
+                    if (rotation.x * x + rotation.y * y + rotation.z * z + rotation.w * w < 0.0f)
+                        currentWeight = -currentWeight;
+                    x += rotation.x * currentWeight;
+                    y += rotation.y * currentWeight;
+                    z += rotation.z * currentWeight;
+                    w += rotation.w * currentWeight;
+                }
+                rotation.set(x, y, z, w);
+                rotation.normalize();
+            }
+            dirtyBits |= Transform::DIRTY_ROTATION;
+        }
+
+        if (entry.weights[TRANSLATE_X] > 0.0f || entry.weights[TRANSLATE_Y] > 0.0f || entry.weights[TRANSLATE_Z] > 0.0f)
+        {
+            target->_translation.x = getComponent(entry, TRANSLATE_X, target->_translation.x);
+            target->_translation.y = getComponent(entry, TRANSLATE_Y, target->_translation.y);
+            target->_translation.z = getComponent(entry, TRANSLATE_Z, target->_translation.z);
+            dirtyBits |= Transform::DIRTY_TRANSLATION;
+        }
+
+        target->_poseIndex = Transform::POSE_INDEX_NONE;
+        entry.dirtyBits = dirtyBits;
+    }
+}
+
+void AnimationPose::apply()
+{
+    // Marking a transform dirty notifies its listeners or queues it with the suspended
+    // transforms, so this is done in order on the calling thread.
+    for (size_t i = 0, count = _targets.size(); i < count; ++i)
+    {
+        const Target& entry = _targets[i];
+        GP_ASSERT(entry.transform && entry.transform->_poseIndex == Transform::POSE_INDEX_NONE);
+        if (entry.dirtyBits)
+            entry.transform->dirty(entry.dirtyBits);
+    }
+
+    // Clear the pose, keeping the storage for the next frame.
+    _targets.clear();
+}
+
+AnimationPose::Target& AnimationPose::getTarget(Transform* transform)
+{
+    GP_ASSERT(transform);
+
+    if (transform->_poseIndex == Transform::POSE_INDEX_NONE)
+    {
+        transform->_poseIndex = (unsigned int)_targets.size();
+        _targets.push_back(Target());
+        _targets.back().transform = transform;
+    }
+    GP_ASSERT(transform->_poseIndex < _targets.size() && _targets[transform->_poseIndex].transform == transform);
+    return _targets[transform->_poseIndex];
+}
+
+void AnimationPose::blendComponent(Target& target, Component component, float value, float blendWeight)
+{
+    target.values[component] += value * blendWeight;
+    target.weights[component] += blendWeight;
+}
+
+void AnimationPose::blendRotation(Target& target, const float* value, float blendWeight)
+{
+    // Quaternions q and -q are the same rotation, so blend the one that is closest
+    // to the rotations blended so far.
+    float x = target.values[ROTATE_X];
+    float y = target.values[ROTATE_Y];
+    float z = target.values[ROTATE_Z];
+    float w = target.values[ROTATE_W];
+    float weight = blendWeight;
+    if (x * value[0] + y * value[1] + z * value[2] + w * value[3] < 0.0f)
+        weight = -weight;
+
+    target.values[ROTATE_X] = x + value[0] * weight;
+    target.values[ROTATE_Y] = y + value[1] * weight;
+    target.values[ROTATE_Z] = z + value[2] * weight;
+    target.values[ROTATE_W] = w + value[3] * weight;
+    target.weights[ROTATE_X] += blendWeight;
+    target.rotationCount++;
+}
+
+float AnimationPose::getComponent(const Target& target, Component component, float current)
+{
+    float weight = target.weights[component];
+    if (weight >= 1.0f)
+        return target.values[component] / weight;
+    return target.values[component] + current * (1.0f - weight);
+}
+
+}
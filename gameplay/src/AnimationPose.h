@@ -0,0 +1,140 @@
+#ifndef ANIMATIONPOSE_H_
+#define ANIMATIONPOSE_H_
+
+namespace gameplay
+{
+
+class Transform;
+
+/**
+ * Defines a buffer of the scale, rotation and translation of the transforms animated
+ * by the running clips of the animation controller.
+ *
+ * Clips blend their evaluated values into the pose with their blend weights instead of
+ * setting them on the transforms directly. When all clips have been blended, the pose
+ * is applied to each transform once, marking it dirty only once for all of the clips
+ * and channels that animate it.
+ *
+ * The blended components of each transform are stored together, in the order that the
+ * transforms were first blended. A component that is blended with a total weight of one
+ * or more is set to the weighted average of the blended values. A component that is
+ * blended with a total weight of less than one keeps the remaining weight of the
+ * transform's current value.
+ *
+ * The blended values of the transforms are resolved independently of each other, so
+ * ranges of the pose can be resolved in parallel. The transforms are then marked dirty
+ * in order when the pose is applied.
+ *
+ * @script{ignore}
+ */
+class AnimationPose
+{
+    friend class AnimationController;
+    friend class AnimationClip;
+
+private:
+
+    /**
+     * The components of the pose.
+     */
+    enum Component
+    {
+        SCALE_X,
+        SCALE_Y,
+        SCALE_Z,
+        ROTATE_X,
+        ROTATE_Y,
+        ROTATE_Z,
+        ROTATE_W,
+        TRANSLATE_X,
+        TRANSLATE_Y,
+        TRANSLATE_Z,
+        COMPONENT_COUNT
+    };
+
+    /**
+     * Constructor.
+     */
+    AnimationPose();
+
+    /**
+     * Destructor.
+     */
+    ~AnimationPose();
+
+    /**
+     * Hidden copy constructor.
+     */
+    AnimationPose(const AnimationPose& copy);
+
+    /**
+     * Hidden copy assignment operator.
+     */
+    AnimationPose& operator=(const AnimationPose&);
+
+    /**
+     * Blends an animation value of a transform into the pose.
+     *
+     * @param target The transform.
+     * @param propertyId The transform property that the value is for.
+     * @param value The components of the value.
+     * @param blendWeight The blend weight of the value.
+     */
+    void blend(Transform* target, int propertyId, const float* value, float blendWeight);
+
+    /**
+     * Returns the number of blended transforms.
+     */
+    unsigned int getTargetCount() const;
+
+    /**
+     * Sets the blended values on a range of the blended transforms, without marking them dirty.
+     *
+     * @param start The index of the first transform to resolve.
+     * @param end The index after the last transform to resolve.
+     */
+    void resolve(unsigned int start, unsigned int end);
+
+    /**
+     * Marks the resolved transforms dirty, in the order they were first blended, and clears the pose.
+     */
+    void apply();
+
+    /**
+     * The blended components of a transform.
+     */
+    struct Target
+    {
+        Transform* transform;                   // The blended transform.
+        float values[COMPONENT_COUNT];          // The weighted sum of the blended values of each component.
+        float weights[COMPONENT_COUNT];         // The sum of the weights of each component, kept in ROTATE_X for the rotation.
+        unsigned int rotationCount;             // The number of rotations blended into the transform.
+        char dirtyBits;                         // The parts of the transform that were changed when it was resolved.
+    };
+
+    /**
+     * Returns the blended components of the given transform, adding it if needed.
+     */
+    Target& getTarget(Transform* transform);
+
+    /**
+     * Blends a value into a scale or translation component of a transform.
+     */
+    static void blendComponent(Target& target, Component component, float value, float blendWeight);
+
+    /**
+     * Blends a quaternion into the rotation of a transform.
+     */
+    static void blendRotation(Target& target, const float* value, float blendWeight);
+
+    /**
+     * Returns the blended value of a scale or translation component, given the current value.
+     */
+    static float getComponent(const Target& target, Component component, float current);
+
+    std::vector<Target> _targets;               // The blended transforms.
+};
+
+}
+
+#endif
@@ -476,6 +476,10 @@ void AnimationTarget::cloneInto(AnimationTarget* target, NodeCloneContext &conte
                 // Clone the animation and register it with the context so that it only gets cloned once.
                 animation = channel->_animation->clone(channel, target);
                 context.registerClonedAnimation(channel->_animation, animation);
+
+                // Use the clone of the level of detail node, if it was cloned before its animated descendants.
+                if (channel->_animation->_lodNode)
+                    animation->_lodNode = context.findClonedNode(channel->_animation->_lodNode);
             }
         }
     }
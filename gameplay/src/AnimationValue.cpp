@@ -4,6 +4,11 @@
 namespace gameplay
 {
 
+AnimationValue::AnimationValue()
+  : _componentCount(0), _componentSize(0), _value(NULL)
+{
+}
+
 AnimationValue::AnimationValue(unsigned int componentCount)
   : _componentCount(componentCount), _componentSize(componentCount * sizeof(float))
 {
@@ -0,0 +1,186 @@
+#include "Base.h"
+#include "AsyncLoad.h"
+#include "Game.h"
+#include "Scene.h"
+#include "Texture.h"
+
+namespace gameplay
+{
+
+static std::vector<AsyncLoad*> __pendingLoads;
+static float __frameBudget = 4.0f;
+
+AsyncLoad::AsyncLoad(const char* path)
+    : _scene(NULL), _texture(NULL), _path(path ? path : ""), _state(LOADING), _submitted(false), _progress(0.0f)
+{
+    _job.load = this;
+    _job.loaded = false;
+}
+
+AsyncLoad::~AsyncLoad()
+{
+    SAFE_RELEASE(_scene);
+    SAFE_RELEASE(_texture);
+}
+
+AsyncLoad::State AsyncLoad::getState() const
+{
+    return _state;
+}
+
+bool AsyncLoad::isDone() const
+{
+    return _state != LOADING;
+}
+
+float AsyncLoad::getProgress() const
+{
+    return _progress;
+}
+
+const char* AsyncLoad::getPath() const
+{
+    return _path.c_str();
+}
+
+Scene* AsyncLoad::getScene() const
+{
+    return _state == COMPLETE ? _scene : NULL;
+}
+
+Texture* AsyncLoad::getTexture() const
+{
+    return _state == COMPLETE ? _texture : NULL;
+}
+
+void AsyncLoad::wait()
+{
+    if (_submitted)
+    {
+        Game::getInstance()->getJobSystem()->wait(&_job);
+    }
+    while (_state == LOADING)
+    {
+        step();
+    }
+
+    std::vector<AsyncLoad*>::iterator itr = std::find(__pendingLoads.begin(), __pendingLoads.end(), this);
+    if (itr != __pendingLoads.end())
+    {
+        __pendingLoads.erase(itr);
+        release();
+    }
+}
+
+void AsyncLoad::setFrameBudget(float milliseconds)
+{
+    __frameBudget = milliseconds;
+}
+
+float AsyncLoad::getFrameBudget()
+{
+    return __frameBudget;
+}
+
+void AsyncLoad::start()
+{
+    // The pending list keeps the load alive until it is done.
+    addRef();
+    __pendingLoads.push_back(this);
+
+    Game* game = Game::getInstance();
+    JobSystem* jobSystem = game ? game->getJobSystem() : NULL;
+    if (jobSystem)
+    {
+        _submitted = true;
+        jobSystem->submitBackground(&_job);
+    }
+    else
+    {
+        // Before the game has started, the background work is done right away.
+        _job.execute();
+    }
+}
+
+void AsyncLoad::setProgress(float progress)
+{
+    _progress = progress;
+}
+
+bool AsyncLoad::step()
+{
+    GP_ASSERT(_state == LOADING);
+
+    if (_submitted)
+    {
+        if (!_job.isComplete())
+            return false;
+        _submitted = false;
+    }
+
+    _state = _job.loaded ? createObjects() : FAILED;
+    if (_state == COMPLETE)
+    {
+        setProgress(1.0f);
+    }
+    else if (_state == FAILED)
+    {
+        GP_WARN("Failed to load '%s' asynchronously.", _path.c_str());
+    }
+    return true;
+}
+
+void AsyncLoad::update()
+{
+    if (__pendingLoads.empty())
+        return;
+
+    GP_PROFILE_SCOPE("AsyncLoad::update");
+
+    // Loads are advanced in the order they were started; at least one step is done per frame.
+    double deadline = Game::getAbsoluteTime() + __frameBudget;
+    bool stepped = false;
+    for (size_t i = 0; i < __pendingLoads.size(); )
+    {
+        AsyncLoad* load = __pendingLoads[i];
+        while (load->_state == LOADING && (!stepped || Game::getAbsoluteTime() < deadline) && load->step())
+        {
+            stepped = true;
+        }
+
+        if (load->_state != LOADING)
+        {
+            __pendingLoads.erase(__pendingLoads.begin() + i);
+            load->release();
+        }
+        else
+        {
+            ++i;
+        }
+
+        if (stepped && Game::getAbsoluteTime() >= deadline)
+            break;
+    }
+}
+
+void AsyncLoad::finalize()
+{
+    Game* game = Game::getInstance();
+    for (size_t i = 0, count = __pendingLoads.size(); i < count; ++i)
+    {
+        AsyncLoad* load = __pendingLoads[i];
+        if (load->_submitted)
+        {
+            game->getJobSystem()->wait(&load->_job);
+        }
+        load->release();
+    }
+    __pendingLoads.clear();
+}
+
+void AsyncLoad::LoadJob::execute()
+{
+    loaded = load->loadData();
+}
+
+}
@@ -0,0 +1,212 @@
+#ifndef ASYNCLOAD_H_
+#define ASYNCLOAD_H_
+
+#include "Ref.h"
+#include "JobSystem.h"
+
+namespace gameplay
+{
+
+class Scene;
+class Texture;
+
+/**
+ * Defines a handle to a resource that is being loaded in the background.
+ *
+ * File I/O, decompression and parsing run on the background thread of the job
+ * system. The remaining work, which creates GL objects, runs on the game thread at
+ * the start of each frame and spends at most the frame budget (see setFrameBudget)
+ * across all pending loads, so that loading does not cause hitches.
+ *
+ * The handle is polled from the game thread with getState and getProgress. Once the
+ * load is complete, the loaded resource is returned by getScene or getTexture. The
+ * handle holds a reference to the resource until it is released, so callers that keep
+ * the resource must add their own reference.
+ *
+ * Asynchronous loads are started with Bundle::loadSceneAsync, Scene::loadAsync and
+ * Texture::createAsync.
+ */
+class AsyncLoad : public Ref
+{
+    friend class Game;
+
+public:
+
+    /**
+     * The state of an asynchronous load.
+     */
+    enum State
+    {
+        LOADING,
+        COMPLETE,
+        FAILED
+    };
+
+    /**
+     * Returns the state of the load.
+     *
+     * @return The state of the load.
+     */
+    State getState() const;
+
+    /**
+     * Determines if the load has finished, either successfully or not.
+     *
+     * @return true if the load is complete or has failed, false if it is still loading.
+     */
+    bool isDone() const;
+
+    /**
+     * Returns an estimate of the fraction of the load that has been done.
+     *
+     * @return The progress of the load in the range [0, 1].
+     */
+    float getProgress() const;
+
+    /**
+     * Returns the path of the resource being loaded.
+     *
+     * @return The path of the resource.
+     */
+    const char* getPath() const;
+
+    /**
+     * Returns the loaded scene.
+     *
+     * @return The scene, or NULL if the load is not complete or did not load a scene.
+     */
+    Scene* getScene() const;
+
+    /**
+     * Returns the loaded texture.
+     *
+     * @return The texture, or NULL if the load is not complete or did not load a texture.
+     */
+    Texture* getTexture() const;
+
+    /**
+     * Blocks until the load has finished, doing the remaining game thread work without
+     * a time budget.
+     *
+     * This must be called on the game thread.
+     */
+    void wait();
+
+    /**
+     * Sets the time that the game thread spends on pending loads in each frame.
+     *
+     * At least one step of the oldest pending load is done in every frame, even if it
+     * takes longer than the budget. The default budget is 4 milliseconds.
+     *
+     * @param milliseconds The frame budget in milliseconds.
+     */
+    static void setFrameBudget(float milliseconds);
+
+    /**
+     * Returns the time that the game thread spends on pending loads in each frame.
+     *
+     * @return The frame budget in milliseconds.
+     */
+    static float getFrameBudget();
+
+protected:
+
+    /**
+     * Constructor.
+     *
+     * @param path The path of the resource being loaded.
+     */
+    AsyncLoad(const char* path);
+
+    /**
+     * Destructor.
+     */
+    virtual ~AsyncLoad();
+
+    /**
+     * Submits the background work of the load and adds it to the pending loads.
+     */
+    void start();
+
+    /**
+     * Called on the background thread to read, decompress and parse the resource.
+     *
+     * @return true if successful, false if the load failed.
+     */
+    virtual bool loadData() = 0;
+
+    /**
+     * Called on the game thread once loadData has returned, to do the next step of
+     * creating the resource. Each step should take a fraction of the frame budget.
+     *
+     * @return LOADING if more steps are needed, or COMPLETE or FAILED once done.
+     */
+    virtual State createObjects() = 0;
+
+    /**
+     * Sets the progress of the load. This can be called from either thread.
+     *
+     * @param progress The progress in the range [0, 1].
+     */
+    void setProgress(float progress);
+
+    /**
+     * The loaded scene, which is released with the handle.
+     */
+    Scene* _scene;
+
+    /**
+     * The loaded texture, which is released with the handle.
+     */
+    Texture* _texture;
+
+private:
+
+    /**
+     * Runs the background work of a load.
+     */
+    class LoadJob : public JobSystem::Job
+    {
+    public:
+        void execute();
+        AsyncLoad* load;
+        bool loaded;
+    };
+
+    /**
+     * Hidden copy constructor.
+     */
+    AsyncLoad(const AsyncLoad& copy);
+
+    /**
+     * Hidden copy assignment operator.
+     */
+    AsyncLoad& operator=(const AsyncLoad&);
+
+    /**
+     * Does the next game thread step of the load, if its background work is done.
+     *
+     * @return true if a step was done, false if the load is still waiting on the background thread.
+     */
+    bool step();
+
+    /**
+     * Advances the pending loads within the frame budget. Called by the game every frame.
+     */
+    static void update();
+
+    /**
+     * Waits for and releases all pending loads. Called by the game on shutdown.
+     */
+    static void finalize();
+
+    std::string _path;
+    State _state;
+    bool _submitted;
+    volatile float _progress;
+    LoadJob _job;
+};
+
+}
+
+#endif
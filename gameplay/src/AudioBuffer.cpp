@@ -1,13 +1,11 @@
 #include "Base.h"
 #include "AudioBuffer.h"
 #include "FileSystem.h"
+#include "ResourceManager.h"
 
 namespace gameplay
 {
 
-// Audio buffer cache
-static std::vector<AudioBuffer*> __buffers;
-
 // Callbacks for loading an ogg file using Stream
 static size_t readStream(void *ptr, size_t size, size_t nmemb, void *datasource)
 {
@@ -45,17 +43,6 @@ AudioBuffer::AudioBuffer(const char* path, ALuint buffer)
 
 AudioBuffer::~AudioBuffer()
 {
-    // Remove the buffer from the cache.
-    unsigned int bufferCount = (unsigned int)__buffers.size();
-    for (unsigned int i = 0; i < bufferCount; i++)
-    {
-        if (this == __buffers[i])
-        {
-            __buffers.erase(__buffers.begin() + i);
-            break;
-        }
-    }
-
     if (_alBuffer)
     {
         AL_CHECK( alDeleteBuffers(1, &_alBuffer) );
@@ -68,17 +55,10 @@ AudioBuffer* AudioBuffer::create(const char* path)
     GP_ASSERT(path);
 
     // Search the cache for a stream from this file.
-    unsigned int bufferCount = (unsigned int)__buffers.size();
-    AudioBuffer* buffer = NULL;
-    for (unsigned int i = 0; i < bufferCount; i++)
+    AudioBuffer* buffer = static_cast<AudioBuffer*>(ResourceManager::find(ResourceManager::AUDIO_BUFFER, path));
+    if (buffer)
     {
-        buffer = __buffers[i];
-        GP_ASSERT(buffer);
-        if (buffer->_filePath.compare(path) == 0)
-        {
-            buffer->addRef();
-            return buffer;
-        }
+        return buffer;
     }
 
     ALuint alBuffer;
@@ -134,7 +114,9 @@ AudioBuffer* AudioBuffer::create(const char* path)
     buffer = new AudioBuffer(path, alBuffer);
 
     // Add the buffer to the cache.
-    __buffers.push_back(buffer);
+    ALint size;
+    AL_CHECK( alGetBufferi(alBuffer, AL_SIZE, &size) );
+    ResourceManager::add(ResourceManager::AUDIO_BUFFER, buffer->_filePath, buffer, AL_LAST_ERROR() == AL_NO_ERROR ? (size_t)size : 0);
 
     return buffer;
     
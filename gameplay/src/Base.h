@@ -105,6 +105,9 @@ extern void print(const char* format, ...);
 // Debug new for memory leak detection
 #include "DebugNew.h"
 
+// Profiling markers
+#include "Profiler.h"
+
 // Object deletion macro
 #define SAFE_DELETE(x) \
     { \
@@ -253,6 +256,12 @@ using std::va_list;
     #endif
 #endif
 
+// Math (SIMD)
+#if !defined(USE_NEON) && (defined(__SSE__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 1))
+    #include <xmmintrin.h>
+    #define USE_SSE
+#endif
+
 // Graphics (GLSL)
 #define VERTEX_ATTRIBUTE_POSITION_NAME              "a_position"
 #define VERTEX_ATTRIBUTE_NORMAL_NAME                "a_normal"
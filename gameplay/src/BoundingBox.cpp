@@ -2,6 +2,7 @@
 #include "BoundingBox.h"
 #include "BoundingSphere.h"
 #include "Plane.h"
+#include "MathUtil.h"
 
 namespace gameplay
 {
@@ -346,4 +347,9 @@ void BoundingBox::transform(const Matrix& matrix)
     this->max.z = newMax.z;
 }
 
+void BoundingBox::transform(const Matrix& matrix, const BoundingBox* boxes, unsigned int count, BoundingBox* dst)
+{
+    MathUtil::transformBoxes(matrix.m, (const float*)boxes, count, (float*)dst);
+}
+
 }
@@ -208,6 +208,20 @@ public:
      */
     void transform(const Matrix& matrix);
 
+    /**
+     * Transforms an array of bounding boxes by the given affine transformation matrix.
+     *
+     * Each resulting box bounds the transformed corners of the corresponding box.
+     *
+     * @param matrix The transformation matrix to transform by.
+     * @param boxes The bounding boxes to transform.
+     * @param count The number of bounding boxes.
+     * @param dst An array of count bounding boxes to store the results in,
+     *      which may be the same array as boxes.
+     * @script{ignore}
+     */
+    static void transform(const Matrix& matrix, const BoundingBox* boxes, unsigned int count, BoundingBox* dst);
+
     /**
      * Transforms this bounding box by the given matrix.
      * 
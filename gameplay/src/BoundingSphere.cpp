@@ -302,6 +302,23 @@ void BoundingSphere::transform(const Matrix& matrix)
     radius = r;
 }
 
+void BoundingSphere::transform(const Matrix& matrix, const BoundingSphere* spheres, unsigned int count, BoundingSphere* dst)
+{
+    GP_ASSERT(count == 0 || (spheres && dst));
+
+    // Decompose the matrix once for the whole array.
+    Vector3 scale;
+    matrix.decompose(&scale, NULL, NULL);
+    for (unsigned int i = 0; i < count; i++)
+    {
+        matrix.transformPoint(spheres[i].center, &dst[i].center);
+        float r = spheres[i].radius * scale.x;
+        r = max(r, spheres[i].radius * scale.y);
+        r = max(r, spheres[i].radius * scale.z);
+        dst[i].radius = r;
+    }
+}
+
 float BoundingSphere::distance(const BoundingSphere& sphere, const Vector3& point)
 {
     return sqrt((point.x - sphere.center.x) * (point.x - sphere.center.x) +
@@ -153,6 +153,18 @@ public:
      */
     void transform(const Matrix& matrix);
 
+    /**
+     * Transforms an array of bounding spheres by the given transformation matrix.
+     *
+     * @param matrix The transformation matrix to transform by.
+     * @param spheres The bounding spheres to transform.
+     * @param count The number of bounding spheres.
+     * @param dst An array of count bounding spheres to store the results in,
+     *      which may be the same array as spheres.
+     * @script{ignore}
+     */
+    static void transform(const Matrix& matrix, const BoundingSphere* spheres, unsigned int count, BoundingSphere* dst);
+
     /**
      * Transforms this bounding sphere by the given matrix.
      * 
@@ -0,0 +1,625 @@
+#include "Base.h"
+#include "BoundingVolumeHierarchy.h"
+#include "Node.h"
+
+// Fraction of a node's bounding radius that its leaf box is enlarged by.
+#define BVH_MARGIN 0.1f
+
+namespace gameplay
+{
+
+/**
+ * Computes the box that contains both of the given boxes.
+ */
+static void mergeBoxes(const BoundingBox& a, const BoundingBox& b, BoundingBox* dst)
+{
+    dst->set(std::min(a.min.x, b.min.x), std::min(a.min.y, b.min.y), std::min(a.min.z, b.min.z),
+             std::max(a.max.x, b.max.x), std::max(a.max.y, b.max.y), std::max(a.max.z, b.max.z));
+}
+
+/**
+ * Returns the surface area of the given box, used as the insertion cost.
+ */
+static float surfaceArea(const BoundingBox& box)
+{
+    float dx = box.max.x - box.min.x;
+    float dy = box.max.y - box.min.y;
+    float dz = box.max.z - box.min.z;
+    return 2.0f * (dx * dy + dy * dz + dz * dx);
+}
+
+/**
+ * Returns the surface area of the box containing both of the given boxes.
+ */
+static float mergedSurfaceArea(const BoundingBox& a, const BoundingBox& b)
+{
+    BoundingBox merged;
+    mergeBoxes(a, b, &merged);
+    return surfaceArea(merged);
+}
+
+/**
+ * Determines if the outer box fully contains the inner box.
+ */
+static bool containsBox(const BoundingBox& outer, const BoundingBox& inner)
+{
+    return outer.min.x <= inner.min.x && outer.min.y <= inner.min.y && outer.min.z <= inner.min.z &&
+           outer.max.x >= inner.max.x && outer.max.y >= inner.max.y && outer.max.z >= inner.max.z;
+}
+
+/**
+ * Classifies a box against a frustum.
+ *
+ * @return Plane::INTERSECTS_BACK if the box is outside the frustum, Plane::INTERSECTS_FRONT
+ *      if it is fully inside and Plane::INTERSECTS_INTERSECTING otherwise.
+ */
+static int classifyBox(const BoundingBox& box, const Frustum& frustum)
+{
+    const Plane* planes[] = { &frustum.getNear(), &frustum.getFar(), &frustum.getLeft(),
+                              &frustum.getRight(), &frustum.getBottom(), &frustum.getTop() };
+
+    int result = Plane::INTERSECTS_FRONT;
+    for (unsigned int i = 0; i < 6; ++i)
+    {
+        float d = box.intersects(*planes[i]);
+        if (d == Plane::INTERSECTS_BACK)
+            return Plane::INTERSECTS_BACK;
+        if (d == Plane::INTERSECTS_INTERSECTING)
+            result = Plane::INTERSECTS_INTERSECTING;
+    }
+    return result;
+}
+
+/**
+ * Orders ray hits by distance.
+ */
+static bool compareHits(const std::pair<float, Node*>& a, const std::pair<float, Node*>& b)
+{
+    return a.first < b.first;
+}
+
+BoundingVolumeHierarchy::BoundingVolumeHierarchy()
+    : _root(-1), _freeList(-1), _nodeCount(0)
+{
+}
+
+BoundingVolumeHierarchy::~BoundingVolumeHierarchy()
+{
+    // Detach all nodes that are still referencing us.
+    for (size_t i = 0, count = _entries.size(); i < count; ++i)
+    {
+        Entry& entry = _entries[i];
+        if (entry.height == 0 && entry.node)
+        {
+            entry.node->_boundingVolumeHierarchy = NULL;
+            entry.node->_boundingVolumeProxy = -1;
+        }
+    }
+}
+
+unsigned int BoundingVolumeHierarchy::getNodeCount() const
+{
+    return _nodeCount;
+}
+
+unsigned int BoundingVolumeHierarchy::getHeight() const
+{
+    return _root == -1 ? 0 : (unsigned int)_entries[_root].height + 1;
+}
+
+void BoundingVolumeHierarchy::addHierarchy(Node* node)
+{
+    GP_ASSERT(node);
+
+    refresh(node);
+    for (Node* child = node->getFirstChild(); child != NULL; child = child->getNextSibling())
+    {
+        addHierarchy(child);
+    }
+}
+
+void BoundingVolumeHierarchy::removeHierarchy(Node* node)
+{
+    GP_ASSERT(node);
+
+    remove(node);
+    for (Node* child = node->getFirstChild(); child != NULL; child = child->getNextSibling())
+    {
+        removeHierarchy(child);
+    }
+}
+
+void BoundingVolumeHierarchy::refresh(Node* node)
+{
+    GP_ASSERT(node);
+
+    if (!node->getModel() && !node->getTerrain())
+        remove(node);
+    else if (node->_boundingVolumeHierarchy == this)
+        setDirty(node->_boundingVolumeProxy);
+    else
+        add(node);
+}
+
+void BoundingVolumeHierarchy::add(Node* node)
+{
+    GP_ASSERT(node);
+
+    if (node->_boundingVolumeHierarchy == this)
+        return;
+
+    int leaf = allocateEntry();
+    Entry& entry = _entries[leaf];
+    entry.node = node;
+    entry.height = 0;
+    computeBox(node, &entry.box);
+    insertLeaf(leaf);
+
+    node->_boundingVolumeHierarchy = this;
+    node->_boundingVolumeProxy = leaf;
+    ++_nodeCount;
+}
+
+void BoundingVolumeHierarchy::remove(Node* node)
+{
+    GP_ASSERT(node);
+
+    if (node->_boundingVolumeHierarchy != this)
+        return;
+
+    int leaf = node->_boundingVolumeProxy;
+    removeLeaf(leaf);
+    freeEntry(leaf);
+
+    node->_boundingVolumeHierarchy = NULL;
+    node->_boundingVolumeProxy = -1;
+    --_nodeCount;
+}
+
+void BoundingVolumeHierarchy::setDirty(int leaf)
+{
+    Entry& entry = _entries[leaf];
+    if (!entry.dirty)
+    {
+        entry.dirty = true;
+        _dirtyLeaves.push_back(leaf);
+    }
+}
+
+void BoundingVolumeHierarchy::computeBox(Node* node, BoundingBox* box)
+{
+    const BoundingSphere& sphere = node->getBoundingSphere();
+    float extent = sphere.radius * (1.0f + BVH_MARGIN);
+    box->set(sphere.center.x - extent, sphere.center.y - extent, sphere.center.z - extent,
+             sphere.center.x + extent, sphere.center.y + extent, sphere.center.z + extent);
+}
+
+void BoundingVolumeHierarchy::update()
+{
+    for (size_t i = 0, count = _dirtyLeaves.size(); i < count; ++i)
+    {
+        int leaf = _dirtyLeaves[i];
+        Entry& entry = _entries[leaf];
+
+        // The leaf may have been removed (and its entry reused) since it was marked.
+        if (entry.height != 0 || !entry.dirty)
+            continue;
+        entry.dirty = false;
+
+        // Only restructure the tree when the bounds have left the enlarged leaf box.
+        const BoundingSphere& sphere = entry.node->getBoundingSphere();
+        BoundingBox bounds(sphere.center.x - sphere.radius, sphere.center.y - sphere.radius, sphere.center.z - sphere.radius,
+                           sphere.center.x + sphere.radius, sphere.center.y + sphere.radius, sphere.center.z + sphere.radius);
+        if (!containsBox(entry.box, bounds))
+        {
+            removeLeaf(leaf);
+            computeBox(_entries[leaf].node, &_entries[leaf].box);
+            insertLeaf(leaf);
+        }
+    }
+    _dirtyLeaves.clear();
+}
+
+unsigned int BoundingVolumeHierarchy::query(const Frustum& frustum, std::vector<Node*>& nodes)
+{
+    update();
+
+    size_t start = nodes.size();
+    if (_root == -1)
+        return 0;
+
+    _stack.clear();
+    _stack.push_back(_root);
+    while (!_stack.empty())
+    {
+        int index = _stack.back();
+        _stack.pop_back();
+
+        const Entry& entry = _entries[index];
+        int result = classifyBox(entry.box, frustum);
+        if (result == Plane::INTERSECTS_BACK)
+            continue;
+
+        if (entry.height == 0)
+        {
+            if (result == Plane::INTERSECTS_FRONT || entry.node->getBoundingSphere().intersects(frustum))
+                nodes.push_back(entry.node);
+        }
+        else if (result == Plane::INTERSECTS_FRONT)
+        {
+            // Everything below a fully contained box is visible without further tests.
+            collect(index, nodes);
+        }
+        else
+        {
+            _stack.push_back(entry.child1);
+            _stack.push_back(entry.child2);
+        }
+    }
+
+    return (unsigned int)(nodes.size() - start);
+}
+
+unsigned int BoundingVolumeHierarchy::query(const BoundingSphere& sphere, std::vector<Node*>& nodes)
+{
+    update();
+
+    size_t start = nodes.size();
+    if (_root == -1)
+        return 0;
+
+    _stack.clear();
+    _stack.push_back(_root);
+    while (!_stack.empty())
+    {
+        int index = _stack.back();
+        _stack.pop_back();
+
+        const Entry& entry = _entries[index];
+        if (!entry.box.intersects(sphere))
+            continue;
+
+        if (entry.height == 0)
+        {
+            if (entry.node->getBoundingSphere().intersects(sphere))
+                nodes.push_back(entry.node);
+        }
+        else
+        {
+            _stack.push_back(entry.child1);
+            _stack.push_back(entry.child2);
+        }
+    }
+
+    return (unsigned int)(nodes.size() - start);
+}
+
+unsigned int BoundingVolumeHierarchy::query(const Ray& ray, std::vector<Node*>& nodes, float maxDistance)
+{
+    update();
+
+    if (_root == -1)
+        return 0;
+
+    std::vector<std::pair<float, Node*> > hits;
+    _stack.clear();
+    _stack.push_back(_root);
+    while (!_stack.empty())
+    {
+        int index = _stack.back();
+        _stack.pop_back();
+
+        const Entry& entry = _entries[index];
+        float distance = entry.box.intersects(ray);
+        if (distance == Ray::INTERSECTS_NONE || distance > maxDistance)
+            continue;
+
+        if (entry.height == 0)
+        {
+            distance = entry.node->getBoundingSphere().intersects(ray);
+            if (distance != Ray::INTERSECTS_NONE && distance <= maxDistance)
+                hits.push_back(std::make_pair(distance, entry.node));
+        }
+        else
+        {
+            _stack.push_back(entry.child1);
+            _stack.push_back(entry.child2);
+        }
+    }
+
+    std::sort(hits.begin(), hits.end(), compareHits);
+    for (size_t i = 0, count = hits.size(); i < count; ++i)
+    {
+        nodes.push_back(hits[i].second);
+    }
+
+    return (unsigned int)hits.size();
+}
+
+void BoundingVolumeHierarchy::collect(int index, std::vector<Node*>& nodes)
+{
+    const Entry& entry = _entries[index];
+    if (entry.height == 0)
+    {
+        nodes.push_back(entry.node);
+    }
+    else
+    {
+        collect(entry.child1, nodes);
+        collect(entry.child2, nodes);
+    }
+}
+
+int BoundingVolumeHierarchy::allocateEntry()
+{
+    int index;
+    if (_freeList == -1)
+    {
+        index = (int)_entries.size();
+        _entries.push_back(Entry());
+    }
+    else
+    {
+        index = _freeList;
+        _freeList = _entries[index].parent;
+    }
+
+    Entry& entry = _entries[index];
+    entry.node = NULL;
+    entry.parent = -1;
+    entry.child1 = -1;
+    entry.child2 = -1;
+    entry.height = 0;
+    entry.dirty = false;
+    return index;
+}
+
+void BoundingVolumeHierarchy::freeEntry(int index)
+{
+    Entry& entry = _entries[index];
+    entry.node = NULL;
+    entry.height = -1;
+    entry.dirty = false;
+    entry.parent = _freeList;
+    _freeList = index;
+}
+
+void BoundingVolumeHierarchy::insertLeaf(int leaf)
+{
+    if (_root == -1)
+    {
+        _root = leaf;
+        _entries[leaf].parent = -1;
+        return;
+    }
+
+    // Descend towards the sibling that results in the smallest increase in surface area.
+    const BoundingBox leafBox = _entries[leaf].box;
+    int index = _root;
+    while (_entries[index].height > 0)
+    {
+        const Entry& entry = _entries[index];
+        float area = surfaceArea(entry.box);
+        float combinedArea = mergedSurfaceArea(entry.box, leafBox);
+
+        // Cost of creating a new parent for this entry and the leaf, and the
+        // minimum cost of pushing the leaf further down the tree.
+        float cost = 2.0f * combinedArea;
+        float inheritanceCost = 2.0f * (combinedArea - area);
+
+        const Entry& child1 = _entries[entry.child1];
+        float cost1 = mergedSurfaceArea(child1.box, leafBox) + inheritanceCost;
+        if (child1.height > 0)
+            cost1 -= surfaceArea(child1.box);
+
+        const Entry& child2 = _entries[entry.child2];
+        float cost2 = mergedSurfaceArea(child2.box, leafBox) + inheritanceCost;
+        if (child2.height > 0)
+            cost2 -= surfaceArea(child2.box);
+
+        if (cost < cost1 && cost < cost2)
+            break;
+
+        index = cost1 < cost2 ? entry.child1 : entry.child2;
+    }
+
+    // Create a new parent for the sibling and the leaf.
+    int sibling = index;
+    int oldParent = _entries[sibling].parent;
+    int newParent = allocateEntry();
+    Entry& parent = _entries[newParent];
+    parent.parent = oldParent;
+    parent.height = _entries[sibling].height + 1;
+    parent.child1 = sibling;
+    parent.child2 = leaf;
+    mergeBoxes(leafBox, _entries[sibling].box, &parent.box);
+    _entries[sibling].parent = newParent;
+    _entries[leaf].parent = newParent;
+
+    if (oldParent != -1)
+    {
+        if (_entries[oldParent].child1 == sibling)
+            _entries[oldParent].child1 = newParent;
+        else
+            _entries[oldParent].child2 = newParent;
+    }
+    else
+    {
+        _root = newParent;
+    }
+
+    // Walk back up the tree, rebalancing and fixing heights and boxes.
+    index = _entries[leaf].parent;
+    while (index != -1)
+    {
+        index = balance(index);
+
+        Entry& entry = _entries[index];
+        const Entry& child1 = _entries[entry.child1];
+        const Entry& child2 = _entries[entry.child2];
+        entry.height = 1 + std::max(child1.height, child2.height);
+        mergeBoxes(child1.box, child2.box, &entry.box);
+
+        index = entry.parent;
+    }
+}
+
+void BoundingVolumeHierarchy::removeLeaf(int leaf)
+{
+    if (leaf == _root)
+    {
+        _root = -1;
+        return;
+    }
+
+    int parent = _entries[leaf].parent;
+    int grandParent = _entries[parent].parent;
+    int sibling = _entries[parent].child1 == leaf ? _entries[parent].child2 : _entries[parent].child1;
+
+    if (grandParent != -1)
+    {
+        // Destroy the parent and connect the sibling to the grandparent.
+        if (_entries[grandParent].child1 == parent)
+            _entries[grandParent].child1 = sibling;
+        else
+            _entries[grandParent].child2 = sibling;
+        _entries[sibling].parent = grandParent;
+        freeEntry(parent);
+
+        int index = grandParent;
+        while (index != -1)
+        {
+            index = balance(index);
+
+            Entry& entry = _entries[index];
+            const Entry& child1 = _entries[entry.child1];
+            const Entry& child2 = _entries[entry.child2];
+            entry.height = 1 + std::max(child1.height, child2.height);
+            mergeBoxes(child1.box, child2.box, &entry.box);
+
+            index = entry.parent;
+        }
+    }
+    else
+    {
+        _root = sibling;
+        _entries[sibling].parent = -1;
+        freeEntry(parent);
+    }
+}
+
+int BoundingVolumeHierarchy::balance(int iA)
+{
+    Entry* A = &_entries[iA];
+    if (A->height < 2)
+        return iA;
+
+    int iB = A->child1;
+    int iC = A->child2;
+    Entry* B = &_entries[iB];
+    Entry* C = &_entries[iC];
+
+    int difference = C->height - B->height;
+
+    // Rotate C up.
+    if (difference > 1)
+    {
+        int iF = C->child1;
+        int iG = C->child2;
+        Entry* F = &_entries[iF];
+        Entry* G = &_entries[iG];
+
+        // Swap A and C.
+        C->child1 = iA;
+        C->parent = A->parent;
+        A->parent = iC;
+        if (C->parent != -1)
+        {
+            if (_entries[C->parent].child1 == iA)
+                _entries[C->parent].child1 = iC;
+            else
+                _entries[C->parent].child2 = iC;
+        }
+        else
+        {
+            _root = iC;
+        }
+
+        // Keep the taller of C's children in place.
+        if (F->height > G->height)
+        {
+            C->child2 = iF;
+            A->child2 = iG;
+            G->parent = iA;
+            mergeBoxes(B->box, G->box, &A->box);
+            mergeBoxes(A->box, F->box, &C->box);
+            A->height = 1 + std::max(B->height, G->height);
+            C->height = 1 + std::max(A->height, F->height);
+        }
+        else
+        {
+            C->child2 = iG;
+            A->child2 = iF;
+            F->parent = iA;
+            mergeBoxes(B->box, F->box, &A->box);
+            mergeBoxes(A->box, G->box, &C->box);
+            A->height = 1 + std::max(B->height, F->height);
+            C->height = 1 + std::max(A->height, G->height);
+        }
+
+        return iC;
+    }
+
+    // Rotate B up.
+    if (difference < -1)
+    {
+        int iD = B->child1;
+        int iE = B->child2;
+        Entry* D = &_entries[iD];
+        Entry* E = &_entries[iE];
+
+        // Swap A and B.
+        B->child1 = iA;
+        B->parent = A->parent;
+        A->parent = iB;
+        if (B->parent != -1)
+        {
+            if (_entries[B->parent].child1 == iA)
+                _entries[B->parent].child1 = iB;
+            else
+                _entries[B->parent].child2 = iB;
+        }
+        else
+        {
+            _root = iB;
+        }
+
+        // Keep the taller of B's children in place.
+        if (D->height > E->height)
+        {
+            B->child2 = iD;
+            A->child1 = iE;
+            E->parent = iA;
+            mergeBoxes(C->box, E->box, &A->box);
+            mergeBoxes(A->box, D->box, &B->box);
+            A->height = 1 + std::max(C->height, E->height);
+            B->height = 1 + std::max(A->height, D->height);
+        }
+        else
+        {
+            B->child2 = iE;
+            A->child1 = iD;
+            D->parent = iA;
+            mergeBoxes(C->box, D->box, &A->box);
+            mergeBoxes(A->box, E->box, &B->box);
+            A->height = 1 + std::max(C->height, D->height);
+            B->height = 1 + std::max(A->height, E->height);
+        }
+
+        return iB;
+    }
+
+    return iA;
+}
+
+}
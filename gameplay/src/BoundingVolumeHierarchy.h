@@ -0,0 +1,198 @@
+#ifndef BOUNDINGVOLUMEHIERARCHY_H_
+#define BOUNDINGVOLUMEHIERARCHY_H_
+
+#include "BoundingBox.h"
+#include "BoundingSphere.h"
+#include "Frustum.h"
+#include "Ray.h"
+
+namespace gameplay
+{
+
+class Node;
+class Scene;
+
+/**
+ * Defines a dynamic bounding volume hierarchy for spatial queries on the nodes of a scene.
+ *
+ * Each node that contains a model or terrain is stored as a leaf holding an axis-aligned
+ * box that is slightly enlarged around the node's world-space bounding sphere. Leaves
+ * are only re-inserted when a node's bounds move outside of their enlarged box, so small
+ * movements do not restructure the tree. Insertions use a surface area heuristic and the
+ * tree is kept balanced with rotations, so queries scale logarithmically with the number
+ * of nodes.
+ *
+ * A bounding volume hierarchy is created and owned by a Scene the first time
+ * the scene is queried with Scene::queryFrustum, Scene::querySphere or Scene::queryRay.
+ */
+class BoundingVolumeHierarchy
+{
+    friend class Scene;
+    friend class Node;
+
+public:
+
+    /**
+     * Returns the number of nodes stored in the hierarchy.
+     *
+     * @return The number of stored nodes.
+     */
+    unsigned int getNodeCount() const;
+
+    /**
+     * Returns the height of the tree.
+     *
+     * @return The height of the tree, or zero if the tree is empty.
+     */
+    unsigned int getHeight() const;
+
+    /**
+     * Re-inserts all nodes whose bounds have changed since the last update.
+     */
+    void update();
+
+    /**
+     * Appends all stored nodes whose bounds intersect the given frustum.
+     *
+     * @param frustum The frustum to test against.
+     * @param nodes The vector to append the matching nodes to.
+     *
+     * @return The number of nodes appended.
+     */
+    unsigned int query(const Frustum& frustum, std::vector<Node*>& nodes);
+
+    /**
+     * Appends all stored nodes whose bounds intersect the given sphere.
+     *
+     * @param sphere The sphere to test against.
+     * @param nodes The vector to append the matching nodes to.
+     *
+     * @return The number of nodes appended.
+     */
+    unsigned int query(const BoundingSphere& sphere, std::vector<Node*>& nodes);
+
+    /**
+     * Appends all stored nodes whose bounds are hit by the given ray, nearest first.
+     *
+     * @param ray The ray to test against.
+     * @param nodes The vector to append the matching nodes to.
+     * @param maxDistance The maximum distance along the ray to consider.
+     *
+     * @return The number of nodes appended.
+     */
+    unsigned int query(const Ray& ray, std::vector<Node*>& nodes, float maxDistance);
+
+private:
+
+    /**
+     * A node of the tree; leaves reference a scene node.
+     */
+    struct Entry
+    {
+        BoundingBox box;
+        Node* node;
+        int parent;
+        int child1;
+        int child2;
+        int height;
+        bool dirty;
+    };
+
+    /**
+     * Constructor.
+     */
+    BoundingVolumeHierarchy();
+
+    /**
+     * Destructor.
+     */
+    ~BoundingVolumeHierarchy();
+
+    /**
+     * Hidden copy constructor.
+     */
+    BoundingVolumeHierarchy(const BoundingVolumeHierarchy& copy);
+
+    /**
+     * Hidden copy assignment operator.
+     */
+    BoundingVolumeHierarchy& operator=(const BoundingVolumeHierarchy&);
+
+    /**
+     * Adds the given node and all of its descendants that should be indexed.
+     */
+    void addHierarchy(Node* node);
+
+    /**
+     * Removes the given node and all of its descendants.
+     */
+    void removeHierarchy(Node* node);
+
+    /**
+     * Adds or removes the given node depending on whether it should be indexed.
+     */
+    void refresh(Node* node);
+
+    /**
+     * Adds a single node.
+     */
+    void add(Node* node);
+
+    /**
+     * Removes a single node.
+     */
+    void remove(Node* node);
+
+    /**
+     * Marks the bounds of the leaf at the given index as changed.
+     */
+    void setDirty(int leaf);
+
+    /**
+     * Computes the enlarged box for the current bounds of the given node.
+     */
+    static void computeBox(Node* node, BoundingBox* box);
+
+    /**
+     * Returns the index of an unused entry, reusing freed entries when possible.
+     */
+    int allocateEntry();
+
+    /**
+     * Returns the entry at the given index to the free list.
+     */
+    void freeEntry(int index);
+
+    /**
+     * Links the given leaf into the tree next to the sibling with the lowest insertion cost.
+     */
+    void insertLeaf(int leaf);
+
+    /**
+     * Unlinks the given leaf from the tree without freeing it.
+     */
+    void removeLeaf(int leaf);
+
+    /**
+     * Performs a rotation at the given entry if its subtrees are unbalanced.
+     *
+     * @return The index of the entry that took the place of the given entry.
+     */
+    int balance(int index);
+
+    /**
+     * Appends the nodes of all leaves below the given entry.
+     */
+    void collect(int index, std::vector<Node*>& nodes);
+
+    std::vector<Entry> _entries;
+    int _root;
+    int _freeList;
+    unsigned int _nodeCount;
+    std::vector<int> _dirtyLeaves;
+    std::vector<int> _stack;
+};
+
+}
+
+#endif
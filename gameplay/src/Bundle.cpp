@@ -4,9 +4,16 @@
 #include "MeshPart.h"
 #include "Scene.h"
 #include "Joint.h"
+#include "SceneLoader.h"
+#include "ResourceManager.h"
+#include "SkinDeformer.h"
 
 #define BUNDLE_VERSION_MAJOR            1
-#define BUNDLE_VERSION_MINOR            2
+#define BUNDLE_VERSION_MINOR            3
+
+// The oldest supported minor version, and the first minor version that stores animations in compressed form.
+#define BUNDLE_VERSION_MINOR_MIN        2
+#define BUNDLE_VERSION_MINOR_COMPRESSED_ANIMATIONS 3
 
 #define BUNDLE_TYPE_SCENE               1
 #define BUNDLE_TYPE_NODE                2
@@ -29,23 +36,18 @@
 namespace gameplay
 {
 
-static std::vector<Bundle*> __bundleCache;
+static bool __mappingEnabled = true;
+static bool __animationLoadingDeferred = true;
 
 Bundle::Bundle(const char* path) :
-    _path(path), _referenceCount(0), _references(NULL), _stream(NULL), _trackedNodes(NULL)
+    _path(path), _referenceCount(0), _references(NULL), _stream(NULL), _trackedNodes(NULL), _keyTimeTracksPosition(0)
 {
 }
 
 Bundle::~Bundle()
 {
     clearLoadSession();
-
-    // Remove this Bundle from the cache.
-    std::vector<Bundle*>::iterator itr = std::find(__bundleCache.begin(), __bundleCache.end(), this);
-    if (itr != __bundleCache.end())
-    {
-        __bundleCache.erase(itr);
-    }
+    clearPreloadedMeshes();
 
     SAFE_DELETE_ARRAY(_references);
 
@@ -127,6 +129,92 @@ bool Bundle::readArray(unsigned int* length, std::vector<T>* values, unsigned in
     return true;
 }
 
+template <class T>
+bool Bundle::skipArray(unsigned int* length)
+{
+    GP_ASSERT(length);
+    GP_ASSERT(_stream);
+
+    if (!read(length))
+    {
+        GP_ERROR("Failed to read the length of an array of data (to be skipped).");
+        return false;
+    }
+    if (*length > 0 && _stream->seek((long int)(sizeof(T) * *length), SEEK_CUR) == false)
+    {
+        GP_ERROR("Failed to skip over an array of data in bundle.");
+        return false;
+    }
+    return true;
+}
+
+template <class T>
+bool Bundle::readArray(unsigned int* length, std::vector<T>* values, const T** data)
+{
+    GP_ASSERT(length);
+    GP_ASSERT(values);
+    GP_ASSERT(data);
+    GP_ASSERT(_stream);
+
+    *data = NULL;
+    if (!read(length))
+    {
+        GP_ERROR("Failed to read the length of an array of data (to be mapped).");
+        return false;
+    }
+    if (*length > 0)
+    {
+        // Values can only be used in place if they are aligned within the mapping.
+        size_t size = sizeof(T) * *length;
+        *data = (const T*)_stream->map(size);
+        if (*data && ((size_t)*data % sizeof(T)) != 0)
+        {
+            *data = NULL;
+            if (_stream->seek(-(long int)size, SEEK_CUR) == false)
+            {
+                GP_ERROR("Failed to seek back over an unaligned array of data in bundle.");
+                return false;
+            }
+        }
+        if (*data == NULL)
+        {
+            values->resize(*length);
+            if (_stream->read(&(*values)[0], sizeof(T), *length) != *length)
+            {
+                GP_ERROR("Failed to read an array of data from bundle (to be mapped).");
+                return false;
+            }
+            *data = &(*values)[0];
+        }
+    }
+    return true;
+}
+
+unsigned char* Bundle::readData(unsigned int size, bool mapData, bool* mapped)
+{
+    GP_ASSERT(mapped);
+    GP_ASSERT(_stream);
+
+    *mapped = false;
+    if (mapData)
+    {
+        unsigned char* data = (unsigned char*)_stream->map(size);
+        if (data)
+        {
+            *mapped = true;
+            return data;
+        }
+    }
+
+    unsigned char* data = new unsigned char[size];
+    if (_stream->read(data, 1, size) != size)
+    {
+        SAFE_DELETE_ARRAY(data);
+        return NULL;
+    }
+    return data;
+}
+
 static std::string readString(Stream* stream)
 {
     GP_ASSERT(stream);
@@ -156,23 +244,32 @@ static std::string readString(Stream* stream)
 
 Bundle* Bundle::create(const char* path)
 {
+    GP_PROFILE_SCOPE("Bundle::create");
+
     GP_ASSERT(path);
 
     // Search the cache for this bundle.
-    for (size_t i = 0, count = __bundleCache.size(); i < count; ++i)
+    Bundle* p = static_cast<Bundle*>(ResourceManager::find(ResourceManager::BUNDLE, path));
+    if (p)
     {
-        Bundle* p = __bundleCache[i];
-        GP_ASSERT(p);
-        if (p->_path == path)
-        {
-            // Found a match
-            p->addRef();
-            return p;
-        }
+        // Found a match
+        return p;
     }
 
+    Bundle* bundle = open(path);
+    if (bundle)
+    {
+        ResourceManager::add(ResourceManager::BUNDLE, bundle->_path, bundle, bundle->_stream->length());
+    }
+    return bundle;
+}
+
+Bundle* Bundle::open(const char* path)
+{
+    GP_ASSERT(path);
+
     // Open the bundle.
-    Stream* stream = FileSystem::open(path);
+    Stream* stream = FileSystem::open(path, __mappingEnabled ? FileSystem::READ | FileSystem::MAP : FileSystem::READ);
     if (!stream)
     {
         GP_ERROR("Failed to open file '%s'.", path);
@@ -196,10 +293,11 @@ Bundle* Bundle::create(const char* path)
         GP_ERROR("Failed to read GPB version for bundle '%s'.", path);
         return NULL;
     }
-    if (ver[0] != BUNDLE_VERSION_MAJOR || ver[1] != BUNDLE_VERSION_MINOR)
+    if (ver[0] != BUNDLE_VERSION_MAJOR || ver[1] < BUNDLE_VERSION_MINOR_MIN || ver[1] > BUNDLE_VERSION_MINOR)
     {
         SAFE_DELETE(stream);
-        GP_ERROR("Unsupported version (%d.%d) for bundle '%s' (expected %d.%d).", (int)ver[0], (int)ver[1], path, BUNDLE_VERSION_MAJOR, BUNDLE_VERSION_MINOR);
+        GP_ERROR("Unsupported version (%d.%d) for bundle '%s' (expected %d.%d to %d.%d).", (int)ver[0], (int)ver[1], path,
+            BUNDLE_VERSION_MAJOR, BUNDLE_VERSION_MINOR_MIN, BUNDLE_VERSION_MAJOR, BUNDLE_VERSION_MINOR);
         return NULL;
     }
 
@@ -232,23 +330,72 @@ Bundle* Bundle::create(const char* path)
     bundle->_referenceCount = refCount;
     bundle->_references = refs;
     bundle->_stream = stream;
+    bundle->_version[0] = ver[0];
+    bundle->_version[1] = ver[1];
 
     return bundle;
 }
 
+Bundle* Bundle::cache(Bundle* bundle)
+{
+    GP_ASSERT(bundle);
+
+    Bundle* cached = static_cast<Bundle*>(ResourceManager::find(ResourceManager::BUNDLE, bundle->_path));
+    if (cached)
+    {
+        return cached;
+    }
+
+    ResourceManager::add(ResourceManager::BUNDLE, bundle->_path, bundle, bundle->_stream->length());
+    bundle->addRef();
+    return bundle;
+}
+
+bool Bundle::isMesh(const Reference* ref)
+{
+    GP_ASSERT(ref);
+    return ref->type == BUNDLE_TYPE_MESH;
+}
+
+AsyncLoad* Bundle::loadSceneAsync(const char* path, const char* id)
+{
+    GP_ASSERT(path);
+
+    return SceneLoader::loadBundleAsync(path, id);
+}
+
+void Bundle::setMappingEnabled(bool enabled)
+{
+    __mappingEnabled = enabled;
+}
+
+bool Bundle::isMappingEnabled()
+{
+    return __mappingEnabled;
+}
+
+void Bundle::setAnimationLoadingDeferred(bool deferred)
+{
+    __animationLoadingDeferred = deferred;
+}
+
+bool Bundle::isAnimationLoadingDeferred()
+{
+    return __animationLoadingDeferred;
+}
+
 Bundle::Reference* Bundle::find(const char* id) const
 {
     GP_ASSERT(id);
     GP_ASSERT(_references);
 
     // Search the ref table for the given id (case-sensitive).
-    for (unsigned int i = 0; i < _referenceCount; ++i)
+    indexReferences<ReferenceIdLess>(_referencesById);
+    std::vector<Reference*>::const_iterator itr = std::lower_bound(_referencesById.begin(), _referencesById.end(), id, ReferenceIdLess());
+    if (itr != _referencesById.end() && (*itr)->id == id)
     {
-        if (_references[i].id == id)
-        {
-            // Found a match
-            return &_references[i];
-        }
+        // Found a match
+        return *itr;
     }
 
     return NULL;
@@ -261,6 +408,16 @@ void Bundle::clearLoadSession()
         SAFE_DELETE(_meshSkins[i]);
     }
     _meshSkins.clear();
+    clearKeyTimeTracks();
+}
+
+void Bundle::clearKeyTimeTracks()
+{
+    for (size_t i = 0, count = _keyTimeTracks.size(); i < count; ++i)
+    {
+        SAFE_RELEASE(_keyTimeTracks[i]);
+    }
+    _keyTimeTracks.clear();
 }
 
 const char* Bundle::getIdFromOffset() const
@@ -275,12 +432,13 @@ const char* Bundle::getIdFromOffset(unsigned int offset) const
     if (offset > 0)
     {
         GP_ASSERT(_references);
-        for (unsigned int i = 0; i < _referenceCount; ++i)
+        // Refs without an id do not name the object at their offset.
+        indexReferences<ReferenceOffsetLess>(_referencesByOffset);
+        std::vector<Reference*>::const_iterator itr = std::lower_bound(_referencesByOffset.begin(), _referencesByOffset.end(), offset, ReferenceOffsetLess());
+        for (; itr != _referencesByOffset.end() && (*itr)->offset == offset; ++itr)
         {
-            if (_references[i].offset == offset && _references[i].id.length() > 0)
-            {
-                return _references[i].id.c_str();
-            }
+            if ((*itr)->id.length() > 0)
+                return (*itr)->id.c_str();
         }
     }
     return NULL;
@@ -317,23 +475,37 @@ Bundle::Reference* Bundle::seekToFirstType(unsigned int type)
     GP_ASSERT(_references);
     GP_ASSERT(_stream);
 
-    for (unsigned int i = 0; i < _referenceCount; ++i)
+    indexReferences<ReferenceTypeLess>(_referencesByType);
+    std::vector<Reference*>::const_iterator itr = std::lower_bound(_referencesByType.begin(), _referencesByType.end(), type, ReferenceTypeLess());
+    if (itr != _referencesByType.end() && (*itr)->type == type)
     {
-        Reference* ref = &_references[i];
-        if (ref->type == type)
+        // Found a match.
+        Reference* ref = *itr;
+        if (_stream->seek(ref->offset, SEEK_SET) == false)
         {
-            // Found a match.
-            if (_stream->seek(ref->offset, SEEK_SET) == false)
-            {
-                GP_ERROR("Failed to seek to object '%s' in bundle '%s'.", ref->id.c_str(), _path.c_str());
-                return NULL;
-            }
-            return ref;
+            GP_ERROR("Failed to seek to object '%s' in bundle '%s'.", ref->id.c_str(), _path.c_str());
+            return NULL;
         }
+        return ref;
     }
     return NULL;
 }
 
+template <class Less>
+void Bundle::indexReferences(std::vector<Reference*>& index) const
+{
+    if (!index.empty())
+        return;
+
+    // The sort is stable, so the first ref wins where ids, offsets or types repeat.
+    index.resize(_referenceCount);
+    for (unsigned int i = 0; i < _referenceCount; ++i)
+    {
+        index[i] = &_references[i];
+    }
+    std::stable_sort(index.begin(), index.end(), Less());
+}
+
 bool Bundle::read(unsigned int* ptr)
 {
     return _stream->read(ptr, sizeof(unsigned int), 1) == 1;
@@ -356,6 +528,8 @@ bool Bundle::readMatrix(float* m)
 
 Scene* Bundle::loadScene(const char* id)
 {
+    GP_PROFILE_SCOPE("Bundle::loadScene");
+
     clearLoadSession();
 
     Reference* ref = NULL;
@@ -464,6 +638,8 @@ Node* Bundle::loadNode(const char* id)
 
 Node* Bundle::loadNode(const char* id, Scene* sceneContext)
 {
+    GP_PROFILE_SCOPE("Bundle::loadNode");
+
     GP_ASSERT(id);
     GP_ASSERT(_references);
     GP_ASSERT(_stream);
@@ -511,6 +687,12 @@ Node* Bundle::loadNode(const char* id, Scene* sceneContext)
                     return NULL;
                 }
 
+                if (!readKeyTimeTracks(id.c_str()))
+                {
+                    SAFE_DELETE(_trackedNodes);
+                    return NULL;
+                }
+
                 Animation* animation = NULL;
                 for (unsigned int k = 0; k < animationChannelCount; k++)
                 {
@@ -957,6 +1139,7 @@ Model* Bundle::readModel(const char* nodeId)
                 if (skin)
                 {
                     model->setSkin(skin);
+                    loadSkinVertices(xref.c_str() + 1, model);
                 }
             }
             // Read material.
@@ -1176,6 +1359,9 @@ void Bundle::readAnimation(Scene* scene)
         return;
     }
 
+    if (!readKeyTimeTracks(animationId.c_str()))
+        return;
+
     Animation* animation = NULL;
     for (unsigned int i = 0; i < animationChannelCount; i++)
     {
@@ -1239,11 +1425,86 @@ Animation* Bundle::readAnimationChannelData(Animation* animation, const char* id
 {
     GP_ASSERT(id);
 
-    std::vector<unsigned int> keyTimes;
-    std::vector<float> values;
-    std::vector<float> tangentsIn;
-    std::vector<float> tangentsOut;
-    std::vector<unsigned int> interpolation;
+    // Only the duration of a channel is read when its curve is loaded on demand.
+    long position = _stream->position();
+    bool deferred = __animationLoadingDeferred && targetAttribute > 0;
+    Curve* curve = NULL;
+    unsigned long duration = 0;
+    if (!readAnimationCurve(id, target, targetAttribute, (targetAttribute > 0 && !deferred) ? &curve : NULL, &duration))
+        return NULL;
+
+    if (targetAttribute > 0)
+    {
+        GP_ASSERT(target);
+        Animation::Channel* channel;
+        if (animation == NULL)
+        {
+            // Release the animation because a newly created animation has a ref count of 1 and the channels hold the ref to animation.
+            animation = new Animation(id);
+            channel = animation->createChannel(target, targetAttribute, curve, duration);
+            animation->release();
+        }
+        else
+        {
+            channel = animation->createChannel(target, targetAttribute, curve, duration);
+        }
+        SAFE_RELEASE(curve);
+
+        if (deferred)
+            animation->deferCurve(this, _keyTimeTracksPosition, channel, position);
+    }
+
+    return animation;
+}
+
+bool Bundle::readAnimationCurves(Animation* animation)
+{
+    GP_ASSERT(animation);
+    GP_ASSERT(_stream);
+
+    // Read the key time tracks of the animation, then the key data of each channel.
+    long position = _stream->position();
+    bool result = _stream->seek(animation->_bundlePosition, SEEK_SET) && readKeyTimeTracks(animation->_id.c_str());
+    for (size_t i = 0, count = animation->_bundleChannels.size(); i < count && result; i++)
+    {
+        Animation::Channel* channel = animation->_bundleChannels[i].first;
+        Curve* curve = NULL;
+        unsigned long duration;
+        result = _stream->seek(animation->_bundleChannels[i].second, SEEK_SET) &&
+            readAnimationCurve(animation->_id.c_str(), channel->_target, channel->_propertyId, &curve, &duration) && curve;
+        if (result)
+            animation->setChannelCurve(channel, curve);
+        SAFE_RELEASE(curve);
+    }
+    clearKeyTimeTracks();
+
+    if (_stream->seek(position, SEEK_SET) == false)
+    {
+        GP_ERROR("Failed to seek back to position %ld in bundle '%s'.", position, _path.c_str());
+        return false;
+    }
+    return result;
+}
+
+bool Bundle::readAnimationCurve(const char* id, AnimationTarget* target, unsigned int targetAttribute, Curve** curve, unsigned long* duration)
+{
+    GP_ASSERT(id);
+    GP_ASSERT(duration);
+
+    if (_version[1] >= BUNDLE_VERSION_MINOR_COMPRESSED_ANIMATIONS)
+        return readCompressedAnimationCurve(id, target, targetAttribute, curve, duration);
+
+    // Key data is used in place when the bundle is memory mapped; the vectors only hold copies otherwise.
+    std::vector<unsigned int> keyTimesBuffer;
+    std::vector<float> valuesBuffer;
+    std::vector<float> tangentsInBuffer;
+    std::vector<float> tangentsOutBuffer;
+    std::vector<unsigned int> interpolationBuffer;
+    const unsigned int* keyTimes;
+    const float* values;
+    const float* tangentsIn;
+    const float* tangentsOut;
+    const unsigned int* interpolation;
 
     // Length of the arrays.
     unsigned int keyTimesCount;
@@ -1253,56 +1514,201 @@ Animation* Bundle::readAnimationChannelData(Animation* animation, const char* id
     unsigned int interpolationCount;
 
     // Read key times.
-    if (!readArray(&keyTimesCount, &keyTimes, sizeof(unsigned int)))
+    if (!readArray(&keyTimesCount, &keyTimesBuffer, &keyTimes))
     {
         GP_ERROR("Failed to read key times for animation '%s'.", id);
-        return NULL;
+        return false;
+    }
+    *duration = keyTimesCount > 0 ? keyTimes[keyTimesCount - 1] - keyTimes[0] : 0;
+
+    if (curve == NULL)
+    {
+        // Skip the key values, tangents and interpolations.
+        if (!skipArray<float>(&valuesCount) || !skipArray<float>(&tangentsInCount) || !skipArray<float>(&tangentsOutCount) ||
+            !skipArray<unsigned int>(&interpolationCount))
+        {
+            GP_ERROR("Failed to skip the key data for animation '%s'.", id);
+            return false;
+        }
+        return true;
     }
 
     // Read key values.
-    if (!readArray(&valuesCount, &values))
+    if (!readArray(&valuesCount, &valuesBuffer, &values))
     {
         GP_ERROR("Failed to read key values for animation '%s'.", id);
-        return NULL;
+        return false;
     }
 
     // Read in-tangents.
-    if (!readArray(&tangentsInCount, &tangentsIn))
+    if (!readArray(&tangentsInCount, &tangentsInBuffer, &tangentsIn))
     {
         GP_ERROR("Failed to read in tangents for animation '%s'.", id);
-        return NULL;
+        return false;
     }
 
     // Read out-tangents.
-    if (!readArray(&tangentsOutCount, &tangentsOut))
+    if (!readArray(&tangentsOutCount, &tangentsOutBuffer, &tangentsOut))
     {
         GP_ERROR("Failed to read out tangents for animation '%s'.", id);
-        return NULL;
+        return false;
     }
 
     // Read interpolations.
-    if (!readArray(&interpolationCount, &interpolation, sizeof(unsigned int)))
+    if (!readArray(&interpolationCount, &interpolationBuffer, &interpolation))
     {
         GP_ERROR("Failed to read the interpolation values for animation '%s'.", id);
-        return NULL;
+        return false;
     }
 
+    *curve = NULL;
     if (targetAttribute > 0)
     {
         GP_ASSERT(target);
-        GP_ASSERT(keyTimes.size() > 0 && values.size() > 0);
-        if (animation == NULL)
+        GP_ASSERT(keyTimes && values);
+        // TODO: This code currently assumes LINEAR only.
+        *curve = Animation::createCurve(target, targetAttribute, keyTimesCount, (unsigned int*)keyTimes, (float*)values, Curve::LINEAR);
+    }
+
+    return true;
+}
+
+bool Bundle::readKeyTimeTracks(const char* id)
+{
+    GP_ASSERT(id);
+
+    clearKeyTimeTracks();
+    _keyTimeTracksPosition = _stream->position();
+    if (_version[1] < BUNDLE_VERSION_MINOR_COMPRESSED_ANIMATIONS)
+        return true;
+
+    unsigned int trackCount;
+    if (!read(&trackCount))
+    {
+        GP_ERROR("Failed to read the number of key time tracks for animation '%s'.", id);
+        return false;
+    }
+
+    for (unsigned int i = 0; i < trackCount; i++)
+    {
+        std::vector<unsigned int> keyTimesBuffer;
+        const unsigned int* keyTimes;
+        unsigned int keyTimesCount;
+        if (!readArray(&keyTimesCount, &keyTimesBuffer, &keyTimes) || keyTimesCount == 0)
+        {
+            GP_ERROR("Failed to read key time track %u for animation '%s'.", i, id);
+            return false;
+        }
+        _keyTimeTracks.push_back(Curve::KeyTimes::create(keyTimesCount, keyTimes));
+    }
+    return true;
+}
+
+bool Bundle::readCompressedAnimationCurve(const char* id, AnimationTarget* target, unsigned int targetAttribute, Curve** curve, unsigned long* duration)
+{
+    GP_ASSERT(id);
+    GP_ASSERT(duration);
+
+    // Read the key time track and the layout of the components.
+    unsigned int track;
+    unsigned int componentCount;
+    unsigned int quaternionOffset;
+    if (!read(&track) || !read(&componentCount) || !read(&quaternionOffset))
+    {
+        GP_ERROR("Failed to read the channel layout for animation '%s'.", id);
+        return false;
+    }
+    if (track >= _keyTimeTracks.size() || componentCount == 0)
+    {
+        GP_ERROR("Invalid channel layout for animation '%s'.", id);
+        return false;
+    }
+    if (targetAttribute > 0)
+    {
+        GP_ASSERT(target);
+        if (componentCount != target->getAnimationPropertyComponentCount(targetAttribute))
+        {
+            GP_ERROR("Invalid component count (%u) for target attribute %u of animation '%s'.", componentCount, targetAttribute, id);
+            return false;
+        }
+    }
+
+    // Read the encoding of each component, with the constant value or the range of each component.
+    std::vector<unsigned char> encodings(componentCount, Curve::CONSTANT);
+    std::vector<float> constants(componentCount, 0.0f);
+    std::vector<float> steps(componentCount, 0.0f);
+    unsigned int stride = 0;
+    for (unsigned int i = 0; i < componentCount; )
+    {
+        unsigned int size = (i == quaternionOffset) ? 4 : 1;
+        unsigned char encoding;
+        if (i + size > componentCount || !read(&encoding))
+        {
+            GP_ERROR("Failed to read the encoding of component %u for animation '%s'.", i, id);
+            return false;
+        }
+
+        if (encoding == Curve::CONSTANT)
+        {
+            if (_stream->read(&constants[i], sizeof(float), size) != size)
+            {
+                GP_ERROR("Failed to read the constant value of component %u for animation '%s'.", i, id);
+                return false;
+            }
+        }
+        else if (encoding == Curve::QUANTIZED && size == 1)
         {
-            // TODO: This code currently assumes LINEAR only.
-            animation = target->createAnimation(id, targetAttribute, keyTimesCount, &keyTimes[0], &values[0], Curve::LINEAR);
+            if (!read(&constants[i]) || !read(&steps[i]))
+            {
+                GP_ERROR("Failed to read the range of component %u for animation '%s'.", i, id);
+                return false;
+            }
+            encodings[i] = Curve::QUANTIZED;
+            stride++;
+        }
+        else if (encoding == Curve::QUATERNION && size == 4)
+        {
+            for (unsigned int j = 0; j < 4; j++)
+            {
+                encodings[i + j] = Curve::QUATERNION;
+            }
+            stride += 3;
         }
         else
         {
-            animation->createChannel(target, targetAttribute, keyTimesCount, &keyTimes[0], &values[0], Curve::LINEAR);
+            GP_ERROR("Invalid encoding (%u) of component %u for animation '%s'.", (unsigned int)encoding, i, id);
+            return false;
         }
+        i += size;
     }
 
-    return animation;
+    // Read the quantized values of all points.
+    Curve::KeyTimes* keyTimes = _keyTimeTracks[track];
+    *duration = keyTimes->duration;
+    unsigned int valuesCount;
+    if (curve == NULL)
+    {
+        if (!skipArray<unsigned short>(&valuesCount) || valuesCount != stride * keyTimes->count)
+        {
+            GP_ERROR("Failed to skip quantized values for animation '%s'.", id);
+            return false;
+        }
+        return true;
+    }
+
+    std::vector<unsigned short> valuesBuffer;
+    const unsigned short* values;
+    if (!readArray(&valuesCount, &valuesBuffer, &values) || valuesCount != stride * keyTimes->count)
+    {
+        GP_ERROR("Failed to read quantized values for animation '%s'.", id);
+        return false;
+    }
+
+    *curve = NULL;
+    if (targetAttribute > 0)
+        *curve = Curve::createCompressed(keyTimes, componentCount, &encodings[0], &constants[0], &steps[0], values, stride);
+
+    return true;
 }
 
 Mesh* Bundle::loadMesh(const char* id)
@@ -1312,9 +1718,20 @@ Mesh* Bundle::loadMesh(const char* id)
 
 Mesh* Bundle::loadMesh(const char* id, const char* nodeId)
 {
+    GP_PROFILE_SCOPE("Bundle::loadMesh");
+
     GP_ASSERT(_stream);
     GP_ASSERT(id);
 
+    // Use a mesh that an asynchronous load has already created.
+    std::map<std::string, Mesh*>::iterator itr = _preloadedMeshes.find(id);
+    if (itr != _preloadedMeshes.end())
+    {
+        Mesh* mesh = itr->second;
+        _preloadedMeshes.erase(itr);
+        return mesh;
+    }
+
     // Save the file position.
     long position = _stream->position();
     if (position == -1L)
@@ -1332,19 +1749,106 @@ Mesh* Bundle::loadMesh(const char* id, const char* nodeId)
     }
 
     // Read mesh data.
-    MeshData* meshData = readMeshData();
+    MeshData* meshData = readMeshData(true);
     if (meshData == NULL)
     {
         GP_ERROR("Failed to load mesh data for mesh '%s'.", id);
         return NULL;
     }
 
+    Mesh* mesh = createMesh(id, meshData);
+    SAFE_DELETE(meshData);
+    if (mesh == NULL)
+    {
+        return NULL;
+    }
+
+    // Restore file pointer.
+    if (_stream->seek(position, SEEK_SET) == false)
+    {
+        GP_ERROR("Failed to restore file pointer after loading mesh '%s'.", id);
+        SAFE_RELEASE(mesh);
+        return NULL;
+    }
+
+    return mesh;
+}
+
+void Bundle::loadSkinVertices(const char* meshId, Model* model)
+{
+    GP_ASSERT(meshId);
+    GP_ASSERT(model && model->getSkin());
+
+    // Save the file position.
+    long position = _stream->position();
+    if (position == -1L)
+    {
+        GP_ERROR("Failed to save the current file position before loading vertices of skinned mesh '%s'.", meshId);
+        return;
+    }
+
+    // The mesh data is read again, since the mesh may have been created ahead of loading
+    // the scene. It points into the mapping when the bundle is memory mapped.
+    MeshData* meshData = NULL;
+    if (seekTo(meshId, BUNDLE_TYPE_MESH))
+    {
+        meshData = readMeshData(true);
+    }
+    if (meshData)
+    {
+        MeshSkin* skin = model->getSkin();
+        SkinDeformer* deformer = SkinDeformer::create(meshData->vertexFormat, (const float*)meshData->vertexData, meshData->vertexCount);
+        if (deformer && deformer->getJointCount() <= skin->getJointCount())
+        {
+            std::vector<BoundingBox> jointBounds(deformer->getJointCount());
+            if (!jointBounds.empty())
+            {
+                deformer->computeJointBounds(&jointBounds[0]);
+                skin->setJointBounds(&jointBounds[0], (unsigned int)jointBounds.size());
+            }
+
+            // Skins with too many joints for the vertex shader are skinned on the CPU into a dynamic mesh.
+            unsigned int maxJointCount = MeshSkin::getMaxPaletteJointCount();
+            if (maxJointCount > 0 && skin->getJointCount() > maxJointCount)
+            {
+                Mesh* mesh = createMesh(meshId, meshData, true);
+                if (mesh)
+                {
+                    SAFE_RELEASE(model->_mesh);
+                    model->_mesh = mesh;
+                    model->setSkinDeformer(deformer);
+                }
+            }
+        }
+        else if (deformer)
+        {
+            GP_WARN("The vertices of skinned mesh '%s' refer to more joints than its skin has.", meshId);
+        }
+        SAFE_RELEASE(deformer);
+        SAFE_DELETE(meshData);
+    }
+    else
+    {
+        GP_ERROR("Failed to load vertices of skinned mesh '%s'.", meshId);
+    }
+
+    // Restore the file position.
+    if (_stream->seek(position, SEEK_SET) == false)
+    {
+        GP_ERROR("Failed to restore file pointer after loading vertices of skinned mesh '%s'.", meshId);
+    }
+}
+
+Mesh* Bundle::createMesh(const char* id, MeshData* meshData, bool dynamic)
+{
+    GP_ASSERT(id);
+    GP_ASSERT(meshData);
+
     // Create mesh.
-    Mesh* mesh = Mesh::createMesh(meshData->vertexFormat, meshData->vertexCount, false);
+    Mesh* mesh = Mesh::createMesh(meshData->vertexFormat, meshData->vertexCount, dynamic);
     if (mesh == NULL)
     {
         GP_ERROR("Failed to create mesh '%s'.", id);
-        SAFE_DELETE_ARRAY(meshData);
         return NULL;
     }
 
@@ -1367,25 +1871,25 @@ Mesh* Bundle::loadMesh(const char* id, const char* nodeId)
         if (part == NULL)
         {
             GP_ERROR("Failed to create mesh part (with index %d) for mesh '%s'.", i, id);
-            SAFE_DELETE(meshData);
+            SAFE_RELEASE(mesh);
             return NULL;
         }
         part->setIndexData(partData->indexData, 0, partData->indexCount);
     }
 
-    SAFE_DELETE(meshData);
+    return mesh;
+}
 
-    // Restore file pointer.
-    if (_stream->seek(position, SEEK_SET) == false)
+void Bundle::clearPreloadedMeshes()
+{
+    for (std::map<std::string, Mesh*>::iterator itr = _preloadedMeshes.begin(); itr != _preloadedMeshes.end(); ++itr)
     {
-        GP_ERROR("Failed to restore file pointer after loading mesh '%s'.", id);
-        return NULL;
+        SAFE_RELEASE(itr->second);
     }
-
-    return mesh;
+    _preloadedMeshes.clear();
 }
 
-Bundle::MeshData* Bundle::readMeshData()
+Bundle::MeshData* Bundle::readMeshData(bool mapData)
 {
     // Read vertex format/elements.
     unsigned int vertexElementCount;
@@ -1441,8 +1945,8 @@ Bundle::MeshData* Bundle::readMeshData()
 
     GP_ASSERT(meshData->vertexFormat.getVertexSize());
     meshData->vertexCount = vertexByteCount / meshData->vertexFormat.getVertexSize();
-    meshData->vertexData = new unsigned char[vertexByteCount];
-    if (_stream->read(meshData->vertexData, 1, vertexByteCount) != vertexByteCount)
+    meshData->vertexData = readData(vertexByteCount, mapData, &meshData->mapped);
+    if (meshData->vertexData == NULL)
     {
         GP_ERROR("Failed to load vertex data.");
         SAFE_DELETE(meshData);
@@ -1520,8 +2024,8 @@ Bundle::MeshData* Bundle::readMeshData()
         GP_ASSERT(indexSize);
         partData->indexCount = iByteCount / indexSize;
 
-        partData->indexData = new unsigned char[iByteCount];
-        if (_stream->read(partData->indexData, 1, iByteCount) != iByteCount)
+        partData->indexData = readData(iByteCount, mapData, &partData->mapped);
+        if (partData->indexData == NULL)
         {
             GP_ERROR("Failed to read index data for mesh part with index %d.", i);
             SAFE_DELETE(meshData);
@@ -1572,7 +2076,8 @@ Bundle::MeshData* Bundle::readMeshData(const char* url)
     }
 
     // Read mesh data from current file position.
-    MeshData* meshData = bundle->readMeshData();
+    // The mesh data outlives the bundle, so it must not point into the mapping.
+    MeshData* meshData = bundle->readMeshData(false);
 
     SAFE_RELEASE(bundle);
 
@@ -1581,6 +2086,8 @@ Bundle::MeshData* Bundle::readMeshData(const char* url)
 
 Font* Bundle::loadFont(const char* id)
 {
+    GP_PROFILE_SCOPE("Bundle::loadFont");
+
     GP_ASSERT(id);
     GP_ASSERT(_stream);
 
@@ -1744,24 +2251,60 @@ Bundle::Reference::~Reference()
 {
 }
 
+bool Bundle::ReferenceIdLess::operator()(const Reference* r1, const Reference* r2) const
+{
+    return r1->id < r2->id;
+}
+
+bool Bundle::ReferenceIdLess::operator()(const Reference* ref, const char* id) const
+{
+    return ref->id.compare(id) < 0;
+}
+
+bool Bundle::ReferenceOffsetLess::operator()(const Reference* r1, const Reference* r2) const
+{
+    return r1->offset < r2->offset;
+}
+
+bool Bundle::ReferenceOffsetLess::operator()(const Reference* ref, unsigned int offset) const
+{
+    return ref->offset < offset;
+}
+
+bool Bundle::ReferenceTypeLess::operator()(const Reference* r1, const Reference* r2) const
+{
+    return r1->type < r2->type;
+}
+
+bool Bundle::ReferenceTypeLess::operator()(const Reference* ref, unsigned int type) const
+{
+    return ref->type < type;
+}
+
 Bundle::MeshPartData::MeshPartData() :
-    indexCount(0), indexData(NULL)
+    indexCount(0), indexData(NULL), mapped(false)
 {
 }
 
 Bundle::MeshPartData::~MeshPartData()
 {
-    SAFE_DELETE_ARRAY(indexData);
+    if (!mapped)
+    {
+        SAFE_DELETE_ARRAY(indexData);
+    }
 }
 
 Bundle::MeshData::MeshData(const VertexFormat& vertexFormat)
-    : vertexFormat(vertexFormat), vertexCount(0), vertexData(NULL)
+    : vertexFormat(vertexFormat), vertexCount(0), vertexData(NULL), mapped(false)
 {
 }
 
 Bundle::MeshData::~MeshData()
 {
-    SAFE_DELETE_ARRAY(vertexData);
+    if (!mapped)
+    {
+        SAFE_DELETE_ARRAY(vertexData);
+    }
 
     for (unsigned int i = 0; i < parts.size(); ++i)
     {
@@ -5,6 +5,7 @@
 #include "Font.h"
 #include "Node.h"
 #include "Game.h"
+#include "AsyncLoad.h"
 
 namespace gameplay
 {
@@ -16,7 +17,9 @@ namespace gameplay
 class Bundle : public Ref
 {
     friend class PhysicsController;
+    friend class Animation;
     friend class SceneLoader;
+    friend class SceneAsyncLoad;
 
 public:
 
@@ -33,6 +36,53 @@ public:
      */
     static Bundle* create(const char* path);
 
+    /**
+     * Sets whether bundles are memory mapped when they are opened.
+     *
+     * Mesh vertex and index data and animation key data are then read straight from
+     * the mapping instead of being copied into temporary arrays first, which reduces
+     * both the load time and the peak memory use for large bundles. Platforms that
+     * cannot map a bundle fall back to reading it. Memory mapping is enabled by default
+     * and only affects bundles that are opened afterwards.
+     *
+     * @param enabled true to memory map bundles, false to read them.
+     * @script{ignore}
+     */
+    static void setMappingEnabled(bool enabled);
+
+    /**
+     * Determines if bundles are memory mapped when they are opened.
+     *
+     * @return true if bundles are memory mapped, false otherwise.
+     * @script{ignore}
+     */
+    static bool isMappingEnabled();
+
+    /**
+     * Sets whether the curves of animations are loaded when they are first needed, instead
+     * of when a scene or node is loaded.
+     *
+     * The channels of an animation are created when it is loaded, but their key data stays
+     * in the bundle until a clip of the animation is played, the animation is cloned or
+     * Animation::prefetch is called. The animation keeps the bundle open until it is destroyed,
+     * and AnimationController::evictAnimations can unload the curves of animations that are
+     * no longer played. Deferred loading is enabled by default and only affects animations
+     * that are loaded afterwards.
+     *
+     * @param deferred true to load the curves of animations when they are needed, false to
+     *      load them with the scene or node.
+     * @script{ignore}
+     */
+    static void setAnimationLoadingDeferred(bool deferred);
+
+    /**
+     * Determines if the curves of animations are loaded when they are first needed.
+     *
+     * @return true if loading the curves of animations is deferred, false otherwise.
+     * @script{ignore}
+     */
+    static bool isAnimationLoadingDeferred();
+
     /**
      * Loads the scene with the specified ID from the bundle.
      * If id is NULL then the first scene found is loaded.
@@ -44,6 +94,24 @@ public:
      */
     Scene* loadScene(const char* id = NULL);
 
+    /**
+     * Starts loading the scene with the specified ID from the bundle at the given path
+     * in the background.
+     *
+     * The bundle is opened and its mesh data is read on a background thread. The
+     * meshes are then created on the game thread within the frame budget of
+     * asynchronous loads, after which the scene is built.
+     *
+     * @param path The path of the bundle.
+     * @param id The ID of the scene to load (NULL to load the first scene).
+     *
+     * @return A handle to poll for the loaded scene. The handle must be released when
+     *      no longer needed.
+     * @see AsyncLoad
+     * @script{ignore}
+     */
+    static AsyncLoad* loadSceneAsync(const char* path, const char* id = NULL);
+
     /**
      * Loads a node with the specified ID from the bundle.
      *
@@ -117,6 +185,54 @@ private:
         ~Reference();
     };
 
+    /**
+     * Orders refs by id, for the binary search of the id index.
+     */
+    struct ReferenceIdLess
+    {
+        /**
+         * Compares the ids of two refs.
+         */
+        bool operator()(const Reference* r1, const Reference* r2) const;
+
+        /**
+         * Compares the id of a ref with the given id.
+         */
+        bool operator()(const Reference* ref, const char* id) const;
+    };
+
+    /**
+     * Orders refs by offset, for the binary search of the offset index.
+     */
+    struct ReferenceOffsetLess
+    {
+        /**
+         * Compares the offsets of two refs.
+         */
+        bool operator()(const Reference* r1, const Reference* r2) const;
+
+        /**
+         * Compares the offset of a ref with the given offset.
+         */
+        bool operator()(const Reference* ref, unsigned int offset) const;
+    };
+
+    /**
+     * Orders refs by type, for the binary search of the type index.
+     */
+    struct ReferenceTypeLess
+    {
+        /**
+         * Compares the types of two refs.
+         */
+        bool operator()(const Reference* r1, const Reference* r2) const;
+
+        /**
+         * Compares the type of a ref with the given type.
+         */
+        bool operator()(const Reference* ref, unsigned int type) const;
+    };
+
     struct MeshSkinData
     {
         MeshSkin* skin;
@@ -133,6 +249,7 @@ private:
         Mesh::IndexFormat indexFormat;
         unsigned int indexCount;
         unsigned char* indexData;
+        bool mapped;
     };
 
     struct MeshData
@@ -143,6 +260,7 @@ private:
         VertexFormat vertexFormat;
         unsigned int vertexCount;
         unsigned char* vertexData;
+        bool mapped;
         BoundingBox boundingBox;
         BoundingSphere boundingSphere;
         Mesh::PrimitiveType primitiveType;
@@ -161,6 +279,23 @@ private:
      */
     Bundle& operator=(const Bundle&);
 
+    /**
+     * Opens the bundle at the given path without looking it up in or adding it to the cache.
+     */
+    static Bundle* open(const char* path);
+
+    /**
+     * Adds the given bundle to the cache, unless a bundle with the same path is already cached.
+     *
+     * @return The cached bundle, with its reference count incremented.
+     */
+    static Bundle* cache(Bundle* bundle);
+
+    /**
+     * Determines if the given reference is a mesh.
+     */
+    static bool isMesh(const Reference* ref);
+
     /**
      * Finds a reference by ID.
      */
@@ -291,6 +426,42 @@ private:
      */
     template <class T>
     bool readArray(unsigned int* length, std::vector<T>* values, unsigned int readSize);
+
+    /**
+     * Reads an array of values and the array length from the current file position,
+     * without copying the values if the bundle is memory mapped.
+     * 
+     * @param length A pointer to where the length of the array will be copied to.
+     * @param values A pointer to the vector to copy the values to if they cannot be mapped.
+     * @param data Set to the values, which point either into the mapping or into the vector.
+     * 
+     * @return True if successful, false if an error occurred.
+     */
+    template <class T>
+    bool readArray(unsigned int* length, std::vector<T>* values, const T** data);
+
+    /**
+     * Skips over an array of values at the current file position.
+     * 
+     * @param length A pointer to where the length of the array will be copied to.
+     * 
+     * @return True if successful, false if an error occurred.
+     */
+    template <class T>
+    bool skipArray(unsigned int* length);
+
+    /**
+     * Reads a block of bytes from the current file position.
+     * 
+     * @param size The number of bytes to read.
+     * @param mapData true to return a pointer into the mapping if the bundle is memory mapped.
+     * @param mapped Set to true if the returned pointer points into the mapping, in which case
+     *      it must not be deleted.
+     * 
+     * @return The bytes, or NULL if an error occurred. Unless mapped, the array is allocated
+     *      with new[] and must be deleted by the caller.
+     */
+    unsigned char* readData(unsigned int size, bool mapData, bool* mapped);
     
     /**
      * Reads 16 floats from the current file position.
@@ -339,10 +510,36 @@ private:
      */
     Model* readModel(const char* nodeId);
 
+    /**
+     * Sets the joint bounds of the skin of a model from the vertices of its mesh, and sets
+     * up skinning on the CPU when the skin has too many joints for the vertex shader.
+     *
+     * @param meshId The ID of the mesh of the model.
+     * @param model The model.
+     */
+    void loadSkinVertices(const char* meshId, Model* model);
+
+    /**
+     * Creates a mesh from the given mesh data.
+     *
+     * @param id The ID of the mesh.
+     * @param meshData The mesh data.
+     * @param dynamic true if the vertices of the mesh are updated every frame.
+     */
+    Mesh* createMesh(const char* id, MeshData* meshData, bool dynamic = false);
+
+    /**
+     * Releases the meshes that were created ahead of loading the scene but not used by it.
+     */
+    void clearPreloadedMeshes();
+
     /**
      * Reads mesh data from the current file position.
+     *
+     * @param mapData true to point the vertex and index data into the mapping if the bundle
+     *      is memory mapped, in which case the mesh data must not outlive the bundle.
      */
-    MeshData* readMeshData();
+    MeshData* readMeshData(bool mapData);
 
     /**
      * Reads mesh data for the specified URL.
@@ -404,6 +601,51 @@ private:
      */
     Animation* readAnimationChannelData(Animation* animation, const char* id, AnimationTarget* target, unsigned int targetAttribute);
 
+    /**
+     * Reads the curve of an animation channel at the current file position.
+     *
+     * @param id The ID of the animation.
+     * @param target The animation target, or NULL if the channel is skipped.
+     * @param targetAttribute The target attribute being animated, or 0 if the channel is skipped.
+     * @param curve Set to the new curve, or NULL to skip over the key data of the channel.
+     * @param duration Set to the duration of the channel.
+     *
+     * @return True if the channel was read; false otherwise.
+     */
+    bool readAnimationCurve(const char* id, AnimationTarget* target, unsigned int targetAttribute, Curve** curve, unsigned long* duration);
+
+    /**
+     * Reads the curves of the channels of an animation whose loading was deferred.
+     *
+     * The file position is restored afterwards.
+     *
+     * @param animation The animation.
+     *
+     * @return True if the curves were read; false otherwise.
+     */
+    bool readAnimationCurves(Animation* animation);
+
+    /**
+     * Reads the key time tracks that are shared by the channels of an animation, if the
+     * bundle stores animations in compressed form.
+     *
+     * @param id The ID of the animation.
+     *
+     * @return True if the key time tracks were read; false otherwise.
+     */
+    bool readKeyTimeTracks(const char* id);
+
+    /**
+     * Reads the curve of a compressed animation channel at the current file position, as
+     * readAnimationCurve does for uncompressed data.
+     */
+    bool readCompressedAnimationCurve(const char* id, AnimationTarget* target, unsigned int targetAttribute, Curve** curve, unsigned long* duration);
+
+    /**
+     * Releases the key time tracks of the last animation that was read.
+     */
+    void clearKeyTimeTracks();
+
     /**
      * Sets the transformation matrix.
      *
@@ -426,13 +668,28 @@ private:
      */
     bool skipNode();
 
+    /**
+     * Builds an index of the ref table on its first use, by sorting the refs with the given order.
+     *
+     * @param index The index to build, if it is empty.
+     */
+    template <class Less>
+    void indexReferences(std::vector<Reference*>& index) const;
+
     std::string _path;
     unsigned int _referenceCount;
     Reference* _references;
+    mutable std::vector<Reference*> _referencesById;
+    mutable std::vector<Reference*> _referencesByOffset;
+    mutable std::vector<Reference*> _referencesByType;
     Stream* _stream;
+    unsigned char _version[2];
 
     std::vector<MeshSkinData*> _meshSkins;
     std::map<std::string, Node*>* _trackedNodes;
+    std::map<std::string, Mesh*> _preloadedMeshes;
+    std::vector<Curve::KeyTimes*> _keyTimeTracks;
+    long _keyTimeTracksPosition;
 };
 
 }
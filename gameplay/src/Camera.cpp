@@ -223,8 +223,18 @@ void Camera::setNode(Node* node)
     }
 }
 
+void Camera::resolveNode() const
+{
+    if (_node)
+    {
+        _node->getWorldMatrix();
+    }
+}
+
 const Matrix& Camera::getViewMatrix() const
 {
+    resolveNode();
+
     if (_dirtyBits & CAMERA_DIRTY_VIEW)
     {
         if (_node)
@@ -245,6 +255,8 @@ const Matrix& Camera::getViewMatrix() const
 
 const Matrix& Camera::getInverseViewMatrix() const
 {
+    resolveNode();
+
     if (_dirtyBits & CAMERA_DIRTY_INV_VIEW)
     {
         getViewMatrix().invert(&_inverseView);
@@ -276,6 +288,8 @@ const Matrix& Camera::getProjectionMatrix() const
 
 const Matrix& Camera::getViewProjectionMatrix() const
 {
+    resolveNode();
+
     if (_dirtyBits & CAMERA_DIRTY_VIEW_PROJ)
     {
         Matrix::multiply(getProjectionMatrix(), getViewMatrix(), &_viewProjection);
@@ -288,6 +302,8 @@ const Matrix& Camera::getViewProjectionMatrix() const
 
 const Matrix& Camera::getInverseViewProjectionMatrix() const
 {
+    resolveNode();
+
     if (_dirtyBits & CAMERA_DIRTY_INV_VIEW_PROJ)
     {
         getViewProjectionMatrix().invert(&_inverseViewProjection);
@@ -300,6 +316,8 @@ const Matrix& Camera::getInverseViewProjectionMatrix() const
 
 const Frustum& Camera::getFrustum() const
 {
+    resolveNode();
+
     if (_dirtyBits & CAMERA_DIRTY_BOUNDS)
     {
         // Update our bounding frustum from our view projection matrix.
@@ -287,6 +287,12 @@ private:
      */
     void setNode(Node* node);
 
+    /**
+     * Resolves the world matrix of our node, so that we are notified if the node moved
+     * with an ancestor in a scene that uses a flat transform hierarchy.
+     */
+    void resolveNode() const;
+
     Camera::Type _type;
     float _fieldOfView;
     float _zoom[2];
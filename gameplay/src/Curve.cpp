@@ -6,6 +6,11 @@
 #include <cmath>
 #include <memory>
 
+#if !defined(__ARM_NEON__) && (defined(__SSE__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 1))
+#include <xmmintrin.h>
+#define CURVE_USE_SSE
+#endif
+
 using std::memcpy;
 using std::fabs;
 using std::sqrt;
@@ -80,6 +85,72 @@ static inline float lerpInl(float s, float from, float to)
     return from + (to - from) * s;
 }
 
+// The largest number of components of a curve whose points are stored in compressed form.
+#define CURVE_MAX_COMPRESSED_COMPONENTS 16
+
+// The smallest three components of a normalized quaternion are between -1/sqrt(2) and 1/sqrt(2).
+#define CURVE_QUATERNION_MIN -0.707106781f
+#define CURVE_QUATERNION_STEP (1.414213562f / 32767.0f)
+
+/**
+ * Decodes a quaternion that is stored as its smallest three components in 15 bits each,
+ * with the index of the largest component in the high bits of the first two values.
+ */
+static inline void decodeQuaternion(const unsigned short* value, float* dst)
+{
+    unsigned int largest = ((value[0] >> 14) & 2) | (value[1] >> 15);
+    float a = CURVE_QUATERNION_MIN + (float)(value[0] & 0x7FFF) * CURVE_QUATERNION_STEP;
+    float b = CURVE_QUATERNION_MIN + (float)(value[1] & 0x7FFF) * CURVE_QUATERNION_STEP;
+    float c = CURVE_QUATERNION_MIN + (float)(value[2] & 0x7FFF) * CURVE_QUATERNION_STEP;
+    float d = 1.0f - a * a - b * b - c * c;
+    d = d > 0.0f ? sqrt(d) : 0.0f;
+
+    switch (largest)
+    {
+    case 0:
+        dst[0] = d; dst[1] = a; dst[2] = b; dst[3] = c;
+        break;
+    case 1:
+        dst[0] = a; dst[1] = d; dst[2] = b; dst[3] = c;
+        break;
+    case 2:
+        dst[0] = a; dst[1] = b; dst[2] = d; dst[3] = c;
+        break;
+    default:
+        dst[0] = a; dst[1] = b; dst[2] = c; dst[3] = d;
+        break;
+    }
+}
+
+/**
+ * Determines the index of the time at or before the given time, which must be between the
+ * first and last times, starting from the given index.
+ */
+static inline unsigned int determineTimeIndex(const float* times, unsigned int count, float time, unsigned int index)
+{
+    // Try the given time and the few times that follow it before searching all times.
+    if (index < count - 1 && time >= times[index])
+    {
+        for (unsigned int end = index + 4; index < count - 1 && index < end; ++index)
+        {
+            if (time <= times[index + 1])
+                return index;
+        }
+    }
+
+    unsigned int min = 0;
+    unsigned int max = count - 1;
+    while (max - min > 1)
+    {
+        unsigned int mid = (min + max) >> 1;
+        if (time >= times[mid])
+            min = mid;
+        else
+            max = mid;
+    }
+    return min;
+}
+
 namespace gameplay
 {
 
@@ -88,8 +159,14 @@ Curve* Curve::create(unsigned int pointCount, unsigned int componentCount)
     return new Curve(pointCount, componentCount);
 }
 
+Curve::Curve()
+    : _pointCount(0), _componentCount(0), _componentSize(0), _quaternionOffset(NULL), _points(NULL), _compressedPoints(NULL)
+{
+}
+
 Curve::Curve(unsigned int pointCount, unsigned int componentCount)
-    : _pointCount(pointCount), _componentCount(componentCount), _componentSize(sizeof(float)*componentCount), _quaternionOffset(NULL), _points(NULL)
+    : _pointCount(pointCount), _componentCount(componentCount), _componentSize(sizeof(float)*componentCount), _quaternionOffset(NULL), _points(NULL),
+      _compressedPoints(NULL)
 {
     _points = new Point[_pointCount];
     for (unsigned int i = 0; i < _pointCount; i++)
@@ -107,6 +184,82 @@ Curve::~Curve()
 {
     SAFE_DELETE_ARRAY(_points);
     SAFE_DELETE_ARRAY(_quaternionOffset);
+    SAFE_DELETE(_compressedPoints);
+}
+
+Curve* Curve::createCompressed(KeyTimes* keyTimes, unsigned int componentCount, const unsigned char* encodings,
+    const float* constants, const float* steps, const unsigned short* values, unsigned int stride)
+{
+    assert(keyTimes && keyTimes->count > 0 && componentCount > 0 && componentCount <= CURVE_MAX_COMPRESSED_COMPONENTS);
+    assert(encodings && constants && steps && (values || stride == 0));
+
+    Curve* curve = new Curve();
+    curve->_pointCount = keyTimes->count;
+    curve->_componentCount = componentCount;
+    curve->_componentSize = sizeof(float) * componentCount;
+
+    CompressedPoints* points = new CompressedPoints();
+    points->keyTimes = keyTimes;
+    keyTimes->addRef();
+    points->encodings = new unsigned char[componentCount];
+    memcpy(points->encodings, encodings, componentCount);
+    points->constants = new float[componentCount];
+    memcpy(points->constants, constants, curve->_componentSize);
+    points->steps = new float[componentCount];
+    memcpy(points->steps, steps, curve->_componentSize);
+    points->stride = stride;
+    if (stride > 0)
+    {
+        points->values = new unsigned short[stride * keyTimes->count];
+        memcpy(points->values, values, sizeof(unsigned short) * stride * keyTimes->count);
+    }
+    curve->_compressedPoints = points;
+
+    return curve;
+}
+
+Curve::KeyTimes::KeyTimes()
+    : count(0), times(NULL), duration(0)
+{
+}
+
+Curve::KeyTimes::~KeyTimes()
+{
+    SAFE_DELETE_ARRAY(times);
+}
+
+Curve::KeyTimes* Curve::KeyTimes::create(unsigned int count, const unsigned int* keyTimes)
+{
+    assert(count > 0 && keyTimes);
+
+    // Normalize the key times as Animation does for curves whose points are stored as floats.
+    KeyTimes* result = new KeyTimes();
+    result->count = count;
+    result->times = new float[count];
+    unsigned int lowest = keyTimes[0];
+    result->duration = keyTimes[count - 1] - lowest;
+    result->times[0] = 0.0f;
+    for (unsigned int i = 1; i < count - 1; i++)
+    {
+        result->times[i] = (float)(keyTimes[i] - lowest) / (float)result->duration;
+    }
+    result->times[count - 1] = 1.0f;
+    return result;
+}
+
+Curve::CompressedPoints::CompressedPoints()
+    : keyTimes(NULL), encodings(NULL), constants(NULL), steps(NULL), values(NULL), stride(0)
+{
+}
+
+Curve::CompressedPoints::~CompressedPoints()
+{
+    if (keyTimes)
+        keyTimes->release();
+    SAFE_DELETE_ARRAY(encodings);
+    SAFE_DELETE_ARRAY(constants);
+    SAFE_DELETE_ARRAY(steps);
+    SAFE_DELETE_ARRAY(values);
 }
 
 Curve::Point::Point()
@@ -133,11 +286,15 @@ unsigned int Curve::getComponentCount() const
 
 float Curve::getStartTime() const
 {
+    if (_compressedPoints)
+        return _compressedPoints->keyTimes->times[0];
     return _points[0].time;
 }
 
 float Curve::getEndTime() const
 {
+    if (_compressedPoints)
+        return _compressedPoints->keyTimes->times[_pointCount-1];
     return _points[_pointCount-1].time;
 }
 
@@ -149,6 +306,7 @@ void Curve::setPoint(unsigned int index, float time, float* value, Interpolation
 void Curve::setPoint(unsigned int index, float time, float* value, InterpolationType type, float* inValue, float* outValue)
 {
     assert(index < _pointCount && time >= 0.0f && time <= 1.0f && !(_pointCount > 1 && index == 0 && time != 0.0f) && !(_pointCount != 1 && index == _pointCount - 1 && time != 1.0f));
+    assert(!_compressedPoints);
 
     _points[index].time = time;
     _points[index].type = type;
@@ -165,7 +323,7 @@ void Curve::setPoint(unsigned int index, float time, float* value, Interpolation
 
 void Curve::setTangent(unsigned int index, InterpolationType type, float* inValue, float* outValue)
 {
-    assert(index < _pointCount);
+    assert(index < _pointCount && !_compressedPoints);
 
     _points[index].type = type;
 
@@ -177,24 +335,43 @@ void Curve::setTangent(unsigned int index, InterpolationType type, float* inValu
 }
 
 void Curve::evaluate(float time, float* dst) const
+{
+    evaluate(time, dst, NULL);
+}
+
+void Curve::evaluate(float time, float* dst, unsigned int* pointIndex) const
 {
     assert(dst && time >= 0 && time <= 1.0f);
 
+    if (_compressedPoints)
+    {
+        evaluateCompressed(time, dst, pointIndex);
+        return;
+    }
+
     // Check if the point count is 1.
     // Check if we are at or beyond the bounds of the curve.
     if (_pointCount == 1 || time <= _points[0].time)
     {
         memcpy(dst, _points[0].value, _componentSize);
+        if (pointIndex)
+            *pointIndex = 0;
         return;
     }
     else if (time >= _points[_pointCount - 1].time)
     {
         memcpy(dst, _points[_pointCount - 1].value, _componentSize);
+        if (pointIndex)
+            *pointIndex = _pointCount - 2;
         return;
     }
 
-    // Locate the points we are interpolating between using a binary search.
-    unsigned int index = determineIndex(time);
+    // Locate the points we are interpolating between, starting from the last points if given.
+    unsigned int index;
+    if (pointIndex)
+        index = *pointIndex = determineIndex(time, *pointIndex);
+    else
+        index = determineIndex(time);
     
     Point* from = _points + index;
     Point* to = _points + (index + 1);
@@ -1157,6 +1334,111 @@ void Curve::interpolateQuaternion(float s, float* from, float* to, float* dst) c
         Quaternion::slerp(to[0], to[1], to[2], to[3], from[0], from[1], from[2], from[3], s, dst, dst + 1, dst + 2, dst + 3);
 }
 
+void Curve::evaluateCompressed(float time, float* dst, unsigned int* pointIndex) const
+{
+    const CompressedPoints* points = _compressedPoints;
+    assert(points);
+
+    // Check if all components are constant, if the point count is 1, or if we are at or
+    // beyond the bounds of the curve.
+    const float* times = points->keyTimes->times;
+    if (points->stride == 0)
+    {
+        memcpy(dst, points->constants, _componentSize);
+        if (pointIndex)
+            *pointIndex = 0;
+        return;
+    }
+    else if (_pointCount == 1 || time <= times[0])
+    {
+        decodePoint(0, dst);
+        if (pointIndex)
+            *pointIndex = 0;
+        return;
+    }
+    else if (time >= times[_pointCount - 1])
+    {
+        decodePoint(_pointCount - 1, dst);
+        if (pointIndex)
+            *pointIndex = _pointCount - 2;
+        return;
+    }
+
+    // Locate and decode the points we are interpolating between.
+    unsigned int index = determineTimeIndex(times, _pointCount, time, pointIndex ? *pointIndex : 0);
+    if (pointIndex)
+        *pointIndex = index;
+
+    float from[CURVE_MAX_COMPRESSED_COMPONENTS];
+    float to[CURVE_MAX_COMPRESSED_COMPONENTS];
+    decodePoint(index, from);
+    decodePoint(index + 1, to);
+    float t = (time - times[index]) / (times[index + 1] - times[index]);
+
+    for (unsigned int i = 0; i < _componentCount; i++)
+    {
+        // Quaternions are stored with a positive largest component, so the two points may be
+        // on opposite sides of the hypersphere. Use the closer one to interpolate towards.
+        if (points->encodings[i] == QUATERNION)
+        {
+            if (from[i] * to[i] + from[i + 1] * to[i + 1] + from[i + 2] * to[i + 2] + from[i + 3] * to[i + 3] < 0.0f)
+            {
+                to[i] = -to[i];
+                to[i + 1] = -to[i + 1];
+                to[i + 2] = -to[i + 2];
+                to[i + 3] = -to[i + 3];
+            }
+            i += 3;
+        }
+    }
+
+    unsigned int quaternionOffset = _quaternionOffset ? *_quaternionOffset : _componentCount;
+    for (unsigned int i = 0; i < _componentCount; i++)
+    {
+        if (i == quaternionOffset)
+        {
+            interpolateQuaternion(t, from + i, to + i, dst + i);
+            i += 3;
+        }
+        else if (from[i] == to[i])
+        {
+            dst[i] = from[i];
+        }
+        else
+        {
+            dst[i] = lerpInl(t, from[i], to[i]);
+        }
+    }
+}
+
+void Curve::decodePoint(unsigned int index, float* dst) const
+{
+    const CompressedPoints* points = _compressedPoints;
+    assert(points && index < _pointCount);
+
+    const unsigned short* value = points->values + index * points->stride;
+    unsigned int i = 0;
+    while (i < _componentCount)
+    {
+        switch (points->encodings[i])
+        {
+        case QUANTIZED:
+            dst[i] = points->constants[i] + points->steps[i] * (float)*value++;
+            i++;
+            break;
+        case QUATERNION:
+            decodeQuaternion(value, dst + i);
+            value += 3;
+            i += 4;
+            break;
+        default:
+            dst[i] = points->constants[i];
+            i++;
+            break;
+        }
+    }
+}
+
 int Curve::determineIndex(float time) const
 {
     unsigned int min = 0;
@@ -1180,6 +1462,222 @@ int Curve::determineIndex(float time) const
     return -1;
 }
 
+int Curve::determineIndex(float time, unsigned int index) const
+{
+    // Try the given points and the few points that follow them before searching all points.
+    if (index < _pointCount - 1 && time >= _points[index].time)
+    {
+        for (unsigned int end = index + 4; index < _pointCount - 1 && index < end; ++index)
+        {
+            if (time <= _points[index + 1].time)
+                return index;
+        }
+    }
+    return determineIndex(time);
+}
+
+bool Curve::isLinear() const
+{
+    if (_compressedPoints)
+        return false;
+
+    for (unsigned int i = 0; i + 1 < _pointCount; ++i)
+    {
+        if (_points[i].type != LINEAR)
+            return false;
+    }
+    return true;
+}
+
+bool Curve::hasSameLayout(const Curve* curve) const
+{
+    assert(curve);
+
+    if (_pointCount != curve->_pointCount || _componentCount != curve->_componentCount)
+        return false;
+
+    if (_compressedPoints || curve->_compressedPoints)
+        return false;
+
+    if ((_quaternionOffset == NULL) != (curve->_quaternionOffset == NULL) ||
+        (_quaternionOffset && *_quaternionOffset != *curve->_quaternionOffset))
+        return false;
+
+    for (unsigned int i = 0; i < _pointCount; ++i)
+    {
+        if (_points[i].time != curve->_points[i].time)
+            return false;
+    }
+    return true;
+}
+
+void Curve::evaluateLinear(Curve* const* curves, unsigned int count, float time, float* const* dst, unsigned int* pointIndex)
+{
+    assert(curves && dst && pointIndex && time >= 0 && time <= 1.0f);
+
+    if (count == 0)
+        return;
+
+    const Curve* first = curves[0];
+    unsigned int pointCount = first->_pointCount;
+    unsigned int componentCount = first->_componentCount;
+
+    // Determine the points and the fractional time between them once for all curves.
+    unsigned int index;
+    float t;
+    if (pointCount == 1 || time <= first->_points[0].time)
+    {
+        index = 0;
+        t = 0.0f;
+        *pointIndex = 0;
+    }
+    else if (time >= first->_points[pointCount - 1].time)
+    {
+        index = pointCount - 2;
+        t = 1.0f;
+        *pointIndex = index;
+    }
+    else
+    {
+        index = *pointIndex = first->determineIndex(time, *pointIndex);
+        Point* from = first->_points + index;
+        Point* to = from + 1;
+        t = (time - from->time) / (to->time - from->time);
+    }
+
+    // Values at or beyond the points are copied, as by evaluate.
+    if (t == 0.0f || t == 1.0f)
+    {
+        unsigned int point = (t == 0.0f) ? index : index + 1;
+        for (unsigned int i = 0; i < count; ++i)
+        {
+            memcpy(dst[i], curves[i]->_points[point].value, first->_componentSize);
+        }
+        return;
+    }
+
+    // Interpolate all components linearly, including any quaternion, which is interpolated
+    // spherically below.
+    for (unsigned int i = 0; i < count; ++i)
+    {
+        const float* fromValue = curves[i]->_points[index].value;
+        const float* toValue = curves[i]->_points[index + 1].value;
+        float* value = dst[i];
+        unsigned int j = 0;
+#ifdef CURVE_USE_SSE
+        __m128 s = _mm_set1_ps(t);
+        for (; j + 4 <= componentCount; j += 4)
+        {
+            __m128 from = _mm_loadu_ps(fromValue + j);
+            __m128 to = _mm_loadu_ps(toValue + j);
+            _mm_storeu_ps(value + j, _mm_add_ps(from, _mm_mul_ps(_mm_sub_ps(to, from), s)));
+        }
+#endif
+        for (; j < componentCount; ++j)
+        {
+            value[j] = lerpInl(t, fromValue[j], toValue[j]);
+        }
+    }
+
+    if (!first->_quaternionOffset)
+        return;
+
+    unsigned int offset = *first->_quaternionOffset;
+    unsigned int i = 0;
+#ifdef CURVE_USE_SSE
+    // The fast slerp of Quaternion::slerp for four curves at a time. The terms that only depend
+    // on the time are shared by all curves.
+    float f2b = t - 0.5f;
+    float u = f2b >= 0 ? f2b : -f2b;
+    float f2a = u - f2b;
+    f2b += u;
+    u += u;
+    float f1 = 1.0f - u;
+    float sqNotU = f1 * f1;
+    float sqU = u * u;
+
+    const __m128 one = _mm_set1_ps(1.0f);
+    const __m128 zero = _mm_setzero_ps();
+    for (; i + 4 <= count; i += 4)
+    {
+        const float* q1[4];
+        const float* q2[4];
+        for (unsigned int k = 0; k < 4; ++k)
+        {
+            q1[k] = curves[i + k]->_points[index].value + offset;
+            q2[k] = curves[i + k]->_points[index + 1].value + offset;
+        }
+
+        // Transpose the quaternions so that each register holds one component of four curves.
+        __m128 q1x = _mm_loadu_ps(q1[0]), q1y = _mm_loadu_ps(q1[1]), q1z = _mm_loadu_ps(q1[2]), q1w = _mm_loadu_ps(q1[3]);
+        __m128 q2x = _mm_loadu_ps(q2[0]), q2y = _mm_loadu_ps(q2[1]), q2z = _mm_loadu_ps(q2[2]), q2w = _mm_loadu_ps(q2[3]);
+        _MM_TRANSPOSE4_PS(q1x, q1y, q1z, q1w);
+        _MM_TRANSPOSE4_PS(q2x, q2y, q2z, q2w);
+
+        __m128 cosTheta = _mm_add_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(q1w, q2w), _mm_mul_ps(q1x, q2x)), _mm_mul_ps(q1y, q2y)), _mm_mul_ps(q1z, q2z));
+
+        // Fold theta.
+        __m128 positive = _mm_cmpge_ps(cosTheta, zero);
+        __m128 alpha = _mm_or_ps(_mm_and_ps(positive, one), _mm_andnot_ps(positive, _mm_set1_ps(-1.0f)));
+        __m128 halfY = _mm_add_ps(one, _mm_mul_ps(alpha, cosTheta));
+
+        // One iteration of Newton to get 1-cos(theta / 2) to good accuracy.
+        __m128 halfSecHalfTheta = _mm_sub_ps(_mm_set1_ps(1.09f), _mm_mul_ps(_mm_sub_ps(_mm_set1_ps(0.476537f), _mm_mul_ps(_mm_set1_ps(0.0903321f), halfY)), halfY));
+        halfSecHalfTheta = _mm_mul_ps(halfSecHalfTheta, _mm_sub_ps(_mm_set1_ps(1.5f), _mm_mul_ps(_mm_mul_ps(halfY, halfSecHalfTheta), halfSecHalfTheta)));
+        __m128 versHalfTheta = _mm_sub_ps(one, _mm_mul_ps(halfY, halfSecHalfTheta));
+
+        // Evaluate series expansions of the coefficients.
+        __m128 ratio2 = _mm_mul_ps(_mm_set1_ps(0.0000440917108f), versHalfTheta);
+        __m128 ratio1 = _mm_add_ps(_mm_set1_ps(-0.00158730159f), _mm_mul_ps(_mm_set1_ps(sqNotU - 16.0f), ratio2));
+        ratio1 = _mm_add_ps(_mm_set1_ps(0.0333333333f), _mm_mul_ps(_mm_mul_ps(ratio1, _mm_set1_ps(sqNotU - 9.0f)), versHalfTheta));
+        ratio1 = _mm_add_ps(_mm_set1_ps(-0.333333333f), _mm_mul_ps(_mm_mul_ps(ratio1, _mm_set1_ps(sqNotU - 4.0f)), versHalfTheta));
+        ratio1 = _mm_add_ps(one, _mm_mul_ps(_mm_mul_ps(ratio1, _mm_set1_ps(sqNotU - 1.0f)), versHalfTheta));
+
+        ratio2 = _mm_add_ps(_mm_set1_ps(-0.00158730159f), _mm_mul_ps(_mm_set1_ps(sqU - 16.0f), ratio2));
+        ratio2 = _mm_add_ps(_mm_set1_ps(0.0333333333f), _mm_mul_ps(_mm_mul_ps(ratio2, _mm_set1_ps(sqU - 9.0f)), versHalfTheta));
+        ratio2 = _mm_add_ps(_mm_set1_ps(-0.333333333f), _mm_mul_ps(_mm_mul_ps(ratio2, _mm_set1_ps(sqU - 4.0f)), versHalfTheta));
+        ratio2 = _mm_add_ps(one, _mm_mul_ps(_mm_mul_ps(ratio2, _mm_set1_ps(sqU - 1.0f)), versHalfTheta));
+
+        // Perform the bisection and resolve the folding done earlier.
+        __m128 c1 = _mm_mul_ps(_mm_set1_ps(f1), _mm_mul_ps(ratio1, halfSecHalfTheta));
+        __m128 c2a = _mm_mul_ps(_mm_set1_ps(f2a), ratio2);
+        __m128 c2b = _mm_mul_ps(_mm_set1_ps(f2b), ratio2);
+        alpha = _mm_mul_ps(alpha, _mm_add_ps(c1, c2a));
+        __m128 beta = _mm_add_ps(c1, c2b);
+
+        // Apply final coefficients and correct the length of the result.
+        __m128 w = _mm_add_ps(_mm_mul_ps(alpha, q1w), _mm_mul_ps(beta, q2w));
+        __m128 x = _mm_add_ps(_mm_mul_ps(alpha, q1x), _mm_mul_ps(beta, q2x));
+        __m128 y = _mm_add_ps(_mm_mul_ps(alpha, q1y), _mm_mul_ps(beta, q2y));
+        __m128 z = _mm_add_ps(_mm_mul_ps(alpha, q1z), _mm_mul_ps(beta, q2z));
+        __m128 lengthSq = _mm_add_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(w, w), _mm_mul_ps(x, x)), _mm_mul_ps(y, y)), _mm_mul_ps(z, z));
+        __m128 scale = _mm_sub_ps(_mm_set1_ps(1.5f), _mm_mul_ps(_mm_set1_ps(0.5f), lengthSq));
+        x = _mm_mul_ps(x, scale);
+        y = _mm_mul_ps(y, scale);
+        z = _mm_mul_ps(z, scale);
+        w = _mm_mul_ps(w, scale);
+
+        // Equal quaternions are copied, as by Quaternion::slerp.
+        __m128 equal = _mm_and_ps(_mm_and_ps(_mm_cmpeq_ps(q1x, q2x), _mm_cmpeq_ps(q1y, q2y)), _mm_and_ps(_mm_cmpeq_ps(q1z, q2z), _mm_cmpeq_ps(q1w, q2w)));
+        x = _mm_or_ps(_mm_and_ps(equal, q1x), _mm_andnot_ps(equal, x));
+        y = _mm_or_ps(_mm_and_ps(equal, q1y), _mm_andnot_ps(equal, y));
+        z = _mm_or_ps(_mm_and_ps(equal, q1z), _mm_andnot_ps(equal, z));
+        w = _mm_or_ps(_mm_and_ps(equal, q1w), _mm_andnot_ps(equal, w));
+
+        _MM_TRANSPOSE4_PS(x, y, z, w);
+        _mm_storeu_ps(dst[i] + offset, x);
+        _mm_storeu_ps(dst[i + 1] + offset, y);
+        _mm_storeu_ps(dst[i + 2] + offset, z);
+        _mm_storeu_ps(dst[i + 3] + offset, w);
+    }
+#endif
+    for (; i < count; ++i)
+    {
+        const Curve* curve = curves[i];
+        curve->interpolateQuaternion(t, curve->_points[index].value + offset, curve->_points[index + 1].value + offset, dst[i] + offset);
+    }
+}
+
 int Curve::getInterpolationType(const char* curveId)
 {
     if (strcmp(curveId, "BEZIER") == 0)
@@ -3,6 +3,8 @@
 
 #include "Ref.h"
 
+class AnimationBenchmarkTest;
+
 namespace gameplay
 {
 
@@ -16,6 +18,8 @@ class Curve : public Ref
     friend class AnimationClip;
     friend class AnimationController;
     friend class MeshSkin;
+    friend class Bundle;
+    friend class ::AnimationBenchmarkTest;
 
 public:
 
@@ -352,6 +356,23 @@ public:
      */
     void evaluate(float time, float* dst) const;
 
+    /**
+     * Evaluates the curve at the given position value, starting the search for the points
+     * to interpolate between at the given point index.
+     *
+     * When the curve is evaluated at positions that advance in small steps, such as while
+     * an animation is playing, the points are found in constant time instead of by a binary
+     * search on every call.
+     *
+     * @param time The position to evaluate the curve at.
+     * @param dst The evaluated value of the curve at the given time.
+     * @param pointIndex The index of the point at or before the position that was last evaluated,
+     *      which is updated to the index of the point at or before the given position. Use
+     *      zero initially, or NULL to always do a binary search.
+     * @script{ignore}
+     */
+    void evaluate(float time, float* dst, unsigned int* pointIndex) const;
+
     /**
      * Linear interpolation function.
      */
@@ -393,6 +414,107 @@ private:
         Point& operator=(const Point&);
     };
 
+    /**
+     * The encodings of the components of a curve whose points are stored in compressed form.
+     */
+    enum Encoding
+    {
+        /** The component has the same value at every point. */
+        CONSTANT = 0,
+        /** The component is stored as a 16-bit fixed-point value at each point. */
+        QUANTIZED = 1,
+        /** The component is part of a quaternion that is stored as its smallest three components at each point. */
+        QUATERNION = 2
+    };
+
+    /**
+     * Defines the point times that are shared by curves whose points are stored in compressed form.
+     */
+    class KeyTimes : public Ref
+    {
+    public:
+
+        /**
+         * Creates the point times from key times in milliseconds.
+         *
+         * @param count The number of key times.
+         * @param keyTimes The key times, in increasing order.
+         */
+        static KeyTimes* create(unsigned int count, const unsigned int* keyTimes);
+
+        /** The number of points. */
+        unsigned int count;
+        /** The times of the points, between 0.0 and 1.0. */
+        float* times;
+        /** The time between the first and last key times, in milliseconds. */
+        unsigned long duration;
+
+    private:
+
+        /**
+         * Constructor.
+         */
+        KeyTimes();
+
+        /**
+         * Destructor.
+         */
+        ~KeyTimes();
+
+        /**
+         * Hidden copy constructor.
+         */
+        KeyTimes(const KeyTimes& copy);
+
+        /**
+         * Hidden copy assignment operator.
+         */
+        KeyTimes& operator=(const KeyTimes&);
+    };
+
+    /**
+     * Defines the points of a curve that are stored in compressed form.
+     */
+    class CompressedPoints
+    {
+    public:
+
+        /**
+         * Constructor.
+         */
+        CompressedPoints();
+
+        /**
+         * Destructor.
+         */
+        ~CompressedPoints();
+
+        /** The shared times of the points. */
+        KeyTimes* keyTimes;
+        /** The encoding of each component. */
+        unsigned char* encodings;
+        /** The value of each constant component, or the value of zero for each quantized component. */
+        float* constants;
+        /** The difference between consecutive values of each quantized component. */
+        float* steps;
+        /** The quantized values of each point, one point after another. */
+        unsigned short* values;
+        /** The number of quantized values per point. */
+        unsigned int stride;
+
+    private:
+
+        /**
+         * Hidden copy constructor.
+         */
+        CompressedPoints(const CompressedPoints& copy);
+
+        /**
+         * Hidden copy assignment operator.
+         */
+        CompressedPoints& operator=(const CompressedPoints&);
+    };
+
     /**
      * Constructor.
      */
@@ -411,6 +533,38 @@ private:
      */
     Curve(const Curve& copy);
 
+    /**
+     * Creates a linearly interpolated curve whose points are stored in compressed form.
+     *
+     * The points are decoded when the curve is evaluated, two at a time, so the curve takes
+     * a fraction of the memory of a curve whose points are stored as floats. Compressed curves
+     * cannot be modified and are not evaluated in batches.
+     *
+     * @param keyTimes The times of the points, which can be shared with other curves.
+     * @param componentCount The number of float component values per key value.
+     * @param encodings The encoding of each component. All four components of a quaternion stored in
+     *      smallest three form are QUATERNION.
+     * @param constants The value of each CONSTANT component and the value of zero for each QUANTIZED component.
+     * @param steps The difference between consecutive values of each QUANTIZED component.
+     * @param values The quantized values of each point, one point after another. Each point has one value
+     *      for each QUANTIZED component and three values for each quaternion, in component order.
+     * @param stride The number of quantized values per point.
+     *
+     * @return The new curve.
+     */
+    static Curve* createCompressed(KeyTimes* keyTimes, unsigned int componentCount, const unsigned char* encodings,
+        const float* constants, const float* steps, const unsigned short* values, unsigned int stride);
+
+    /**
+     * Evaluates a curve whose points are stored in compressed form.
+     */
+    void evaluateCompressed(float time, float* dst, unsigned int* pointIndex) const;
+
+    /**
+     * Decodes the value of a point of a curve whose points are stored in compressed form.
+     */
+    void decodePoint(unsigned int index, float* dst) const;
+
     /**
      * Destructor.
      */
@@ -461,6 +615,12 @@ private:
      */ 
     int determineIndex(float time) const;
 
+    /**
+     * Determines the current keyframe to interpolate from based on the specified time, starting
+     * from the given keyframe and falling back to a binary search if it is not close to the time.
+     */
+    int determineIndex(float time, unsigned int index) const;
+
     /**
      * Sets the offset for the beginning of a Quaternion piece of data within the curve's value span at the specified
      * index. The next four components of data starting at the given index will be interpolated as a Quaternion.
@@ -471,6 +631,33 @@ private:
      */
     void setQuaternionOffset(unsigned int index);
 
+    /**
+     * Determines if the curve is interpolated linearly between all of its points.
+     */
+    bool isLinear() const;
+
+    /**
+     * Determines if the given curve has the same point times, component count and quaternion
+     * offset as this curve.
+     */
+    bool hasSameLayout(const Curve* curve) const;
+
+    /**
+     * Evaluates several curves at the given time in one pass.
+     *
+     * The curves must be linear (see isLinear) and have the same layout (see hasSameLayout).
+     * The points to interpolate between are determined once for all curves, and on SSE
+     * capable processors the quaternions of four curves are interpolated at a time.
+     *
+     * @param curves The curves to evaluate.
+     * @param count The number of curves.
+     * @param time The position to evaluate the curves at.
+     * @param dst The destinations of the evaluated values, one per curve.
+     * @param pointIndex The index of the point at or before the position that was last evaluated,
+     *      which is updated as for evaluate.
+     */
+    static void evaluateLinear(Curve* const* curves, unsigned int count, float time, float* const* dst, unsigned int* pointIndex);
+
     /**
      * Gets the InterpolationType value for the given string ID
      *
@@ -484,6 +671,7 @@ private:
     unsigned int _componentSize;        // The component size (in bytes).
     unsigned int* _quaternionOffset;    // Offset for the rotation component.
     Point* _points;                     // The points on the curve.
+    CompressedPoints* _compressedPoints; // The points on the curve, if they are stored in compressed form.
 };
 
 }
@@ -1,14 +1,13 @@
 #include "Base.h"
 #include "Effect.h"
 #include "FileSystem.h"
+#include "ResourceManager.h"
 
 #define OPENGL_ES_DEFINE  "#define OPENGL_ES\n"
 
 namespace gameplay
 {
 
-// Cache of unique effects.
-static std::map<std::string, Effect*> __effectCache;
 static Effect* __currentEffect = NULL;
 
 Effect::Effect() : _program(0)
@@ -17,9 +16,6 @@ Effect::Effect() : _program(0)
 
 Effect::~Effect()
 {
-    // Remove this effect from the cache.
-    __effectCache.erase(_id);
-
     // Free uniforms.
     for (std::map<std::string, Uniform*>::iterator itr = _uniforms.begin(); itr != _uniforms.end(); ++itr)
     {
@@ -54,13 +50,11 @@ Effect* Effect::createFromFile(const char* vshPath, const char* fshPath, const c
     {
         uniqueId += defines;
     }
-    std::map<std::string, Effect*>::const_iterator itr = __effectCache.find(uniqueId);
-    if (itr != __effectCache.end())
+    Effect* cached = static_cast<Effect*>(ResourceManager::find(ResourceManager::EFFECT, uniqueId));
+    if (cached)
     {
-        // Found an exiting effect with this id, so increase its ref count and return it.
-        GP_ASSERT(itr->second);
-        itr->second->addRef();
-        return itr->second;
+        // Found an exiting effect with this id, so return it with an increased ref count.
+        return cached;
     }
 
     // Read source from file.
@@ -79,7 +73,10 @@ Effect* Effect::createFromFile(const char* vshPath, const char* fshPath, const c
     }
 
     Effect* effect = createFromSource(vshPath, vshSource, fshPath, fshSource, defines);
-    
+
+    // Estimate the size of the compiled program by the size of its source.
+    size_t size = strlen(vshSource) + strlen(fshSource);
+
     SAFE_DELETE_ARRAY(vshSource);
     SAFE_DELETE_ARRAY(fshSource);
 
@@ -91,7 +88,7 @@ Effect* Effect::createFromFile(const char* vshPath, const char* fshPath, const c
     {
         // Store this effect in the cache.
         effect->_id = uniqueId;
-        __effectCache[uniqueId] = effect;
+        ResourceManager::add(ResourceManager::EFFECT, uniqueId, effect, size);
     }
 
     return effect;
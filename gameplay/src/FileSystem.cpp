@@ -2,9 +2,14 @@
 #include "FileSystem.h"
 #include "Properties.h"
 #include "Stream.h"
+#include "Ref.h"
 
 #include <sys/types.h>
 #include <sys/stat.h>
+#include <zlib.h>
+
+// The size of the read-ahead buffer of files that are only read. Smaller files are read whole.
+#define FILESTREAM_BUFFER_SIZE 65536
 
 #ifdef WIN32
     #include <windows.h>
@@ -14,6 +19,9 @@
     #define gp_stat_struct struct stat
 #else
     #include <dirent.h>
+    #include <fcntl.h>
+    #include <unistd.h>
+    #include <sys/mman.h>
     #define gp_stat stat
     #define gp_stat_struct struct stat
 #endif
@@ -87,6 +95,11 @@ static std::string __resourcePath("./");
 static std::map<std::string, std::string> __aliases;
 
 /**
+ * A stream over a file that is opened with fopen.
+ *
+ * Files that are only read are read ahead into a buffer, and files that fit in the buffer are
+ * read whole when they are opened and then read from memory. Reading lines and characters,
+ * checking for the end of the file and seeking within the buffer do not call the C library.
  * 
  * @script{ignore}
  */
@@ -114,10 +127,131 @@ public:
 private:
     FileStream(FILE* file);
 
+    bool fillBuffer();
+
 private:
     FILE* _file;
     bool _canRead;
     bool _canWrite;
+    char* _buffer;              // The read-ahead buffer of a file that is only read, or NULL.
+    size_t _bufferSize;         // The capacity of the buffer.
+    size_t _bufferLength;       // The number of bytes in the buffer.
+    size_t _bufferPosition;     // The position of the stream in the buffer.
+    long int _bufferOffset;     // The position in the file of the first byte of the buffer.
+    long int _length;           // The length of the file, if it is buffered.
+};
+
+class Archive;
+
+/**
+ * A read-only stream over a file in memory: a file that is mapped into memory, a file that is
+ * stored in a mounted archive, or a compressed file of an archive that is decompressed.
+ * 
+ * @script{ignore}
+ */
+class FileStreamMapped : public Stream
+{
+public:
+    friend class FileSystem;
+    friend class Archive;
+
+    /**
+     * Defines who owns the memory of the stream.
+     */
+    enum Storage
+    {
+        STORAGE_MAPPED,     // The stream maps the file, and unmaps it when it is closed.
+        STORAGE_ARCHIVE,    // The memory belongs to an archive, which the stream references until it is closed.
+        STORAGE_ALLOCATED   // The stream allocated the memory, and deletes it when it is closed.
+    };
+    
+    ~FileStreamMapped();
+    virtual bool canRead();
+    virtual bool canWrite();
+    virtual bool canSeek();
+    virtual void close();
+    virtual size_t read(void* ptr, size_t size, size_t count);
+    virtual char* readLine(char* str, int num);
+    virtual const void* map(size_t size);
+    virtual size_t write(const void* ptr, size_t size, size_t count);
+    virtual bool eof();
+    virtual size_t length();
+    virtual long int position();
+    virtual bool seek(long int offset, int origin);
+    virtual bool rewind();
+
+    static FileStreamMapped* create(const char* filePath);
+
+private:
+    FileStreamMapped(const char* data, size_t length, Storage storage, Archive* archive = NULL);
+
+private:
+    const char* _data;
+    size_t _length;
+    size_t _position;
+    Storage _storage;
+    Archive* _archive;
+};
+
+// The identifier and version of archives, which are written by gameplay-encoder -pack.
+static const char __archiveIdentifier[9] = { '\xAB', 'G', 'P', 'K', '\xBB', '\r', '\n', '\x1A', '\n' };
+#define ARCHIVE_VERSION_MAJOR 1
+
+// The size of the header of an archive: the identifier, the version, one byte of padding,
+// the number of entries and the size of the names.
+#define ARCHIVE_HEADER_SIZE 20
+
+/**
+ * An entry in the directory of an archive, as it is stored in the archive.
+ *
+ * The entries follow the header, sorted by hash, and are followed by the names of the
+ * entries and then by their data.
+ */
+struct ArchiveEntry
+{
+    unsigned int hash;          // The hash of the path of the file (see hashArchivePath).
+    unsigned int nameOffset;    // The offset of the path in the names, which are not NULL-terminated.
+    unsigned int nameLength;    // The length of the path.
+    unsigned int offset;        // The offset of the data of the file from the start of the archive.
+    unsigned int size;          // The size of the file.
+    unsigned int storedSize;    // The size of the data, which is compressed with zlib when it is smaller than the file.
+};
+
+/**
+ * An archive that is mounted with FileSystem::mountArchive.
+ *
+ * The archive is mapped into memory and its directory is searched in place. The streams of
+ * the files that are stored in the archive reference it, so that it stays mapped until they
+ * are closed after it is unmounted.
+ *
+ * @script{ignore}
+ */
+class Archive : public Ref
+{
+public:
+
+    static Archive* create(const char* path);
+
+    const ArchiveEntry* find(const char* path) const;
+
+    Stream* open(const ArchiveEntry* entry);
+
+    void listFiles(const std::string& dirPath, std::vector<std::string>& files) const;
+
+    const std::string& getPath() const;
+
+private:
+
+    Archive(const char* path, Stream* stream, const char* data);
+
+    ~Archive();
+
+    std::string _path;
+    Stream* _stream;
+    const char* _data;
+    const ArchiveEntry* _entries;
+    unsigned int _entryCount;
+    const char* _names;
 };
 
 #ifdef __ANDROID__
@@ -138,6 +272,7 @@ public:
     virtual void close();
     virtual size_t read(void* ptr, size_t size, size_t count);
     virtual char* readLine(char* str, int num);
+    virtual const void* map(size_t size);
     virtual size_t write(const void* ptr, size_t size, size_t count);
     virtual bool eof();
     virtual size_t length();
@@ -156,6 +291,53 @@ private:
 
 #endif
 
+static std::vector<Archive*> __archives;
+
+/**
+ * Returns the FNV-1a hash of the path of a file in an archive.
+ */
+static unsigned int hashArchivePath(const char* path, size_t length)
+{
+    unsigned int hash = 2166136261u;
+    for (size_t i = 0; i < length; ++i)
+    {
+        hash ^= (unsigned char)path[i];
+        hash *= 16777619u;
+    }
+    return hash;
+}
+
+/**
+ * Returns the path of a file as it is stored in archives, relative to the resource path.
+ */
+static const char* getArchivePath(const char* path)
+{
+    while (path[0] == '.' && path[1] == '/')
+        path += 2;
+    return path;
+}
+
+/**
+ * Finds a file in the mounted archives, searching the archives that were mounted last first.
+ */
+static const ArchiveEntry* findArchiveEntry(const char* path, Archive** archive)
+{
+    if (__archives.empty())
+        return NULL;
+
+    path = getArchivePath(FileSystem::resolvePath(path));
+    for (size_t i = __archives.size(); i-- > 0;)
+    {
+        const ArchiveEntry* entry = __archives[i]->find(path);
+        if (entry)
+        {
+            *archive = __archives[i];
+            return entry;
+        }
+    }
+    return NULL;
+}
+
 /////////////////////////////
 
 FileSystem::FileSystem()
@@ -218,8 +400,46 @@ const char* FileSystem::resolvePath(const char* path)
     return path;
 }
 
+bool FileSystem::mountArchive(const char* archivePath)
+{
+    GP_ASSERT(archivePath);
+
+    Archive* archive = Archive::create(archivePath);
+    if (!archive)
+        return false;
+    __archives.push_back(archive);
+    return true;
+}
+
+void FileSystem::unmountArchive(const char* archivePath)
+{
+    GP_ASSERT(archivePath);
+
+    for (size_t i = __archives.size(); i-- > 0;)
+    {
+        if (__archives[i]->getPath() == archivePath)
+        {
+            SAFE_RELEASE(__archives[i]);
+            __archives.erase(__archives.begin() + i);
+            return;
+        }
+    }
+}
+
 bool FileSystem::listFiles(const char* dirPath, std::vector<std::string>& files)
 {
+    bool found = false;
+    if (!__archives.empty())
+    {
+        std::string path(dirPath ? getArchivePath(dirPath) : "");
+        if (path.length() > 0 && path[path.length() - 1] != '/')
+            path += '/';
+        size_t count = files.size();
+        for (size_t i = 0; i < __archives.size(); ++i)
+            __archives[i]->listFiles(path, files);
+        found = files.size() > count;
+    }
+
 #ifdef WIN32
     std::string path(FileSystem::getResourcePath());
     if (dirPath && strlen(dirPath) > 0)
@@ -235,8 +455,9 @@ bool FileSystem::listFiles(const char* dirPath, std::vector<std::string>& files)
     HANDLE hFind = FindFirstFile(wPath.c_str(), &FindFileData);
     if (hFind == INVALID_HANDLE_VALUE) 
     {
-        return false;
+        return found;
     }
+    size_t archiveCount = files.size();
     do
     {
         // Add to the list if this is not a directory
@@ -246,7 +467,8 @@ bool FileSystem::listFiles(const char* dirPath, std::vector<std::string>& files)
             std::basic_string<TCHAR> wfilename(FindFileData.cFileName);
             std::string filename;
             filename.assign(wfilename.begin(), wfilename.end());
-            files.push_back(filename);
+            if (std::find(files.begin(), files.begin() + archiveCount, filename) == files.begin() + archiveCount)
+                files.push_back(filename);
         }
     } while (FindNextFile(hFind, &FindFileData) != 0);
 
@@ -263,8 +485,9 @@ bool FileSystem::listFiles(const char* dirPath, std::vector<std::string>& files)
     DIR* dir = opendir(path.c_str());
     if (!dir)
     {
-        return false;
+        return found;
     }
+    size_t archiveCount = files.size();
     while ((dp = readdir(dir)) != NULL)
     {
         std::string filepath(path);
@@ -275,7 +498,7 @@ bool FileSystem::listFiles(const char* dirPath, std::vector<std::string>& files)
         if (!stat(filepath.c_str(), &buf))
         {
             // Add to the list if this is not a directory
-            if (!S_ISDIR(buf.st_mode))
+            if (!S_ISDIR(buf.st_mode) && std::find(files.begin(), files.begin() + archiveCount, dp->d_name) == files.begin() + archiveCount)
             {
                 files.push_back(dp->d_name);
             }
@@ -290,6 +513,10 @@ bool FileSystem::fileExists(const char* filePath)
 {
     GP_ASSERT(filePath);
 
+    Archive* archive;
+    if (findArchiveEntry(filePath, &archive))
+        return true;
+
 #ifdef __ANDROID__
     if (androidFileExists(filePath))
     {
@@ -329,6 +556,13 @@ Stream* FileSystem::open(const char* path, size_t mode)
     char modeStr[] = "rb";
     if ((mode & WRITE) != 0)
         modeStr[0] = 'w';
+    else
+    {
+        Archive* archive;
+        const ArchiveEntry* entry = findArchiveEntry(path, &archive);
+        if (entry)
+            return archive->open(entry);
+    }
 #ifdef __ANDROID__
     if ((mode & WRITE) != 0)
     {
@@ -376,6 +610,12 @@ Stream* FileSystem::open(const char* path, size_t mode)
         }
     }
 #endif
+    if ((mode & MAP) != 0 && (mode & WRITE) == 0)
+    {
+        FileStreamMapped* stream = FileStreamMapped::create(fullPath.c_str());
+        if (stream)
+            return stream;
+    }
     FileStream* stream = FileStream::create(fullPath.c_str(), modeStr);
     return stream;
 #endif
@@ -533,17 +773,15 @@ std::string FileSystem::getExtension(const char* path)
 //////////////////
 
 FileStream::FileStream(FILE* file)
-    : _file(file), _canRead(false), _canWrite(false)
+    : _file(file), _canRead(false), _canWrite(false), _buffer(NULL), _bufferSize(0), _bufferLength(0),
+      _bufferPosition(0), _bufferOffset(0), _length(0)
 {
     
 }
 
 FileStream::~FileStream()
 {
-    if (_file)
-    {
-        close();
-    }
+    close();
 }
 
 FileStream* FileStream::create(const char* filePath, const char* mode)
@@ -557,19 +795,48 @@ FileStream* FileStream::create(const char* filePath, const char* mode)
         {
             if (*s == 'r')
                 stream->_canRead = true;
-            else if (*s == 'w')
+            else if (*s == 'w' || *s == 'a' || *s == '+')
                 stream->_canWrite = true;
             ++s;
         }
 
+        // Files that are only read are buffered, and read whole if they fit in the buffer.
+        if (stream->_canRead && !stream->_canWrite && fseek(file, 0, SEEK_END) == 0)
+        {
+            long int length = ftell(file);
+            if (length >= 0 && fseek(file, 0, SEEK_SET) == 0)
+            {
+                stream->_length = length;
+                stream->_bufferSize = std::min((size_t)length, (size_t)FILESTREAM_BUFFER_SIZE);
+                stream->_buffer = new char[std::max(stream->_bufferSize, (size_t)1)];
+                if (length <= FILESTREAM_BUFFER_SIZE)
+                {
+                    stream->fillBuffer();
+                    stream->_length = (long int)stream->_bufferLength;
+                    fclose(file);
+                    stream->_file = NULL;
+                }
+            }
+        }
+
         return stream;
     }
     return NULL;
 }
 
+bool FileStream::fillBuffer()
+{
+    if (!_file)
+        return false;
+    _bufferOffset += (long int)_bufferLength;
+    _bufferLength = fread(_buffer, 1, _bufferSize, _file);
+    _bufferPosition = 0;
+    return _bufferLength > 0;
+}
+
 bool FileStream::canRead()
 {
-    return _file && _canRead;
+    return (_file || _buffer) && _canRead;
 }
 
 bool FileStream::canWrite()
@@ -579,7 +846,7 @@ bool FileStream::canWrite()
 
 bool FileStream::canSeek()
 {
-    return _file != NULL;
+    return _file || _buffer;
 }
 
 void FileStream::close()
@@ -587,20 +854,85 @@ void FileStream::close()
     if (_file)
         fclose(_file);
     _file = NULL;
+    SAFE_DELETE_ARRAY(_buffer);
+    _bufferSize = 0;
+    _bufferLength = 0;
+    _bufferPosition = 0;
+    _bufferOffset = 0;
+    _length = 0;
 }
 
 size_t FileStream::read(void* ptr, size_t size, size_t count)
 {
-    if (!_file)
+    if (!_buffer)
+    {
+        if (!_file)
+            return 0;
+        return fread(ptr, size, count, _file);
+    }
+    if (size == 0)
         return 0;
-    return fread(ptr, size, count, _file);
+
+    char* dst = (char*)ptr;
+    size_t bytes = size * count;
+    size_t copied = 0;
+    while (copied < bytes)
+    {
+        if (_bufferPosition == _bufferLength)
+        {
+            // Reads that are larger than the buffer bypass it.
+            if (_file && bytes - copied >= _bufferSize)
+            {
+                size_t result = fread(dst + copied, 1, bytes - copied, _file);
+                _bufferOffset += (long int)(_bufferLength + result);
+                _bufferLength = 0;
+                _bufferPosition = 0;
+                copied += result;
+                break;
+            }
+            if (!fillBuffer())
+                break;
+        }
+        size_t n = std::min(_bufferLength - _bufferPosition, bytes - copied);
+        memcpy(dst + copied, _buffer + _bufferPosition, n);
+        _bufferPosition += n;
+        copied += n;
+    }
+    return copied / size;
 }
 
 char* FileStream::readLine(char* str, int num)
 {
-    if (!_file)
-        return 0;
-    return fgets(str, num, _file);
+    if (!_buffer)
+    {
+        if (!_file)
+            return 0;
+        return fgets(str, num, _file);
+    }
+    if (num <= 0)
+        return NULL;
+
+    // Matches fgets: stops after a new line character or when the array is full.
+    size_t i = 0;
+    size_t max = (size_t)num - 1;
+    while (i < max)
+    {
+        if (_bufferPosition == _bufferLength && !fillBuffer())
+            break;
+        size_t n = std::min(_bufferLength - _bufferPosition, max - i);
+        const char* end = (const char*)memchr(_buffer + _bufferPosition, '\n', n);
+        if (end)
+            n = end - (_buffer + _bufferPosition) + 1;
+        memcpy(str + i, _buffer + _bufferPosition, n);
+        _bufferPosition += n;
+        i += n;
+        if (end)
+            break;
+    }
+    if (i == 0 && max > 0)
+        return NULL;
+    str[i] = '\0';
+    return str;
 }
 
 size_t FileStream::write(const void* ptr, size_t size, size_t count)
@@ -612,6 +944,8 @@ size_t FileStream::write(const void* ptr, size_t size, size_t count)
 
 bool FileStream::eof()
 {
+    if (_buffer)
+        return position() >= _length;
     if (!_file || feof(_file))
         return true;
     return ((size_t)position()) >= length();
@@ -619,6 +953,9 @@ bool FileStream::eof()
 
 size_t FileStream::length()
 {
+    if (_buffer)
+        return (size_t)_length;
+
     size_t len = 0;
     if (canSeek())
     {
@@ -634,6 +971,8 @@ size_t FileStream::length()
 
 long int FileStream::position()
 {
+    if (_buffer)
+        return _bufferOffset + (long int)_bufferPosition;
     if (!_file)
         return -1;
     return ftell(_file);
@@ -641,13 +980,50 @@ long int FileStream::position()
 
 bool FileStream::seek(long int offset, int origin)
 {
-    if (!_file)
+    if (!_buffer)
+    {
+        if (!_file)
+            return false;
+        return fseek(_file, offset, origin) == 0;
+    }
+
+    long int base;
+    switch (origin)
+    {
+    case SEEK_SET:
+        base = 0;
+        break;
+    case SEEK_CUR:
+        base = position();
+        break;
+    case SEEK_END:
+        base = _length;
+        break;
+    default:
+        return false;
+    }
+    long int target = base + offset;
+    if (target < 0)
+        return false;
+
+    // Seeking within the buffer keeps its contents.
+    if (target >= _bufferOffset && target <= _bufferOffset + (long int)_bufferLength)
+    {
+        _bufferPosition = (size_t)(target - _bufferOffset);
+        return true;
+    }
+    if (!_file || fseek(_file, target, SEEK_SET) != 0)
         return false;
-    return fseek(_file, offset, origin) == 0;
+    _bufferOffset = target;
+    _bufferLength = 0;
+    _bufferPosition = 0;
+    return true;
 }
 
 bool FileStream::rewind()
 {
+    if (_buffer)
+        return seek(0, SEEK_SET);
     if (canSeek())
     {
         ::rewind(_file);
@@ -658,6 +1034,323 @@ bool FileStream::rewind()
 
 ////////////////////////////////
 
+FileStreamMapped::FileStreamMapped(const char* data, size_t length, Storage storage, Archive* archive)
+    : _data(data), _length(length), _position(0), _storage(storage), _archive(archive)
+{
+    if (_archive)
+        _archive->addRef();
+}
+
+FileStreamMapped::~FileStreamMapped()
+{
+    if (_data)
+    {
+        close();
+    }
+}
+
+FileStreamMapped* FileStreamMapped::create(const char* filePath)
+{
+    // Empty files cannot be mapped; they are left to FileStream.
+    void* data = NULL;
+    size_t length = 0;
+#ifdef WIN32
+    HANDLE file = CreateFileA(filePath, GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+    if (file == INVALID_HANDLE_VALUE)
+        return NULL;
+    LARGE_INTEGER size;
+    if (GetFileSizeEx(file, &size) && size.QuadPart > 0 && (unsigned long long)size.QuadPart <= (size_t)-1)
+    {
+        // The view keeps the file and the mapping open until it is unmapped.
+        HANDLE mapping = CreateFileMapping(file, NULL, PAGE_READONLY, 0, 0, NULL);
+        if (mapping)
+        {
+            data = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+            length = (size_t)size.QuadPart;
+            CloseHandle(mapping);
+        }
+    }
+    CloseHandle(file);
+#else
+    int file = ::open(filePath, O_RDONLY);
+    if (file == -1)
+        return NULL;
+    gp_stat_struct s;
+    if (fstat(file, &s) == 0 && s.st_size > 0)
+    {
+        // The mapping keeps the file open until it is unmapped.
+        data = mmap(NULL, s.st_size, PROT_READ, MAP_PRIVATE, file, 0);
+        if (data == MAP_FAILED)
+            data = NULL;
+        length = (size_t)s.st_size;
+    }
+    ::close(file);
+#endif
+    if (data == NULL)
+        return NULL;
+    return new FileStreamMapped((const char*)data, length, STORAGE_MAPPED);
+}
+
+bool FileStreamMapped::canRead()
+{
+    return _data != NULL;
+}
+
+bool FileStreamMapped::canWrite()
+{
+    return false;
+}
+
+bool FileStreamMapped::canSeek()
+{
+    return _data != NULL;
+}
+
+void FileStreamMapped::close()
+{
+    if (_data && _storage == STORAGE_MAPPED)
+    {
+#ifdef WIN32
+        UnmapViewOfFile(_data);
+#else
+        munmap((void*)_data, _length);
+#endif
+    }
+    else if (_storage == STORAGE_ALLOCATED)
+    {
+        delete[] _data;
+    }
+    SAFE_RELEASE(_archive);
+    _data = NULL;
+    _length = 0;
+    _position = 0;
+}
+
+size_t FileStreamMapped::read(void* ptr, size_t size, size_t count)
+{
+    if (!_data || size == 0)
+        return 0;
+    size_t available = (_length - _position) / size;
+    if (count > available)
+        count = available;
+    memcpy(ptr, _data + _position, size * count);
+    _position += size * count;
+    return count;
+}
+
+char* FileStreamMapped::readLine(char* str, int num)
+{
+    if (!_data || num <= 0 || _position >= _length)
+        return NULL;
+
+    // Matches fgets: stops after a new line character or when the array is full.
+    size_t n = std::min(_length - _position, (size_t)num - 1);
+    const char* end = (const char*)memchr(_data + _position, '\n', n);
+    if (end)
+        n = end - (_data + _position) + 1;
+    memcpy(str, _data + _position, n);
+    str[n] = '\0';
+    _position += n;
+    return str;
+}
+
+const void* FileStreamMapped::map(size_t size)
+{
+    if (!_data || size > _length - _position)
+        return NULL;
+    const void* ptr = _data + _position;
+    _position += size;
+    return ptr;
+}
+
+size_t FileStreamMapped::write(const void* /*ptr*/, size_t /*size*/, size_t /*count*/)
+{
+    return 0;
+}
+
+bool FileStreamMapped::eof()
+{
+    return _position >= _length;
+}
+
+size_t FileStreamMapped::length()
+{
+    return _length;
+}
+
+long int FileStreamMapped::position()
+{
+    if (!_data)
+        return -1;
+    return (long int)_position;
+}
+
+bool FileStreamMapped::seek(long int offset, int origin)
+{
+    if (!_data)
+        return false;
+
+    long int base;
+    switch (origin)
+    {
+    case SEEK_SET:
+        base = 0;
+        break;
+    case SEEK_CUR:
+        base = (long int)_position;
+        break;
+    case SEEK_END:
+        base = (long int)_length;
+        break;
+    default:
+        return false;
+    }
+    if (base + offset < 0 || (size_t)(base + offset) > _length)
+        return false;
+    _position = (size_t)(base + offset);
+    return true;
+}
+
+bool FileStreamMapped::rewind()
+{
+    if (canSeek())
+    {
+        _position = 0;
+        return true;
+    }
+    return false;
+}
+
+////////////////////////////////
+
+Archive::Archive(const char* path, Stream* stream, const char* data)
+    : _path(path), _stream(stream), _data(data), _entries(NULL), _entryCount(0), _names(NULL)
+{
+}
+
+Archive::~Archive()
+{
+    SAFE_DELETE(_stream);
+}
+
+Archive* Archive::create(const char* path)
+{
+    // The archive is read through a stream that maps it, from the filesystem or from the
+    // read-only asset directory on Android.
+    Stream* stream = FileSystem::open(path, FileSystem::READ | FileSystem::MAP);
+    if (!stream)
+    {
+        GP_ERROR("Failed to open archive '%s'.", path);
+        return NULL;
+    }
+    size_t length = stream->length();
+    const char* data = (const char*)stream->map(length);
+    if (!data)
+    {
+        GP_ERROR("Failed to map archive '%s' into memory.", path);
+        SAFE_DELETE(stream);
+        return NULL;
+    }
+
+    Archive* archive = new Archive(path, stream, data);
+    if (length < ARCHIVE_HEADER_SIZE || memcmp(data, __archiveIdentifier, sizeof(__archiveIdentifier)) != 0 || data[9] != ARCHIVE_VERSION_MAJOR)
+    {
+        GP_ERROR("Invalid archive '%s'.", path);
+        SAFE_RELEASE(archive);
+        return NULL;
+    }
+
+    unsigned int namesSize;
+    memcpy(&archive->_entryCount, data + 12, sizeof(unsigned int));
+    memcpy(&namesSize, data + 16, sizeof(unsigned int));
+    size_t directorySize = length - ARCHIVE_HEADER_SIZE;
+    if (archive->_entryCount > directorySize / sizeof(ArchiveEntry) || namesSize > directorySize - archive->_entryCount * sizeof(ArchiveEntry))
+    {
+        GP_ERROR("Invalid directory in archive '%s'.", path);
+        SAFE_RELEASE(archive);
+        return NULL;
+    }
+    archive->_entries = (const ArchiveEntry*)(data + ARCHIVE_HEADER_SIZE);
+    archive->_names = data + ARCHIVE_HEADER_SIZE + archive->_entryCount * sizeof(ArchiveEntry);
+
+    for (unsigned int i = 0; i < archive->_entryCount; ++i)
+    {
+        const ArchiveEntry& entry = archive->_entries[i];
+        if (entry.nameOffset > namesSize || entry.nameLength > namesSize - entry.nameOffset ||
+            entry.offset > length || entry.storedSize > length - entry.offset || entry.storedSize > entry.size ||
+            (i > 0 && entry.hash < archive->_entries[i - 1].hash))
+        {
+            GP_ERROR("Invalid entry %u in archive '%s'.", i, path);
+            SAFE_RELEASE(archive);
+            return NULL;
+        }
+    }
+
+    return archive;
+}
+
+static bool compareArchiveEntryHash(const ArchiveEntry& entry, unsigned int hash)
+{
+    return entry.hash < hash;
+}
+
+const ArchiveEntry* Archive::find(const char* path) const
+{
+    size_t length = strlen(path);
+    unsigned int hash = hashArchivePath(path, length);
+
+    // Entries whose paths have the same hash are next to each other.
+    const ArchiveEntry* end = _entries + _entryCount;
+    for (const ArchiveEntry* entry = std::lower_bound(_entries, end, hash, compareArchiveEntryHash); entry != end && entry->hash == hash; ++entry)
+    {
+        if (entry->nameLength == length && memcmp(_names + entry->nameOffset, path, length) == 0)
+            return entry;
+    }
+    return NULL;
+}
+
+Stream* Archive::open(const ArchiveEntry* entry)
+{
+    GP_ASSERT(entry);
+
+    const char* data = _data + entry->offset;
+    if (entry->storedSize == entry->size)
+        return new FileStreamMapped(data, entry->size, FileStreamMapped::STORAGE_ARCHIVE, this);
+
+    char* buffer = new char[entry->size];
+    uLongf size = entry->size;
+    if (uncompress((Bytef*)buffer, &size, (const Bytef*)data, entry->storedSize) != Z_OK || size != entry->size)
+    {
+        GP_ERROR("Failed to decompress '%.*s' from archive '%s'.", (int)entry->nameLength, _names + entry->nameOffset, _path.c_str());
+        SAFE_DELETE_ARRAY(buffer);
+        return NULL;
+    }
+    return new FileStreamMapped(buffer, entry->size, FileStreamMapped::STORAGE_ALLOCATED);
+}
+
+void Archive::listFiles(const std::string& dirPath, std::vector<std::string>& files) const
+{
+    for (unsigned int i = 0; i < _entryCount; ++i)
+    {
+        const char* name = _names + _entries[i].nameOffset;
+        size_t length = _entries[i].nameLength;
+        if (length <= dirPath.length() || dirPath.compare(0, dirPath.length(), name, dirPath.length()) != 0)
+            continue;
+
+        // Files in subdirectories are not listed.
+        std::string filename(name + dirPath.length(), length - dirPath.length());
+        if (filename.find('/') == std::string::npos && std::find(files.begin(), files.end(), filename) == files.end())
+            files.push_back(filename);
+    }
+}
+
+const std::string& Archive::getPath() const
+{
+    return _path;
+}
+
+////////////////////////////////
+
 #ifdef __ANDROID__
 
 FileStreamAndroid::FileStreamAndroid(AAsset* asset)
@@ -769,6 +1462,17 @@ char* FileStreamAndroid::readLine(char* str, int num)
     return str; // what if first read failed?
 }
 
+const void* FileStreamAndroid::map(size_t size)
+{
+    // Uncompressed assets are already mapped from the APK.
+    const char* buffer = (const char*)AAsset_getBuffer(_asset);
+    long int pos = position();
+    if (buffer == NULL || pos < 0 || size > length() - (size_t)pos)
+        return NULL;
+    seek(size, SEEK_CUR);
+    return buffer + pos;
+}
+
 size_t FileStreamAndroid::write(const void* ptr, size_t size, size_t count)
 {
     return 0;
@@ -22,7 +22,8 @@ public:
     enum StreamMode
     {
         READ = 1,
-        WRITE = 2
+        WRITE = 2,
+        MAP = 4
     };
 
     /**
@@ -98,8 +99,39 @@ public:
      */
     static const char* resolvePath(const char* path);
 
+    /**
+     * Mounts an archive of files that are read instead of the files on the filesystem.
+     *
+     * An archive is created from a directory with the -pack option of gameplay-encoder. Its files
+     * are stored with their paths relative to the resource path, and are looked up in the
+     * directory of the archive when they are opened for reading, listed or checked for existence.
+     * The archive is mapped into memory, so opening one of its files does not access the
+     * filesystem, and files that are not compressed can be mapped with Stream::map().
+     *
+     * Archives that are mounted later take precedence over archives that are mounted earlier,
+     * and files that are not in any archive are read from the filesystem.
+     *
+     * @param archivePath The path to the archive, relative to the currently set resource path.
+     *
+     * @return True if the archive was mounted, false if it could not be mapped or is not valid.
+     * @script{ignore}
+     */
+    static bool mountArchive(const char* archivePath);
+
+    /**
+     * Unmounts an archive that was mounted with mountArchive.
+     *
+     * Streams that were opened from the archive remain valid until they are closed.
+     *
+     * @param archivePath The path that the archive was mounted with.
+     * @script{ignore}
+     */
+    static void unmountArchive(const char* archivePath);
+
     /**
      * Lists the files in the specified directory and adds the files to the vector. Excludes directories.
+     *
+     * Files in the directory that are stored in mounted archives are included.
      * 
      * @param dirPath Directory path relative to the path set in <code>setResourcePath(const char*)</code>.
      * @param files The vector to append the files to.
@@ -125,6 +157,12 @@ public:
      * If <code>path</code> is a file path, the file at the specified location is opened relative to the currently set
      * resource path.
      *
+     * When <code>mode</code> includes MAP, a file opened for reading is mapped into memory so that
+     * its contents can be accessed with Stream::map() without being copied. If the file cannot be
+     * mapped, it is opened as a regular stream instead.
+     *
+     * Files that are opened for reading are read from the mounted archives that contain them.
+     *
      * @param path The path to the resource to be opened, relative to the currently set resource path.
      * @param mode The mode used to open the file.
      * 
@@ -139,7 +177,7 @@ public:
      * Opens the specified file.
      *
      * The file at the specified location is opened, relative to the currently set
-     * resource path.
+     * resource path. Files in mounted archives cannot be opened with this method.
      *
      * @param filePath The path to the file to be opened, relative to the currently set resource path.
      * @param mode The mode used to open the file, passed directly to fopen.
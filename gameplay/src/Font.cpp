@@ -3,6 +3,7 @@
 #include "Game.h"
 #include "FileSystem.h"
 #include "Bundle.h"
+#include "ResourceManager.h"
 
 // Default font shaders
 #define FONT_VSH "res/shaders/font.vert"
@@ -11,8 +12,6 @@
 namespace gameplay
 {
 
-static std::vector<Font*> __fontCache;
-
 static Effect* __fontEffect = NULL;
 
 Font::Font() :
@@ -22,13 +21,6 @@ Font::Font() :
 
 Font::~Font()
 {
-    // Remove this Font from the font cache.
-    std::vector<Font*>::iterator itr = std::find(__fontCache.begin(), __fontCache.end(), this);
-    if (itr != __fontCache.end())
-    {
-        __fontCache.erase(itr);
-    }
-
     SAFE_DELETE(_batch);
     SAFE_DELETE_ARRAY(_glyphs);
     SAFE_RELEASE(_texture);
@@ -39,16 +31,17 @@ Font* Font::create(const char* path, const char* id)
     GP_ASSERT(path);
 
     // Search the font cache for a font with the given path and ID.
-    for (size_t i = 0, count = __fontCache.size(); i < count; ++i)
+    std::string key = path;
+    if (id)
     {
-        Font* f = __fontCache[i];
-        GP_ASSERT(f);
-        if (f->_path == path && (id == NULL || f->_id == id))
-        {
-            // Found a match.
-            f->addRef();
-            return f;
-        }
+        key += '#';
+        key += id;
+    }
+    Font* f = static_cast<Font*>(ResourceManager::find(ResourceManager::FONT, key));
+    if (f)
+    {
+        // Found a match.
+        return f;
     }
 
     // Load the bundle.
@@ -81,8 +74,10 @@ Font* Font::create(const char* path, const char* id)
 
     if (font)
     {
-        // Add this font to the cache.
-        __fontCache.push_back(font);
+        // Add this font to the cache, with the size of its glyph texture and table.
+        GP_ASSERT(font->_texture);
+        size_t size = (size_t)font->_texture->getWidth() * font->_texture->getHeight() + font->_glyphCount * sizeof(Glyph);
+        ResourceManager::add(ResourceManager::FONT, key, font, size);
     }
 
     SAFE_RELEASE(bundle);
@@ -17,7 +17,6 @@
 namespace gameplay
 {
 
-static Effect* __formEffect = NULL;
 static std::vector<Form*> __forms;
 
 Form::Form() : _theme(NULL), _frameBuffer(NULL), _spriteBatch(NULL), _node(NULL), _nodeQuad(NULL), _nodeMaterial(NULL) , _u2(0), _v1(0)
@@ -30,15 +29,6 @@ Form::~Form()
     SAFE_RELEASE(_frameBuffer);
     SAFE_RELEASE(_theme);
 
-    if (__formEffect)
-    {
-        if (__formEffect->getRefCount() == 1)
-        {
-            __formEffect->release();
-            __formEffect = NULL;
-        }
-    }
-
     // Remove this Form from the global list.
     std::vector<Form*>::iterator it = std::find(__forms.begin(), __forms.end(), this);
     if (it != __forms.end())
@@ -311,20 +301,12 @@ void Form::setAutoHeight(bool autoHeight)
 
 static Effect* createEffect()
 {
-    Effect* effect = NULL;
-    if (__formEffect == NULL)
+    // The form effect is shared through the effect cache.
+    Effect* effect = Effect::createFromFile(FORM_VSH, FORM_FSH);
+    if (effect == NULL)
     {
-        __formEffect = Effect::createFromFile(FORM_VSH, FORM_FSH);
-        if (__formEffect == NULL)
-        {
-            GP_ERROR("Unable to load form effect.");
-            return NULL;
-        }
-        effect = __formEffect;
-    }
-    else
-    {
-        effect = __formEffect;
+        GP_ERROR("Unable to load form effect.");
+        return NULL;
     }
     return effect;
 }
@@ -362,6 +344,7 @@ void Form::setNode(Node* node)
         Effect* effect = createEffect();
         GP_ASSERT(effect);
         _nodeMaterial = Material::create(effect);
+        SAFE_RELEASE(effect);
 
         GP_ASSERT(_nodeMaterial);
         _nodeQuad->setMaterial(_nodeMaterial);
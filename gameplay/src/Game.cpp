@@ -5,6 +5,8 @@
 #include "FileSystem.h"
 #include "FrameBuffer.h"
 #include "SceneLoader.h"
+#include "AsyncLoad.h"
+#include "ResourceManager.h"
 
 /** @script{ignore} */
 GLenum __gl_error_code = GL_NO_ERROR;
@@ -23,7 +25,7 @@ Game::Game()
       _frameLastFPS(0), _frameCount(0), _frameRate(0),
       _clearDepth(1.0f), _clearStencil(0), _properties(NULL),
       _animationController(NULL), _audioController(NULL),
-      _physicsController(NULL), _aiController(NULL), _audioListener(NULL),
+      _physicsController(NULL), _aiController(NULL), _jobSystem(NULL), _audioListener(NULL),
       _timeEvents(NULL), _scriptController(NULL), _scriptListeners(NULL)
 {
     GP_ASSERT(__gameInstance == NULL);
@@ -98,6 +100,8 @@ bool Game::startup()
     RenderState::initialize();
     FrameBuffer::initialize();
 
+    _jobSystem = new JobSystem(JobSystem::getProcessorCount());
+
     _animationController = new AnimationController();
     _animationController->initialize();
 
@@ -171,6 +175,9 @@ void Game::shutdown()
 		// Call user finalize
         finalize();
 
+        // Finish and release pending asynchronous loads.
+        AsyncLoad::finalize();
+
 		// Shutdown scripting system first so that any objects allocated in script are released before our subsystems are released
 		_scriptController->finalizeGame();
 		if (_scriptListeners)
@@ -183,6 +190,9 @@ void Game::shutdown()
 		}
 		_scriptController->finalize();
 
+        // Release the cached resources before the subsystems they depend on.
+        ResourceManager::finalize();
+
         unsigned int gamepadCount = Gamepad::getGamepadCount();
         for (unsigned int i = 0; i < gamepadCount; i++)
         {
@@ -201,6 +211,8 @@ void Game::shutdown()
         _aiController->finalize();
         SAFE_DELETE(_aiController);
 
+        SAFE_DELETE(_jobSystem);
+
         // Note: we do not clean up the script controller here
         // because users can call Game::exit() from a script.
 
@@ -267,8 +279,13 @@ void Game::exit()
 
 void Game::frame()
 {
+    // Start a new frame in the profiler capture.
+    Profiler::beginFrame();
+    GP_PROFILE_SCOPE("Game::frame");
+
     if (!_initialized)
     {
+        GP_PROFILE_SCOPE("Game::initialize");
         initialize();
         _scriptController->initializeGame();
         _initialized = true;
@@ -291,6 +308,12 @@ void Game::frame()
         float elapsedTime = (frameTime - lastFrameTime);
         lastFrameTime = frameTime;
 
+        // Advance pending asynchronous loads.
+        AsyncLoad::update();
+
+        // Release unreferenced resources that exceed the memory budget.
+        ResourceManager::update();
+
         // Update the scheduled and running animations.
         _animationController->update(elapsedTime);
 
@@ -301,16 +324,25 @@ void Game::frame()
         _aiController->update(elapsedTime);
 
         // Application Update.
-        update(elapsedTime);
+        {
+            GP_PROFILE_SCOPE("Game::update");
+            update(elapsedTime);
+        }
 
         // Run script update.
         _scriptController->update(elapsedTime);
 
         // Audio Rendering.
-        _audioController->update(elapsedTime);
+        {
+            GP_PROFILE_SCOPE("AudioController::update");
+            _audioController->update(elapsedTime);
+        }
 
         // Graphics Rendering.
-        render(elapsedTime);
+        {
+            GP_PROFILE_SCOPE("Game::render");
+            render(elapsedTime);
+        }
 
         // Run script render.
         _scriptController->render(elapsedTime);
@@ -323,6 +355,9 @@ void Game::frame()
             _frameCount = 0;
             _frameLastFPS = getGameTime();
         }
+
+        // Roll over the worker utilization statistics.
+        _jobSystem->endFrame();
     }
 	else if (_state == Game::PAUSED)
     {
@@ -0,0 +1,747 @@
+#include "Base.h"
+#include "JobSystem.h"
+
+#ifdef WIN32
+    #include <windows.h>
+#else
+    #include <pthread.h>
+    #include <sched.h>
+    #include <unistd.h>
+    #include <sys/time.h>
+#endif
+
+// Maximum number of chunks a parallelFor is split into per worker.
+#define JOB_CHUNKS_PER_WORKER 4
+// Maximum number of chunks a single parallelFor is split into.
+#define JOB_MAX_CHUNKS 64
+
+namespace gameplay
+{
+
+// The helper classes below are in anonymous namespaces, so that they do not clash with
+// classes of the same name elsewhere in the gameplay namespace.
+
+#ifdef WIN32
+
+typedef HANDLE ThreadHandle;
+typedef DWORD ThreadKey;
+
+namespace
+{
+
+class Mutex
+{
+public:
+    Mutex() { InitializeCriticalSection(&_cs); }
+    ~Mutex() { DeleteCriticalSection(&_cs); }
+    void lock() { EnterCriticalSection(&_cs); }
+    void unlock() { LeaveCriticalSection(&_cs); }
+    CRITICAL_SECTION _cs;
+};
+
+}
+
+static int atomicAdd(volatile int* value, int amount)
+{
+    return InterlockedExchangeAdd((volatile LONG*)value, amount) + amount;
+}
+
+static void createThreadKey(ThreadKey* key)
+{
+    *key = TlsAlloc();
+}
+
+static void setThreadValue(ThreadKey key, void* value)
+{
+    TlsSetValue(key, value);
+}
+
+static void* getThreadValue(ThreadKey key)
+{
+    return TlsGetValue(key);
+}
+
+static void yieldThread()
+{
+    SwitchToThread();
+}
+
+static double getTime()
+{
+    static LARGE_INTEGER frequency = { 0 };
+    if (frequency.QuadPart == 0)
+        QueryPerformanceFrequency(&frequency);
+    LARGE_INTEGER counter;
+    QueryPerformanceCounter(&counter);
+    return (double)counter.QuadPart * 1000.0 / (double)frequency.QuadPart;
+}
+
+#else
+
+typedef pthread_t ThreadHandle;
+typedef pthread_key_t ThreadKey;
+
+namespace
+{
+
+class Mutex
+{
+public:
+    Mutex() { pthread_mutex_init(&_mutex, NULL); }
+    ~Mutex() { pthread_mutex_destroy(&_mutex); }
+    void lock() { pthread_mutex_lock(&_mutex); }
+    void unlock() { pthread_mutex_unlock(&_mutex); }
+    pthread_mutex_t _mutex;
+};
+
+}
+
+static int atomicAdd(volatile int* value, int amount)
+{
+    return __sync_add_and_fetch(value, amount);
+}
+
+static void createThreadKey(ThreadKey* key)
+{
+    pthread_key_create(key, NULL);
+}
+
+static void setThreadValue(ThreadKey key, void* value)
+{
+    pthread_setspecific(key, value);
+}
+
+static void* getThreadValue(ThreadKey key)
+{
+    return pthread_getspecific(key);
+}
+
+static void yieldThread()
+{
+    sched_yield();
+}
+
+static double getTime()
+{
+    timeval time;
+    gettimeofday(&time, NULL);
+    return (double)time.tv_sec * 1000.0 + (double)time.tv_usec / 1000.0;
+}
+
+#endif
+
+// The key of the thread-local value holding the Worker of each worker thread.
+static ThreadKey __workerKey;
+static bool __workerKeyCreated = false;
+
+namespace
+{
+
+/**
+ * Locks a mutex for the lifetime of the lock.
+ */
+class MutexLock
+{
+public:
+    MutexLock(Mutex& mutex) : _mutex(mutex) { _mutex.lock(); }
+    ~MutexLock() { _mutex.unlock(); }
+private:
+    MutexLock& operator=(const MutexLock&);
+    Mutex& _mutex;
+};
+
+}
+
+/**
+ * The condition that idle workers sleep on until jobs are queued.
+ */
+struct JobSystem::Condition
+{
+#ifdef WIN32
+    Condition() { InitializeConditionVariable(&_condition); }
+    void wait() { SleepConditionVariableCS(&_condition, &_mutex._cs, INFINITE); }
+    void notifyAll() { WakeAllConditionVariable(&_condition); }
+    CONDITION_VARIABLE _condition;
+#else
+    Condition() { pthread_cond_init(&_condition, NULL); }
+    ~Condition() { pthread_cond_destroy(&_condition); }
+    void wait() { pthread_cond_wait(&_condition, &_mutex._mutex); }
+    void notifyAll() { pthread_cond_broadcast(&_condition); }
+    pthread_cond_t _condition;
+#endif
+    Mutex _mutex;
+};
+
+/**
+ * The queue and statistics of a single worker.
+ */
+struct JobSystem::Worker
+{
+    Worker() : system(NULL), index(0), busyTime(0), jobCount(0) { }
+
+    JobSystem* system;
+    int index;
+    ThreadHandle thread;
+    Mutex mutex;
+    std::deque<Job*> jobs;
+    double busyTime;
+    unsigned int jobCount;
+};
+
+namespace
+{
+
+/**
+ * The function and argument that a thread is started with.
+ */
+struct ThreadData
+{
+    int (*function)(void*);
+    void* arg;
+};
+
+}
+
+#ifdef WIN32
+
+static DWORD WINAPI threadProc(LPVOID arg)
+{
+    ThreadData data = *(ThreadData*)arg;
+    delete (ThreadData*)arg;
+    return (DWORD)data.function(data.arg);
+}
+
+static bool createThread(ThreadHandle* handle, int (*function)(void*), void* arg)
+{
+    ThreadData* data = new ThreadData();
+    data->function = function;
+    data->arg = arg;
+    *handle = CreateThread(NULL, 0, &threadProc, data, 0, NULL);
+    if (*handle == NULL)
+    {
+        delete data;
+        return false;
+    }
+    return true;
+}
+
+static void joinThread(ThreadHandle handle)
+{
+    WaitForSingleObject(handle, INFINITE);
+    CloseHandle(handle);
+}
+
+#else
+
+static void* threadProc(void* arg)
+{
+    ThreadData data = *(ThreadData*)arg;
+    delete (ThreadData*)arg;
+    data.function(data.arg);
+    return NULL;
+}
+
+static bool createThread(ThreadHandle* handle, int (*function)(void*), void* arg)
+{
+    ThreadData* data = new ThreadData();
+    data->function = function;
+    data->arg = arg;
+    if (pthread_create(handle, NULL, &threadProc, data) != 0)
+    {
+        delete data;
+        return false;
+    }
+    return true;
+}
+
+static void joinThread(ThreadHandle handle)
+{
+    pthread_join(handle, NULL);
+}
+
+#endif
+
+JobSystem::Job::Job()
+    : _dependencyCount(0), _pendingCount(1), _complete(0)
+{
+}
+
+JobSystem::Job::~Job()
+{
+}
+
+void JobSystem::Job::addDependency(Job* job)
+{
+    GP_ASSERT(job);
+    GP_ASSERT(job != this);
+
+    job->_dependents.push_back(this);
+    ++_dependencyCount;
+    ++_pendingCount;
+}
+
+bool JobSystem::Job::isComplete() const
+{
+    // The atomic read orders the job's results before its completion.
+    return atomicAdd(const_cast<volatile int*>(&_complete), 0) != 0;
+}
+
+void JobSystem::RangeJob::execute()
+{
+    function(start, end, cookie);
+}
+
+JobSystem::JobSystem(unsigned int workerCount)
+    : _injected(NULL), _queuedCount(0), _shutdown(0), _idle(NULL), _background(NULL), _backgroundIdle(NULL),
+      _backgroundShutdown(0), _frameStartTime(getTime()), _jobCount(0)
+{
+    _injected = new Worker();
+    _injected->index = -1;
+    _idle = new Condition();
+    _backgroundIdle = new Condition();
+    if (!__workerKeyCreated)
+    {
+        createThreadKey(&__workerKey);
+        __workerKeyCreated = true;
+    }
+    startWorkers(workerCount);
+}
+
+JobSystem::~JobSystem()
+{
+    stopBackground();
+    stopWorkers();
+    SAFE_DELETE(_backgroundIdle);
+    SAFE_DELETE(_idle);
+    GP_ASSERT(_injected->jobs.empty());
+    SAFE_DELETE(_injected);
+}
+
+unsigned int JobSystem::getProcessorCount()
+{
+#ifdef WIN32
+    SYSTEM_INFO info;
+    GetSystemInfo(&info);
+    return std::max((unsigned int)info.dwNumberOfProcessors, 1u);
+#else
+    long count = sysconf(_SC_NPROCESSORS_ONLN);
+    return count > 0 ? (unsigned int)count : 1u;
+#endif
+}
+
+unsigned int JobSystem::getWorkerCount() const
+{
+    return (unsigned int)_workers.size();
+}
+
+void JobSystem::setWorkerCount(unsigned int count)
+{
+    if (count != _workers.size())
+    {
+        stopWorkers();
+        startWorkers(count);
+    }
+}
+
+bool JobSystem::isMainThread() const
+{
+    return getCurrentWorker() == 0;
+}
+
+void JobSystem::startWorkers(unsigned int count)
+{
+    GP_ASSERT(_workers.empty());
+
+    count = std::max(count, 1u);
+    _shutdown = 0;
+    _utilization.assign(count, 0.0f);
+
+    // Worker zero is the thread that owns the job system.
+    for (unsigned int i = 0; i < count; ++i)
+    {
+        Worker* worker = new Worker();
+        worker->system = this;
+        worker->index = (int)i;
+        _workers.push_back(worker);
+    }
+    setThreadValue(__workerKey, _workers[0]);
+
+    for (unsigned int i = 1; i < count; ++i)
+    {
+        Worker* worker = _workers[i];
+        if (!createThread(&worker->thread, &workerMain, worker))
+        {
+            GP_WARN("Failed to create job system worker thread %u; continuing with %u workers.", i, i);
+            for (unsigned int j = i; j < count; ++j)
+            {
+                SAFE_DELETE(_workers[j]);
+            }
+            _workers.resize(i);
+            _utilization.resize(i);
+            break;
+        }
+    }
+}
+
+void JobSystem::stopWorkers()
+{
+    {
+        MutexLock lock(_idle->_mutex);
+        _shutdown = 1;
+        _idle->notifyAll();
+    }
+
+    for (size_t i = 1, count = _workers.size(); i < count; ++i)
+    {
+        joinThread(_workers[i]->thread);
+    }
+
+    for (size_t i = 0, count = _workers.size(); i < count; ++i)
+    {
+        GP_ASSERT(_workers[i]->jobs.empty());
+        SAFE_DELETE(_workers[i]);
+    }
+    _workers.clear();
+    setThreadValue(__workerKey, NULL);
+}
+
+int JobSystem::workerMain(void* arg)
+{
+    Worker* worker = (Worker*)arg;
+    JobSystem* system = worker->system;
+    setThreadValue(__workerKey, worker);
+
+    while (true)
+    {
+        if (system->runOne(worker->index))
+            continue;
+
+        // Sleep until more jobs are queued.
+        MutexLock lock(system->_idle->_mutex);
+        if (system->_shutdown)
+            break;
+        if (system->_queuedCount == 0)
+            system->_idle->wait();
+    }
+
+    return 0;
+}
+
+bool JobSystem::startBackground()
+{
+    GP_ASSERT(_background == NULL);
+
+    _background = new Worker();
+    _background->system = this;
+    _background->index = -1;
+    _backgroundShutdown = 0;
+    if (!createThread(&_background->thread, &backgroundMain, this))
+    {
+        GP_ERROR("Failed to create job system background thread.");
+        SAFE_DELETE(_background);
+        return false;
+    }
+    return true;
+}
+
+void JobSystem::stopBackground()
+{
+    if (_background == NULL)
+        return;
+
+    {
+        MutexLock lock(_backgroundIdle->_mutex);
+        _backgroundShutdown = 1;
+        _backgroundIdle->notifyAll();
+    }
+    joinThread(_background->thread);
+
+    GP_ASSERT(_background->jobs.empty());
+    SAFE_DELETE(_background);
+}
+
+int JobSystem::backgroundMain(void* arg)
+{
+    JobSystem* system = (JobSystem*)arg;
+    Worker* background = system->_background;
+
+    while (true)
+    {
+        // The background queue is guarded by the mutex of its condition.
+        Job* job = NULL;
+        {
+            MutexLock lock(system->_backgroundIdle->_mutex);
+            while (background->jobs.empty() && !system->_backgroundShutdown)
+                system->_backgroundIdle->wait();
+            if (background->jobs.empty())
+                break;
+            job = background->jobs.front();
+            background->jobs.pop_front();
+        }
+        system->run(job, -1);
+    }
+
+    return 0;
+}
+
+int JobSystem::getCurrentWorker() const
+{
+    Worker* worker = (Worker*)getThreadValue(__workerKey);
+    return worker && worker->system == this ? worker->index : -1;
+}
+
+void JobSystem::submit(Job* job)
+{
+    GP_ASSERT(job);
+
+    job->_complete = 0;
+    if (atomicAdd(&job->_pendingCount, -1) == 0)
+    {
+        push(job, getCurrentWorker());
+        wake();
+    }
+}
+
+void JobSystem::submitBackground(Job* job)
+{
+    GP_ASSERT(job);
+    GP_ASSERT(job->_dependencyCount == 0);
+
+    if (_background == NULL && !startBackground())
+    {
+        // Without a background thread the job runs to completion right away.
+        job->_complete = 0;
+        run(job, getCurrentWorker());
+        return;
+    }
+
+    job->_complete = 0;
+    MutexLock lock(_backgroundIdle->_mutex);
+    _background->jobs.push_back(job);
+    _backgroundIdle->notifyAll();
+}
+
+void JobSystem::wait(Job* job)
+{
+    GP_ASSERT(job);
+
+    int worker = getCurrentWorker();
+    while (!job->isComplete())
+    {
+        if (!runOne(worker))
+            yieldThread();
+    }
+}
+
+void JobSystem::parallelFor(unsigned int count, RangeFunction function, void* cookie, unsigned int grainSize)
+{
+    GP_ASSERT(function);
+
+    if (count == 0)
+        return;
+
+    grainSize = std::max(grainSize, 1u);
+    unsigned int chunkCount = (count + grainSize - 1) / grainSize;
+    chunkCount = std::min(chunkCount, (unsigned int)_workers.size() * JOB_CHUNKS_PER_WORKER);
+    chunkCount = std::min(chunkCount, (unsigned int)JOB_MAX_CHUNKS);
+
+    // Run small ranges directly rather than paying for scheduling.
+    if (chunkCount <= 1)
+    {
+        function(0, count, cookie);
+        return;
+    }
+
+    RangeJob jobs[JOB_MAX_CHUNKS];
+    int worker = getCurrentWorker();
+    unsigned int start = 0;
+    for (unsigned int i = 0; i < chunkCount; ++i)
+    {
+        RangeJob& job = jobs[i];
+        job.function = function;
+        job.cookie = cookie;
+        job.start = start;
+        job.end = start + (count - start) / (chunkCount - i);
+        start = job.end;
+
+        job._complete = 0;
+        job._pendingCount = 0;
+        push(&job, worker);
+    }
+    wake();
+
+    // Help out until all of the chunks are complete.
+    for (unsigned int i = 0; i < chunkCount; ++i)
+    {
+        wait(&jobs[i]);
+    }
+}
+
+void JobSystem::push(Job* job, int worker)
+{
+    // Threads that are not workers, such as the background thread, queue their jobs
+    // on the injection queue so that they are not executed ahead of frame jobs.
+    Worker* target = worker < 0 ? _injected : _workers[worker];
+    {
+        MutexLock lock(target->mutex);
+        target->jobs.push_back(job);
+    }
+    atomicAdd(&_queuedCount, 1);
+}
+
+void JobSystem::wake()
+{
+    if (_workers.size() > 1)
+    {
+        MutexLock lock(_idle->_mutex);
+        _idle->notifyAll();
+    }
+}
+
+JobSystem::Job* JobSystem::pop(int worker)
+{
+    if (_queuedCount == 0)
+        return NULL;
+
+    // Take the most recently queued job from our own queue first. Threads that are
+    // not workers start with the oldest job on the injection queue instead.
+    if (worker >= 0)
+    {
+        Worker* own = _workers[worker];
+        MutexLock lock(own->mutex);
+        if (!own->jobs.empty())
+        {
+            Job* job = own->jobs.back();
+            own->jobs.pop_back();
+            atomicAdd(&_queuedCount, -1);
+            return job;
+        }
+    }
+    else
+    {
+        Job* job = popInjected();
+        if (job)
+            return job;
+    }
+
+    // Steal the oldest job from another worker.
+    size_t count = _workers.size();
+    size_t first = worker < 0 ? 0 : (size_t)worker;
+    for (size_t i = 1; i <= count; ++i)
+    {
+        Worker* victim = _workers[(first + i) % count];
+        MutexLock lock(victim->mutex);
+        if (!victim->jobs.empty())
+        {
+            Job* job = victim->jobs.front();
+            victim->jobs.pop_front();
+            atomicAdd(&_queuedCount, -1);
+            return job;
+        }
+    }
+
+    // The main worker leaves injected jobs to the other workers, unless there are none.
+    if (worker > 0 || (worker == 0 && count == 1))
+        return popInjected();
+
+    return NULL;
+}
+
+JobSystem::Job* JobSystem::popInjected()
+{
+    MutexLock lock(_injected->mutex);
+    if (_injected->jobs.empty())
+        return NULL;
+
+    Job* job = _injected->jobs.front();
+    _injected->jobs.pop_front();
+    atomicAdd(&_queuedCount, -1);
+    return job;
+}
+
+void JobSystem::run(Job* job, int worker)
+{
+    double start = getTime();
+    {
+        GP_PROFILE_SCOPE("JobSystem::run");
+        job->execute();
+    }
+
+    // Schedule the dependents whose last dependency this was.
+    bool pushed = false;
+    for (size_t i = 0, count = job->_dependents.size(); i < count; ++i)
+    {
+        Job* dependent = job->_dependents[i];
+        if (atomicAdd(&dependent->_pendingCount, -1) == 0)
+        {
+            push(dependent, worker);
+            pushed = true;
+        }
+    }
+    if (pushed)
+        wake();
+
+    if (worker >= 0)
+    {
+        Worker* w = _workers[worker];
+        MutexLock lock(w->mutex);
+        w->busyTime += getTime() - start;
+        ++w->jobCount;
+    }
+
+    // Re-arm the job so it can be submitted again. The job must not be
+    // touched after it is marked complete since its owner may destroy it.
+    job->_pendingCount = job->_dependencyCount + 1;
+    atomicAdd(&job->_complete, 1);
+}
+
+bool JobSystem::runOne(int worker)
+{
+    Job* job = pop(worker);
+    if (job == NULL)
+        return false;
+
+    run(job, worker);
+    return true;
+}
+
+void JobSystem::endFrame()
+{
+    double time = getTime();
+    double frameTime = time - _frameStartTime;
+    _frameStartTime = time;
+
+    _jobCount = 0;
+    for (size_t i = 0, count = _workers.size(); i < count; ++i)
+    {
+        Worker* worker = _workers[i];
+        MutexLock lock(worker->mutex);
+        _utilization[i] = frameTime > 0.0 ? (float)std::min(worker->busyTime / frameTime, 1.0) : 0.0f;
+        _jobCount += worker->jobCount;
+        worker->busyTime = 0;
+        worker->jobCount = 0;
+    }
+}
+
+float JobSystem::getWorkerUtilization(unsigned int worker) const
+{
+    GP_ASSERT(worker < _utilization.size());
+    return _utilization[worker];
+}
+
+float JobSystem::getUtilization() const
+{
+    float total = 0.0f;
+    for (size_t i = 0, count = _utilization.size(); i < count; ++i)
+    {
+        total += _utilization[i];
+    }
+    return _utilization.empty() ? 0.0f : total / (float)_utilization.size();
+}
+
+unsigned int JobSystem::getJobCount() const
+{
+    return _jobCount;
+}
+
+}
@@ -0,0 +1,367 @@
+#ifndef JOBSYSTEM_H_
+#define JOBSYSTEM_H_
+
+namespace gameplay
+{
+
+/**
+ * Defines a pool of worker threads that execute jobs in parallel.
+ *
+ * Each worker owns a double-ended queue of jobs. Workers push and pop jobs at the
+ * back of their own queue and, when it is empty, steal jobs from the front of the
+ * queues of other workers. The thread that created the job system (the main game
+ * thread) is worker zero and takes part in executing jobs whenever it waits on them.
+ * Jobs pushed by threads that are not workers go to a separate injection queue, which
+ * the main game thread only takes jobs from when it is the only worker.
+ *
+ * Jobs can depend on other jobs, which allows frame work to be described as a graph
+ * that is scheduled as soon as the dependencies of each job have completed. For data
+ * parallel work, parallelFor splits a range of indices into chunks that are executed
+ * on all workers.
+ *
+ * Long-running work, such as loading files, can be submitted with submitBackground.
+ * Background jobs run on a separate thread, so they never delay threads that wait
+ * on frame jobs.
+ *
+ * The job system is created and owned by the Game and can be accessed with
+ * Game::getJobSystem().
+ */
+class JobSystem
+{
+    friend class Game;
+
+public:
+
+    /**
+     * Defines a unit of work that is executed by the job system.
+     */
+    class Job
+    {
+        friend class JobSystem;
+
+    public:
+
+        /**
+         * Constructor.
+         */
+        Job();
+
+        /**
+         * Destructor.
+         */
+        virtual ~Job();
+
+        /**
+         * Makes this job wait for the given job to complete before it is executed.
+         *
+         * Dependencies must be added before either of the jobs is submitted.
+         *
+         * @param job The job that must complete first.
+         */
+        void addDependency(Job* job);
+
+        /**
+         * Determines if the job has been executed since it was last submitted.
+         *
+         * @return true if the job is complete, false otherwise.
+         */
+        bool isComplete() const;
+
+    protected:
+
+        /**
+         * Called on a worker thread to execute the job.
+         */
+        virtual void execute() = 0;
+
+    private:
+
+        /**
+         * Hidden copy constructor.
+         */
+        Job(const Job& copy);
+
+        /**
+         * Hidden copy assignment operator.
+         */
+        Job& operator=(const Job&);
+
+        std::vector<Job*> _dependents;
+        unsigned int _dependencyCount;
+        volatile int _pendingCount;
+        volatile int _complete;
+    };
+
+    /**
+     * Defines the function that is called by parallelFor for each chunk of indices.
+     *
+     * @param start The first index of the chunk.
+     * @param end One past the last index of the chunk.
+     * @param cookie The cookie passed to parallelFor.
+     */
+    typedef void (*RangeFunction)(unsigned int start, unsigned int end, void* cookie);
+
+    /**
+     * Returns the number of processors available on the device.
+     *
+     * @return The number of processors.
+     */
+    static unsigned int getProcessorCount();
+
+    /**
+     * Returns the number of workers, including the main game thread.
+     *
+     * @return The number of workers.
+     */
+    unsigned int getWorkerCount() const;
+
+    /**
+     * Sets the number of workers, including the main game thread.
+     *
+     * This must not be called while jobs are running. A count of one executes
+     * all jobs on the thread that waits on them.
+     *
+     * @param count The number of workers.
+     */
+    void setWorkerCount(unsigned int count);
+
+    /**
+     * Returns whether the calling thread is the main game thread, which is worker zero.
+     *
+     * @return true if the calling thread is the main game thread, false otherwise.
+     */
+    bool isMainThread() const;
+
+    /**
+     * Submits a job for execution.
+     *
+     * The job is executed as soon as all of its dependencies have completed.
+     * A job can be submitted again once it is complete.
+     *
+     * @param job The job to execute.
+     */
+    void submit(Job* job);
+
+    /**
+     * Submits a long-running job for execution on the background thread.
+     *
+     * Background jobs are executed one at a time in the order they were submitted,
+     * and are never executed by workers or by threads waiting on other jobs. A background
+     * job must not have dependencies, but it may submit and wait on other jobs. Use
+     * Job::isComplete to poll for completion.
+     *
+     * @param job The job to execute.
+     */
+    void submitBackground(Job* job);
+
+    /**
+     * Waits for the given job to complete, executing other jobs while waiting.
+     *
+     * @param job The job to wait for.
+     */
+    void wait(Job* job);
+
+    /**
+     * Calls the given function for chunks of the index range [0, count) on all workers
+     * and returns once all chunks have been executed.
+     *
+     * @param count The number of indices.
+     * @param function The function to call for each chunk.
+     * @param cookie The user data to pass to the function.
+     * @param grainSize The minimum number of indices per chunk.
+     * @script{ignore}
+     */
+    void parallelFor(unsigned int count, RangeFunction function, void* cookie, unsigned int grainSize = 1);
+
+    /**
+     * Calls the given method for chunks of the index range [0, count) on all workers
+     * and returns once all chunks have been executed.
+     *
+     * @param count The number of indices.
+     * @param instance The instance to call the method on.
+     * @param method The method to call for each chunk, taking the first index and one past the last index.
+     * @param grainSize The minimum number of indices per chunk.
+     * @script{ignore}
+     */
+    template <class T>
+    void parallelFor(unsigned int count, T* instance, void (T::*method)(unsigned int, unsigned int), unsigned int grainSize = 1);
+
+    /**
+     * Returns the fraction of the last frame that the given worker spent executing jobs.
+     *
+     * @param worker The index of the worker, where zero is the main game thread.
+     *
+     * @return The utilization of the worker in the range [0, 1].
+     */
+    float getWorkerUtilization(unsigned int worker) const;
+
+    /**
+     * Returns the fraction of the last frame that all workers spent executing jobs.
+     *
+     * @return The average utilization of the workers in the range [0, 1].
+     */
+    float getUtilization() const;
+
+    /**
+     * Returns the number of jobs executed during the last frame.
+     *
+     * @return The number of executed jobs.
+     */
+    unsigned int getJobCount() const;
+
+private:
+
+    struct Worker;
+    struct Condition;
+
+    /**
+     * A job executing one chunk of a parallelFor.
+     */
+    class RangeJob : public Job
+    {
+    public:
+        void execute();
+        RangeFunction function;
+        void* cookie;
+        unsigned int start;
+        unsigned int end;
+    };
+
+    /**
+     * Adapts a member function to a RangeFunction.
+     */
+    template <class T>
+    struct MethodRange
+    {
+        static void call(unsigned int start, unsigned int end, void* cookie);
+        T* instance;
+        void (T::*method)(unsigned int, unsigned int);
+    };
+
+    /**
+     * Constructor.
+     *
+     * @param workerCount The number of workers, including the calling thread.
+     */
+    JobSystem(unsigned int workerCount);
+
+    /**
+     * Destructor.
+     */
+    ~JobSystem();
+
+    /**
+     * Hidden copy constructor.
+     */
+    JobSystem(const JobSystem& copy);
+
+    /**
+     * Hidden copy assignment operator.
+     */
+    JobSystem& operator=(const JobSystem&);
+
+    /**
+     * Starts the worker threads.
+     */
+    void startWorkers(unsigned int count);
+
+    /**
+     * Stops and joins the worker threads.
+     */
+    void stopWorkers();
+
+    /**
+     * Starts the background thread.
+     */
+    bool startBackground();
+
+    /**
+     * Runs the queued background jobs and joins the background thread.
+     */
+    void stopBackground();
+
+    /**
+     * Returns the index of the worker running on the calling thread, or -1 if the
+     * calling thread is not a worker.
+     */
+    int getCurrentWorker() const;
+
+    /**
+     * Pushes a job whose dependencies have completed to the queue of the given worker.
+     */
+    void push(Job* job, int worker);
+
+    /**
+     * Wakes sleeping workers after jobs have been pushed.
+     */
+    void wake();
+
+    /**
+     * Pops a job from the given worker's queue, or steals one from another worker.
+     */
+    Job* pop(int worker);
+
+    /**
+     * Pops the oldest job from the injection queue.
+     */
+    Job* popInjected();
+
+    /**
+     * Executes a job and schedules the dependents that became ready.
+     */
+    void run(Job* job, int worker);
+
+    /**
+     * Pops and executes a single job.
+     *
+     * @return true if a job was executed, false if no jobs were queued.
+     */
+    bool runOne(int worker);
+
+    /**
+     * Rolls the utilization statistics over to a new frame.
+     */
+    void endFrame();
+
+    /**
+     * The entry point of each worker thread.
+     */
+    static int workerMain(void* arg);
+
+    /**
+     * The entry point of the background thread.
+     */
+    static int backgroundMain(void* arg);
+
+    std::vector<Worker*> _workers;
+    Worker* _injected;
+    volatile int _queuedCount;
+    volatile int _shutdown;
+    Condition* _idle;
+    Worker* _background;
+    Condition* _backgroundIdle;
+    volatile int _backgroundShutdown;
+    double _frameStartTime;
+    std::vector<float> _utilization;
+    unsigned int _jobCount;
+};
+
+template <class T>
+void JobSystem::MethodRange<T>::call(unsigned int start, unsigned int end, void* cookie)
+{
+    MethodRange<T>* range = (MethodRange<T>*)cookie;
+    (range->instance->*range->method)(start, end);
+}
+
+template <class T>
+void JobSystem::parallelFor(unsigned int count, T* instance, void (T::*method)(unsigned int, unsigned int), unsigned int grainSize)
+{
+    MethodRange<T> range;
+    range.instance = instance;
+    range.method = method;
+    parallelFor(count, &MethodRange<T>::call, &range, grainSize);
+}
+
+}
+
+#endif
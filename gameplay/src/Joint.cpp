@@ -6,7 +6,7 @@ namespace gameplay
 {
 
 Joint::Joint(const char* id)
-    : Node(id), _jointMatrixDirty(true), _skinCount(0)
+    : Node(id), _generation(1), _bindPoseGeneration(1), _skinCount(0)
 {
 }
 
@@ -38,28 +38,7 @@ Node::Type Joint::getType() const
 void Joint::transformChanged()
 {
     Node::transformChanged();
-    _jointMatrixDirty = true;
-}
-
-void Joint::updateJointMatrix(const Matrix& bindShape, Vector4* matrixPalette)
-{
-    // Note: If more than one MeshSkin influences this Joint, we need to skip
-    // the _jointMatrixDirty optimization since updateJointMatrix() may be
-    // called multiple times a frame with different bindShape matrices (and
-    // different matrixPallete pointers).
-    if (_skinCount > 1 || _jointMatrixDirty)
-    {
-        _jointMatrixDirty = false;
-
-        static Matrix t;
-        Matrix::multiply(Node::getWorldMatrix(), getInverseBindPose(), &t);
-        Matrix::multiply(t, bindShape, &t);
-
-        GP_ASSERT(matrixPalette);
-        matrixPalette[0].set(t.m[0], t.m[4], t.m[8], t.m[12]);
-        matrixPalette[1].set(t.m[1], t.m[5], t.m[9], t.m[13]);
-        matrixPalette[2].set(t.m[2], t.m[6], t.m[10], t.m[14]);
-    }
+    ++_generation;
 }
 
 const Matrix& Joint::getInverseBindPose() const
@@ -70,7 +49,7 @@ const Matrix& Joint::getInverseBindPose() const
 void Joint::setInverseBindPose(const Matrix& m)
 {
     _bindPose = m;
-    _jointMatrixDirty = true;
+    ++_bindPoseGeneration;
 }
 
 }
@@ -70,14 +70,6 @@ protected:
      */
     void setInverseBindPose(const Matrix& m);
 
-    /**
-     * Updates the joint matrix.
-     * 
-     * @param bindShape The bind shape matrix.
-     * @param matrixPalette The matrix palette to update.
-     */
-    void updateJointMatrix(const Matrix& bindShape, Vector4* matrixPalette);
-
     /**
      * Called when this Joint's transform changes.
      */
@@ -103,9 +95,15 @@ protected:
     Matrix _bindPose;
     
     /** 
-     * Flag used to mark if the Joint's matrix is dirty.
+     * Incremented whenever the Joint's world matrix changes.
+     * Each MeshSkin compares it to the generation it last built its palette from.
+     */
+    unsigned int _generation;
+
+    /** 
+     * Incremented whenever the Joint's inverse bind pose changes.
      */
-    bool _jointMatrixDirty;
+    unsigned int _bindPoseGeneration;
     
     /** 
      * The number of MeshSkin's influencing the Joint.
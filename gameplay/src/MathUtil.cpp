@@ -25,4 +25,156 @@ void MathUtil::smooth(float* x, float target, float elapsedTime, float riseTime,
     }
 }
 
+#ifdef USE_SSE
+static inline void storeVector3(float* dst, __m128 v)
+{
+    _mm_storel_pi((__m64*)dst, v);
+    _mm_store_ss(&dst[2], _mm_movehl_ps(v, v));
+}
+#endif
+
+void MathUtil::multiplyMatrices(const float* m1, const float* m2, unsigned int count, float* dst)
+{
+    GP_ASSERT(count == 0 || (m1 && m2 && dst));
+
+    for (unsigned int i = 0; i < count; ++i, m1 += 16, m2 += 16, dst += 16)
+    {
+        multiplyMatrix(m1, m2, dst);
+    }
+}
+
+void MathUtil::multiplyMatricesToRows(const float* const* m1, const float* const* m2, unsigned int count, float* const* dst)
+{
+    GP_ASSERT(count == 0 || (m1 && m2 && dst));
+
+#ifdef USE_SSE
+    for (unsigned int i = 0; i < count; ++i)
+    {
+        const float* a = m1[i];
+        const float* b = m2[i];
+        __m128 c0 = _mm_loadu_ps(&a[0]);
+        __m128 c1 = _mm_loadu_ps(&a[4]);
+        __m128 c2 = _mm_loadu_ps(&a[8]);
+        __m128 c3 = _mm_loadu_ps(&a[12]);
+        __m128 r0 = transformColumns(c0, c1, c2, c3, &b[0]);
+        __m128 r1 = transformColumns(c0, c1, c2, c3, &b[4]);
+        __m128 r2 = transformColumns(c0, c1, c2, c3, &b[8]);
+        __m128 r3 = transformColumns(c0, c1, c2, c3, &b[12]);
+
+        // The product is stored by columns, so transposing it yields its rows.
+        _MM_TRANSPOSE4_PS(r0, r1, r2, r3);
+        _mm_storeu_ps(&dst[i][0], r0);
+        _mm_storeu_ps(&dst[i][4], r1);
+        _mm_storeu_ps(&dst[i][8], r2);
+    }
+#else
+    float product[16];
+    for (unsigned int i = 0; i < count; ++i)
+    {
+        multiplyMatrix(m1[i], m2[i], product);
+        float* rows = dst[i];
+        for (unsigned int r = 0; r < 3; ++r, rows += 4)
+        {
+            rows[0] = product[r];
+            rows[1] = product[r + 4];
+            rows[2] = product[r + 8];
+            rows[3] = product[r + 12];
+        }
+    }
+#endif
+}
+
+void MathUtil::transformPoints(const float* m, const float* points, unsigned int count, float* dst)
+{
+    GP_ASSERT(m);
+    GP_ASSERT(count == 0 || (points && dst));
+
+#ifdef USE_SSE
+    // Keep the columns of the matrix in registers for the whole batch.
+    __m128 c0 = _mm_loadu_ps(&m[0]);
+    __m128 c1 = _mm_loadu_ps(&m[4]);
+    __m128 c2 = _mm_loadu_ps(&m[8]);
+    __m128 c3 = _mm_loadu_ps(&m[12]);
+    for (unsigned int i = 0; i < count; ++i, points += 3, dst += 3)
+    {
+        __m128 r = _mm_add_ps(c3, _mm_mul_ps(c0, _mm_set1_ps(points[0])));
+        r = _mm_add_ps(r, _mm_mul_ps(c1, _mm_set1_ps(points[1])));
+        r = _mm_add_ps(r, _mm_mul_ps(c2, _mm_set1_ps(points[2])));
+        storeVector3(dst, r);
+    }
+#else
+    for (unsigned int i = 0; i < count; ++i, points += 3, dst += 3)
+    {
+        transformVector4(m, points[0], points[1], points[2], 1.0f, dst);
+    }
+#endif
+}
+
+void MathUtil::transformVectors(const float* m, const float* vectors, unsigned int count, float* dst)
+{
+    GP_ASSERT(m);
+    GP_ASSERT(count == 0 || (vectors && dst));
+
+#ifdef USE_SSE
+    __m128 c0 = _mm_loadu_ps(&m[0]);
+    __m128 c1 = _mm_loadu_ps(&m[4]);
+    __m128 c2 = _mm_loadu_ps(&m[8]);
+    __m128 c3 = _mm_loadu_ps(&m[12]);
+    for (unsigned int i = 0; i < count; ++i, vectors += 4, dst += 4)
+    {
+        _mm_storeu_ps(dst, transformColumns(c0, c1, c2, c3, vectors));
+    }
+#else
+    for (unsigned int i = 0; i < count; ++i, vectors += 4, dst += 4)
+    {
+        transformVector4(m, vectors, dst);
+    }
+#endif
+}
+
+void MathUtil::transformBoxes(const float* m, const float* boxes, unsigned int count, float* dst)
+{
+    GP_ASSERT(m);
+    GP_ASSERT(count == 0 || (boxes && dst));
+
+    // Each axis of the box contributes the smaller and the larger of its scaled matrix
+    // column to the new min and max, which bounds the eight transformed corners.
+#ifdef USE_SSE
+    __m128 c[3] = { _mm_loadu_ps(&m[0]), _mm_loadu_ps(&m[4]), _mm_loadu_ps(&m[8]) };
+    __m128 t = _mm_loadu_ps(&m[12]);
+    for (unsigned int i = 0; i < count; ++i, boxes += 6, dst += 6)
+    {
+        __m128 min = t;
+        __m128 max = t;
+        for (unsigned int k = 0; k < 3; ++k)
+        {
+            __m128 a = _mm_mul_ps(c[k], _mm_set1_ps(boxes[k]));
+            __m128 b = _mm_mul_ps(c[k], _mm_set1_ps(boxes[k + 3]));
+            min = _mm_add_ps(min, _mm_min_ps(a, b));
+            max = _mm_add_ps(max, _mm_max_ps(a, b));
+        }
+        storeVector3(&dst[0], min);
+        storeVector3(&dst[3], max);
+    }
+#else
+    for (unsigned int i = 0; i < count; ++i, boxes += 6, dst += 6)
+    {
+        float min[3] = { m[12], m[13], m[14] };
+        float max[3] = { m[12], m[13], m[14] };
+        for (unsigned int k = 0; k < 3; ++k)
+        {
+            for (unsigned int j = 0; j < 3; ++j)
+            {
+                float a = m[k * 4 + j] * boxes[k];
+                float b = m[k * 4 + j] * boxes[k + 3];
+                min[j] += a < b ? a : b;
+                max[j] += a < b ? b : a;
+            }
+        }
+        memcpy(&dst[0], min, sizeof(min));
+        memcpy(&dst[3], max, sizeof(max));
+    }
+#endif
+}
+
 }
@@ -10,6 +10,8 @@ class MathUtil
 {
     friend class Matrix;
     friend class Vector3;
+    friend class BoundingBox;
+    friend class MeshSkin;
 
 public:
 
@@ -64,6 +66,37 @@ private:
 
     inline static void crossVector3(const float* v1, const float* v2, float* dst);
 
+    /**
+     * Multiplies count pairs of matrices, where dst[i] = m1[i] * m2[i].
+     */
+    static void multiplyMatrices(const float* m1, const float* m2, unsigned int count, float* dst);
+
+    /**
+     * Multiplies count pairs of matrices given by pointer, and stores the first three rows
+     * of each product m1[i] * m2[i] as twelve floats at dst[i], as used by skinning palettes.
+     */
+    static void multiplyMatricesToRows(const float* const* m1, const float* const* m2, unsigned int count, float* const* dst);
+
+    /**
+     * Transforms count points of three components by the given matrix, with an implied w of one.
+     */
+    static void transformPoints(const float* m, const float* points, unsigned int count, float* dst);
+
+    /**
+     * Transforms count vectors of four components by the given matrix.
+     */
+    static void transformVectors(const float* m, const float* vectors, unsigned int count, float* dst);
+
+    /**
+     * Transforms count axis-aligned boxes, each stored as its min and max points, by the given
+     * affine matrix and stores the axis-aligned boxes that bound the results.
+     */
+    static void transformBoxes(const float* m, const float* boxes, unsigned int count, float* dst);
+
+#ifdef USE_SSE
+    inline static __m128 transformColumns(__m128 c0, __m128 c1, __m128 c2, __m128 c3, const float* v);
+#endif
+
     MathUtil();
 };
 
@@ -73,6 +106,8 @@ private:
 
 #ifdef USE_NEON
 #include "MathUtilNeon.inl"
+#elif defined(USE_SSE)
+#include "MathUtilSSE.inl"
 #else
 #include "MathUtil.inl"
 #endif
@@ -0,0 +1,118 @@
+namespace gameplay
+{
+
+inline void MathUtil::addMatrix(const float* m, float scalar, float* dst)
+{
+    __m128 s = _mm_set1_ps(scalar);
+    _mm_storeu_ps(&dst[0],  _mm_add_ps(_mm_loadu_ps(&m[0]),  s));
+    _mm_storeu_ps(&dst[4],  _mm_add_ps(_mm_loadu_ps(&m[4]),  s));
+    _mm_storeu_ps(&dst[8],  _mm_add_ps(_mm_loadu_ps(&m[8]),  s));
+    _mm_storeu_ps(&dst[12], _mm_add_ps(_mm_loadu_ps(&m[12]), s));
+}
+
+inline void MathUtil::addMatrix(const float* m1, const float* m2, float* dst)
+{
+    _mm_storeu_ps(&dst[0],  _mm_add_ps(_mm_loadu_ps(&m1[0]),  _mm_loadu_ps(&m2[0])));
+    _mm_storeu_ps(&dst[4],  _mm_add_ps(_mm_loadu_ps(&m1[4]),  _mm_loadu_ps(&m2[4])));
+    _mm_storeu_ps(&dst[8],  _mm_add_ps(_mm_loadu_ps(&m1[8]),  _mm_loadu_ps(&m2[8])));
+    _mm_storeu_ps(&dst[12], _mm_add_ps(_mm_loadu_ps(&m1[12]), _mm_loadu_ps(&m2[12])));
+}
+
+inline void MathUtil::subtractMatrix(const float* m1, const float* m2, float* dst)
+{
+    _mm_storeu_ps(&dst[0],  _mm_sub_ps(_mm_loadu_ps(&m1[0]),  _mm_loadu_ps(&m2[0])));
+    _mm_storeu_ps(&dst[4],  _mm_sub_ps(_mm_loadu_ps(&m1[4]),  _mm_loadu_ps(&m2[4])));
+    _mm_storeu_ps(&dst[8],  _mm_sub_ps(_mm_loadu_ps(&m1[8]),  _mm_loadu_ps(&m2[8])));
+    _mm_storeu_ps(&dst[12], _mm_sub_ps(_mm_loadu_ps(&m1[12]), _mm_loadu_ps(&m2[12])));
+}
+
+inline void MathUtil::multiplyMatrix(const float* m, float scalar, float* dst)
+{
+    __m128 s = _mm_set1_ps(scalar);
+    _mm_storeu_ps(&dst[0],  _mm_mul_ps(_mm_loadu_ps(&m[0]),  s));
+    _mm_storeu_ps(&dst[4],  _mm_mul_ps(_mm_loadu_ps(&m[4]),  s));
+    _mm_storeu_ps(&dst[8],  _mm_mul_ps(_mm_loadu_ps(&m[8]),  s));
+    _mm_storeu_ps(&dst[12], _mm_mul_ps(_mm_loadu_ps(&m[12]), s));
+}
+
+inline __m128 MathUtil::transformColumns(__m128 c0, __m128 c1, __m128 c2, __m128 c3, const float* v)
+{
+    // c0 * v[0] + c1 * v[1] + c2 * v[2] + c3 * v[3]
+    __m128 x = _mm_loadu_ps(v);
+    __m128 r = _mm_mul_ps(c0, _mm_shuffle_ps(x, x, _MM_SHUFFLE(0, 0, 0, 0)));
+    r = _mm_add_ps(r, _mm_mul_ps(c1, _mm_shuffle_ps(x, x, _MM_SHUFFLE(1, 1, 1, 1))));
+    r = _mm_add_ps(r, _mm_mul_ps(c2, _mm_shuffle_ps(x, x, _MM_SHUFFLE(2, 2, 2, 2))));
+    return _mm_add_ps(r, _mm_mul_ps(c3, _mm_shuffle_ps(x, x, _MM_SHUFFLE(3, 3, 3, 3))));
+}
+
+inline void MathUtil::multiplyMatrix(const float* m1, const float* m2, float* dst)
+{
+    __m128 c0 = _mm_loadu_ps(&m1[0]);
+    __m128 c1 = _mm_loadu_ps(&m1[4]);
+    __m128 c2 = _mm_loadu_ps(&m1[8]);
+    __m128 c3 = _mm_loadu_ps(&m1[12]);
+
+    // Support the case where m1 or m2 is the same array as dst.
+    __m128 p0 = transformColumns(c0, c1, c2, c3, &m2[0]);
+    __m128 p1 = transformColumns(c0, c1, c2, c3, &m2[4]);
+    __m128 p2 = transformColumns(c0, c1, c2, c3, &m2[8]);
+    __m128 p3 = transformColumns(c0, c1, c2, c3, &m2[12]);
+
+    _mm_storeu_ps(&dst[0],  p0);
+    _mm_storeu_ps(&dst[4],  p1);
+    _mm_storeu_ps(&dst[8],  p2);
+    _mm_storeu_ps(&dst[12], p3);
+}
+
+inline void MathUtil::negateMatrix(const float* m, float* dst)
+{
+    __m128 zero = _mm_setzero_ps();
+    _mm_storeu_ps(&dst[0],  _mm_sub_ps(zero, _mm_loadu_ps(&m[0])));
+    _mm_storeu_ps(&dst[4],  _mm_sub_ps(zero, _mm_loadu_ps(&m[4])));
+    _mm_storeu_ps(&dst[8],  _mm_sub_ps(zero, _mm_loadu_ps(&m[8])));
+    _mm_storeu_ps(&dst[12], _mm_sub_ps(zero, _mm_loadu_ps(&m[12])));
+}
+
+inline void MathUtil::transposeMatrix(const float* m, float* dst)
+{
+    __m128 c0 = _mm_loadu_ps(&m[0]);
+    __m128 c1 = _mm_loadu_ps(&m[4]);
+    __m128 c2 = _mm_loadu_ps(&m[8]);
+    __m128 c3 = _mm_loadu_ps(&m[12]);
+    _MM_TRANSPOSE4_PS(c0, c1, c2, c3);
+    _mm_storeu_ps(&dst[0],  c0);
+    _mm_storeu_ps(&dst[4],  c1);
+    _mm_storeu_ps(&dst[8],  c2);
+    _mm_storeu_ps(&dst[12], c3);
+}
+
+inline void MathUtil::transformVector4(const float* m, float x, float y, float z, float w, float* dst)
+{
+    float v[4] = { x, y, z, w };
+    __m128 r = transformColumns(_mm_loadu_ps(&m[0]), _mm_loadu_ps(&m[4]), _mm_loadu_ps(&m[8]), _mm_loadu_ps(&m[12]), v);
+
+    // Only the x, y and z components are written.
+    _mm_storel_pi((__m64*)dst, r);
+    _mm_store_ss(&dst[2], _mm_movehl_ps(r, r));
+}
+
+inline void MathUtil::transformVector4(const float* m, const float* v, float* dst)
+{
+    // Handle case where v == dst.
+    __m128 r = transformColumns(_mm_loadu_ps(&m[0]), _mm_loadu_ps(&m[4]), _mm_loadu_ps(&m[8]), _mm_loadu_ps(&m[12]), v);
+    _mm_storeu_ps(dst, r);
+}
+
+inline void MathUtil::crossVector3(const float* v1, const float* v2, float* dst)
+{
+    // Vectors have three components, which is too few to benefit from SSE.
+    float x = (v1[1] * v2[2]) - (v1[2] * v2[1]);
+    float y = (v1[2] * v2[0]) - (v1[0] * v2[2]);
+    float z = (v1[0] * v2[1]) - (v1[1] * v2[0]);
+
+    dst[0] = x;
+    dst[1] = y;
+    dst[2] = z;
+}
+
+}
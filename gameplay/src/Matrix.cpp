@@ -727,6 +727,11 @@ void Matrix::multiply(const Matrix& m1, const Matrix& m2, Matrix* dst)
     MathUtil::multiplyMatrix(m1.m, m2.m, dst->m);
 }
 
+void Matrix::multiply(const Matrix* m1, const Matrix* m2, unsigned int count, Matrix* dst)
+{
+    MathUtil::multiplyMatrices((const float*)m1, (const float*)m2, count, (float*)dst);
+}
+
 void Matrix::negate()
 {
     negate(this);
@@ -927,6 +932,16 @@ void Matrix::transformVector(const Vector4& vector, Vector4* dst) const
     MathUtil::transformVector4(m, (const float*) &vector, (float*)dst);
 }
 
+void Matrix::transformPoints(const Vector3* points, unsigned int count, Vector3* dst) const
+{
+    MathUtil::transformPoints(m, (const float*)points, count, (float*)dst);
+}
+
+void Matrix::transformVectors(const Vector4* vectors, unsigned int count, Vector4* dst) const
+{
+    MathUtil::transformVectors(m, (const float*)vectors, count, (float*)dst);
+}
+
 void Matrix::translate(float x, float y, float z)
 {
     translate(x, y, z, this);
@@ -515,6 +515,20 @@ public:
      */
     static void multiply(const Matrix& m1, const Matrix& m2, Matrix* dst);
 
+    /**
+     * Multiplies each matrix in m1 by the matrix at the same index in m2 and stores
+     * the results in dst.
+     *
+     * The arrays may be the same, in which case the products replace their factors.
+     *
+     * @param m1 The first matrices to multiply.
+     * @param m2 The second matrices to multiply.
+     * @param count The number of matrices in each array.
+     * @param dst An array of count matrices to store the results in.
+     * @script{ignore}
+     */
+    static void multiply(const Matrix* m1, const Matrix* m2, unsigned int count, Matrix* dst);
+
     /**
      * Negates this matrix.
      */
@@ -750,6 +764,18 @@ public:
      */
     void transformPoint(const Vector3& point, Vector3* dst) const;
 
+    /**
+     * Transforms an array of points by this matrix, and stores
+     * the results in dst.
+     *
+     * @param points The points to transform.
+     * @param count The number of points.
+     * @param dst An array of count vectors to store the transformed points in,
+     *      which may be the same array as points.
+     * @script{ignore}
+     */
+    void transformPoints(const Vector3* points, unsigned int count, Vector3* dst) const;
+
     /**
      * Transforms the specified vector by this matrix by
      * treating the fourth (w) coordinate as zero.
@@ -798,6 +824,18 @@ public:
      */
     void transformVector(const Vector4& vector, Vector4* dst) const;
 
+    /**
+     * Transforms an array of vectors by this matrix, and stores
+     * the results in dst.
+     *
+     * @param vectors The vectors to transform.
+     * @param count The number of vectors.
+     * @param dst An array of count vectors to store the transformed vectors in,
+     *      which may be the same array as vectors.
+     * @script{ignore}
+     */
+    void transformVectors(const Vector4* vectors, unsigned int count, Vector4* dst) const;
+
     /**
      * Post-multiplies this matrix by the matrix corresponding to the
      * specified translation.
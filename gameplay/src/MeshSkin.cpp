@@ -1,15 +1,25 @@
 #include "Base.h"
 #include "MeshSkin.h"
 #include "Joint.h"
+#include "Game.h"
+#include "MathUtil.h"
+#include "SkinDeformer.h"
 
 // The number of rows in each palette matrix.
 #define PALETTE_ROWS 3
 
+// The listener cookies of the parent of the root joint and of the joints.
+#define COOKIE_ROOT_JOINT_PARENT 1
+#define COOKIE_JOINT 2
+
 namespace gameplay
 {
 
+static unsigned int __maxPaletteJointCount = 0;
+
 MeshSkin::MeshSkin()
-    : _rootJoint(NULL), _rootNode(NULL), _matrixPalette(NULL), _model(NULL)
+    : _rootJoint(NULL), _rootNode(NULL), _matrixPalette(NULL), _model(NULL), _matrixPaletteDirty(true),
+      _matrixPaletteGeneration(0), _boundsDirty(true)
 {
 }
 
@@ -28,6 +38,7 @@ const Matrix& MeshSkin::getBindShape() const
 void MeshSkin::setBindShape(const float* matrix)
 {
     _bindShape.set(matrix);
+    _matrixPaletteDirty = true;
 }
 
 unsigned int MeshSkin::getJointCount() const
@@ -60,7 +71,11 @@ Joint* MeshSkin::getJoint(const char* id) const
 MeshSkin* MeshSkin::clone(NodeCloneContext &context) const
 {
     MeshSkin* skin = new MeshSkin();
-    skin->_bindShape = _bindShape;
+    skin->setBindShape(_bindShape.m);
+    if (!_jointBounds.empty())
+    {
+        skin->setJointBounds(&_jointBounds[0], (unsigned int)_jointBounds.size());
+    }
     if (_rootNode && _rootJoint)
     {
         const unsigned int jointCount = getJointCount();
@@ -133,6 +148,11 @@ void MeshSkin::setJointCount(unsigned int jointCount)
             _matrixPalette[i+2].set(0.0f, 0.0f, 1.0f, 0.0f);
         }
     }
+
+    _jointGenerations.assign(jointCount, 0);
+    _bindPoseGenerations.assign(jointCount, 0);
+    _bindMatrices.resize(jointCount);
+    _matrixPaletteDirty = true;
 }
 
 void MeshSkin::setJoint(Joint* joint, unsigned int index)
@@ -141,6 +161,7 @@ void MeshSkin::setJoint(Joint* joint, unsigned int index)
 
     if (_joints[index])
     {
+        setJointListener(_joints[index], false);
         _joints[index]->_skinCount--;
         SAFE_RELEASE(_joints[index]);
     }
@@ -151,19 +172,175 @@ void MeshSkin::setJoint(Joint* joint, unsigned int index)
     {
         joint->addRef();
         joint->_skinCount++;
+        setJointListener(joint, true);
     }
+    _matrixPaletteDirty = true;
 }
 
 Vector4* MeshSkin::getMatrixPalette() const
 {
     GP_ASSERT(_matrixPalette);
 
+    updateMatrixPalette();
+    return _matrixPalette;
+}
+
+void MeshSkin::updateMatrixPalette() const
+{
+    // Resolving a world matrix brings the generations of joints that moved with an
+    // ancestor in a flat transform hierarchy up to date.
+    if (!_joints.empty())
+    {
+        _joints[0]->getWorldMatrix();
+    }
+
+    _dirtyWorldMatrices.clear();
+    _dirtyBindMatrices.clear();
+    _dirtyPaletteRows.clear();
+
     for (size_t i = 0, count = _joints.size(); i < count; i++)
     {
-        GP_ASSERT(_joints[i]);
-        _joints[i]->updateJointMatrix(getBindShape(), &_matrixPalette[i * PALETTE_ROWS]);
+        Joint* joint = _joints[i];
+        GP_ASSERT(joint);
+
+        bool bindMatrixChanged = _matrixPaletteDirty || _bindPoseGenerations[i] != joint->_bindPoseGeneration;
+        if (bindMatrixChanged)
+        {
+            Matrix::multiply(joint->getInverseBindPose(), _bindShape, &_bindMatrices[i]);
+            _bindPoseGenerations[i] = joint->_bindPoseGeneration;
+        }
+
+        if (bindMatrixChanged || _jointGenerations[i] != joint->_generation)
+        {
+            _jointGenerations[i] = joint->_generation;
+            _dirtyWorldMatrices.push_back(joint->getWorldMatrix().m);
+            _dirtyBindMatrices.push_back(_bindMatrices[i].m);
+            _dirtyPaletteRows.push_back(&_matrixPalette[i * PALETTE_ROWS].x);
+        }
+    }
+    _matrixPaletteDirty = false;
+
+    if (!_dirtyPaletteRows.empty())
+    {
+        ++_matrixPaletteGeneration;
+    }
+
+    // Each palette matrix is the joint's world matrix * inverse bind pose * bind shape,
+    // stored as the first three rows of the product.
+    if (!_dirtyPaletteRows.empty())
+    {
+        MathUtil::multiplyMatricesToRows(&_dirtyWorldMatrices[0], &_dirtyBindMatrices[0],
+            (unsigned int)_dirtyPaletteRows.size(), &_dirtyPaletteRows[0]);
     }
-    return _matrixPalette;
+}
+
+void MeshSkin::updateMatrixPalettes(MeshSkin* const* skins, unsigned int count)
+{
+    GP_ASSERT(count == 0 || skins);
+
+    // Resolving a world matrix updates the cached transforms of the joint and its
+    // ancestors, which may be shared by several skins, so it is done up front.
+    for (unsigned int i = 0; i < count; ++i)
+    {
+        GP_ASSERT(skins[i] && skins[i]->_matrixPalette);
+        const std::vector<Joint*>& joints = skins[i]->_joints;
+        for (size_t j = 0, jointCount = joints.size(); j < jointCount; ++j)
+        {
+            GP_ASSERT(joints[j]);
+            joints[j]->getWorldMatrix();
+        }
+    }
+
+    Game* game = Game::getInstance();
+    if (game && game->getJobSystem())
+    {
+        game->getJobSystem()->parallelFor(count, &MeshSkin::updateMatrixPaletteRange, (void*)skins);
+    }
+    else
+    {
+        updateMatrixPaletteRange(0, count, (void*)skins);
+    }
+}
+
+void MeshSkin::updateMatrixPaletteRange(unsigned int start, unsigned int end, void* cookie)
+{
+    MeshSkin* const* skins = (MeshSkin* const*)cookie;
+    for (unsigned int i = start; i < end; ++i)
+    {
+        skins[i]->updateMatrixPalette();
+    }
+}
+
+void MeshSkin::setJointBounds(const BoundingBox* bounds, unsigned int count)
+{
+    GP_ASSERT(count == 0 || bounds);
+    GP_ASSERT(count <= _joints.size());
+
+    // The joints notify the skin when they move only while it has joint bounds.
+    bool listening = !_jointBounds.empty();
+    if (listening && count == 0)
+    {
+        for (size_t i = 0, jointCount = _joints.size(); i < jointCount; ++i)
+        {
+            if (_joints[i])
+                setJointListener(_joints[i], false);
+        }
+    }
+    _jointBounds.assign(bounds, bounds + count);
+    if (!listening && count > 0)
+    {
+        for (size_t i = 0, jointCount = _joints.size(); i < jointCount; ++i)
+        {
+            if (_joints[i])
+                setJointListener(_joints[i], true);
+        }
+    }
+
+    _boundsDirty = true;
+    if (_model && _model->getNode())
+    {
+        _model->getNode()->setBoundsDirty();
+    }
+}
+
+const BoundingBox& MeshSkin::getBoundingBox() const
+{
+    if (_boundsDirty)
+    {
+        _boundsDirty = false;
+        if (_jointBounds.empty())
+        {
+            _bounds.set(BoundingBox::empty());
+        }
+        else
+        {
+            SkinDeformer::computeBounds(getMatrixPalette(), &_jointBounds[0], (unsigned int)_jointBounds.size(), &_bounds);
+        }
+    }
+    return _bounds;
+}
+
+void MeshSkin::setMaxPaletteJointCount(unsigned int jointCount)
+{
+    __maxPaletteJointCount = jointCount;
+}
+
+unsigned int MeshSkin::getMaxPaletteJointCount()
+{
+    return __maxPaletteJointCount;
+}
+
+void MeshSkin::setJointListener(Joint* joint, bool listen)
+{
+    GP_ASSERT(joint);
+
+    if (_jointBounds.empty())
+        return;
+
+    if (listen)
+        joint->addListener(this, COOKIE_JOINT);
+    else
+        joint->removeListener(this);
 }
 
 unsigned int MeshSkin::getMatrixPaletteSize() const
@@ -196,7 +373,7 @@ void MeshSkin::setRootJoint(Joint* joint)
     // If the root joint has a parent node, register for its transformChanged event
     if (_rootJoint && _rootJoint->getParent())
     {
-        _rootJoint->getParent()->addListener(this, 1);
+        _rootJoint->getParent()->addListener(this, COOKIE_ROOT_JOINT_PARENT);
     }
 
     Node* newRootNode = _rootJoint;
@@ -219,7 +396,7 @@ void MeshSkin::transformChanged(Transform* transform, long cookie)
 {
     switch (cookie)
     {
-    case 1:
+    case COOKIE_ROOT_JOINT_PARENT:
         // The direct parent of our joint hierarchy has changed.
         // Dirty the bounding volume for our model's node. This special
         // case allows us to have much tighter bounding volumes for
@@ -231,6 +408,18 @@ void MeshSkin::transformChanged(Transform* transform, long cookie)
             _model->getNode()->setBoundsDirty();
         }
         break;
+    case COOKIE_JOINT:
+        // A joint has moved, which changes the bounds of the skinned mesh. The node is
+        // only notified once until the bounds are computed again.
+        if (!_boundsDirty)
+        {
+            _boundsDirty = true;
+            if (_model && _model->getNode())
+            {
+                _model->getNode()->setBoundsDirty();
+            }
+        }
+        break;
     }
 }
 
@@ -257,6 +446,12 @@ void MeshSkin::setRootNode(Node* node)
         {
             _rootNode->addRef();
         }
+
+        // Searches of the scene descend into the joint hierarchy of the skin.
+        if (_model && _model->getNode())
+        {
+            _model->getNode()->refreshSceneIndices();
+        }
     }
 }
 
@@ -266,6 +461,10 @@ void MeshSkin::clearJoints()
 
     for (size_t i = 0, count = _joints.size(); i < count; ++i)
     {
+        if (_joints[i])
+        {
+            setJointListener(_joints[i], false);
+        }
         SAFE_RELEASE(_joints[i]);
     }
     _joints.clear();
@@ -3,6 +3,7 @@
 
 #include "Matrix.h"
 #include "Transform.h"
+#include "BoundingBox.h"
 
 namespace gameplay
 {
@@ -21,6 +22,7 @@ class MeshSkin : public Transform::Listener
     friend class Model;
     friend class Joint;
     friend class Node;
+    friend class NodeIndex;
 
 public:
 
@@ -86,11 +88,73 @@ public:
 
     /**
      * Returns the pointer to the Vector4 array for the purpose of binding to a shader.
+     *
+     * Only the palette matrices of the joints that changed since the palette was last
+     * returned are rebuilt.
      * 
      * @return The pointer to the matrix palette.
      */
     Vector4* getMatrixPalette() const;
 
+    /**
+     * Updates the matrix palettes of the given skins, using the job system of the game
+     * to build the palettes of different skins in parallel.
+     *
+     * The world matrices of the joints are resolved first, after which the palettes are
+     * built without modifying the joints, so skins that share joints can be processed
+     * concurrently. The palettes are then up to date for getMatrixPalette.
+     *
+     * @param skins The skins to update.
+     * @param count The number of skins.
+     * @script{ignore}
+     */
+    static void updateMatrixPalettes(MeshSkin* const* skins, unsigned int count);
+
+    /**
+     * Sets the bounds of the bind pose vertices that each joint influences.
+     *
+     * This enables tight bounds of the skinned mesh in its current pose (see getBoundingBox),
+     * which the node of the model then uses as its bounding volume. Bundles set the joint
+     * bounds of the skins that they load.
+     *
+     * @param bounds The bounds for each joint, as computed by SkinDeformer::computeJointBounds.
+     * @param count The number of bounds, which must not exceed the joint count, or zero to
+     *      bound the model by its mesh instead.
+     * @script{ignore}
+     */
+    void setJointBounds(const BoundingBox* bounds, unsigned int count);
+
+    /**
+     * Returns the bounds of the skinned mesh in its current pose.
+     *
+     * The bounds are in the space that the world matrix of the model's node transforms, and
+     * are updated when joints move. They can be used for culling or to fit physics shapes
+     * to the animated mesh.
+     *
+     * @return The bounding box, which is empty when the skin has no joint bounds.
+     */
+    const BoundingBox& getBoundingBox() const;
+
+    /**
+     * Sets the largest number of joints that the matrix palette of the skinning shaders
+     * can hold.
+     *
+     * Models with skins that have more joints are loaded from bundles into a dynamic mesh
+     * that is skinned on the CPU (see SkinDeformer), and must be drawn with materials that
+     * do not define SKINNING.
+     *
+     * @param jointCount The number of joints, or zero to skin all models in the vertex shader (the default).
+     */
+    static void setMaxPaletteJointCount(unsigned int jointCount);
+
+    /**
+     * Returns the largest number of joints that the matrix palette of the skinning shaders
+     * can hold.
+     *
+     * @return The number of joints, or zero if there is no limit.
+     */
+    static unsigned int getMaxPaletteJointCount();
+
     /**
      * Returns the number of elements in the matrix palette array.
      * Each element is a Vector4* that represents a row.
@@ -169,6 +233,22 @@ private:
      */
     void clearJoints();
 
+    /**
+     * Rebuilds the palette matrices of the joints whose world matrix or inverse bind pose
+     * changed since the palette was last updated.
+     */
+    void updateMatrixPalette() const;
+
+    /**
+     * Updates the matrix palettes of a range of skins. Called by updateMatrixPalettes.
+     */
+    static void updateMatrixPaletteRange(unsigned int start, unsigned int end, void* cookie);
+
+    /**
+     * Adds or removes this skin as a listener of the given joint for the joint bounds.
+     */
+    void setJointListener(Joint* joint, bool listen);
+
     Matrix _bindShape;
     std::vector<Joint*> _joints;
     Joint* _rootJoint;
@@ -184,6 +264,32 @@ private:
     // The number of Vector4's is (_joints.size() * 3).
     Vector4* _matrixPalette;
     Model* _model;
+
+    // The generations of each joint's world matrix and inverse bind pose that its palette
+    // matrix was last built from. Each skin keeps its own, so joints that are shared by
+    // several skins are still only rebuilt when they change.
+    mutable std::vector<unsigned int> _jointGenerations;
+    mutable std::vector<unsigned int> _bindPoseGenerations;
+
+    // The inverse bind pose of each joint multiplied by the bind shape.
+    mutable std::vector<Matrix> _bindMatrices;
+
+    // Whether every palette matrix must be rebuilt, after the bind shape or joints changed.
+    mutable bool _matrixPaletteDirty;
+
+    // The matrices to multiply and the palette rows to write when the palette is updated.
+    mutable std::vector<const float*> _dirtyWorldMatrices;
+    mutable std::vector<const float*> _dirtyBindMatrices;
+    mutable std::vector<float*> _dirtyPaletteRows;
+
+    // Incremented whenever palette matrices are rebuilt.
+    mutable unsigned int _matrixPaletteGeneration;
+
+    // The bounds of the bind pose vertices that each joint influences, and the bounds
+    // of the skinned mesh, which are dirtied by the joints when they move.
+    std::vector<BoundingBox> _jointBounds;
+    mutable BoundingBox _bounds;
+    mutable bool _boundsDirty;
 };
 
 }
@@ -5,12 +5,17 @@
 #include "Technique.h"
 #include "Pass.h"
 #include "Node.h"
+#include "Game.h"
+
+// The smallest number of vertices that are skinned by each job on the CPU.
+#define SKIN_DEFORM_GRAIN_SIZE 1024
 
 namespace gameplay
 {
 
 Model::Model(Mesh* mesh) :
-    _mesh(mesh), _material(NULL), _partCount(0), _partMaterials(NULL), _node(NULL), _skin(NULL)
+    _mesh(mesh), _material(NULL), _partCount(0), _partMaterials(NULL), _node(NULL), _skin(NULL),
+    _skinDeformer(NULL), _skinnedVertexData(NULL), _skinnedPaletteGeneration(0)
 {
     GP_ASSERT(mesh);
     _partCount = mesh->getPartCount();
@@ -32,6 +37,9 @@ Model::~Model()
     SAFE_RELEASE(_mesh);
 
     SAFE_DELETE(_skin);
+
+    SAFE_RELEASE(_skinDeformer);
+    SAFE_DELETE_ARRAY(_skinnedVertexData);
 }
 
 Model* Model::create(Mesh* mesh)
@@ -221,7 +229,72 @@ void Model::setSkin(MeshSkin* skin)
         _skin = skin;
         if (_skin)
             _skin->_model = this;
+
+        if (_node)
+            _node->refreshSceneIndices();
+    }
+}
+
+SkinDeformer* Model::getSkinDeformer() const
+{
+    return _skinDeformer;
+}
+
+void Model::setSkinDeformer(SkinDeformer* deformer)
+{
+    if (_skinDeformer == deformer)
+        return;
+
+    GP_ASSERT(_mesh);
+    if (deformer && (deformer->getVertexFormat() != _mesh->getVertexFormat() || deformer->getVertexCount() != _mesh->getVertexCount()))
+    {
+        GP_ERROR("Failed to set skin deformer; its vertex format and count must match the mesh '%s'.", _mesh->getUrl());
+        return;
+    }
+
+    SAFE_RELEASE(_skinDeformer);
+    SAFE_DELETE_ARRAY(_skinnedVertexData);
+    _skinDeformer = deformer;
+    if (_skinDeformer)
+    {
+        _skinDeformer->addRef();
+
+        // The elements that are not skinned are copied once.
+        unsigned int size = _skinDeformer->getVertexCount() * _mesh->getVertexSize() / sizeof(float);
+        _skinnedVertexData = new float[size];
+        memcpy(_skinnedVertexData, _skinDeformer->getVertexData(), size * sizeof(float));
+        _skinnedPaletteGeneration = 0;
+    }
+}
+
+void Model::deformSkin()
+{
+    GP_ASSERT(_skinDeformer && _skin && _mesh);
+
+    // The palette generation starts at one when the palette is first built. Models that
+    // share the mesh, such as clones, overwrite its vertices, so unchanged vertices are
+    // only kept when no other model can draw the mesh.
+    _skin->getMatrixPalette();
+    if (_skinnedPaletteGeneration == _skin->_matrixPaletteGeneration && _mesh->getRefCount() == 1)
+        return;
+    _skinnedPaletteGeneration = _skin->_matrixPaletteGeneration;
+
+    unsigned int vertexCount = _skinDeformer->getVertexCount();
+    JobSystem* jobSystem = Game::getInstance() ? Game::getInstance()->getJobSystem() : NULL;
+    if (jobSystem)
+    {
+        jobSystem->parallelFor(vertexCount, this, &Model::deformSkinRange, SKIN_DEFORM_GRAIN_SIZE);
+    }
+    else
+    {
+        deformSkinRange(0, vertexCount);
     }
+    _mesh->setVertexData(_skinnedVertexData, 0, vertexCount);
+}
+
+void Model::deformSkinRange(unsigned int start, unsigned int end)
+{
+    _skinDeformer->deform(_skin->_matrixPalette, start, end - start, _skinnedVertexData);
 }
 
 Node* Model::getNode() const
@@ -333,6 +406,11 @@ void Model::draw(bool wireframe)
 {
     GP_ASSERT(_mesh);
 
+    if (_skinDeformer && _skin)
+    {
+        deformSkin();
+    }
+
     unsigned int partCount = _mesh->getPartCount();
     if (partCount == 0)
     {
@@ -428,6 +506,7 @@ Model* Model::clone(NodeCloneContext &context)
     {
         model->setSkin(getSkin()->clone(context));
     }
+    model->setSkinDeformer(getSkinDeformer());
     if (getMaterial())
     {
         Material* materialClone = getMaterial()->clone(context);
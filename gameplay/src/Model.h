@@ -4,6 +4,7 @@
 #include "Mesh.h"
 #include "MeshSkin.h"
 #include "Material.h"
+#include "SkinDeformer.h"
 
 namespace gameplay
 {
@@ -127,6 +128,29 @@ public:
      */
     MeshSkin* getSkin() const;
 
+    /**
+     * Returns the deformer that skins the vertices of this model on the CPU.
+     *
+     * @return The skin deformer, or NULL if the model is skinned in the vertex shader.
+     * @script{ignore}
+     */
+    SkinDeformer* getSkinDeformer() const;
+
+    /**
+     * Sets the deformer that skins the vertices of this model on the CPU.
+     *
+     * Before the model is drawn, its vertices are skinned by the matrix palette of its
+     * skin and written to its mesh, which should therefore be dynamic and not be shared
+     * with models that are skinned in the vertex shader. The materials of the model must
+     * not define SKINNING. Bundles set a skin deformer for the models with skins that
+     * have too many joints for the vertex shader (see MeshSkin::setMaxPaletteJointCount).
+     *
+     * @param deformer The skin deformer, with the vertex format and count of the mesh, or
+     *      NULL to skin the model in the vertex shader.
+     * @script{ignore}
+     */
+    void setSkinDeformer(SkinDeformer* deformer);
+
     /**
      * Returns the node that is associated with this model.
      * 
@@ -187,6 +211,16 @@ private:
 
     void validatePartCount();
 
+    /**
+     * Skins the vertices of the mesh with the skin deformer if the pose of the skin has changed.
+     */
+    void deformSkin();
+
+    /**
+     * Skins a range of vertices. Called by deformSkin.
+     */
+    void deformSkinRange(unsigned int start, unsigned int end);
+
     /**
      * Clones the model and returns a new model.
      * 
@@ -201,6 +235,11 @@ private:
     Material** _partMaterials;
     Node* _node;
     MeshSkin* _skin;
+    SkinDeformer* _skinDeformer;
+    // The skinned vertices that are written to the mesh, and the generation of the
+    // matrix palette of the skin that they were skinned with.
+    float* _skinnedVertexData;
+    unsigned int _skinnedPaletteGeneration;
 };
 
 }
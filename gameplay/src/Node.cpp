@@ -10,6 +10,7 @@
 #include "PhysicsCharacter.h"
 #include "Game.h"
 #include "Terrain.h"
+#include "TransformHierarchy.h"
 
 // Node dirty flags
 #define NODE_DIRTY_WORLD 1
@@ -22,7 +23,8 @@ namespace gameplay
 Node::Node(const char* id)
     : _scene(NULL), _firstChild(NULL), _nextSibling(NULL), _prevSibling(NULL), _parent(NULL), _childCount(0),
     _tags(NULL), _camera(NULL), _light(NULL), _model(NULL), _terrain(NULL), _form(NULL), _audioSource(NULL), _particleEmitter(NULL),
-    _collisionObject(NULL), _agent(NULL), _dirtyBits(NODE_DIRTY_ALL), _notifyHierarchyChanged(true), _userData(NULL)
+    _collisionObject(NULL), _agent(NULL), _dirtyBits(NODE_DIRTY_ALL), _notifyHierarchyChanged(true), _userData(NULL),
+    _transformHierarchy(NULL), _transformIndex(0), _boundingVolumeHierarchy(NULL), _boundingVolumeProxy(-1)
 {
     if (id)
     {
@@ -34,6 +36,9 @@ Node::~Node()
 {
     removeAllChildren();
 
+    if (_boundingVolumeHierarchy)
+        _boundingVolumeHierarchy->remove(this);
+
     if (_model)
         _model->setNode(NULL);
     if (_audioSource)
@@ -79,7 +84,18 @@ void Node::setId(const char* id)
 {
     if (id)
     {
-        _id = id;
+        // Re-index this node under its new id.
+        Scene* scene = getScene();
+        if (scene && scene->_nodeIndex)
+        {
+            scene->_nodeIndex->remove(this);
+            _id = id;
+            scene->_nodeIndex->add(this);
+        }
+        else
+        {
+            _id = id;
+        }
     }
 }
 
@@ -126,6 +142,20 @@ void Node::addChild(Node* child)
 
     ++_childCount;
 
+    if (_transformHierarchy)
+    {
+        _transformHierarchy->invalidate();
+    }
+
+    Scene* scene = getScene();
+    if (scene)
+    {
+        if (scene->_nodeIndex)
+            scene->_nodeIndex->addHierarchy(child);
+        if (scene->_boundingVolumeHierarchy)
+            scene->_boundingVolumeHierarchy->addHierarchy(child);
+    }
+
     if (_notifyHierarchyChanged)
     {
         hierarchyChanged();
@@ -161,6 +191,22 @@ void Node::removeAllChildren()
 
 void Node::remove()
 {
+    // The flat transform hierarchy must release this node before it leaves the scene graph.
+    if (_transformHierarchy)
+    {
+        _transformHierarchy->invalidate();
+    }
+
+    // Remove this node and its descendants from the scene's node index and bounding volume hierarchy.
+    Scene* scene = getScene();
+    if (scene)
+    {
+        if (scene->_nodeIndex)
+            scene->_nodeIndex->removeHierarchy(this);
+        if (scene->_boundingVolumeHierarchy)
+            scene->_boundingVolumeHierarchy->removeHierarchy(this);
+    }
+
     // Re-link our neighbours.
     if (_prevSibling)
     {
@@ -293,6 +339,21 @@ Node* Node::findNode(const char* id, bool recursive, bool exactMatch) const
 {
     GP_ASSERT(id);
 
+    // Look the node up in the scene's index when all of our descendants are searched.
+    Scene* scene = recursive ? getScene() : NULL;
+    Node* match = NULL;
+    if (scene && scene->_nodeIndex && scene->_nodeIndex->findNode(id, exactMatch, this, &match))
+    {
+        return match;
+    }
+
+    return findNodeInHierarchy(id, recursive, exactMatch);
+}
+
+Node* Node::findNodeInHierarchy(const char* id, bool recursive, bool exactMatch) const
+{
+    GP_ASSERT(id);
+
     // If the node has a model with a mesh skin, search the skin's hierarchy as well.
     Node* rootNode = NULL;
     if (_model != NULL && _model->getSkin() != NULL && (rootNode = _model->getSkin()->_rootNode) != NULL)
@@ -300,7 +361,7 @@ Node* Node::findNode(const char* id, bool recursive, bool exactMatch) const
         if ((exactMatch && rootNode->_id == id) || (!exactMatch && rootNode->_id.find(id) == 0))
             return rootNode;
         
-        Node* match = rootNode->findNode(id, true, exactMatch);
+        Node* match = rootNode->findNodeInHierarchy(id, true, exactMatch);
         if (match)
         {
             return match;
@@ -322,7 +383,7 @@ Node* Node::findNode(const char* id, bool recursive, bool exactMatch) const
     {
         for (Node* child = getFirstChild(); child != NULL; child = child->getNextSibling())
         {
-            Node* match = child->findNode(id, true, exactMatch);
+            Node* match = child->findNodeInHierarchy(id, true, exactMatch);
             if (match)
             {
                 return match;
@@ -336,7 +397,22 @@ Node* Node::findNode(const char* id, bool recursive, bool exactMatch) const
 unsigned int Node::findNodes(const char* id, std::vector<Node*>& nodes, bool recursive, bool exactMatch) const
 {
     GP_ASSERT(id);
-    
+
+    // Look the nodes up in the scene's index when all of our descendants are searched.
+    Scene* scene = recursive ? getScene() : NULL;
+    size_t size = nodes.size();
+    if (scene && scene->_nodeIndex && scene->_nodeIndex->findNodes(id, exactMatch, this, nodes))
+    {
+        return (unsigned int)(nodes.size() - size);
+    }
+
+    return findNodesInHierarchy(id, nodes, recursive, exactMatch);
+}
+
+unsigned int Node::findNodesInHierarchy(const char* id, std::vector<Node*>& nodes, bool recursive, bool exactMatch) const
+{
+    GP_ASSERT(id);
+
     unsigned int count = 0;
 
     // If the node has a model with a mesh skin, search the skin's hierarchy as well.
@@ -348,7 +424,7 @@ unsigned int Node::findNodes(const char* id, std::vector<Node*>& nodes, bool rec
             nodes.push_back(rootNode);
             ++count;
         }
-        count += rootNode->findNodes(id, nodes, true, exactMatch);
+        count += rootNode->findNodesInHierarchy(id, nodes, true, exactMatch);
     }
 
     // Search immediate children first.
@@ -367,7 +443,7 @@ unsigned int Node::findNodes(const char* id, std::vector<Node*>& nodes, bool rec
     {
         for (Node* child = getFirstChild(); child != NULL; child = child->getNextSibling())
         {
-            count += child->findNodes(id, nodes, true, exactMatch);
+            count += child->findNodesInHierarchy(id, nodes, true, exactMatch);
         }
     }
 
@@ -400,6 +476,11 @@ Node* Node::getRootNode() const
 
 const Matrix& Node::getWorldMatrix() const
 {
+    if (_transformHierarchy)
+    {
+        return _transformHierarchy->getWorldMatrix(_transformIndex);
+    }
+
     if (_dirtyBits & NODE_DIRTY_WORLD)
     {
         // Clear our dirty flag immediately to prevent this block from being entered if our
@@ -628,6 +709,20 @@ void Node::transformChanged()
     // Our local transform was changed, so mark our world matrices dirty.
     _dirtyBits |= NODE_DIRTY_WORLD | NODE_DIRTY_BOUNDS;
 
+    if (_boundingVolumeHierarchy)
+    {
+        _boundingVolumeHierarchy->setDirty(_boundingVolumeProxy);
+    }
+
+    if (_transformHierarchy)
+    {
+        // Only our subtree is marked dirty. The flat hierarchy updates and notifies our
+        // descendants when it resolves the subtree.
+        _transformHierarchy->setDirty(_transformIndex);
+        Transform::transformChanged();
+        return;
+    }
+
     // Notify our children that their transform has also changed (since transforms are inherited).
     for (Node* n = getFirstChild(); n != NULL; n = n->getNextSibling())
     {
@@ -649,11 +744,29 @@ void Node::transformChanged()
     Transform::transformChanged();
 }
 
+void Node::ancestorTransformChanged()
+{
+    _dirtyBits |= NODE_DIRTY_WORLD | NODE_DIRTY_BOUNDS;
+
+    if (_boundingVolumeHierarchy)
+    {
+        _boundingVolumeHierarchy->setDirty(_boundingVolumeProxy);
+    }
+
+    if (getType() == Node::JOINT)
+    {
+        ++static_cast<Joint*>(this)->_generation;
+    }
+}
+
 void Node::setBoundsDirty()
 {
     // Mark ourself and our parent nodes as dirty
     _dirtyBits |= NODE_DIRTY_BOUNDS;
 
+    if (_boundingVolumeHierarchy)
+        _boundingVolumeHierarchy->setDirty(_boundingVolumeProxy);
+
     // Mark our parent bounds as dirty as well
     if (_parent)
         _parent->setBoundsDirty();
@@ -791,6 +904,8 @@ void Node::setModel(Model* model)
             _model->addRef();
             _model->setNode(this);
         }
+
+        refreshSceneIndices();
     }
 }
 
@@ -816,6 +931,20 @@ void Node::setTerrain(Terrain* terrain)
             _terrain->addRef();
             _terrain->setNode(this);
         }
+
+        refreshSceneIndices();
+    }
+}
+
+void Node::refreshSceneIndices()
+{
+    Scene* scene = getScene();
+    if (scene)
+    {
+        if (scene->_nodeIndex)
+            scene->_nodeIndex->refresh(this);
+        if (scene->_boundingVolumeHierarchy)
+            scene->_boundingVolumeHierarchy->refresh(this);
     }
 }
 
@@ -846,6 +975,12 @@ void Node::setForm(Form* form)
 
 const BoundingSphere& Node::getBoundingSphere() const
 {
+    // Our bounds are marked dirty when the flat hierarchy resolves a change of an ancestor.
+    if (_transformHierarchy)
+    {
+        _transformHierarchy->resolve();
+    }
+
     if (_dirtyBits & NODE_DIRTY_BOUNDS)
     {
         _dirtyBits &= ~NODE_DIRTY_BOUNDS;
@@ -860,16 +995,25 @@ const BoundingSphere& Node::getBoundingSphere() const
             _bounds.set(_terrain->getBoundingBox());
             empty = false;
         }
+        // Skins with joint bounds have tight bounds in their current pose.
+        MeshSkin* skin = _model ? _model->getSkin() : NULL;
+        bool skinned = skin && !skin->_jointBounds.empty();
         if (_model && _model->getMesh())
         {
+            BoundingSphere modelBounds;
+            if (skinned)
+                modelBounds.set(skin->getBoundingBox());
+            else
+                modelBounds.set(_model->getMesh()->getBoundingSphere());
+
             if (empty)
             {
-                _bounds.set(_model->getMesh()->getBoundingSphere());
+                _bounds.set(modelBounds);
                 empty = false;
             }
             else
             {
-                _bounds.merge(_model->getMesh()->getBoundingSphere());
+                _bounds.merge(modelBounds);
             }
         }
         else
@@ -883,7 +1027,7 @@ const BoundingSphere& Node::getBoundingSphere() const
         if (!empty)
         {
             bool applyWorldTransform = true;
-            if (_model && _model->getSkin())
+            if (skin && !skinned)
             {
                 // Special case: If the root joint of our mesh skin is parented by any nodes, 
                 // multiply the world matrix of the root joint's parent by this node's
@@ -20,6 +20,8 @@ class Bundle;
 class Scene;
 class Form;
 class Terrain;
+class TransformHierarchy;
+class BoundingVolumeHierarchy;
 
 /**
  * Defines a basic hierarchical structure of transformation spaces.
@@ -29,6 +31,10 @@ class Node : public Transform, public Ref
     friend class Scene;
     friend class Bundle;
     friend class MeshSkin;
+    friend class Model;
+    friend class TransformHierarchy;
+    friend class BoundingVolumeHierarchy;
+    friend class NodeIndex;
 
 public:
 
@@ -193,7 +199,8 @@ public:
      *
      * This method checks the specified ID against its immediate child nodes 
      * but does not check the ID against itself.
-     * If recursive is true, it also traverses the Node's hierarchy with a breadth first search.
+     * If recursive is true, it also traverses the Node's hierarchy with a breadth first search,
+     * or looks the ID up in the index of the node's scene when the node is part of a scene.
      *
      * @param id The ID of the child to find.
      * @param recursive True to search recursively all the node's children, false for only direct children.
@@ -691,11 +698,33 @@ protected:
      */
     void hierarchyChanged();
 
+    /**
+     * Marks the world matrix and bounds of this node dirty after the transform of one of
+     * its ancestors changed, without visiting its children.
+     */
+    void ancestorTransformChanged();
+
     /**
      * Marks the bounding volume of the node as dirty.
      */
     void setBoundsDirty();
 
+    /**
+     * Updates the bounding volume hierarchy and node index of this node's scene
+     * after its model, mesh skin or terrain has changed.
+     */
+    void refreshSceneIndices();
+
+    /**
+     * Searches this node's hierarchy for the first node matching the given ID without using the scene's node index.
+     */
+    Node* findNodeInHierarchy(const char* id, bool recursive, bool exactMatch) const;
+
+    /**
+     * Searches this node's hierarchy for all nodes matching the given ID without using the scene's node index.
+     */
+    unsigned int findNodesInHierarchy(const char* id, std::vector<Node*>& nodes, bool recursive, bool exactMatch) const;
+
 private:
 
     /**
@@ -848,6 +877,26 @@ protected:
      * lowest common ancestor.
      */
     std::vector<Node*> _advertisedDescendants;
+
+    /**
+     * The flat transform hierarchy resolving this Node's world matrix, or NULL to resolve it recursively.
+     */
+    TransformHierarchy* _transformHierarchy;
+
+    /**
+     * The index of the Node within its flat transform hierarchy.
+     */
+    unsigned int _transformIndex;
+
+    /**
+     * The bounding volume hierarchy of the scene that this Node is stored in, or NULL if it is not stored.
+     */
+    BoundingVolumeHierarchy* _boundingVolumeHierarchy;
+
+    /**
+     * The index of this Node's leaf within its bounding volume hierarchy.
+     */
+    int _boundingVolumeProxy;
 };
 
 /**
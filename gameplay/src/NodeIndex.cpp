@@ -0,0 +1,360 @@
+#include "Base.h"
+#include "NodeIndex.h"
+#include "Node.h"
+#include "MeshSkin.h"
+#include "Scene.h"
+
+// The number of slots of the hash table when the first node is added.
+#define NODE_INDEX_MIN_SLOTS 16
+
+namespace gameplay
+{
+
+NodeIndex::NodeIndex(Scene* scene)
+    : _scene(scene), _usedSlotCount(0), _deletedSlotCount(0), _nodeCount(0)
+{
+}
+
+NodeIndex::~NodeIndex()
+{
+}
+
+unsigned int NodeIndex::getNodeCount() const
+{
+    return _nodeCount;
+}
+
+void NodeIndex::addHierarchy(Node* node)
+{
+    GP_ASSERT(node);
+
+    add(node);
+    for (Node* child = node->getFirstChild(); child != NULL; child = child->getNextSibling())
+    {
+        addHierarchy(child);
+    }
+}
+
+void NodeIndex::removeHierarchy(Node* node)
+{
+    GP_ASSERT(node);
+
+    remove(node);
+    for (Node* child = node->getFirstChild(); child != NULL; child = child->getNextSibling())
+    {
+        removeHierarchy(child);
+    }
+}
+
+void NodeIndex::add(Node* node)
+{
+    GP_ASSERT(node);
+
+    const char* id = node->_id.c_str();
+    unsigned int hash = hashId(id);
+    int index = findSlot(id, hash);
+    if (index < 0)
+    {
+        // Keep at least a quarter of the slots empty, so that probing for an id stays short.
+        if ((_usedSlotCount + _deletedSlotCount + 1) * 4 > _slots.size() * 3)
+        {
+            size_t slotCount = NODE_INDEX_MIN_SLOTS;
+            while (slotCount < (_usedSlotCount + 1) * 2)
+                slotCount *= 2;
+            rehash(slotCount);
+        }
+
+        size_t mask = _slots.size() - 1;
+        index = (int)(hash & mask);
+        while (_slots[index].state == SLOT_USED)
+            index = (int)((index + 1) & mask);
+
+        Slot& slot = _slots[index];
+        if (slot.state == SLOT_DELETED)
+            _deletedSlotCount--;
+        slot.hash = hash;
+        slot.state = SLOT_USED;
+        slot.id = node->_id;
+        _usedSlotCount++;
+        _sortedIds.insert(node->_id);
+    }
+
+    _slots[index].nodes.push_back(node);
+    _nodeCount++;
+    refresh(node);
+}
+
+void NodeIndex::remove(Node* node)
+{
+    GP_ASSERT(node);
+
+    int index = findSlot(node->_id.c_str(), hashId(node->_id.c_str()));
+    if (index >= 0)
+    {
+        Slot& slot = _slots[index];
+        std::vector<Node*>::iterator itr = std::find(slot.nodes.begin(), slot.nodes.end(), node);
+        if (itr != slot.nodes.end())
+        {
+            slot.nodes.erase(itr);
+            _nodeCount--;
+        }
+
+        // Leave a deleted slot behind, so that the ids probed past this slot are still found.
+        if (slot.nodes.empty())
+        {
+            _sortedIds.erase(slot.id);
+            slot.state = SLOT_DELETED;
+            slot.id.clear();
+            _usedSlotCount--;
+            _deletedSlotCount++;
+        }
+    }
+
+    _skinnedNodes.erase(node);
+}
+
+void NodeIndex::refresh(Node* node)
+{
+    GP_ASSERT(node);
+
+    Model* model = node->getModel();
+    if (model && model->getSkin())
+        _skinnedNodes.insert(node);
+    else
+        _skinnedNodes.erase(node);
+}
+
+bool NodeIndex::findNode(const char* id, bool exactMatch, const Node* ancestor, Node** node) const
+{
+    GP_ASSERT(id);
+    GP_ASSERT(node);
+
+    unsigned char skinState = getSkinState(ancestor);
+    if (skinState & SKINS_EXTERNAL)
+        return false;
+
+    std::vector<Node*> matches;
+    findMatches(id, exactMatch, ancestor, matches);
+    if (matches.empty())
+    {
+        *node = NULL;
+        return true;
+    }
+
+    // The traversal searches joint hierarchies when it reaches their mesh skin, which
+    // can be before their place in the scene graph, so it has to pick between matches.
+    if (matches.size() > 1 && skinState != SKINS_NONE)
+        return false;
+
+    // The traversal of the scene graph finds the match that it reaches first.
+    Node* match = matches[0];
+    for (size_t i = 1, count = matches.size(); i < count; ++i)
+    {
+        if (precedes(matches[i], match))
+            match = matches[i];
+    }
+
+    *node = match;
+    return true;
+}
+
+bool NodeIndex::findNodes(const char* id, bool exactMatch, const Node* ancestor, std::vector<Node*>& nodes) const
+{
+    GP_ASSERT(id);
+
+    // The traversal finds the nodes of joint hierarchies in the scope twice, through the
+    // mesh skin and through the scene graph.
+    if (getSkinState(ancestor) != SKINS_NONE)
+        return false;
+
+    size_t first = nodes.size();
+    findMatches(id, exactMatch, ancestor, nodes);
+    std::sort(nodes.begin() + first, nodes.end(), precedes);
+
+    return true;
+}
+
+void NodeIndex::findMatches(const char* id, bool exactMatch, const Node* ancestor, std::vector<Node*>& nodes) const
+{
+    if (exactMatch)
+    {
+        int index = findSlot(id, hashId(id));
+        if (index >= 0)
+        {
+            const Slot& slot = _slots[index];
+            for (size_t i = 0, count = slot.nodes.size(); i < count; ++i)
+            {
+                if (isInScope(slot.nodes[i], ancestor))
+                    nodes.push_back(slot.nodes[i]);
+            }
+        }
+        return;
+    }
+
+    // The ids that start with the prefix are a contiguous range of the sorted ids.
+    size_t length = strlen(id);
+    for (std::set<std::string>::const_iterator itr = _sortedIds.lower_bound(id); itr != _sortedIds.end(); ++itr)
+    {
+        if (itr->compare(0, length, id) != 0)
+            break;
+
+        const Slot& slot = _slots[findSlot(itr->c_str(), hashId(itr->c_str()))];
+        for (size_t i = 0, count = slot.nodes.size(); i < count; ++i)
+        {
+            if (isInScope(slot.nodes[i], ancestor))
+                nodes.push_back(slot.nodes[i]);
+        }
+    }
+}
+
+unsigned char NodeIndex::getSkinState(const Node* ancestor) const
+{
+    if (_skinnedNodes.empty())
+        return SKINS_NONE;
+
+    // Searches also descend into the joint hierarchies of mesh skins. The index can answer a
+    // search if the joint hierarchies that it descends into are within its scope, and the
+    // joint hierarchies within its scope are only reached from within its scope.
+    unsigned char state = SKINS_NONE;
+    for (std::set<Node*>::const_iterator itr = _skinnedNodes.begin(); itr != _skinnedNodes.end(); ++itr)
+    {
+        Node* node = *itr;
+        MeshSkin* skin = node->getModel() ? node->getModel()->getSkin() : NULL;
+        Node* rootNode = skin ? skin->_rootNode : NULL;
+        if (rootNode == NULL)
+            continue;
+
+        bool searched = ancestor == NULL || node == ancestor || isInScope(node, ancestor);
+        bool stored = ancestor ? isInScope(rootNode, ancestor) : rootNode->getScene() == _scene;
+        if (searched != stored)
+        {
+            state = SKINS_EXTERNAL;
+            break;
+        }
+        if (searched)
+            state |= SKINS_REACHABLE;
+    }
+
+    return state;
+}
+
+bool NodeIndex::isInScope(const Node* node, const Node* ancestor) const
+{
+    if (ancestor == NULL)
+        return true;
+
+    for (Node* parent = node->getParent(); parent != NULL; parent = parent->getParent())
+    {
+        if (parent == ancestor)
+            return true;
+    }
+    return false;
+}
+
+unsigned int NodeIndex::hashId(const char* id)
+{
+    // FNV-1a.
+    unsigned int hash = 2166136261u;
+    for (; *id; ++id)
+    {
+        hash ^= (unsigned char)*id;
+        hash *= 16777619u;
+    }
+    return hash;
+}
+
+int NodeIndex::findSlot(const char* id, unsigned int hash) const
+{
+    if (_slots.empty())
+        return -1;
+
+    size_t mask = _slots.size() - 1;
+    for (size_t i = hash & mask; _slots[i].state != SLOT_EMPTY; i = (i + 1) & mask)
+    {
+        const Slot& slot = _slots[i];
+        if (slot.state == SLOT_USED && slot.hash == hash && slot.id == id)
+            return (int)i;
+    }
+    return -1;
+}
+
+bool NodeIndex::precedes(const Node* a, const Node* b)
+{
+    if (a == b)
+        return false;
+
+    unsigned int depthA = 0;
+    for (const Node* node = a->getParent(); node != NULL; node = node->getParent())
+        depthA++;
+    unsigned int depthB = 0;
+    for (const Node* node = b->getParent(); node != NULL; node = node->getParent())
+        depthB++;
+
+    // Bring both nodes up to the same depth. A node is found before its descendants.
+    const Node* x = a;
+    const Node* y = b;
+    for (; depthA > depthB; depthA--)
+        x = x->getParent();
+    for (; depthB > depthA; depthB--)
+        y = y->getParent();
+    if (x == y)
+        return x == a;
+
+    // Find the children of the closest shared ancestor, or the nodes at the top of the scene.
+    while (x->getParent() != y->getParent())
+    {
+        x = x->getParent();
+        y = y->getParent();
+    }
+
+    // A child is found before the hierarchies of its siblings are searched.
+    bool childA = x == a;
+    bool childB = y == b;
+    if (childA != childB)
+        return childA;
+
+    // Otherwise the sibling that comes first is found or searched first. Walk both ways
+    // from one sibling, so that the cost depends on the distance between them.
+    const Node* next = x->getNextSibling();
+    const Node* previous = x->getPreviousSibling();
+    while (next != NULL || previous != NULL)
+    {
+        if (next == y)
+            return true;
+        if (previous == y)
+            return false;
+        if (next)
+            next = next->getNextSibling();
+        if (previous)
+            previous = previous->getPreviousSibling();
+    }
+
+    // The nodes are not part of the same scene graph.
+    GP_ASSERT(false);
+    return false;
+}
+
+void NodeIndex::rehash(size_t slotCount)
+{
+    std::vector<Slot> slots(slotCount);
+    size_t mask = slotCount - 1;
+    for (size_t i = 0, count = _slots.size(); i < count; ++i)
+    {
+        Slot& slot = _slots[i];
+        if (slot.state != SLOT_USED)
+            continue;
+
+        size_t j = slot.hash & mask;
+        while (slots[j].state != SLOT_EMPTY)
+            j = (j + 1) & mask;
+
+        slots[j].hash = slot.hash;
+        slots[j].state = SLOT_USED;
+        slots[j].id.swap(slot.id);
+        slots[j].nodes.swap(slot.nodes);
+    }
+    _slots.swap(slots);
+    _deletedSlotCount = 0;
+}
+
+}
@@ -0,0 +1,204 @@
+#ifndef NODEINDEX_H_
+#define NODEINDEX_H_
+
+namespace gameplay
+{
+
+class Node;
+class Scene;
+
+/**
+ * Defines an index of the nodes of a scene by their id.
+ *
+ * Every node in the scene graph is stored in a hash table by its id, so that exact
+ * matches are found with a single lookup. Prefix matches are found as a range of the
+ * sorted ids. The index is kept up to date as nodes are added to and removed from the
+ * scene and as their ids change.
+ *
+ * When several nodes match, they are returned in the order that a traversal of the
+ * scene graph finds them. The matches are ordered by comparing their paths in the
+ * scene graph, so changing the scene graph never requires the index to renumber its
+ * nodes. Searches don't modify the index.
+ *
+ * Scene::findNode and Node::findNode use the index whenever it can answer a search
+ * with the same result as a traversal of the scene graph, and fall back to the
+ * traversal otherwise, such as when a mesh skin references joints that are not part
+ * of the searched hierarchy.
+ *
+ * A node index is created and owned by each Scene.
+ */
+class NodeIndex
+{
+    friend class Scene;
+    friend class Node;
+
+public:
+
+    /**
+     * Returns the number of nodes stored in the index.
+     *
+     * @return The number of stored nodes.
+     */
+    unsigned int getNodeCount() const;
+
+private:
+
+    /**
+     * The states of the slots of the hash table.
+     */
+    enum SlotState
+    {
+        SLOT_EMPTY,
+        SLOT_USED,
+        SLOT_DELETED
+    };
+
+    /**
+     * The ways that mesh skins affect a search below an ancestor.
+     */
+    enum SkinState
+    {
+        SKINS_NONE = 0,
+        SKINS_REACHABLE = 1,    // The search descends into joint hierarchies that are also stored in the index.
+        SKINS_EXTERNAL = 2      // The search can only be answered by a traversal of the scene graph.
+    };
+
+    /**
+     * A slot of the hash table, which stores the nodes that share an id.
+     */
+    struct Slot
+    {
+        /**
+         * Constructor.
+         */
+        Slot() : hash(0), state(SLOT_EMPTY) {}
+
+        unsigned int hash;              // The hash of the id.
+        unsigned char state;            // The SlotState of the slot.
+        std::string id;                 // The id of the nodes.
+        std::vector<Node*> nodes;       // The nodes with the id.
+    };
+
+    /**
+     * Constructor.
+     */
+    NodeIndex(Scene* scene);
+
+    /**
+     * Destructor.
+     */
+    ~NodeIndex();
+
+    /**
+     * Hidden copy constructor.
+     */
+    NodeIndex(const NodeIndex& copy);
+
+    /**
+     * Hidden copy assignment operator.
+     */
+    NodeIndex& operator=(const NodeIndex&);
+
+    /**
+     * Adds the given node and all of its descendants.
+     */
+    void addHierarchy(Node* node);
+
+    /**
+     * Removes the given node and all of its descendants.
+     */
+    void removeHierarchy(Node* node);
+
+    /**
+     * Adds a single node.
+     */
+    void add(Node* node);
+
+    /**
+     * Removes a single node.
+     */
+    void remove(Node* node);
+
+    /**
+     * Updates whether the given node is tracked as having a mesh skin.
+     */
+    void refresh(Node* node);
+
+    /**
+     * Finds the single node matching the given id.
+     *
+     * @param id The id or id prefix to search for.
+     * @param exactMatch true to match the id exactly, false to match it as a prefix.
+     * @param ancestor The node whose descendants are searched, or NULL to search the whole scene.
+     * @param node Set to the matching node, or NULL if there is no match.
+     *
+     * @return true if the search was answered by the index, false if the caller
+     *      must traverse the scene graph to find the node.
+     */
+    bool findNode(const char* id, bool exactMatch, const Node* ancestor, Node** node) const;
+
+    /**
+     * Finds all nodes matching the given id.
+     *
+     * @param id The id or id prefix to search for.
+     * @param exactMatch true to match the id exactly, false to match it as a prefix.
+     * @param ancestor The node whose descendants are searched, or NULL to search the whole scene.
+     * @param nodes The vector to append the matching nodes to.
+     *
+     * @return true if the search was answered by the index, false if the caller
+     *      must traverse the scene graph to find the nodes.
+     */
+    bool findNodes(const char* id, bool exactMatch, const Node* ancestor, std::vector<Node*>& nodes) const;
+
+    /**
+     * Appends the nodes matching the given id that are within the scope of a search below
+     * the given ancestor, in no particular order.
+     */
+    void findMatches(const char* id, bool exactMatch, const Node* ancestor, std::vector<Node*>& nodes) const;
+
+    /**
+     * Returns the SkinState of a search below the given ancestor.
+     */
+    unsigned char getSkinState(const Node* ancestor) const;
+
+    /**
+     * Determines if the given node is within the scope of a search below the given ancestor.
+     */
+    bool isInScope(const Node* node, const Node* ancestor) const;
+
+    /**
+     * Returns the hash of the given id.
+     */
+    static unsigned int hashId(const char* id);
+
+    /**
+     * Returns the index of the slot of the given id, or -1 if no node has the id.
+     */
+    int findSlot(const char* id, unsigned int hash) const;
+
+    /**
+     * Determines if a traversal of the scene graph finds node a before node b.
+     *
+     * Searches check all children of a node before they descend into the hierarchy
+     * of any child, so the order follows from the paths of the nodes below the
+     * closest ancestor that they share.
+     */
+    static bool precedes(const Node* a, const Node* b);
+
+    /**
+     * Rebuilds the hash table with the given number of slots, which is a power of two.
+     */
+    void rehash(size_t slotCount);
+
+    Scene* _scene;
+    std::vector<Slot> _slots;           // The hash table, with a power of two slots.
+    unsigned int _usedSlotCount;        // The number of slots that store an id.
+    unsigned int _deletedSlotCount;     // The number of slots whose id was removed.
+    unsigned int _nodeCount;            // The number of nodes stored in the index.
+    std::set<std::string> _sortedIds;   // The ids of the used slots, for prefix searches.
+    std::set<Node*> _skinnedNodes;      // The nodes with a mesh skin.
+};
+
+}
+
+#endif
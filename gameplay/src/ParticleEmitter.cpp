@@ -796,9 +796,68 @@ void ParticleEmitter::update(float elapsedTime)
         return;
     }
 
-    // Calculate the time passed since last update.
-    float elapsedSecs = elapsedTime * 0.001f;
+    emit(elapsedTime);
+
+    GP_ASSERT(_node && _node->getScene() && _node->getScene()->getActiveCamera());
+    simulate(elapsedTime, _node->getScene()->getActiveCamera()->getFrustum());
+}
+
+/**
+ * The arguments of a batched emitter update.
+ */
+struct ParticleEmitterBatch
+{
+    std::vector<ParticleEmitter*> emitters;
+    std::vector<const Frustum*> frustums;
+    float elapsedTime;
+};
+
+void ParticleEmitter::update(const std::vector<ParticleEmitter*>& emitters, float elapsedTime)
+{
+    // Emission draws from the shared random number generator, so it stays serial. The
+    // frustums are resolved here as well, since they are computed lazily.
+    ParticleEmitterBatch batch;
+    batch.elapsedTime = elapsedTime;
+    for (size_t i = 0, count = emitters.size(); i < count; ++i)
+    {
+        ParticleEmitter* emitter = emitters[i];
+        GP_ASSERT(emitter);
+        if (!emitter->isActive())
+            continue;
+
+        emitter->emit(elapsedTime);
+
+        GP_ASSERT(emitter->_node && emitter->_node->getScene() && emitter->_node->getScene()->getActiveCamera());
+        batch.emitters.push_back(emitter);
+        batch.frustums.push_back(&emitter->_node->getScene()->getActiveCamera()->getFrustum());
+    }
+
+    if (batch.emitters.empty())
+        return;
+
+    Game* game = Game::getInstance();
+    if (game && game->getJobSystem())
+    {
+        game->getJobSystem()->parallelFor((unsigned int)batch.emitters.size(), &ParticleEmitter::simulateRange, &batch);
+    }
+    else
+    {
+        simulateRange(0, (unsigned int)batch.emitters.size(), &batch);
+    }
+}
 
+void ParticleEmitter::simulateRange(unsigned int start, unsigned int end, void* cookie)
+{
+    ParticleEmitterBatch* batch = (ParticleEmitterBatch*)cookie;
+    GP_ASSERT(batch);
+    for (unsigned int i = start; i < end; ++i)
+    {
+        batch->emitters[i]->simulate(batch->elapsedTime, *batch->frustums[i]);
+    }
+}
+
+void ParticleEmitter::emit(float elapsedTime)
+{
     if (_started && _emissionRate)
     {
         // Calculate how much time has passed since we last emitted particles.
@@ -817,9 +876,12 @@ void ParticleEmitter::update(float elapsedTime)
             emitOnce(emitCount);
         }
     }
+}
 
-    GP_ASSERT(_node && _node->getScene() && _node->getScene()->getActiveCamera());
-    const Frustum& frustum = _node->getScene()->getActiveCamera()->getFrustum();
+void ParticleEmitter::simulate(float elapsedTime, const Frustum& frustum)
+{
+    // Calculate the time passed since last update.
+    float elapsedSecs = elapsedTime * 0.001f;
 
     // Now update all currently living particles.
     GP_ASSERT(_particles);
@@ -10,10 +10,13 @@
 #include "SpriteBatch.h"
 #include "Properties.h"
 
+class SceneBenchmarkTest;
+
 namespace gameplay
 {
 
 class Node;
+class Frustum;
 
 /**
  * Defines a particle emitter that can be made to simulate and render a particle system.
@@ -139,6 +142,7 @@ class Node;
 class ParticleEmitter : public Ref
 {
     friend class Node;
+    friend class ::SceneBenchmarkTest;
 
 public:
 
@@ -613,6 +617,20 @@ public:
      */
     void update(float elapsedTime);
 
+    /**
+     * Updates the particles of several emitters, simulating them in parallel on the game's job system.
+     *
+     * New particles are emitted by each active emitter in turn, in the order of the emitters, so
+     * that the random properties of the particles are the same as when each emitter is updated
+     * with update(). The living particles of the active emitters are then simulated in parallel.
+     * Each emitter must appear at most once.
+     *
+     * @param emitters The emitters to update.
+     * @param elapsedTime The amount of time that has passed since the last call to update(), in milliseconds.
+     * @script{ignore}
+     */
+    static void update(const std::vector<ParticleEmitter*>& emitters, float elapsedTime);
+
     /**
      * Draws the particles currently being emitted.
      */
@@ -650,6 +668,21 @@ private:
      */
     void setNode(Node* node);
 
+    /**
+     * Emits the particles that are due after the given amount of time.
+     */
+    void emit(float elapsedTime);
+
+    /**
+     * Moves the living particles on by the given amount of time, and removes the dead ones.
+     */
+    void simulate(float elapsedTime, const Frustum& frustum);
+
+    /**
+     * Simulates a range of emitters from a batched update on the job system.
+     */
+    static void simulateRange(unsigned int start, unsigned int end, void* cookie);
+
     // Generates a scalar within the range defined by min and max.
     float generateScalar(float min, float max);
 
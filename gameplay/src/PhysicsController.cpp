@@ -472,6 +472,8 @@ void PhysicsController::resume()
 
 void PhysicsController::update(float elapsedTime)
 {
+    GP_PROFILE_SCOPE("PhysicsController::update");
+
     GP_ASSERT(_world);
     _isUpdating = true;
 
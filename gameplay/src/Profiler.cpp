@@ -0,0 +1,396 @@
+#include "Base.h"
+#include "Profiler.h"
+#include "FileSystem.h"
+#include "Stream.h"
+#include "Font.h"
+
+#ifdef WIN32
+    #include <windows.h>
+#else
+    #include <pthread.h>
+    #include <sys/time.h>
+#endif
+
+// The default number of frames kept in the capture.
+#define PROFILER_CAPTURE_FRAMES 120
+
+namespace gameplay
+{
+
+#ifdef WIN32
+
+typedef DWORD ProfilerThreadId;
+
+struct ProfilerMutex
+{
+    ProfilerMutex() { InitializeCriticalSection(&cs); }
+    ~ProfilerMutex() { DeleteCriticalSection(&cs); }
+    CRITICAL_SECTION cs;
+};
+
+static ProfilerMutex __profilerMutex;
+
+static void lockProfiler()
+{
+    EnterCriticalSection(&__profilerMutex.cs);
+}
+
+static void unlockProfiler()
+{
+    LeaveCriticalSection(&__profilerMutex.cs);
+}
+
+static ProfilerThreadId getCurrentThreadId()
+{
+    return GetCurrentThreadId();
+}
+
+static bool isSameThread(ProfilerThreadId thread1, ProfilerThreadId thread2)
+{
+    return thread1 == thread2;
+}
+
+static double getProfilerTime()
+{
+    static LARGE_INTEGER frequency = { 0 };
+    if (frequency.QuadPart == 0)
+        QueryPerformanceFrequency(&frequency);
+    LARGE_INTEGER counter;
+    QueryPerformanceCounter(&counter);
+    return (double)counter.QuadPart * 1000.0 / (double)frequency.QuadPart;
+}
+
+#else
+
+typedef pthread_t ProfilerThreadId;
+
+static pthread_mutex_t __profilerMutex = PTHREAD_MUTEX_INITIALIZER;
+
+static void lockProfiler()
+{
+    pthread_mutex_lock(&__profilerMutex);
+}
+
+static void unlockProfiler()
+{
+    pthread_mutex_unlock(&__profilerMutex);
+}
+
+static ProfilerThreadId getCurrentThreadId()
+{
+    return pthread_self();
+}
+
+static bool isSameThread(ProfilerThreadId thread1, ProfilerThreadId thread2)
+{
+    return pthread_equal(thread1, thread2) != 0;
+}
+
+static double getProfilerTime()
+{
+    timeval time;
+    gettimeofday(&time, NULL);
+    return (double)time.tv_sec * 1000.0 + (double)time.tv_usec / 1000.0;
+}
+
+#endif
+
+/**
+ * A scope recorded by the profiler.
+ */
+struct ProfilerEvent
+{
+    const char* name;
+    double start;
+    double duration;
+    unsigned int thread;
+};
+
+/**
+ * A node of the tree of scopes in the on-screen summary.
+ */
+struct ProfilerSummaryNode
+{
+    const char* name;
+    int parent;
+    unsigned int depth;
+    double total;
+    double max;
+    double frameTotal;
+    unsigned int calls;
+    std::vector<int> children;
+};
+
+#ifdef GAMEPLAY_PROFILER
+static bool __profilerEnabled = true;
+#else
+static bool __profilerEnabled = false;
+#endif
+static unsigned int __profilerCaptureFrames = PROFILER_CAPTURE_FRAMES;
+static std::vector<ProfilerEvent> __profilerFrame;
+static std::deque<std::vector<ProfilerEvent> > __profilerFrames;
+static std::vector<ProfilerThreadId> __profilerThreads;
+
+/**
+ * Returns the index of the calling thread. The profiler must be locked.
+ */
+static unsigned int getThreadIndex()
+{
+    ProfilerThreadId thread = getCurrentThreadId();
+    for (size_t i = 0, count = __profilerThreads.size(); i < count; ++i)
+    {
+        if (isSameThread(__profilerThreads[i], thread))
+            return (unsigned int)i;
+    }
+    __profilerThreads.push_back(thread);
+    return (unsigned int)__profilerThreads.size() - 1;
+}
+
+static bool compareEvents(const ProfilerEvent& event1, const ProfilerEvent& event2)
+{
+    if (event1.thread != event2.thread)
+        return event1.thread < event2.thread;
+    if (event1.start != event2.start)
+        return event1.start < event2.start;
+    // Outer scopes start at the same time as their first child but last longer.
+    return event1.duration > event2.duration;
+}
+
+/**
+ * Writes the given string to the stream as a JSON string.
+ */
+static void writeString(Stream* stream, const char* str)
+{
+    stream->write("\"", 1, 1);
+    for (const char* c = str; *c; ++c)
+    {
+        if (*c == '"' || *c == '\\')
+            stream->write("\\", 1, 1);
+        stream->write(c, 1, 1);
+    }
+    stream->write("\"", 1, 1);
+}
+
+Profiler::Scope::Scope(const char* name)
+    : _name(name), _start(__profilerEnabled ? getProfilerTime() : -1.0)
+{
+}
+
+Profiler::Scope::~Scope()
+{
+    if (_start < 0.0)
+        return;
+
+    ProfilerEvent event;
+    event.name = _name;
+    event.start = _start;
+    event.duration = getProfilerTime() - _start;
+
+    lockProfiler();
+    event.thread = getThreadIndex();
+    __profilerFrame.push_back(event);
+    unlockProfiler();
+}
+
+void Profiler::setEnabled(bool enabled)
+{
+    __profilerEnabled = enabled;
+}
+
+bool Profiler::isEnabled()
+{
+    return __profilerEnabled;
+}
+
+void Profiler::setCaptureFrameCount(unsigned int count)
+{
+    lockProfiler();
+    __profilerCaptureFrames = count;
+    while (__profilerFrames.size() > __profilerCaptureFrames)
+    {
+        __profilerFrames.pop_front();
+    }
+    unlockProfiler();
+}
+
+unsigned int Profiler::getCaptureFrameCount()
+{
+    return __profilerCaptureFrames;
+}
+
+void Profiler::clear()
+{
+    lockProfiler();
+    __profilerFrame.clear();
+    __profilerFrames.clear();
+    unlockProfiler();
+}
+
+void Profiler::beginFrame()
+{
+    lockProfiler();
+    if (!__profilerFrame.empty() && __profilerCaptureFrames > 0)
+    {
+        __profilerFrames.push_back(std::vector<ProfilerEvent>());
+        __profilerFrames.back().swap(__profilerFrame);
+        while (__profilerFrames.size() > __profilerCaptureFrames)
+        {
+            __profilerFrames.pop_front();
+        }
+    }
+    __profilerFrame.clear();
+    unlockProfiler();
+}
+
+bool Profiler::saveTrace(const char* path)
+{
+    GP_ASSERT(path);
+
+    // Copy the capture so that recording is not blocked while the file is written.
+    lockProfiler();
+    std::vector<ProfilerEvent> events;
+    for (size_t i = 0, count = __profilerFrames.size(); i < count; ++i)
+    {
+        events.insert(events.end(), __profilerFrames[i].begin(), __profilerFrames[i].end());
+    }
+    unlockProfiler();
+
+    Stream* stream = FileSystem::open(path, FileSystem::WRITE);
+    if (stream == NULL)
+    {
+        GP_WARN("Failed to open file '%s' for writing the profiler trace.", path);
+        return false;
+    }
+
+    // Timestamps and durations are in microseconds, relative to the oldest captured scope.
+    double origin = 0.0;
+    for (size_t i = 0, count = events.size(); i < count; ++i)
+    {
+        if (i == 0 || events[i].start < origin)
+            origin = events[i].start;
+    }
+
+    char buffer[128];
+    const char* header = "{\"traceEvents\":[\n";
+    stream->write(header, 1, strlen(header));
+    for (size_t i = 0, count = events.size(); i < count; ++i)
+    {
+        const ProfilerEvent& event = events[i];
+        stream->write("{\"name\":", 1, 8);
+        writeString(stream, event.name);
+        sprintf(buffer, ",\"cat\":\"gameplay\",\"ph\":\"X\",\"pid\":0,\"tid\":%u,\"ts\":%.3f,\"dur\":%.3f}%s\n",
+            event.thread, (event.start - origin) * 1000.0, event.duration * 1000.0, i + 1 < count ? "," : "");
+        stream->write(buffer, 1, strlen(buffer));
+    }
+    const char* footer = "]}\n";
+    stream->write(footer, 1, strlen(footer));
+    stream->close();
+    SAFE_DELETE(stream);
+
+    return true;
+}
+
+void Profiler::drawSummary(Font* font, int x, int y)
+{
+    GP_ASSERT(font);
+
+    std::vector<std::string> lines;
+    getSummary(&lines);
+
+    unsigned int size = font->getSize();
+    font->start();
+    for (size_t i = 0, count = lines.size(); i < count; ++i)
+    {
+        font->drawText(lines[i].c_str(), x, y, Vector4::one(), size);
+        y += size;
+    }
+    font->finish();
+}
+
+void Profiler::getSummary(std::vector<std::string>* lines)
+{
+    GP_ASSERT(lines);
+
+    lockProfiler();
+    std::deque<std::vector<ProfilerEvent> > frames(__profilerFrames);
+    unlockProfiler();
+
+    // Merge the scopes of all frames into a tree, where scopes with the same name
+    // and parent are combined, and the children of each node are kept in the order
+    // in which they first ran.
+    std::vector<ProfilerSummaryNode> nodes;
+    std::vector<int> roots;
+    std::map<std::pair<int, std::string>, int> lookup;
+    for (size_t f = 0, frameCount = frames.size(); f < frameCount; ++f)
+    {
+        std::vector<ProfilerEvent>& events = frames[f];
+        std::sort(events.begin(), events.end(), compareEvents);
+
+        std::vector<std::pair<int, double> > stack;
+        for (size_t i = 0, count = events.size(); i < count; ++i)
+        {
+            const ProfilerEvent& event = events[i];
+            if (i > 0 && events[i - 1].thread != event.thread)
+                stack.clear();
+            while (!stack.empty() && event.start >= stack.back().second)
+            {
+                stack.pop_back();
+            }
+
+            int parent = stack.empty() ? -1 : stack.back().first;
+            std::pair<int, std::string> key(parent, event.name);
+            std::map<std::pair<int, std::string>, int>::iterator itr = lookup.find(key);
+            int index;
+            if (itr == lookup.end())
+            {
+                index = (int)nodes.size();
+                ProfilerSummaryNode node;
+                node.name = event.name;
+                node.parent = parent;
+                node.depth = (unsigned int)stack.size();
+                node.total = 0.0;
+                node.max = 0.0;
+                node.frameTotal = 0.0;
+                node.calls = 0;
+                nodes.push_back(node);
+                lookup[key] = index;
+                if (parent < 0)
+                    roots.push_back(index);
+                else
+                    nodes[parent].children.push_back(index);
+            }
+            else
+            {
+                index = itr->second;
+            }
+
+            nodes[index].total += event.duration;
+            nodes[index].frameTotal += event.duration;
+            nodes[index].calls++;
+            stack.push_back(std::make_pair(index, event.start + event.duration));
+        }
+
+        for (size_t i = 0, count = nodes.size(); i < count; ++i)
+        {
+            nodes[i].max = std::max(nodes[i].max, nodes[i].frameTotal);
+            nodes[i].frameTotal = 0.0;
+        }
+    }
+
+    // Format the tree depth first.
+    float frameCount = frames.empty() ? 1.0f : (float)frames.size();
+    char buffer[256];
+    std::vector<int> pending(roots.rbegin(), roots.rend());
+    while (!pending.empty())
+    {
+        const ProfilerSummaryNode& node = nodes[pending.back()];
+        pending.pop_back();
+        pending.insert(pending.end(), node.children.rbegin(), node.children.rend());
+
+        sprintf(buffer, "%*s%s: %.2f ms avg, %.2f ms max, %.1f calls", node.depth * 2, "", node.name,
+            node.total / frameCount, node.max, node.calls / frameCount);
+        lines->push_back(buffer);
+    }
+}
+
+}
@@ -0,0 +1,145 @@
+#ifndef PROFILER_H_
+#define PROFILER_H_
+
+namespace gameplay
+{
+
+class Font;
+
+/**
+ * Defines a hierarchical CPU profiler for finding where the time of a frame goes.
+ *
+ * Code is instrumented with the GP_PROFILE_SCOPE macro, which records the time spent
+ * in the enclosing scope on the calling thread. Scopes that run inside other scopes
+ * on the same thread are nested below them. The macro compiles to nothing unless
+ * GAMEPLAY_PROFILER is defined, so instrumentation has no cost in normal builds.
+ *
+ * The profiler keeps a rolling capture of the most recent frames. The capture can be
+ * saved as a Chrome trace (open it from chrome://tracing) or summarized on screen,
+ * which shows the average and maximum time of each scope over the captured frames.
+ */
+class Profiler
+{
+    friend class Game;
+
+public:
+
+    /**
+     * Records the time spent between its construction and destruction.
+     *
+     * Use the GP_PROFILE_SCOPE macro rather than creating scopes directly.
+     */
+    class Scope
+    {
+    public:
+
+        /**
+         * Constructor.
+         *
+         * @param name The name of the scope, which must be a string literal.
+         */
+        Scope(const char* name);
+
+        /**
+         * Destructor.
+         */
+        ~Scope();
+
+    private:
+
+        /**
+         * Hidden copy constructor.
+         */
+        Scope(const Scope& copy);
+
+        /**
+         * Hidden copy assignment operator.
+         */
+        Scope& operator=(const Scope&);
+
+        const char* _name;
+        double _start;
+    };
+
+    /**
+     * Sets whether scopes are recorded.
+     *
+     * Recording is enabled by default when GAMEPLAY_PROFILER is defined.
+     *
+     * @param enabled true to record scopes, false to ignore them.
+     */
+    static void setEnabled(bool enabled);
+
+    /**
+     * Determines if scopes are recorded.
+     *
+     * @return true if scopes are recorded, false otherwise.
+     */
+    static bool isEnabled();
+
+    /**
+     * Sets the number of most recent frames kept in the capture.
+     *
+     * @param count The number of frames to keep.
+     */
+    static void setCaptureFrameCount(unsigned int count);
+
+    /**
+     * Returns the number of most recent frames kept in the capture.
+     *
+     * @return The number of frames kept.
+     */
+    static unsigned int getCaptureFrameCount();
+
+    /**
+     * Discards all captured frames.
+     */
+    static void clear();
+
+    /**
+     * Saves the captured frames in the Chrome trace event format.
+     *
+     * @param path The path of the file to write, relative to the resource path.
+     *
+     * @return true if the trace was saved, false otherwise.
+     */
+    static bool saveTrace(const char* path);
+
+    /**
+     * Draws the average and maximum time of each scope over the captured frames.
+     *
+     * @param font The font to draw the summary with.
+     * @param x The x coordinate of the summary.
+     * @param y The y coordinate of the summary.
+     */
+    static void drawSummary(Font* font, int x, int y);
+
+private:
+
+    /**
+     * Constructor.
+     */
+    Profiler();
+
+    /**
+     * Ends the frame being captured and starts a new one.
+     */
+    static void beginFrame();
+
+    /**
+     * Formats one line of the summary for each scope of the captured frames.
+     */
+    static void getSummary(std::vector<std::string>* lines);
+};
+
+}
+
+#ifdef GAMEPLAY_PROFILER
+    #define GP_PROFILE_CONCAT_(a, b) a##b
+    #define GP_PROFILE_CONCAT(a, b) GP_PROFILE_CONCAT_(a, b)
+    #define GP_PROFILE_SCOPE(name) gameplay::Profiler::Scope GP_PROFILE_CONCAT(__profileScope, __LINE__)(name)
+#else
+    #define GP_PROFILE_SCOPE(name)
+#endif
+
+#endif
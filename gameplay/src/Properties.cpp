@@ -1,11 +1,24 @@
 #include "Base.h"
 #include "Properties.h"
 #include "FileSystem.h"
+#include "Ref.h"
 #include "Quaternion.h"
 
+// The version of the compiled properties format.
+#define PROPERTIES_VERSION 1
+
+// The most values that are parsed from a property, as in a matrix.
+#define PROPERTY_MAX_VALUES 16
+
 namespace gameplay
 {
 
+// The directory that compiled properties are cached in, or empty if the cache is disabled.
+static std::string __cachePath;
+
+// Identifies compiled properties files.
+static const unsigned char __propertiesIdentifier[9] = { 0xAB, 'G', 'P', 'P', 0xBB, '\r', '\n', 0x1A, '\n' };
+
 /**
  * Reads the next character from the stream. Returns EOF if the end of the stream is reached.
  */
@@ -25,31 +38,77 @@ void calculateNamespacePath(const std::string& urlString, std::string& fileStrin
 /** @script{ignore} */
 Properties* getPropertiesFromNamespacePath(Properties* properties, const std::vector<std::string>& namespacePath);
 
-Properties::Properties()
+/**
+ * A namespace of a properties file as it is read from text, before it is compiled.
+ */
+class PropertiesNamespace
 {
-}
+public:
+
+    PropertiesNamespace(Stream* stream);
+
+    PropertiesNamespace(Stream* stream, const char* name, const char* id = NULL, const char* parentID = NULL);
+
+    PropertiesNamespace(const PropertiesNamespace& copy);
+
+    ~PropertiesNamespace();
+
+    // Called after reading the file; copies info from parents into derived namespaces.
+    void resolveInheritance(const char* id = NULL);
+
+    const char* getNextProperty(char** value = NULL);
+
+    PropertiesNamespace* getNextNamespace();
 
-Properties::Properties(const Properties& copy)
+    void rewind();
+
+    PropertiesNamespace* getNamespace(const char* id, bool searchNames = false) const;
+
+    const char* getNamespace() const;
+
+    const char* getId() const;
+
+    std::string _namespace;
+    std::string _id;
+    std::string _parentID;
+    std::map<std::string, std::string> _properties;
+    std::map<std::string, std::string>::const_iterator _propertiesItr;
+    std::vector<PropertiesNamespace*> _namespaces;
+    std::vector<PropertiesNamespace*>::const_iterator _namespacesItr;
+
+private:
+
+    void readProperties(Stream* stream);
+
+    void skipWhiteSpace(Stream* stream);
+
+    char* trimWhiteSpace(char* str);
+
+    // Called by resolveInheritance().
+    void mergeWith(PropertiesNamespace* overrides);
+};
+
+PropertiesNamespace::PropertiesNamespace(const PropertiesNamespace& copy)
     : _namespace(copy._namespace), _id(copy._id), _parentID(copy._parentID), _properties(copy._properties)
 {
-    _namespaces = std::vector<Properties*>();
-    std::vector<Properties*>::const_iterator it;
+    _namespaces = std::vector<PropertiesNamespace*>();
+    std::vector<PropertiesNamespace*>::const_iterator it;
     for (it = copy._namespaces.begin(); it < copy._namespaces.end(); ++it)
     {
         GP_ASSERT(*it);
-        _namespaces.push_back(new Properties(**it));
+        _namespaces.push_back(new PropertiesNamespace(**it));
     }
     rewind();
 }
 
 
-Properties::Properties(Stream* stream)
+PropertiesNamespace::PropertiesNamespace(Stream* stream)
 {
     readProperties(stream);
     rewind();
 }
 
-Properties::Properties(Stream* stream, const char* name, const char* id, const char* parentID) : _namespace(name)
+PropertiesNamespace::PropertiesNamespace(Stream* stream, const char* name, const char* id, const char* parentID) : _namespace(name)
 {
     if (id)
     {
@@ -63,51 +122,7 @@ Properties::Properties(Stream* stream, const char* name, const char* id, const c
     rewind();
 }
 
-Properties* Properties::create(const char* url)
-{
-    if (!url || strlen(url) == 0)
-    {
-        GP_ERROR("Attempting to create a Properties object from an empty URL!");
-        return NULL;
-    }
-
-    // Calculate the file and full namespace path from the specified url.
-    std::string urlString = url;
-    std::string fileString;
-    std::vector<std::string> namespacePath;
-    calculateNamespacePath(urlString, fileString, namespacePath);
-
-    std::auto_ptr<Stream> stream(FileSystem::open(fileString.c_str()));
-    if (stream.get() == NULL)
-    {
-        GP_ERROR("Failed to open file '%s'.", fileString.c_str());
-        return NULL;
-    }
-
-    Properties* properties = new Properties(stream.get());
-    properties->resolveInheritance();
-    stream->close();
-
-    // Get the specified properties object.
-    Properties* p = getPropertiesFromNamespacePath(properties, namespacePath);
-    if (!p)
-    {
-        GP_ERROR("Failed to load properties from url '%s'.", url);
-        return NULL;
-    }
-
-    // If the loaded properties object is not the root namespace,
-    // then we have to clone it and delete the root namespace
-    // so that we don't leak memory.
-    if (p != properties)
-    {
-        p = p->clone();
-        SAFE_DELETE(properties);
-    }
-    return p;
-}
-
-void Properties::readProperties(Stream* stream)
+void PropertiesNamespace::readProperties(Stream* stream)
 {
     GP_ASSERT(stream);
 
@@ -248,7 +263,7 @@ void Properties::readProperties(Stream* stream)
                     }
 
                     // New namespace without an ID.
-                    Properties* space = new Properties(stream, name, NULL, parentID);
+                    PropertiesNamespace* space = new PropertiesNamespace(stream, name, NULL, parentID);
                     _namespaces.push_back(space);
 
                     // If the namespace ends on this line, seek to right after the '}' character.
@@ -290,7 +305,7 @@ void Properties::readProperties(Stream* stream)
                         }
 
                         // Create new namespace.
-                        Properties* space = new Properties(stream, name, value, parentID);
+                        PropertiesNamespace* space = new PropertiesNamespace(stream, name, value, parentID);
                         _namespaces.push_back(space);
 
                         // If the namespace ends on this line, seek to right after the '}' character.
@@ -311,7 +326,7 @@ void Properties::readProperties(Stream* stream)
                         if (c == '{')
                         {
                             // Create new namespace.
-                            Properties* space = new Properties(stream, name, value, parentID);
+                            PropertiesNamespace* space = new PropertiesNamespace(stream, name, value, parentID);
                             _namespaces.push_back(space);
                         }
                         else
@@ -337,7 +352,7 @@ void Properties::readProperties(Stream* stream)
     }
 }
 
-Properties::~Properties()
+PropertiesNamespace::~PropertiesNamespace()
 {
     for (size_t i = 0, count = _namespaces.size(); i < count; ++i)
     {
@@ -345,7 +360,7 @@ Properties::~Properties()
     }
 }
 
-void Properties::skipWhiteSpace(Stream* stream)
+void PropertiesNamespace::skipWhiteSpace(Stream* stream)
 {
     signed char c;
     do
@@ -364,7 +379,7 @@ void Properties::skipWhiteSpace(Stream* stream)
     }
 }
 
-char* Properties::trimWhiteSpace(char *str)
+char* PropertiesNamespace::trimWhiteSpace(char *str)
 {
     if (str == NULL)
     {
@@ -394,14 +409,14 @@ char* Properties::trimWhiteSpace(char *str)
     return str;
 }
 
-void Properties::resolveInheritance(const char* id)
+void PropertiesNamespace::resolveInheritance(const char* id)
 {
     // Namespaces can be defined like so:
     // "name id : parentID { }"
     // This method merges data from the parent namespace into the child.
 
     // Get a top-level namespace.
-    Properties* derived;
+    PropertiesNamespace* derived;
     if (id)
     {
         derived = getNamespace(id);
@@ -415,13 +430,13 @@ void Properties::resolveInheritance(const char* id)
         // If the namespace has a parent ID, find the parent.
         if (!derived->_parentID.empty())
         {
-            Properties* parent = getNamespace(derived->_parentID.c_str());
+            PropertiesNamespace* parent = getNamespace(derived->_parentID.c_str());
             if (parent)
             {
                 resolveInheritance(parent->getId());
 
                 // Copy the child.
-                Properties* overrides = new Properties(*derived);
+                PropertiesNamespace* overrides = new PropertiesNamespace(*derived);
 
                 // Delete the child's data.
                 for (size_t i = 0, count = derived->_namespaces.size(); i < count; i++)
@@ -431,12 +446,12 @@ void Properties::resolveInheritance(const char* id)
 
                 // Copy data from the parent into the child.
                 derived->_properties = parent->_properties;
-                derived->_namespaces = std::vector<Properties*>();
-                std::vector<Properties*>::const_iterator itt;
+                derived->_namespaces = std::vector<PropertiesNamespace*>();
+                std::vector<PropertiesNamespace*>::const_iterator itt;
                 for (itt = parent->_namespaces.begin(); itt < parent->_namespaces.end(); ++itt)
                 {
                     GP_ASSERT(*itt);
-                    derived->_namespaces.push_back(new Properties(**itt));
+                    derived->_namespaces.push_back(new PropertiesNamespace(**itt));
                 }
                 derived->rewind();
 
@@ -463,7 +478,7 @@ void Properties::resolveInheritance(const char* id)
     }
 }
 
-void Properties::mergeWith(Properties* overrides)
+void PropertiesNamespace::mergeWith(PropertiesNamespace* overrides)
 {
     GP_ASSERT(overrides);
 
@@ -480,13 +495,13 @@ void Properties::mergeWith(Properties* overrides)
     this->_propertiesItr = this->_properties.end();
 
     // Merge all common nested namespaces, add new ones.
-    Properties* overridesNamespace = overrides->getNextNamespace();
+    PropertiesNamespace* overridesNamespace = overrides->getNextNamespace();
     while (overridesNamespace)
     {
         bool merged = false;
 
         rewind();
-        Properties* derivedNamespace = getNextNamespace();
+        PropertiesNamespace* derivedNamespace = getNextNamespace();
         while (derivedNamespace)
         {
             if (strcmp(derivedNamespace->getNamespace(), overridesNamespace->getNamespace()) == 0 &&
@@ -502,7 +517,7 @@ void Properties::mergeWith(Properties* overrides)
         if (!merged)
         {
             // Add this new namespace.
-            Properties* newNamespace = new Properties(*overridesNamespace);
+            PropertiesNamespace* newNamespace = new PropertiesNamespace(*overridesNamespace);
 
             this->_namespaces.push_back(newNamespace);
             this->_namespacesItr = this->_namespaces.end();
@@ -512,7 +527,7 @@ void Properties::mergeWith(Properties* overrides)
     }
 }
 
-const char* Properties::getNextProperty(char** value)
+const char* PropertiesNamespace::getNextProperty(char** value)
 {
     if (_propertiesItr == _properties.end())
     {
@@ -541,7 +556,7 @@ const char* Properties::getNextProperty(char** value)
     return NULL;
 }
 
-Properties* Properties::getNextNamespace()
+PropertiesNamespace* PropertiesNamespace::getNextNamespace()
 {
     if (_namespacesItr == _namespaces.end())
     {
@@ -555,25 +570,25 @@ Properties* Properties::getNextNamespace()
 
     if (_namespacesItr != _namespaces.end())
     {
-        Properties* ns = *_namespacesItr;
+        PropertiesNamespace* ns = *_namespacesItr;
         return ns;
     }
 
     return NULL;
 }
 
-void Properties::rewind()
+void PropertiesNamespace::rewind()
 {
     _propertiesItr = _properties.end();
     _namespacesItr = _namespaces.end();
 }
 
-Properties* Properties::getNamespace(const char* id, bool searchNames) const
+PropertiesNamespace* PropertiesNamespace::getNamespace(const char* id, bool searchNames) const
 {
     GP_ASSERT(id);
 
-    Properties* ret = NULL;
-    std::vector<Properties*>::const_iterator it;
+    PropertiesNamespace* ret = NULL;
+    std::vector<PropertiesNamespace*>::const_iterator it;
     
     for (it = _namespaces.begin(); it < _namespaces.end(); ++it)
     {
@@ -594,22 +609,16 @@ Properties* Properties::getNamespace(const char* id, bool searchNames) const
     return ret;
 }
 
-const char* Properties::getNamespace() const
+const char* PropertiesNamespace::getNamespace() const
 {
     return _namespace.c_str();
 }
 
-const char* Properties::getId() const
+const char* PropertiesNamespace::getId() const
 {
     return _id.c_str();
 }
 
-bool Properties::exists(const char* name) const
-{
-    GP_ASSERT(name);
-    return _properties.find(name) != _properties.end();
-}
-
 static const bool isStringNumeric(const char* str)
 {
     GP_ASSERT(str);
@@ -644,20 +653,14 @@ static const bool isStringNumeric(const char* str)
     return true;
 }
 
-Properties::Type Properties::getType(const char* name) const
+// Returns the type of a property value, by the number of commas in it.
+static Properties::Type getValueType(const char* value)
 {
-    const char* value = getString(name);
-    if (!value)
-    {
-        return Properties::NONE;
-    }
+    GP_ASSERT(value);
 
-    // Parse the value to determine the format
     unsigned int commaCount = 0;
-    char* valuePtr = const_cast<char*>(value);
-    while (valuePtr = strchr(valuePtr, ','))
+    for (const char* c = strchr(value, ','); c; c = strchr(c + 1, ','))
     {
-        valuePtr++;
         commaCount++;
     }
 
@@ -678,33 +681,725 @@ Properties::Type Properties::getType(const char* name) const
     }
 }
 
-const char* Properties::getString(const char* name) const
+/**
+ * The header of a compiled properties file.
+ *
+ * It is followed by the namespaces, the properties, the parsed values and the strings of
+ * the file. The namespaces are stored breadth first, so the namespaces within a namespace
+ * are consecutive, and the properties of a namespace are consecutive and sorted by name.
+ */
+struct PropertiesHeader
+{
+    unsigned char identifier[9];
+    unsigned char version;
+    unsigned char reserved[2];
+    unsigned int sourceHash[2];
+    unsigned int sourceSize;
+    unsigned int namespaceCount;
+    unsigned int propertyCount;
+    unsigned int valueCount;
+    unsigned int stringsSize;
+};
+
+/**
+ * A compiled namespace. Names and IDs are offsets into the strings.
+ */
+struct PropertiesNamespaceEntry
+{
+    unsigned int name;
+    unsigned int id;
+    unsigned int firstProperty;
+    unsigned int propertyCount;
+    unsigned int firstNamespace;
+    unsigned int namespaceCount;
+};
+
+// The flags of a compiled property.
+enum PropertyFlags
+{
+    PROPERTY_TRUE = 1,
+    PROPERTY_INTEGER = 2,
+    PROPERTY_RGB = 4,
+    PROPERTY_RGBA = 8
+};
+
+struct Properties::Property
+{
+    // The offsets of the name and the value into the strings.
+    unsigned int name;
+    unsigned int value;
+    unsigned char type;
+    // The number of floats that the value starts with, and the index of the first one.
+    unsigned char valueCount;
+    unsigned short flags;
+    int integer;
+    unsigned int color;
+    unsigned int firstValue;
+};
+
+/**
+ * The strings of a compiled file, each of which is stored once.
+ */
+class PropertiesStringTable
 {
-    if (name)
+public:
+
+    PropertiesStringTable() : _offsets(256, 0), _hashes(256, 0), _count(0)
+    {
+        add("");
+    }
+
+    // Returns the offset of the given string, adding it if it is not stored yet.
+    unsigned int add(const char* str)
     {
-        std::map<std::string, std::string>::const_iterator itr = _properties.find(name);
-        if (itr != _properties.end())
+        size_t length = strlen(str);
+        unsigned int hash = 2166136261u;
+        for (size_t i = 0; i < length; ++i)
+        {
+            hash = (hash ^ (unsigned char)str[i]) * 16777619u;
+        }
+
+        // Find the string by linear probing. The slots store offsets plus one, or zero if empty.
+        size_t mask = _offsets.size() - 1;
+        size_t slot = hash & mask;
+        while (_offsets[slot] != 0)
         {
-            return itr->second.c_str();
+            if (_hashes[slot] == hash && strcmp(&_strings[_offsets[slot] - 1], str) == 0)
+                return _offsets[slot] - 1;
+            slot = (slot + 1) & mask;
         }
+
+        unsigned int offset = (unsigned int)_strings.size();
+        _strings.insert(_strings.end(), str, str + length + 1);
+        _offsets[slot] = offset + 1;
+        _hashes[slot] = hash;
+        if (++_count * 2 > _offsets.size())
+            grow();
+        return offset;
+    }
+
+    std::vector<char> _strings;
+
+private:
+
+    void grow()
+    {
+        std::vector<unsigned int> offsets(_offsets.size() * 2, 0);
+        std::vector<unsigned int> hashes(_offsets.size() * 2, 0);
+        size_t mask = offsets.size() - 1;
+        for (size_t i = 0; i < _offsets.size(); ++i)
+        {
+            if (_offsets[i] == 0)
+                continue;
+            size_t slot = _hashes[i] & mask;
+            while (offsets[slot] != 0)
+            {
+                slot = (slot + 1) & mask;
+            }
+            offsets[slot] = _offsets[i];
+            hashes[slot] = _hashes[i];
+        }
+        _offsets.swap(offsets);
+        _hashes.swap(hashes);
+    }
+
+    std::vector<unsigned int> _offsets;
+    std::vector<unsigned int> _hashes;
+    unsigned int _count;
+};
+
+class Properties::Data : public Ref
+{
+public:
+
+    /**
+     * Loads the properties file at the given path, from the cache if possible.
+     */
+    static Data* load(const char* path);
+
+    /**
+     * Compiles the namespaces read from a properties file.
+     */
+    static Data* compile(PropertiesNamespace* root, const unsigned int sourceHash[2], unsigned int sourceSize);
+
+    const char* getString(unsigned int offset) const
+    {
+        return _strings + offset;
+    }
+
+    const PropertiesHeader* _header;
+    const PropertiesNamespaceEntry* _namespaces;
+    const Property* _properties;
+    const float* _values;
+    const char* _strings;
+
+private:
+
+    Data(char* buffer, Stream* stream);
+
+    ~Data();
+
+    Data(const Data& copy);
+
+    Data& operator=(const Data&);
+
+    // Points the data at a compiled file, after checking that it is complete and consistent.
+    bool attach(const char* buffer, size_t size);
+
+    // Maps a cached file that was compiled from the given source.
+    static Data* map(const char* path, const unsigned int sourceHash[2], unsigned int sourceSize);
+
+    static void compileProperty(const char* name, const char* value, std::vector<Property>& properties,
+        std::vector<float>& values, PropertiesStringTable& strings);
+
+    char* _buffer;
+    Stream* _stream;
+};
+
+
+// Computes a 64-bit FNV-1a hash of the rest of a stream.
+static void hashStream(Stream* stream, unsigned int hash[2], unsigned int* size)
+{
+    unsigned long long h = 14695981039346656037ULL;
+    unsigned int total = 0;
+    unsigned char buffer[4096];
+    size_t read;
+    while ((read = stream->read(buffer, 1, sizeof(buffer))) > 0)
+    {
+        for (size_t i = 0; i < read; ++i)
+        {
+            h = (h ^ buffer[i]) * 1099511628211ULL;
+        }
+        total += (unsigned int)read;
+    }
+    hash[0] = (unsigned int)h;
+    hash[1] = (unsigned int)(h >> 32);
+    *size = total;
+}
+
+Properties::Data::Data(char* buffer, Stream* stream)
+    : _header(NULL), _namespaces(NULL), _properties(NULL), _values(NULL), _strings(NULL), _buffer(buffer), _stream(stream)
+{
+}
+
+Properties::Data::~Data()
+{
+    SAFE_DELETE_ARRAY(_buffer);
+    SAFE_DELETE(_stream);
+}
+
+Properties::Data* Properties::Data::load(const char* path)
+{
+    GP_ASSERT(path);
+
+    Stream* stream = FileSystem::open(path);
+    if (!stream)
+    {
+        GP_ERROR("Failed to open file '%s'.", path);
+        return NULL;
+    }
+
+    // Compiled files are only looked up by the hash of their source when they are cached.
+    unsigned int sourceHash[2] = { 0, 0 };
+    unsigned int sourceSize = 0;
+    std::string cacheFile;
+    if (!__cachePath.empty())
+    {
+        hashStream(stream, sourceHash, &sourceSize);
+
+        char name[32];
+        sprintf(name, "/%08x%08x.gpp", sourceHash[1], sourceHash[0]);
+        cacheFile = __cachePath + name;
+        Data* data = map(cacheFile.c_str(), sourceHash, sourceSize);
+        if (data)
+        {
+            SAFE_DELETE(stream);
+            return data;
+        }
+
+        if (!stream->rewind())
+        {
+            GP_ERROR("Failed to rewind file '%s'.", path);
+            SAFE_DELETE(stream);
+            return NULL;
+        }
+    }
+
+    PropertiesNamespace root(stream);
+    root.resolveInheritance();
+    SAFE_DELETE(stream);
+
+    Data* data = compile(&root, sourceHash, sourceSize);
+    if (!data)
+    {
+        return NULL;
+    }
+
+    if (!cacheFile.empty())
+    {
+        size_t size = data->_strings + data->_header->stringsSize - data->_buffer;
+        Stream* cache = FileSystem::open(cacheFile.c_str(), FileSystem::WRITE);
+        if (!cache || cache->write(data->_buffer, 1, size) != size)
+        {
+            GP_WARN("Failed to write properties cache file '%s'.", cacheFile.c_str());
+        }
+        SAFE_DELETE(cache);
+    }
+
+    return data;
+}
+
+Properties::Data* Properties::Data::map(const char* path, const unsigned int sourceHash[2], unsigned int sourceSize)
+{
+    Stream* stream = FileSystem::open(path, FileSystem::READ | FileSystem::MAP);
+    if (!stream)
+        return NULL;
+
+    size_t size = stream->length();
+    const char* buffer = (const char*)stream->map(size);
+    Data* data;
+    if (buffer)
+    {
+        data = new Data(NULL, stream);
     }
     else
     {
-        if (_propertiesItr != _properties.end())
+        // Read the file on platforms that cannot map it.
+        char* copy = new char[size];
+        if (stream->read(copy, 1, size) != size)
         {
-            return _propertiesItr->second.c_str();
+            SAFE_DELETE_ARRAY(copy);
+            SAFE_DELETE(stream);
+            return NULL;
         }
+        SAFE_DELETE(stream);
+        data = new Data(copy, NULL);
+        buffer = copy;
+    }
+
+    if (!data->attach(buffer, size) ||
+        data->_header->sourceHash[0] != sourceHash[0] || data->_header->sourceHash[1] != sourceHash[1] ||
+        data->_header->sourceSize != sourceSize)
+    {
+        SAFE_RELEASE(data);
+        return NULL;
+    }
+    return data;
+}
+
+bool Properties::Data::attach(const char* buffer, size_t size)
+{
+    GP_ASSERT(buffer);
+
+    if (size < sizeof(PropertiesHeader))
+        return false;
+    const PropertiesHeader* header = (const PropertiesHeader*)buffer;
+    if (memcmp(header->identifier, __propertiesIdentifier, sizeof(__propertiesIdentifier)) != 0 ||
+        header->version != PROPERTIES_VERSION || header->namespaceCount == 0 || header->stringsSize == 0)
+    {
+        return false;
     }
 
+    // Check that the sections add up to the size of the file.
+    size_t offset = sizeof(PropertiesHeader);
+    if (header->namespaceCount > (size - offset) / sizeof(PropertiesNamespaceEntry))
+        return false;
+    offset += header->namespaceCount * sizeof(PropertiesNamespaceEntry);
+    if (header->propertyCount > (size - offset) / sizeof(Property))
+        return false;
+    offset += header->propertyCount * sizeof(Property);
+    if (header->valueCount > (size - offset) / sizeof(float))
+        return false;
+    offset += header->valueCount * sizeof(float);
+    if (header->stringsSize != size - offset || buffer[size - 1] != '\0')
+        return false;
+
+    const PropertiesNamespaceEntry* namespaces = (const PropertiesNamespaceEntry*)(buffer + sizeof(PropertiesHeader));
+    const Property* properties = (const Property*)(namespaces + header->namespaceCount);
+
+    // Check that all offsets and ranges are within their sections. The namespaces within
+    // a namespace must come after it, which also rules out cycles.
+    for (unsigned int i = 0; i < header->namespaceCount; ++i)
+    {
+        const PropertiesNamespaceEntry& ns = namespaces[i];
+        if (ns.name >= header->stringsSize || ns.id >= header->stringsSize ||
+            ns.firstProperty > header->propertyCount || ns.propertyCount > header->propertyCount - ns.firstProperty ||
+            ns.firstNamespace > header->namespaceCount || ns.namespaceCount > header->namespaceCount - ns.firstNamespace ||
+            (ns.namespaceCount > 0 && ns.firstNamespace <= i))
+        {
+            return false;
+        }
+    }
+    for (unsigned int i = 0; i < header->propertyCount; ++i)
+    {
+        const Property& p = properties[i];
+        if (p.name >= header->stringsSize || p.value >= header->stringsSize || p.type > MATRIX ||
+            p.firstValue > header->valueCount || p.valueCount > header->valueCount - p.firstValue)
+        {
+            return false;
+        }
+    }
+
+    _header = header;
+    _namespaces = namespaces;
+    _properties = properties;
+    _values = (const float*)(properties + header->propertyCount);
+    _strings = buffer + offset;
+    return true;
+}
+
+void Properties::Data::compileProperty(const char* name, const char* value, std::vector<Property>& properties,
+    std::vector<float>& values, PropertiesStringTable& strings)
+{
+    Property p;
+    p.name = strings.add(name);
+    p.value = strings.add(value);
+    p.type = (unsigned char)getValueType(value);
+    p.flags = 0;
+
+    // Parse as many comma separated floats as the value starts with, the way the get
+    // methods used to scan them with "%f,%f,...". Most values that are not numbers are
+    // told apart by their first character, without calling strtof.
+    float v[PROPERTY_MAX_VALUES];
+    unsigned int count = 0;
+    const char* ptr = value;
+    while (isspace(*ptr))
+        ++ptr;
+    bool number = *ptr != '\0' && (isdigit(*ptr) || strchr("+-.iInN", *ptr) != NULL);
+    while (number && count < PROPERTY_MAX_VALUES)
+    {
+        char* end;
+        v[count] = strtof(ptr, &end);
+        if (end == ptr)
+            break;
+        ++count;
+        if (*end != ',')
+            break;
+        ptr = end + 1;
+    }
+    p.valueCount = (unsigned char)count;
+    p.firstValue = count > 0 ? (unsigned int)values.size() : 0;
+    values.insert(values.end(), v, v + count);
+
+    if (strcmp(value, "true") == 0)
+        p.flags |= PROPERTY_TRUE;
+
+    p.integer = 0;
+    if (number)
+    {
+        char* end;
+        p.integer = (int)strtol(value, &end, 10);
+        if (end != value)
+            p.flags |= PROPERTY_INTEGER;
+    }
+
+    p.color = 0;
+    size_t length = strlen(value);
+    if ((length == 7 || length == 9) && value[0] == '#')
+    {
+        if (sscanf(value + 1, "%x", &p.color) == 1)
+            p.flags |= length == 7 ? PROPERTY_RGB : PROPERTY_RGBA;
+        else
+            p.color = 0;
+    }
+
+    properties.push_back(p);
+}
+
+Properties::Data* Properties::Data::compile(PropertiesNamespace* root, const unsigned int sourceHash[2], unsigned int sourceSize)
+{
+    GP_ASSERT(root);
+
+    std::vector<PropertiesNamespace*> spaces(1, root);
+    std::vector<PropertiesNamespaceEntry> namespaces;
+    std::vector<Property> properties;
+    std::vector<float> values;
+    PropertiesStringTable strings;
+
+    // Number the namespaces breadth first, so the namespaces within each are consecutive.
+    for (size_t i = 0; i < spaces.size(); ++i)
+    {
+        PropertiesNamespace* space = spaces[i];
+        PropertiesNamespaceEntry ns;
+        ns.name = strings.add(space->_namespace.c_str());
+        ns.id = strings.add(space->_id.c_str());
+        ns.firstProperty = (unsigned int)properties.size();
+        std::map<std::string, std::string>::const_iterator itr;
+        for (itr = space->_properties.begin(); itr != space->_properties.end(); ++itr)
+        {
+            compileProperty(itr->first.c_str(), itr->second.c_str(), properties, values, strings);
+        }
+        ns.propertyCount = (unsigned int)properties.size() - ns.firstProperty;
+        ns.firstNamespace = (unsigned int)spaces.size();
+        ns.namespaceCount = (unsigned int)space->_namespaces.size();
+        spaces.insert(spaces.end(), space->_namespaces.begin(), space->_namespaces.end());
+        namespaces.push_back(ns);
+    }
+
+    PropertiesHeader header;
+    memset(&header, 0, sizeof(header));
+    memcpy(header.identifier, __propertiesIdentifier, sizeof(__propertiesIdentifier));
+    header.version = PROPERTIES_VERSION;
+    header.sourceHash[0] = sourceHash[0];
+    header.sourceHash[1] = sourceHash[1];
+    header.sourceSize = sourceSize;
+    header.namespaceCount = (unsigned int)namespaces.size();
+    header.propertyCount = (unsigned int)properties.size();
+    header.valueCount = (unsigned int)values.size();
+    header.stringsSize = (unsigned int)strings._strings.size();
+
+    size_t size = sizeof(header) + namespaces.size() * sizeof(PropertiesNamespaceEntry) +
+        properties.size() * sizeof(Property) + values.size() * sizeof(float) + strings._strings.size();
+    char* buffer = new char[size];
+    char* ptr = buffer;
+    memcpy(ptr, &header, sizeof(header));
+    ptr += sizeof(header);
+    memcpy(ptr, &namespaces[0], namespaces.size() * sizeof(PropertiesNamespaceEntry));
+    ptr += namespaces.size() * sizeof(PropertiesNamespaceEntry);
+    if (!properties.empty())
+        memcpy(ptr, &properties[0], properties.size() * sizeof(Property));
+    ptr += properties.size() * sizeof(Property);
+    if (!values.empty())
+        memcpy(ptr, &values[0], values.size() * sizeof(float));
+    ptr += values.size() * sizeof(float);
+    memcpy(ptr, &strings._strings[0], strings._strings.size());
+
+    Data* data = new Data(buffer, NULL);
+    if (!data->attach(buffer, size))
+    {
+        GP_ERROR("Failed to attach compiled properties data.");
+        SAFE_RELEASE(data);
+        return NULL;
+    }
+    return data;
+}
+
+Properties::Properties()
+    : _data(NULL), _index(0), _propertyIndex(0), _namespaceIndex(0)
+{
+}
+
+Properties::Properties(Data* data, unsigned int index)
+    : _data(data), _index(index), _propertyIndex(0), _namespaceIndex(0)
+{
+    GP_ASSERT(data);
+    _data->addRef();
+
+    const PropertiesNamespaceEntry& ns = _data->_namespaces[_index];
+    _namespaces.reserve(ns.namespaceCount);
+    for (unsigned int i = 0; i < ns.namespaceCount; ++i)
+    {
+        _namespaces.push_back(new Properties(data, ns.firstNamespace + i));
+    }
+    rewind();
+}
+
+Properties* Properties::create(const char* url)
+{
+    if (!url || strlen(url) == 0)
+    {
+        GP_ERROR("Attempting to create a Properties object from an empty URL!");
+        return NULL;
+    }
+
+    // Calculate the file and full namespace path from the specified url.
+    std::string urlString = url;
+    std::string fileString;
+    std::vector<std::string> namespacePath;
+    calculateNamespacePath(urlString, fileString, namespacePath);
+
+    Data* data = Data::load(fileString.c_str());
+    if (!data)
+    {
+        return NULL;
+    }
+    Properties* properties = new Properties(data, 0);
+    SAFE_RELEASE(data);
+
+    // Get the specified properties object.
+    Properties* p = getPropertiesFromNamespacePath(properties, namespacePath);
+    if (!p)
+    {
+        GP_ERROR("Failed to load properties from url '%s'.", url);
+        SAFE_DELETE(properties);
+        return NULL;
+    }
+
+    // If the loaded properties object is not the root namespace,
+    // then we have to clone it and delete the root namespace
+    // so that we don't leak memory.
+    if (p != properties)
+    {
+        p = p->clone();
+        SAFE_DELETE(properties);
+    }
+    return p;
+}
+
+void Properties::setCachePath(const char* path)
+{
+    __cachePath = path ? path : "";
+}
+
+const char* Properties::getCachePath()
+{
+    return __cachePath.empty() ? NULL : __cachePath.c_str();
+}
+
+Properties::~Properties()
+{
+    for (size_t i = 0, count = _namespaces.size(); i < count; ++i)
+    {
+        SAFE_DELETE(_namespaces[i]);
+    }
+    SAFE_RELEASE(_data);
+}
+
+const char* Properties::getNextProperty(char** value)
+{
+    unsigned int count = _data ? _data->_namespaces[_index].propertyCount : 0;
+    if (_propertyIndex >= count)
+    {
+        // Restart from the beginning
+        _propertyIndex = 0;
+    }
+    else
+    {
+        // Move to the next property
+        ++_propertyIndex;
+    }
+
+    if (_propertyIndex < count)
+    {
+        const Property& p = _data->_properties[_data->_namespaces[_index].firstProperty + _propertyIndex];
+        const char* name = _data->getString(p.name);
+        if (*name)
+        {
+            if (value)
+            {
+                strcpy(*value, _data->getString(p.value));
+            }
+            return name;
+        }
+    }
+
+    return NULL;
+}
+
+Properties* Properties::getNextNamespace()
+{
+    if (_namespaceIndex >= _namespaces.size())
+    {
+        // Restart from the beginning
+        _namespaceIndex = 0;
+    }
+    else
+    {
+        ++_namespaceIndex;
+    }
+
+    if (_namespaceIndex < _namespaces.size())
+    {
+        return _namespaces[_namespaceIndex];
+    }
+
+    return NULL;
+}
+
+void Properties::rewind()
+{
+    _propertyIndex = _data ? _data->_namespaces[_index].propertyCount : 0;
+    _namespaceIndex = (unsigned int)_namespaces.size();
+}
+
+Properties* Properties::getNamespace(const char* id, bool searchNames) const
+{
+    GP_ASSERT(id);
+
+    Properties* ret = NULL;
+    std::vector<Properties*>::const_iterator it;
+
+    for (it = _namespaces.begin(); it < _namespaces.end(); ++it)
+    {
+        ret = *it;
+        if (strcmp(searchNames ? ret->getNamespace() : ret->getId(), id) == 0)
+        {
+            return ret;
+        }
+
+        // Search recursively.
+        ret = ret->getNamespace(id, searchNames);
+        if (ret != NULL)
+        {
+            return ret;
+        }
+    }
+
+    return ret;
+}
+
+const char* Properties::getNamespace() const
+{
+    return _data ? _data->getString(_data->_namespaces[_index].name) : "";
+}
+
+const char* Properties::getId() const
+{
+    return _data ? _data->getString(_data->_namespaces[_index].id) : "";
+}
+
+const Properties::Property* Properties::getProperty(const char* name) const
+{
+    if (!_data)
+        return NULL;
+
+    const PropertiesNamespaceEntry& ns = _data->_namespaces[_index];
+    if (!name)
+    {
+        return _propertyIndex < ns.propertyCount ? &_data->_properties[ns.firstProperty + _propertyIndex] : NULL;
+    }
+
+    // The properties of a namespace are sorted by name.
+    unsigned int first = ns.firstProperty;
+    unsigned int last = ns.firstProperty + ns.propertyCount;
+    while (first < last)
+    {
+        unsigned int middle = first + (last - first) / 2;
+        int c = strcmp(_data->getString(_data->_properties[middle].name), name);
+        if (c < 0)
+            first = middle + 1;
+        else if (c > 0)
+            last = middle;
+        else
+            return &_data->_properties[middle];
+    }
     return NULL;
 }
 
+bool Properties::exists(const char* name) const
+{
+    GP_ASSERT(name);
+    return getProperty(name) != NULL;
+}
+
+Properties::Type Properties::getType(const char* name) const
+{
+    const Property* p = getProperty(name);
+    return p ? (Properties::Type)p->type : Properties::NONE;
+}
+
+const char* Properties::getString(const char* name) const
+{
+    const Property* p = getProperty(name);
+    return p ? _data->getString(p->value) : NULL;
+}
+
 bool Properties::getBool(const char* name, bool defaultValue) const
 {
-    const char* valueString = getString(name);
-    if (valueString)
+    const Property* p = getProperty(name);
+    if (p)
     {
-        return (strcmp(valueString, "true") == 0);
+        return (p->flags & PROPERTY_TRUE) != 0;
     }
 
     return defaultValue;
@@ -712,18 +1407,15 @@ bool Properties::getBool(const char* name, bool defaultValue) const
 
 int Properties::getInt(const char* name) const
 {
-    const char* valueString = getString(name);
-    if (valueString)
+    const Property* p = getProperty(name);
+    if (p)
     {
-        int value;
-        int scanned;
-        scanned = sscanf(valueString, "%d", &value);
-        if (scanned != 1)
+        if ((p->flags & PROPERTY_INTEGER) == 0)
         {
             GP_ERROR("Error attempting to parse property '%s' as an integer.", name);
             return 0;
         }
-        return value;
+        return p->integer;
     }
 
     return 0;
@@ -731,18 +1423,15 @@ int Properties::getInt(const char* name) const
 
 float Properties::getFloat(const char* name) const
 {
-    const char* valueString = getString(name);
-    if (valueString)
+    const Property* p = getProperty(name);
+    if (p)
     {
-        float value;
-        int scanned;
-        scanned = sscanf(valueString, "%f", &value);
-        if (scanned != 1)
+        if (p->valueCount < 1)
         {
             GP_ERROR("Error attempting to parse property '%s' as a float.", name);
             return 0.0f;
         }
-        return value;
+        return _data->_values[p->firstValue];
     }
 
     return 0.0f;
@@ -771,23 +1460,17 @@ bool Properties::getMatrix(const char* name, Matrix* out) const
 {
     GP_ASSERT(out);
 
-    const char* valueString = getString(name);
-    if (valueString)
+    const Property* p = getProperty(name);
+    if (p)
     {
-        float m[16];
-        int scanned;
-        scanned = sscanf(valueString, "%f,%f,%f,%f,%f,%f,%f,%f,%f,%f,%f,%f,%f,%f,%f,%f",
-                &m[0], &m[1], &m[2], &m[3], &m[4], &m[5], &m[6], &m[7],
-                &m[8], &m[9], &m[10], &m[11], &m[12], &m[13], &m[14], &m[15]);
-
-        if (scanned != 16)
+        if (p->valueCount < 16)
         {
             GP_ERROR("Error attempting to parse property '%s' as a matrix.", name);
             out->setIdentity();
             return false;
         }
 
-        out->set(m);
+        out->set(&_data->_values[p->firstValue]);
         return true;
     }
 
@@ -799,23 +1482,20 @@ bool Properties::getVector2(const char* name, Vector2* out) const
 {
     GP_ASSERT(out);
 
-    const char* valueString = getString(name);
-    if (valueString)
+    const Property* p = getProperty(name);
+    if (p)
     {
-        float x, y;
-        int scanned;
-        scanned = sscanf(valueString, "%f,%f", &x, &y);
-        if (scanned != 2)
+        if (p->valueCount < 2)
         {
             GP_ERROR("Error attempting to parse property '%s' as a two-dimensional vector.", name);
             out->set(0.0f, 0.0f);
             return false;
         }
 
-        out->set(x, y);
+        out->set(&_data->_values[p->firstValue]);
         return true;
     }
-    
+
     out->set(0.0f, 0.0f);
     return false;
 }
@@ -824,23 +1504,20 @@ bool Properties::getVector3(const char* name, Vector3* out) const
 {
     GP_ASSERT(out);
 
-    const char* valueString = getString(name);
-    if (valueString)
+    const Property* p = getProperty(name);
+    if (p)
     {
-        float x, y, z;
-        int scanned;
-        scanned = sscanf(valueString, "%f,%f,%f", &x, &y, &z);
-        if (scanned != 3)
+        if (p->valueCount < 3)
         {
             GP_ERROR("Error attempting to parse property '%s' as a three-dimensional vector.", name);
             out->set(0.0f, 0.0f, 0.0f);
             return false;
         }
 
-        out->set(x, y, z);
+        out->set(&_data->_values[p->firstValue]);
         return true;
     }
-    
+
     out->set(0.0f, 0.0f, 0.0f);
     return false;
 }
@@ -849,23 +1526,20 @@ bool Properties::getVector4(const char* name, Vector4* out) const
 {
     GP_ASSERT(out);
 
-    const char* valueString = getString(name);
-    if (valueString)
+    const Property* p = getProperty(name);
+    if (p)
     {
-        float x, y, z, w;
-        int scanned;
-        scanned = sscanf(valueString, "%f,%f,%f,%f", &x, &y, &z, &w);
-        if (scanned != 4)
+        if (p->valueCount < 4)
         {
             GP_ERROR("Error attempting to parse property '%s' as a four-dimensional vector.", name);
             out->set(0.0f, 0.0f, 0.0f, 0.0f);
             return false;
         }
 
-        out->set(x, y, z, w);
+        out->set(&_data->_values[p->firstValue]);
         return true;
     }
-    
+
     out->set(0.0f, 0.0f, 0.0f, 0.0f);
     return false;
 }
@@ -874,23 +1548,21 @@ bool Properties::getQuaternionFromAxisAngle(const char* name, Quaternion* out) c
 {
     GP_ASSERT(out);
 
-    const char* valueString = getString(name);
-    if (valueString)
+    const Property* p = getProperty(name);
+    if (p)
     {
-        float x, y, z, theta;
-        int scanned;
-        scanned = sscanf(valueString, "%f,%f,%f,%f", &x, &y, &z, &theta);
-        if (scanned != 4)
+        if (p->valueCount < 4)
         {
             GP_ERROR("Error attempting to parse property '%s' as an axis-angle rotation.", name);
             out->set(0.0f, 0.0f, 0.0f, 1.0f);
             return false;
         }
 
-        out->set(Vector3(x, y, z), MATH_DEG_TO_RAD(theta));
+        const float* v = &_data->_values[p->firstValue];
+        out->set(Vector3(v[0], v[1], v[2]), MATH_DEG_TO_RAD(v[3]));
         return true;
     }
-    
+
     out->set(0.0f, 0.0f, 0.0f, 1.0f);
     return false;
 }
@@ -899,28 +1571,27 @@ bool Properties::getColor(const char* name, Vector3* out) const
 {
     GP_ASSERT(out);
 
-    const char* valueString = getString(name);
-    if (valueString)
+    const Property* p = getProperty(name);
+    if (p)
     {
-        if (strlen(valueString) != 7 ||
-            valueString[0] != '#')
+        if ((p->flags & PROPERTY_RGB) == 0)
         {
-            // Not a color string.
-            GP_ERROR("Error attempting to parse property '%s' as an RGB color (not specified as a color string).", name);
-            out->set(0.0f, 0.0f, 0.0f);
-            return false;
-        }
-
-        // Read the string into an int as hex.
-        unsigned int color;
-        if (sscanf(valueString+1, "%x", &color) != 1)
-        {
-            GP_ERROR("Error attempting to parse property '%s' as an RGB color.", name);
+            const char* valueString = _data->getString(p->value);
+            if (strlen(valueString) != 7 ||
+                valueString[0] != '#')
+            {
+                // Not a color string.
+                GP_ERROR("Error attempting to parse property '%s' as an RGB color (not specified as a color string).", name);
+            }
+            else
+            {
+                GP_ERROR("Error attempting to parse property '%s' as an RGB color.", name);
+            }
             out->set(0.0f, 0.0f, 0.0f);
             return false;
         }
 
-        out->set(Vector3::fromColor(color));
+        out->set(Vector3::fromColor(p->color));
         return true;
     }
 
@@ -932,28 +1603,27 @@ bool Properties::getColor(const char* name, Vector4* out) const
 {
     GP_ASSERT(out);
 
-    const char* valueString = getString(name);
-    if (valueString)
+    const Property* p = getProperty(name);
+    if (p)
     {
-        if (strlen(valueString) != 9 ||
-            valueString[0] != '#')
-        {
-            // Not a color string.
-            GP_ERROR("Error attempting to parse property '%s' as an RGBA color (not specified as a color string).", name);
-            out->set(0.0f, 0.0f, 0.0f, 0.0f);
-            return false;
-        }
-
-        // Read the string into an int as hex.
-        unsigned int color;
-        if (sscanf(valueString+1, "%x", &color) != 1)
+        if ((p->flags & PROPERTY_RGBA) == 0)
         {
-            GP_ERROR("Error attempting to parse property '%s' as an RGBA color.", name);
+            const char* valueString = _data->getString(p->value);
+            if (strlen(valueString) != 9 ||
+                valueString[0] != '#')
+            {
+                // Not a color string.
+                GP_ERROR("Error attempting to parse property '%s' as an RGBA color (not specified as a color string).", name);
+            }
+            else
+            {
+                GP_ERROR("Error attempting to parse property '%s' as an RGBA color.", name);
+            }
             out->set(0.0f, 0.0f, 0.0f, 0.0f);
             return false;
         }
 
-        out->set(Vector4::fromColor(color));
+        out->set(Vector4::fromColor(p->color));
         return true;
     }
 
@@ -963,22 +1633,10 @@ bool Properties::getColor(const char* name, Vector4* out) const
 
 Properties* Properties::clone()
 {
-    Properties* p = new Properties();
-    
-    p->_namespace = _namespace;
-    p->_id = _id;
-    p->_parentID = _parentID;
-    p->_properties = _properties;
-    p->_propertiesItr = p->_properties.end();
+    if (!_data)
+        return new Properties();
 
-    for (size_t i = 0, count = _namespaces.size(); i < count; i++)
-    {
-        GP_ASSERT(_namespaces[i]);
-        p->_namespaces.push_back(_namespaces[i]->clone());
-    }
-    p->_namespacesItr = p->_namespaces.end();
-
-    return p;
+    return new Properties(_data, _index);
 }
 
 void calculateNamespacePath(const std::string& urlString, std::string& fileString, std::vector<std::string>& namespacePath)
@@ -124,6 +124,13 @@ namespace gameplay
  * modified to do so.  Also note that nothing in a properties file indicates the type
  * of a property. If the type is unknown, its string can be retrieved and interpreted
  * as necessary.
+ *
+ * A properties file is compiled when it is loaded: inheritance between namespaces is
+ * resolved, names and values are stored once in a string table, and values that can be
+ * read as numbers, vectors, matrices or colors are parsed up front. Properties objects are
+ * read-only views of the compiled file, so the get methods do not parse strings. When a
+ * cache path is set (see setCachePath), compiled files are written to it and memory mapped
+ * by later loads of files with the same contents, which skips parsing the text altogether.
  */
 class Properties
 {
@@ -155,6 +162,27 @@ public:
      */
     static Properties* create(const char* url);
 
+    /**
+     * Sets the directory that compiled properties files are cached in.
+     *
+     * A compiled file is named after a hash of the contents of its source file, so it is
+     * only used while the source file is unchanged. The directory must already exist and
+     * be writable; it is resolved like any other path given to FileSystem::open. By default
+     * no cache path is set and files are compiled each time they are loaded.
+     *
+     * @param path The cache directory, or NULL to disable the cache.
+     * @script{ignore}
+     */
+    static void setCachePath(const char* path);
+
+    /**
+     * Returns the directory that compiled properties files are cached in.
+     *
+     * @return The cache directory, or NULL if the cache is disabled.
+     * @script{ignore}
+     */
+    static const char* getCachePath();
+
     /**
      * Destructor.
      */
@@ -379,41 +407,48 @@ public:
 
 
 private:
-    
+
     /**
-     * Constructors.
+     * A compiled properties file, which is shared by the views of its namespaces.
      */
-    Properties();
-    Properties(Stream* stream);
-    Properties(const Properties& copy);
+    class Data;
 
     /**
-     * Constructor. Read from the beginning of namespace specified
+     * A compiled property.
      */
-    Properties(Stream* stream, const char* name, const char* id = NULL, const char* parentID = NULL);
+    struct Property;
 
-    void readProperties(Stream* stream);
+    /**
+     * Constructor. Creates empty properties.
+     */
+    Properties();
 
-    void skipWhiteSpace(Stream* stream);
+    /**
+     * Constructor. Creates a view of a namespace of compiled properties.
+     */
+    Properties(Data* data, unsigned int index);
 
-    char* trimWhiteSpace(char* str);
+    /**
+     * Hidden copy constructor.
+     */
+    Properties(const Properties& copy);
 
-    // Called after create(); copies info from parents into derived namespaces.
-    void resolveInheritance(const char* id = NULL);
+    /**
+     * Hidden copy assignment operator.
+     */
+    Properties& operator=(const Properties&);
 
-    // Called by resolveInheritance().
-    void mergeWith(Properties* overrides);
+    // Returns the property with the given name, or the current property if name is NULL.
+    const Property* getProperty(const char* name) const;
 
     // Clones the Properties object.
     Properties* clone();
 
-    std::string _namespace;
-    std::string _id;
-    std::string _parentID;
-    std::map<std::string, std::string> _properties;
-    std::map<std::string, std::string>::const_iterator _propertiesItr;
+    Data* _data;
+    unsigned int _index;
+    unsigned int _propertyIndex;
+    unsigned int _namespaceIndex;
     std::vector<Properties*> _namespaces;
-    std::vector<Properties*>::const_iterator _namespacesItr;
 };
 
 }
@@ -0,0 +1,157 @@
+#include "Base.h"
+#include "ResourceManager.h"
+#include "Game.h"
+
+#define RESOURCE_TYPE_COUNT (ResourceManager::BUNDLE + 1)
+
+// Asserts that the cache is used on the main game thread, since it is not locked. Any thread
+// is accepted before the game has created its job system.
+#define ASSERT_MAIN_THREAD() GP_ASSERT(!Game::getInstance() || !Game::getInstance()->getJobSystem() || \
+    Game::getInstance()->getJobSystem()->isMainThread())
+
+namespace gameplay
+{
+
+/**
+ * A cached resource.
+ *
+ * @script{ignore}
+ */
+struct ResourceEntry
+{
+    ResourceManager::Type type;
+    std::string key;
+    Ref* resource;
+    size_t size;
+    std::list<ResourceEntry*>::iterator lru;
+};
+
+// Cached resources by key for each type, and in order from least to most recently used.
+static std::map<std::string, ResourceEntry*> __resources[RESOURCE_TYPE_COUNT];
+static std::list<ResourceEntry*> __lru;
+static size_t __memoryUsage[RESOURCE_TYPE_COUNT];
+static size_t __totalMemoryUsage = 0;
+static size_t __budget = 0;
+
+ResourceManager::ResourceManager()
+{
+}
+
+void ResourceManager::setBudget(size_t bytes)
+{
+    __budget = bytes;
+    trim(__budget);
+}
+
+size_t ResourceManager::getBudget()
+{
+    return __budget;
+}
+
+size_t ResourceManager::getMemoryUsage()
+{
+    return __totalMemoryUsage;
+}
+
+size_t ResourceManager::getMemoryUsage(Type type)
+{
+    GP_ASSERT(type < RESOURCE_TYPE_COUNT);
+    return __memoryUsage[type];
+}
+
+unsigned int ResourceManager::getResourceCount(Type type)
+{
+    GP_ASSERT(type < RESOURCE_TYPE_COUNT);
+    return (unsigned int)__resources[type].size();
+}
+
+void ResourceManager::releaseUnreferenced()
+{
+    trim(0);
+}
+
+Ref* ResourceManager::find(Type type, const std::string& key)
+{
+    GP_ASSERT(type < RESOURCE_TYPE_COUNT);
+    ASSERT_MAIN_THREAD();
+
+    std::map<std::string, ResourceEntry*>::const_iterator itr = __resources[type].find(key);
+    if (itr == __resources[type].end())
+        return NULL;
+
+    ResourceEntry* entry = itr->second;
+    GP_ASSERT(entry && entry->resource);
+    __lru.splice(__lru.end(), __lru, entry->lru);
+    entry->resource->addRef();
+    return entry->resource;
+}
+
+void ResourceManager::add(Type type, const std::string& key, Ref* resource, size_t size)
+{
+    GP_ASSERT(type < RESOURCE_TYPE_COUNT);
+    ASSERT_MAIN_THREAD();
+    GP_ASSERT(resource);
+    GP_ASSERT(__resources[type].find(key) == __resources[type].end());
+
+    ResourceEntry* entry = new ResourceEntry();
+    entry->type = type;
+    entry->key = key;
+    entry->resource = resource;
+    entry->size = size;
+    entry->lru = __lru.insert(__lru.end(), entry);
+    __resources[type][key] = entry;
+    __memoryUsage[type] += size;
+    __totalMemoryUsage += size;
+    resource->addRef();
+}
+
+void ResourceManager::trim(size_t budget)
+{
+    std::list<ResourceEntry*>::iterator itr = __lru.begin();
+    while (itr != __lru.end() && (__totalMemoryUsage > budget || budget == 0))
+    {
+        ResourceEntry* entry = *itr;
+        GP_ASSERT(entry && entry->resource);
+        if (entry->resource->getRefCount() > 1)
+        {
+            ++itr;
+            continue;
+        }
+
+        itr = __lru.erase(itr);
+        __resources[entry->type].erase(entry->key);
+        __memoryUsage[entry->type] -= entry->size;
+        __totalMemoryUsage -= entry->size;
+
+        // Releasing a resource may leave resources it referenced unreferenced, which are
+        // released by a later trim if they were used less recently.
+        SAFE_RELEASE(entry->resource);
+        SAFE_DELETE(entry);
+    }
+}
+
+void ResourceManager::update()
+{
+    trim(__budget);
+}
+
+void ResourceManager::finalize()
+{
+    std::list<ResourceEntry*> entries;
+    entries.swap(__lru);
+    for (unsigned int i = 0; i < RESOURCE_TYPE_COUNT; ++i)
+    {
+        __resources[i].clear();
+        __memoryUsage[i] = 0;
+    }
+    __totalMemoryUsage = 0;
+
+    for (std::list<ResourceEntry*>::iterator itr = entries.begin(); itr != entries.end(); ++itr)
+    {
+        ResourceEntry* entry = *itr;
+        SAFE_RELEASE(entry->resource);
+        SAFE_DELETE(entry);
+    }
+}
+
+}
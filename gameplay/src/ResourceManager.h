@@ -0,0 +1,162 @@
+#ifndef RESOURCEMANAGER_H_
+#define RESOURCEMANAGER_H_
+
+#include "Ref.h"
+
+namespace gameplay
+{
+
+/**
+ * Defines the cache of resources that are loaded from files and shared by path.
+ *
+ * Textures, effects, fonts, audio buffers, themes and bundles are looked up in the
+ * resource manager when they are created from a file, and return the loaded resource
+ * with an additional reference when it is already cached. The resource manager holds
+ * its own reference to each cached resource, so resources stay cached for a while
+ * after they are no longer referenced elsewhere and can be reused without loading
+ * them again.
+ *
+ * The size of each cached resource is estimated when it is loaded. Once per frame, before
+ * the game is updated, and when the memory budget is set (see setBudget), cached resources
+ * that are only referenced by the resource manager are released, least recently used first,
+ * until the total size is within the budget. Adding resources does not release others, so
+ * the total size can exceed the budget until the next frame. Resources that are still
+ * referenced elsewhere are never released by the resource manager, so the total size can
+ * also exceed the budget while they are in use.
+ *
+ * The default budget is zero, which releases resources at the end of the frame in
+ * which they are no longer referenced.
+ *
+ * The cache is not locked, so it must only be used on the main game thread. Loads that
+ * run on other threads open their files there and add the resources to the cache once
+ * they are back on the main game thread.
+ */
+class ResourceManager
+{
+    friend class Game;
+    friend class Texture;
+    friend class TextureBatch;
+    friend class Effect;
+    friend class Font;
+    friend class AudioBuffer;
+    friend class Theme;
+    friend class Bundle;
+    friend class SceneLoader;
+
+public:
+
+    /**
+     * The types of cached resources.
+     */
+    enum Type
+    {
+        TEXTURE,
+        EFFECT,
+        FONT,
+        AUDIO_BUFFER,
+        THEME,
+        BUNDLE
+    };
+
+    /**
+     * Sets the memory budget for cached resources.
+     *
+     * Unreferenced resources are released right away until the total size of the cached
+     * resources is within the new budget.
+     *
+     * @param bytes The memory budget in bytes.
+     */
+    static void setBudget(size_t bytes);
+
+    /**
+     * Returns the memory budget for cached resources.
+     *
+     * @return The memory budget in bytes.
+     */
+    static size_t getBudget();
+
+    /**
+     * Returns the estimated size of all cached resources.
+     *
+     * @return The size in bytes.
+     */
+    static size_t getMemoryUsage();
+
+    /**
+     * Returns the estimated size of the cached resources of the given type.
+     *
+     * Textures that are loaded by other resources, such as the texture of a theme, are
+     * counted as textures only.
+     *
+     * @param type The type of resources.
+     *
+     * @return The size in bytes.
+     */
+    static size_t getMemoryUsage(Type type);
+
+    /**
+     * Returns the number of cached resources of the given type.
+     *
+     * @param type The type of resources.
+     *
+     * @return The number of cached resources, including unreferenced ones.
+     */
+    static unsigned int getResourceCount(Type type);
+
+    /**
+     * Releases all cached resources that are only referenced by the resource manager,
+     * regardless of the memory budget.
+     *
+     * This is useful when a level is unloaded, before the next level is loaded.
+     */
+    static void releaseUnreferenced();
+
+private:
+
+    /**
+     * Hidden constructor.
+     */
+    ResourceManager();
+
+    /**
+     * Returns the cached resource of the given type and key, with an added reference,
+     * and marks it as the most recently used resource.
+     *
+     * This must only be called on the main game thread.
+     *
+     * @return The resource, or NULL if it is not cached.
+     */
+    static Ref* find(Type type, const std::string& key);
+
+    /**
+     * Adds a resource to the cache and adds a reference to it.
+     *
+     * This must only be called on the main game thread.
+     *
+     * @param type The type of the resource.
+     * @param key The key to find the resource by, which is usually its path.
+     * @param resource The resource.
+     * @param size The estimated size of the resource in bytes.
+     */
+    static void add(Type type, const std::string& key, Ref* resource, size_t size);
+
+    /**
+     * Releases unreferenced resources, least recently used first, until the total
+     * size is within the given budget.
+     */
+    static void trim(size_t budget);
+
+    /**
+     * Enforces the memory budget. Called by the game every frame, before it is updated.
+     */
+    static void update();
+
+    /**
+     * Releases all cached resources. Called by the game on shutdown.
+     */
+    static void finalize();
+};
+
+}
+
+#endif
@@ -5,6 +5,7 @@
 #include "MeshSkin.h"
 #include "Joint.h"
 #include "Terrain.h"
+#include "ParticleEmitter.h"
 
 namespace gameplay
 {
@@ -14,8 +15,10 @@ static std::vector<Scene*> __sceneList;
 
 Scene::Scene(const char* id)
     : _id(id ? id : ""), _activeCamera(NULL), _firstNode(NULL), _lastNode(NULL), _nodeCount(0), 
-    _lightColor(1,1,1), _lightDirection(0,-1,0), _bindAudioListenerToCamera(true), _debugBatch(NULL)
+    _lightColor(1,1,1), _lightDirection(0,-1,0), _bindAudioListenerToCamera(true), _debugBatch(NULL), _transformHierarchy(NULL),
+    _boundingVolumeHierarchy(NULL), _nodeIndex(NULL)
 {
+    _nodeIndex = new NodeIndex(this);
     __sceneList.push_back(this);
 }
 
@@ -33,9 +36,12 @@ Scene::~Scene()
         SAFE_RELEASE(_activeCamera);
     }
 
-    // Remove all nodes from the scene
+    // Remove all nodes from the scene; the index no longer needs to be kept up to date.
+    SAFE_DELETE(_nodeIndex);
     removeAllNodes();
     SAFE_DELETE(_debugBatch);
+    SAFE_DELETE(_transformHierarchy);
+    SAFE_DELETE(_boundingVolumeHierarchy);
 
     // Remove the scene from global list
     std::vector<Scene*>::iterator itr = std::find(__sceneList.begin(), __sceneList.end(), this);
@@ -53,6 +59,16 @@ Scene* Scene::load(const char* filePath)
     return SceneLoader::load(filePath);
 }
 
+AsyncLoad* Scene::loadAsync(const char* filePath)
+{
+    return SceneLoader::loadAsync(filePath);
+}
+
+const std::vector<Scene::FileLoadTime>& Scene::getFileLoadTimes() const
+{
+    return _fileLoadTimes;
+}
+
 Scene* Scene::getScene(const char* id)
 {
     if (id == NULL)
@@ -81,6 +97,13 @@ Node* Scene::findNode(const char* id, bool recursive, bool exactMatch) const
 {
     GP_ASSERT(id);
 
+    // Look the node up in the index when all nodes of the scene are searched.
+    Node* match = NULL;
+    if (recursive && _nodeIndex->findNode(id, exactMatch, NULL, &match))
+    {
+        return match;
+    }
+
     // Search immediate children first.
     for (Node* child = getFirstNode(); child != NULL; child = child->getNextSibling())
     {
@@ -96,7 +119,7 @@ Node* Scene::findNode(const char* id, bool recursive, bool exactMatch) const
     {
         for (Node* child = getFirstNode(); child != NULL; child = child->getNextSibling())
         {
-            Node* match = child->findNode(id, true, exactMatch);
+            Node* match = child->findNodeInHierarchy(id, true, exactMatch);
             if (match)
             {
                 return match;
@@ -111,6 +134,13 @@ unsigned int Scene::findNodes(const char* id, std::vector<Node*>& nodes, bool re
 {
     GP_ASSERT(id);
 
+    // Look the nodes up in the index when all nodes of the scene are searched.
+    size_t size = nodes.size();
+    if (recursive && _nodeIndex->findNodes(id, exactMatch, NULL, nodes))
+    {
+        return (unsigned int)(nodes.size() - size);
+    }
+
     unsigned int count = 0;
 
     // Search immediate children first.
@@ -129,7 +159,7 @@ unsigned int Scene::findNodes(const char* id, std::vector<Node*>& nodes, bool re
     {
         for (Node* child = getFirstNode(); child != NULL; child = child->getNextSibling())
         {
-            count += child->findNodes(id, nodes, true, exactMatch);
+            count += child->findNodesInHierarchy(id, nodes, true, exactMatch);
         }
     }
 
@@ -172,6 +202,11 @@ void Scene::addNode(Node* node)
         node->getParent()->removeChild(node);
     }
 
+    if (_transformHierarchy)
+    {
+        _transformHierarchy->invalidate();
+    }
+
     // Link the new node into our list.
     if (_lastNode)
     {
@@ -188,6 +223,13 @@ void Scene::addNode(Node* node)
 
     ++_nodeCount;
 
+    _nodeIndex->addHierarchy(node);
+
+    if (_boundingVolumeHierarchy)
+    {
+        _boundingVolumeHierarchy->addHierarchy(node);
+    }
+
     // If we don't have an active camera set, then check for one and set it.
     if (_activeCamera == NULL)
     {
@@ -321,6 +363,83 @@ void Scene::setLightDirection(const Vector3& direction)
     _lightDirection = direction;
 }
 
+void Scene::setTransformHierarchyEnabled(bool enabled)
+{
+    if (enabled && !_transformHierarchy)
+    {
+        _transformHierarchy = new TransformHierarchy(this);
+    }
+    else if (!enabled && _transformHierarchy)
+    {
+        SAFE_DELETE(_transformHierarchy);
+    }
+}
+
+bool Scene::isTransformHierarchyEnabled() const
+{
+    return _transformHierarchy != NULL;
+}
+
+void Scene::updateTransforms()
+{
+    if (_transformHierarchy)
+    {
+        _transformHierarchy->update();
+    }
+}
+
+static void gatherParticleEmitters(Node* node, std::vector<ParticleEmitter*>& emitters)
+{
+    for (; node != NULL; node = node->getNextSibling())
+    {
+        if (node->getParticleEmitter())
+            emitters.push_back(node->getParticleEmitter());
+        gatherParticleEmitters(node->getFirstChild(), emitters);
+    }
+}
+
+void Scene::updateParticleEmitters(float elapsedTime)
+{
+    std::vector<ParticleEmitter*> emitters;
+    gatherParticleEmitters(getFirstNode(), emitters);
+    ParticleEmitter::update(emitters, elapsedTime);
+}
+
+unsigned int Scene::queryFrustum(const Frustum& frustum, std::vector<Node*>& nodes)
+{
+    return getBoundingVolumeHierarchy()->query(frustum, nodes);
+}
+
+unsigned int Scene::querySphere(const BoundingSphere& sphere, std::vector<Node*>& nodes)
+{
+    return getBoundingVolumeHierarchy()->query(sphere, nodes);
+}
+
+unsigned int Scene::queryRay(const Ray& ray, std::vector<Node*>& nodes, float maxDistance)
+{
+    return getBoundingVolumeHierarchy()->query(ray, nodes, maxDistance);
+}
+
+BoundingVolumeHierarchy* Scene::getBoundingVolumeHierarchy()
+{
+    // Nodes that moved with an ancestor are marked dirty when the flat hierarchy is resolved.
+    if (_transformHierarchy)
+    {
+        _transformHierarchy->resolve();
+    }
+
+    if (!_boundingVolumeHierarchy)
+    {
+        // Build the hierarchy on first use, after which nodes keep it up to date.
+        _boundingVolumeHierarchy = new BoundingVolumeHierarchy();
+        for (Node* node = _firstNode; node != NULL; node = node->_nextSibling)
+        {
+            _boundingVolumeHierarchy->addHierarchy(node);
+        }
+    }
+    return _boundingVolumeHierarchy;
+}
+
 static Material* createDebugMaterial()
 {
     // Vertex shader for drawing colored lines.
@@ -5,6 +5,10 @@
 #include "MeshBatch.h"
 #include "ScriptController.h"
 #include "Light.h"
+#include "TransformHierarchy.h"
+#include "BoundingVolumeHierarchy.h"
+#include "NodeIndex.h"
+#include "AsyncLoad.h"
 
 namespace gameplay
 {
@@ -14,6 +18,9 @@ namespace gameplay
  */
 class Scene : public Ref
 {
+    friend class Node;
+    friend class SceneLoader;
+
 public:
 
     /**
@@ -45,6 +52,59 @@ public:
      */
     static Scene* load(const char* filePath);
 
+    /**
+     * Starts loading a scene from the given '.scene' file in the background.
+     *
+     * The scene file is parsed and the mesh data of its bundle is read on a background
+     * thread. The meshes are then created on the game thread within the frame budget of
+     * asynchronous loads, after which the scene is built as by load(const char*).
+     *
+     * @param filePath The path to the '.scene' file to load from.
+     *
+     * @return A handle to poll for the loaded scene. The handle must be released when
+     *      no longer needed.
+     * @see AsyncLoad
+     * @script{ignore}
+     */
+    static AsyncLoad* loadAsync(const char* filePath);
+
+    /**
+     * Defines the time spent reading a file that is referenced by a '.scene' file.
+     *
+     * @script{ignore}
+     */
+    struct FileLoadTime
+    {
+        /**
+         * The path of the file.
+         */
+        std::string path;
+
+        /**
+         * The time spent opening and parsing the file, in milliseconds.
+         */
+        double time;
+
+        /**
+         * true if the file was read, false if it failed to load.
+         */
+        bool loaded;
+    };
+
+    /**
+     * Returns the time spent reading each file that the '.scene' file of this scene references.
+     *
+     * The bundles and properties files (such as materials, animations and collision objects)
+     * that a scene file references are read in parallel before the nodes of the scene are
+     * built, so the times of the files overlap. Bundles that were already loaded are not read
+     * again and are not listed.
+     *
+     * @return The files that were read, in the order they are first referenced by the scene
+     *      file. The list is empty for scenes that were not loaded from a scene file.
+     * @script{ignore}
+     */
+    const std::vector<FileLoadTime>& getFileLoadTimes() const;
+
     /**
      * Gets a currently active scene.
      *
@@ -73,6 +133,9 @@ public:
     /**
      * Returns the first node in the scene that matches the given ID.
      *
+     * Recursive searches are answered from an index of the node IDs in the scene,
+     * so their cost does not grow with the number of nodes in the scene.
+     *
      * @param id The ID of the node to find.
      * @param recursive true if a recursive search should be performed, false otherwise.
      * @param exactMatch true if only nodes whose ID exactly matches the specified ID are returned,
@@ -230,6 +293,102 @@ public:
      */
     void setLightDirection(const Vector3& direction);
 
+    /**
+     * Enables or disables the flat transform hierarchy for the scene.
+     *
+     * When enabled, the world matrices of all nodes in the scene are kept in
+     * contiguous, parent-before-child ordered arrays and are resolved in a single
+     * linear pass that only visits the subtrees that changed, instead of being
+     * resolved lazily and recursively by each node. This is recommended for scenes
+     * containing large numbers of nodes. The Node and Transform API is unaffected.
+     *
+     * A change to a node's transform then no longer visits the node's descendants.
+     * Their transform listeners are notified when the world matrices are resolved,
+     * which happens in updateTransforms or when a world matrix, bounding volume,
+     * camera matrix or mesh skin palette in the scene is requested.
+     *
+     * The flat transform hierarchy is disabled by default.
+     *
+     * @param enabled true to enable the flat transform hierarchy, false to disable it.
+     * @see updateTransforms()
+     */
+    void setTransformHierarchyEnabled(bool enabled);
+
+    /**
+     * Determines if the flat transform hierarchy is enabled for the scene.
+     *
+     * @return true if the flat transform hierarchy is enabled, false otherwise.
+     */
+    bool isTransformHierarchyEnabled() const;
+
+    /**
+     * Resolves the world matrices of all nodes whose transforms changed since the last update.
+     *
+     * When the flat transform hierarchy is enabled, this should be called once per
+     * frame after the scene has been updated and before it is drawn. Changes to the
+     * structure of the scene (adding or removing nodes) are also applied here, and
+     * nodes use the recursive path until then. Calling this method has no effect when
+     * the flat transform hierarchy is disabled.
+     */
+    void updateTransforms();
+
+    /**
+     * Updates the particle emitters of all nodes in the scene.
+     *
+     * New particles are emitted serially, and the particles of the active emitters are then
+     * simulated in parallel on the game's job system. This replaces calling
+     * ParticleEmitter::update() on each emitter of the scene.
+     *
+     * @param elapsedTime The amount of time that has passed since the last update, in milliseconds.
+     * @see ParticleEmitter::update(const std::vector<ParticleEmitter*>&, float)
+     */
+    void updateParticleEmitters(float elapsedTime);
+
+    /**
+     * Finds all nodes in the scene whose bounds intersect the given frustum.
+     *
+     * Only nodes that contain a model or terrain are considered. The nodes are
+     * looked up in a bounding volume hierarchy that is built on the first query
+     * and kept up to date incrementally as nodes move or are added and removed.
+     *
+     * @param frustum The frustum to test against, typically the frustum of a camera.
+     * @param nodes The vector to append the intersecting nodes to.
+     *
+     * @return The number of nodes appended.
+     * @script{ignore}
+     */
+    unsigned int queryFrustum(const Frustum& frustum, std::vector<Node*>& nodes);
+
+    /**
+     * Finds all nodes in the scene whose bounds intersect the given sphere.
+     *
+     * Only nodes that contain a model or terrain are considered.
+     *
+     * @param sphere The sphere to test against.
+     * @param nodes The vector to append the intersecting nodes to.
+     *
+     * @return The number of nodes appended.
+     * @see queryFrustum(const Frustum&, std::vector<Node*>&)
+     * @script{ignore}
+     */
+    unsigned int querySphere(const BoundingSphere& sphere, std::vector<Node*>& nodes);
+
+    /**
+     * Finds all nodes in the scene whose bounds are hit by the given ray.
+     *
+     * Only nodes that contain a model or terrain are considered. The nodes are
+     * appended in order of increasing distance along the ray.
+     *
+     * @param ray The ray to test against.
+     * @param nodes The vector to append the intersecting nodes to.
+     * @param maxDistance The maximum distance along the ray to consider.
+     *
+     * @return The number of nodes appended.
+     * @see queryFrustum(const Frustum&, std::vector<Node*>&)
+     * @script{ignore}
+     */
+    unsigned int queryRay(const Ray& ray, std::vector<Node*>& nodes, float maxDistance = FLT_MAX);
+
     /**
      * Visits each node in the scene and calls the specified method pointer.
      *
@@ -318,6 +477,11 @@ private:
      */
     Scene& operator=(const Scene&);
 
+    /**
+     * Returns the bounding volume hierarchy of the scene, building it if required.
+     */
+    BoundingVolumeHierarchy* getBoundingVolumeHierarchy();
+
     /**
      * Visits the given node and all of its children recursively.
      */
@@ -345,6 +509,10 @@ private:
     Vector3 _lightDirection;
     bool _bindAudioListenerToCamera;
     MeshBatch* _debugBatch;
+    TransformHierarchy* _transformHierarchy;
+    BoundingVolumeHierarchy* _boundingVolumeHierarchy;
+    NodeIndex* _nodeIndex;
+    std::vector<FileLoadTime> _fileLoadTimes;
 };
 
 template <class T>
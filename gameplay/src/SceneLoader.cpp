@@ -3,6 +3,7 @@
 #include "Game.h"
 #include "Bundle.h"
 #include "SceneLoader.h"
+#include "ResourceManager.h"
 #include "Terrain.h"
 
 namespace gameplay
@@ -12,21 +13,187 @@ namespace gameplay
 extern void calculateNamespacePath(const std::string& urlString, std::string& fileString, std::vector<std::string>& namespacePath);
 extern Properties* getPropertiesFromNamespacePath(Properties* properties, const std::vector<std::string>& namespacePath);
 
+/**
+ * Loads a scene from a scene file or from a bundle in the background.
+ *
+ * The background thread parses the scene file, opens the bundle of the scene and
+ * reads its mesh data. The game thread then creates one mesh per step and hands the
+ * meshes to the cached bundle, so that the final step, which builds the scene, uses
+ * them instead of reading the meshes again.
+ *
+ * @script{ignore}
+ */
+class SceneAsyncLoad : public AsyncLoad
+{
+public:
+
+    static SceneAsyncLoad* create(const char* url, const char* bundlePath, const char* sceneId);
+
+protected:
+
+    SceneAsyncLoad(const char* url, const char* bundlePath, const char* sceneId);
+
+    ~SceneAsyncLoad();
+
+    bool loadData();
+
+    State createObjects();
+
+private:
+
+    std::string _url;
+    std::string _bundlePath;
+    std::string _sceneId;
+    bool _firstScene;
+    Properties* _properties;
+    Bundle* _bundle;
+    Bundle* _cachedBundle;
+    std::vector<std::pair<std::string, Bundle::MeshData*> > _meshData;
+    size_t _meshIndex;
+};
+
+SceneAsyncLoad::SceneAsyncLoad(const char* url, const char* bundlePath, const char* sceneId)
+    : AsyncLoad(url ? url : bundlePath), _url(url ? url : ""), _bundlePath(bundlePath ? bundlePath : ""),
+      _sceneId(sceneId ? sceneId : ""), _firstScene(sceneId == NULL), _properties(NULL), _bundle(NULL),
+      _cachedBundle(NULL), _meshIndex(0)
+{
+}
+
+SceneAsyncLoad* SceneAsyncLoad::create(const char* url, const char* bundlePath, const char* sceneId)
+{
+    SceneAsyncLoad* load = new SceneAsyncLoad(url, bundlePath, sceneId);
+    load->start();
+    return load;
+}
+
+SceneAsyncLoad::~SceneAsyncLoad()
+{
+    for (size_t i = 0, count = _meshData.size(); i < count; ++i)
+    {
+        SAFE_DELETE(_meshData[i].second);
+    }
+    SAFE_RELEASE(_cachedBundle);
+    SAFE_RELEASE(_bundle);
+    SAFE_DELETE(_properties);
+}
+
+bool SceneAsyncLoad::loadData()
+{
+    if (!_url.empty())
+    {
+        _properties = Properties::create(_url.c_str());
+        if (_properties == NULL)
+        {
+            GP_ERROR("Failed to load scene file '%s'.", _url.c_str());
+            return false;
+        }
+
+        // Find the path to the main GPB of the scene, if there is one.
+        Properties* sceneProperties = (strlen(_properties->getNamespace()) > 0) ? _properties : _properties->getNextNamespace();
+        const char* path = sceneProperties ? sceneProperties->getString("path") : NULL;
+        if (path)
+            _bundlePath = path;
+        _properties->rewind();
+    }
+
+    if (_bundlePath.empty())
+        return true;
+
+    _bundle = Bundle::open(_bundlePath.c_str());
+    if (_bundle == NULL)
+    {
+        GP_ERROR("Failed to open bundle '%s'.", _bundlePath.c_str());
+        return false;
+    }
+
+    // Read the data of all meshes; it points into the mapping if the bundle is memory mapped.
+    for (unsigned int i = 0; i < _bundle->_referenceCount; ++i)
+    {
+        Bundle::Reference* ref = &_bundle->_references[i];
+        if (Bundle::isMesh(ref) && _bundle->_stream->seek(ref->offset, SEEK_SET))
+        {
+            Bundle::MeshData* meshData = _bundle->readMeshData(true);
+            if (meshData)
+                _meshData.push_back(std::make_pair(ref->id, meshData));
+        }
+        setProgress(0.5f * (float)(i + 1) / (float)_bundle->_referenceCount);
+    }
+    return true;
+}
+
+AsyncLoad::State SceneAsyncLoad::createObjects()
+{
+    // Create one mesh per step.
+    if (_meshIndex < _meshData.size())
+    {
+        if (_cachedBundle == NULL)
+            _cachedBundle = Bundle::cache(_bundle);
+
+        const std::pair<std::string, Bundle::MeshData*>& data = _meshData[_meshIndex++];
+        if (_cachedBundle->_preloadedMeshes.find(data.first) == _cachedBundle->_preloadedMeshes.end())
+        {
+            Mesh* mesh = _bundle->createMesh(data.first.c_str(), data.second);
+            if (mesh)
+                _cachedBundle->_preloadedMeshes[data.first] = mesh;
+        }
+        SAFE_DELETE(_meshData[_meshIndex - 1].second);
+        setProgress(0.5f + 0.45f * (float)_meshIndex / (float)_meshData.size());
+        return LOADING;
+    }
+
+    // Build the scene.
+    if (!_url.empty())
+    {
+        SceneLoader loader;
+        _scene = loader.loadInternal(_url.c_str(), _properties);
+        _properties = NULL;
+    }
+    else if (_bundle)
+    {
+        if (_cachedBundle == NULL)
+            _cachedBundle = Bundle::cache(_bundle);
+        _scene = _cachedBundle->loadScene(_firstScene ? NULL : _sceneId.c_str());
+    }
+    if (_cachedBundle)
+        _cachedBundle->clearPreloadedMeshes();
+
+    return _scene ? COMPLETE : FAILED;
+}
+
+SceneLoader::~SceneLoader()
+{
+    for (size_t i = 0, count = _bundles.size(); i < count; ++i)
+    {
+        SAFE_RELEASE(_bundles[i]);
+    }
+}
+
 Scene* SceneLoader::load(const char* url)
 {
     SceneLoader loader;
     return loader.loadInternal(url);
 }
 
-Scene* SceneLoader::loadInternal(const char* url)
+AsyncLoad* SceneLoader::loadAsync(const char* url)
+{
+    return SceneAsyncLoad::create(url, NULL, NULL);
+}
+
+AsyncLoad* SceneLoader::loadBundleAsync(const char* path, const char* id)
+{
+    return SceneAsyncLoad::create(NULL, path, id);
+}
+
+Scene* SceneLoader::loadInternal(const char* url, Properties* properties)
 {
     // Get the file part of the url that we are loading the scene from.
     std::string urlStr = url ? url : "";
     std::string id;
     splitURL(urlStr, &_path, &id);
 
-    // Load the scene properties from file.
-    Properties* properties = Properties::create(url);
+    // Load the scene properties from file, unless they have been loaded already.
+    if (properties == NULL)
+        properties = Properties::create(url);
     if (properties == NULL)
     {
         GP_ERROR("Failed to load scene file '%s'.", url);
@@ -47,8 +214,10 @@ Scene* SceneLoader::loadInternal(const char* url)
     if (path)
         _gpbPath = path;
 
-    // Build the node URL/property and animation reference tables and load the referenced files/store the inline properties objects.
+    // Build the node URL/property and animation reference tables, read all of the referenced files
+    // in parallel, and then resolve the referenced properties objects/store the inline properties objects.
     buildReferenceTables(sceneProperties);
+    prefetchReferencedFiles();
     loadReferencedFiles();
 
     // Load the main scene data from GPB and apply the global scene properties.
@@ -70,6 +239,17 @@ Scene* SceneLoader::loadInternal(const char* url)
         scene = Scene::create(sceneProperties->getId());
     }
 
+    // Report the time spent reading each referenced file.
+    for (size_t i = 0, count = _prefetchedFiles.size(); i < count; ++i)
+    {
+        const SceneFile& file = _prefetchedFiles[i];
+        Scene::FileLoadTime loadTime;
+        loadTime.path = file._path;
+        loadTime.time = file._time;
+        loadTime.loaded = file._bundle ? file._openedBundle != NULL : file._properties != NULL;
+        scene->_fileLoadTimes.push_back(loadTime);
+    }
+
     // First apply the node url properties. Following that,
     // apply the normal node properties and create the animations.
     // We apply physics properties after all other node properties
@@ -993,9 +1173,14 @@ void SceneLoader::loadReferencedFiles()
             // Check if the referenced properties file has already been loaded.
             Properties* properties = NULL;
             std::map<std::string, Properties*>::iterator pffIter = _propertiesFromFile.find(fileString);
-            if (pffIter != _propertiesFromFile.end() && pffIter->second)
+            if (pffIter != _propertiesFromFile.end())
             {
                 properties = pffIter->second;
+                if (properties == NULL)
+                {
+                    GP_ERROR("Failed to load referenced properties file '%s'.", fileString.c_str());
+                    continue;
+                }
             }
             else
             {
@@ -1123,6 +1308,100 @@ PhysicsConstraint* SceneLoader::loadSpringConstraint(const Properties* constrain
     return physicsConstraint;
 }
 
+void SceneLoader::prefetchReferencedFiles()
+{
+    GP_PROFILE_SCOPE("SceneLoader::prefetchReferencedFiles");
+
+    // Collect each referenced file once, in the order that the scene file first references it.
+    // Bundles that are already loaded are kept for the duration of the load instead.
+    std::set<std::string> paths;
+    std::vector<std::string> bundlePaths;
+    if (!_gpbPath.empty())
+        bundlePaths.push_back(_gpbPath);
+    for (size_t i = 0, count = _sceneNodes.size(); i < count; ++i)
+    {
+        const std::vector<SceneNodeProperty>& properties = _sceneNodes[i]._properties;
+        for (size_t j = 0, propertyCount = properties.size(); j < propertyCount; ++j)
+        {
+            if (properties[j]._type != SceneNodeProperty::URL)
+                continue;
+
+            std::string file;
+            std::string id;
+            splitURL(properties[j]._url, &file, &id);
+            if (!file.empty())
+                bundlePaths.push_back(file);
+        }
+    }
+    for (size_t i = 0, count = bundlePaths.size(); i < count; ++i)
+    {
+        if (!paths.insert(bundlePaths[i]).second)
+            continue;
+
+        Bundle* bundle = static_cast<Bundle*>(ResourceManager::find(ResourceManager::BUNDLE, bundlePaths[i]));
+        if (bundle)
+            _bundles.push_back(bundle);
+        else
+            _prefetchedFiles.push_back(SceneFile(bundlePaths[i], true));
+    }
+    for (std::map<std::string, Properties*>::const_iterator itr = _properties.begin(); itr != _properties.end(); ++itr)
+    {
+        if (itr->second)
+            continue;
+
+        std::string fileString;
+        std::vector<std::string> namespacePath;
+        calculateNamespacePath(itr->first, fileString, namespacePath);
+        if (paths.insert(fileString).second)
+            _prefetchedFiles.push_back(SceneFile(fileString, false));
+    }
+
+    // Read the files in parallel.
+    Game* game = Game::getInstance();
+    JobSystem* jobSystem = game ? game->getJobSystem() : NULL;
+    if (jobSystem)
+    {
+        jobSystem->parallelFor((unsigned int)_prefetchedFiles.size(), this, &SceneLoader::prefetchRange);
+    }
+    else
+    {
+        prefetchRange(0, (unsigned int)_prefetchedFiles.size());
+    }
+
+    // Hand the results to the rest of the load in a fixed order, so that it does not depend on
+    // which files finished first. Bundles are cached, so that the scene finds them by path.
+    for (size_t i = 0, count = _prefetchedFiles.size(); i < count; ++i)
+    {
+        SceneFile& file = _prefetchedFiles[i];
+        if (file._bundle)
+        {
+            if (file._openedBundle)
+            {
+                _bundles.push_back(file._openedBundle);
+                _bundles.push_back(Bundle::cache(file._openedBundle));
+            }
+        }
+        else
+        {
+            _propertiesFromFile[file._path] = file._properties;
+        }
+    }
+}
+
+void SceneLoader::prefetchRange(unsigned int start, unsigned int end)
+{
+    for (unsigned int i = start; i < end; ++i)
+    {
+        SceneFile& file = _prefetchedFiles[i];
+        double startTime = Game::getAbsoluteTime();
+        if (file._bundle)
+            file._openedBundle = Bundle::open(file._path.c_str());
+        else
+            file._properties = Properties::create(file._path.c_str());
+        file._time = Game::getAbsoluteTime() - startTime;
+    }
+}
+
 void splitURL(const std::string& url, std::string* file, std::string* id)
 {
     if (url.empty())
@@ -1162,6 +1441,11 @@ SceneLoader::SceneNode::SceneNode()
 {
 }
 
+SceneLoader::SceneFile::SceneFile(const std::string& path, bool bundle)
+    : _path(path), _bundle(bundle), _properties(NULL), _openedBundle(NULL), _time(0.0)
+{
+}
+
 SceneLoader::SceneNodeProperty::SceneNodeProperty(Type type, const std::string& url, int index)
     : _type(type), _url(url), _index(index)
 {
@@ -10,6 +10,8 @@
 namespace gameplay
 {
 
+class Bundle;
+
 /**
  * Helper class for loading scenes from .scene files.
  * @script{ignore}
@@ -17,6 +19,8 @@ namespace gameplay
 class SceneLoader
 {
     friend class Scene;
+    friend class Bundle;
+    friend class SceneAsyncLoad;
 
 private:
 
@@ -28,7 +32,27 @@ private:
      * @param url The URL pointing to the Properties object defining the scene.
      */
     static Scene* load(const char* url);
+
+    /**
+     * Starts loading a scene from the Properties object defined at the specified URL in the background.
+     *
+     * @param url The URL pointing to the Properties object defining the scene.
+     */
+    static AsyncLoad* loadAsync(const char* url);
+
+    /**
+     * Starts loading the scene with the given ID from the bundle at the given path in the background.
+     *
+     * @param path The path of the bundle.
+     * @param id The ID of the scene to load (NULL to load the first scene).
+     */
+    static AsyncLoad* loadBundleAsync(const char* path, const char* id);
     
+    /**
+     * Destructor.
+     */
+    ~SceneLoader();
+
     /**
      * Helper structures and functions for SceneLoader::load(const char*).
      */
@@ -76,7 +100,17 @@ private:
         std::map<std::string, std::string> _tags;
     };
 
-    Scene* loadInternal(const char* url);
+    struct SceneFile
+    {
+        SceneFile(const std::string& path, bool bundle);
+        std::string _path;
+        bool _bundle;
+        Properties* _properties;
+        Bundle* _openedBundle;
+        double _time;
+    };
+
+    Scene* loadInternal(const char* url, Properties* properties = NULL);
 
     void addSceneAnimation(const char* animationID, const char* targetID, const char* url);
 
@@ -103,6 +137,8 @@ private:
     void loadPhysics(Properties* physics, Scene* scene);
 
     void loadReferencedFiles();
+    void prefetchReferencedFiles();
+    void prefetchRange(unsigned int start, unsigned int end);
 
     PhysicsConstraint* loadSocketConstraint(const Properties* constraint, PhysicsRigidBody* rbA, PhysicsRigidBody* rbB);
 
@@ -112,6 +148,8 @@ private:
     std::map<std::string, Properties*> _properties;              // Holds the properties object for a given URL.
     std::vector<SceneAnimation> _animations;                     // Holds the animations declared in the .scene file.
     std::vector<SceneNode> _sceneNodes;                          // Holds all the nodes+properties declared in the .scene file.
+    std::vector<SceneFile> _prefetchedFiles;                     // Holds the referenced files that are read in parallel.
+    std::vector<Bundle*> _bundles;                               // Holds the referenced bundles until the scene is loaded.
     std::string _gpbPath;                                        // The path of the main GPB for the scene being loaded.
     std::string _path;                                           // The path of the scene file being loaded.
 };
@@ -665,6 +665,8 @@ void ScriptController::finalizeGame()
 
 void ScriptController::update(float elapsedTime)
 {
+    GP_PROFILE_SCOPE("ScriptController::update");
+
     if (_callbacks[UPDATE])
     {
         executeFunction<void>(_callbacks[UPDATE]->c_str(), "f", elapsedTime);
@@ -673,6 +675,8 @@ void ScriptController::update(float elapsedTime)
 
 void ScriptController::render(float elapsedTime)
 {
+    GP_PROFILE_SCOPE("ScriptController::render");
+
     if (_callbacks[RENDER])
     {
         executeFunction<void>(_callbacks[RENDER]->c_str(), "f", elapsedTime);
@@ -0,0 +1,273 @@
+#include "Base.h"
+#include "SkinDeformer.h"
+#include "Vector4.h"
+
+// The most joints that can influence a vertex, as in the skinning vertex shaders.
+#define SKIN_MAX_INFLUENCES 4
+
+namespace gameplay
+{
+
+SkinDeformer::SkinDeformer(const VertexFormat& vertexFormat)
+    : _vertexFormat(vertexFormat), _vertexCount(0), _vertexData(NULL), _jointCount(0), _stride(0),
+      _positionOffset(0), _weightOffset(0), _indexOffset(0), _influenceCount(0), _vectorCount(0)
+{
+}
+
+SkinDeformer::~SkinDeformer()
+{
+    SAFE_DELETE_ARRAY(_vertexData);
+}
+
+SkinDeformer* SkinDeformer::create(const VertexFormat& vertexFormat, const float* vertexData, unsigned int vertexCount)
+{
+    GP_ASSERT(vertexCount == 0 || vertexData);
+
+    SkinDeformer* deformer = new SkinDeformer(vertexFormat);
+    bool hasPosition = false;
+    unsigned int weightCount = 0;
+    unsigned int indexCount = 0;
+    unsigned int offset = 0;
+    for (unsigned int i = 0, count = vertexFormat.getElementCount(); i < count; ++i)
+    {
+        const VertexFormat::Element& e = vertexFormat.getElement(i);
+        switch (e.usage)
+        {
+        case VertexFormat::POSITION:
+            hasPosition = e.size >= 3;
+            deformer->_positionOffset = offset;
+            break;
+        case VertexFormat::NORMAL:
+        case VertexFormat::TANGENT:
+        case VertexFormat::BINORMAL:
+            if (e.size >= 3)
+                deformer->_vectorOffsets[deformer->_vectorCount++] = offset;
+            break;
+        case VertexFormat::BLENDWEIGHTS:
+            weightCount = e.size;
+            deformer->_weightOffset = offset;
+            break;
+        case VertexFormat::BLENDINDICES:
+            indexCount = e.size;
+            deformer->_indexOffset = offset;
+            break;
+        default:
+            break;
+        }
+        offset += e.size;
+    }
+    deformer->_stride = offset;
+    deformer->_influenceCount = std::min(std::min(weightCount, indexCount), (unsigned int)SKIN_MAX_INFLUENCES);
+
+    if (!hasPosition || deformer->_influenceCount == 0)
+    {
+        GP_ERROR("Failed to create skin deformer; the vertex format must have a position, blend weights and blend indices.");
+        SAFE_RELEASE(deformer);
+        return NULL;
+    }
+
+    deformer->_vertexCount = vertexCount;
+    deformer->_vertexData = new float[vertexCount * deformer->_stride];
+    memcpy(deformer->_vertexData, vertexData, vertexCount * deformer->_stride * sizeof(float));
+
+    for (unsigned int i = 0; i < vertexCount; ++i)
+    {
+        const float* indices = &vertexData[i * deformer->_stride + deformer->_indexOffset];
+        for (unsigned int k = 0; k < deformer->_influenceCount; ++k)
+        {
+            deformer->_jointCount = std::max(deformer->_jointCount, (unsigned int)indices[k] + 1);
+        }
+    }
+
+    return deformer;
+}
+
+const VertexFormat& SkinDeformer::getVertexFormat() const
+{
+    return _vertexFormat;
+}
+
+unsigned int SkinDeformer::getVertexCount() const
+{
+    return _vertexCount;
+}
+
+const float* SkinDeformer::getVertexData() const
+{
+    return _vertexData;
+}
+
+unsigned int SkinDeformer::getJointCount() const
+{
+    return _jointCount;
+}
+
+#ifdef USE_SSE
+static inline void storeVector3(float* dst, __m128 v)
+{
+    _mm_storel_pi((__m64*)dst, v);
+    _mm_store_ss(&dst[2], _mm_movehl_ps(v, v));
+}
+#endif
+
+void SkinDeformer::deform(const Vector4* matrixPalette, unsigned int vertexStart, unsigned int vertexCount, float* vertexData) const
+{
+    GP_ASSERT(matrixPalette);
+    GP_ASSERT(vertexData);
+    GP_ASSERT(vertexStart + vertexCount <= _vertexCount);
+
+    const float* palette = &matrixPalette[0].x;
+    const float* src = &_vertexData[vertexStart * _stride];
+    float* dst = &vertexData[vertexStart * _stride];
+    for (unsigned int i = 0; i < vertexCount; ++i, src += _stride, dst += _stride)
+    {
+        const float* weights = &src[_weightOffset];
+        const float* indices = &src[_indexOffset];
+        const float* position = &src[_positionOffset];
+
+        // Blend the palette matrices of the joints that influence the vertex, then transform
+        // the vertex once by the blended matrix.
+#ifdef USE_SSE
+        __m128 r0 = _mm_setzero_ps();
+        __m128 r1 = _mm_setzero_ps();
+        __m128 r2 = _mm_setzero_ps();
+        for (unsigned int k = 0; k < _influenceCount; ++k)
+        {
+            if (weights[k] == 0.0f)
+                continue;
+            const float* m = &palette[(unsigned int)indices[k] * 12];
+            __m128 w = _mm_set1_ps(weights[k]);
+            r0 = _mm_add_ps(r0, _mm_mul_ps(w, _mm_loadu_ps(&m[0])));
+            r1 = _mm_add_ps(r1, _mm_mul_ps(w, _mm_loadu_ps(&m[4])));
+            r2 = _mm_add_ps(r2, _mm_mul_ps(w, _mm_loadu_ps(&m[8])));
+        }
+
+        // The palette stores rows, so transposing them yields the columns of the matrix.
+        __m128 r3 = _mm_setzero_ps();
+        _MM_TRANSPOSE4_PS(r0, r1, r2, r3);
+
+        __m128 p = _mm_add_ps(_mm_add_ps(_mm_mul_ps(r0, _mm_set1_ps(position[0])), _mm_mul_ps(r1, _mm_set1_ps(position[1]))),
+            _mm_add_ps(_mm_mul_ps(r2, _mm_set1_ps(position[2])), r3));
+        storeVector3(&dst[_positionOffset], p);
+
+        for (unsigned int j = 0; j < _vectorCount; ++j)
+        {
+            const float* v = &src[_vectorOffsets[j]];
+            __m128 n = _mm_add_ps(_mm_add_ps(_mm_mul_ps(r0, _mm_set1_ps(v[0])), _mm_mul_ps(r1, _mm_set1_ps(v[1]))),
+                _mm_mul_ps(r2, _mm_set1_ps(v[2])));
+            storeVector3(&dst[_vectorOffsets[j]], n);
+        }
+#else
+        float m[12] = { 0.0f, 0.0f, 0.0f, 0.0f, 0.0f, 0.0f, 0.0f, 0.0f, 0.0f, 0.0f, 0.0f, 0.0f };
+        for (unsigned int k = 0; k < _influenceCount; ++k)
+        {
+            if (weights[k] == 0.0f)
+                continue;
+            const float* jointMatrix = &palette[(unsigned int)indices[k] * 12];
+            for (unsigned int e = 0; e < 12; ++e)
+            {
+                m[e] += weights[k] * jointMatrix[e];
+            }
+        }
+
+        float p[3];
+        for (unsigned int r = 0; r < 3; ++r)
+        {
+            p[r] = m[r * 4] * position[0] + m[r * 4 + 1] * position[1] + m[r * 4 + 2] * position[2] + m[r * 4 + 3];
+        }
+        memcpy(&dst[_positionOffset], p, sizeof(p));
+
+        for (unsigned int j = 0; j < _vectorCount; ++j)
+        {
+            const float* v = &src[_vectorOffsets[j]];
+            float n[3];
+            for (unsigned int r = 0; r < 3; ++r)
+            {
+                n[r] = m[r * 4] * v[0] + m[r * 4 + 1] * v[1] + m[r * 4 + 2] * v[2];
+            }
+            memcpy(&dst[_vectorOffsets[j]], n, sizeof(n));
+        }
+#endif
+    }
+}
+
+void SkinDeformer::computeJointBounds(BoundingBox* bounds) const
+{
+    GP_ASSERT(_jointCount == 0 || bounds);
+
+    std::vector<bool> influenced(_jointCount, false);
+    const float* src = _vertexData;
+    for (unsigned int i = 0; i < _vertexCount; ++i, src += _stride)
+    {
+        const float* weights = &src[_weightOffset];
+        const float* indices = &src[_indexOffset];
+        const Vector3 position(&src[_positionOffset]);
+        for (unsigned int k = 0; k < _influenceCount; ++k)
+        {
+            if (weights[k] == 0.0f)
+                continue;
+            unsigned int joint = (unsigned int)indices[k];
+            if (influenced[joint])
+            {
+                bounds[joint].min.set(std::min(bounds[joint].min.x, position.x), std::min(bounds[joint].min.y, position.y), std::min(bounds[joint].min.z, position.z));
+                bounds[joint].max.set(std::max(bounds[joint].max.x, position.x), std::max(bounds[joint].max.y, position.y), std::max(bounds[joint].max.z, position.z));
+            }
+            else
+            {
+                bounds[joint].set(position, position);
+                influenced[joint] = true;
+            }
+        }
+    }
+
+    for (unsigned int i = 0; i < _jointCount; ++i)
+    {
+        if (!influenced[i])
+            bounds[i].set(FLT_MAX, FLT_MAX, FLT_MAX, -FLT_MAX, -FLT_MAX, -FLT_MAX);
+    }
+}
+
+void SkinDeformer::computeBounds(const Vector4* matrixPalette, const BoundingBox* jointBounds, unsigned int jointCount, BoundingBox* dst)
+{
+    GP_ASSERT(jointCount == 0 || (matrixPalette && jointBounds));
+    GP_ASSERT(dst);
+
+    // Each row of a palette matrix gives one coordinate of the transformed box: its center
+    // is transformed by the row, and its extents are scaled by the absolute values of the row.
+    bool empty = true;
+    const float* m = &matrixPalette[0].x;
+    for (unsigned int i = 0; i < jointCount; ++i, m += 12)
+    {
+        const BoundingBox& box = jointBounds[i];
+        if (box.min.x > box.max.x)
+            continue;
+
+        Vector3 center = box.getCenter();
+        Vector3 extents = (box.max - box.min) * 0.5f;
+        float min[3];
+        float max[3];
+        for (unsigned int r = 0; r < 3; ++r)
+        {
+            const float* row = &m[r * 4];
+            float c = row[0] * center.x + row[1] * center.y + row[2] * center.z + row[3];
+            float e = fabs(row[0]) * extents.x + fabs(row[1]) * extents.y + fabs(row[2]) * extents.z;
+            min[r] = c - e;
+            max[r] = c + e;
+        }
+
+        if (empty)
+        {
+            dst->set(min[0], min[1], min[2], max[0], max[1], max[2]);
+            empty = false;
+        }
+        else
+        {
+            dst->merge(BoundingBox(min[0], min[1], min[2], max[0], max[1], max[2]));
+        }
+    }
+
+    if (empty)
+        dst->set(BoundingBox::empty());
+}
+
+}
@@ -0,0 +1,156 @@
+#ifndef SKINDEFORMER_H_
+#define SKINDEFORMER_H_
+
+#include "Ref.h"
+#include "VertexFormat.h"
+#include "BoundingBox.h"
+
+namespace gameplay
+{
+
+class Vector4;
+
+/**
+ * Defines the skinning of mesh vertices on the CPU.
+ *
+ * A skin deformer holds a copy of the bind pose vertices of a skinned mesh and transforms
+ * them by the matrix palette of a MeshSkin, the same way the skinning vertex shaders do.
+ * This allows drawing skins that have more joints than the matrix palette of the shaders
+ * can hold: the model skins its vertices into a dynamic mesh before it is drawn with a
+ * material that does not define SKINNING (see Model::setSkinDeformer).
+ *
+ * Deforming vertices does not use the graphics API and does not modify the deformer, so
+ * ranges of vertices can be deformed in parallel, and deformers can be used without a window.
+ */
+class SkinDeformer : public Ref
+{
+public:
+
+    /**
+     * Creates a skin deformer for the given bind pose vertices.
+     *
+     * The vertex format must have a position, blend weights and blend indices. The
+     * positions, normals, tangents and binormals of the vertices are skinned, using up
+     * to four joints per vertex.
+     *
+     * @param vertexFormat The format of the vertices.
+     * @param vertexData The bind pose vertices, which are copied.
+     * @param vertexCount The number of vertices.
+     *
+     * @return The new skin deformer, or NULL if the vertex format cannot be skinned.
+     * @script{ignore}
+     */
+    static SkinDeformer* create(const VertexFormat& vertexFormat, const float* vertexData, unsigned int vertexCount);
+
+    /**
+     * Returns the format of the vertices.
+     *
+     * @return The vertex format.
+     */
+    const VertexFormat& getVertexFormat() const;
+
+    /**
+     * Returns the number of vertices.
+     *
+     * @return The number of vertices.
+     */
+    unsigned int getVertexCount() const;
+
+    /**
+     * Returns the bind pose vertices.
+     *
+     * @return The vertex data.
+     * @script{ignore}
+     */
+    const float* getVertexData() const;
+
+    /**
+     * Returns the number of joints that the blend indices of the vertices refer to.
+     *
+     * @return The number of joints, which is one more than the largest blend index.
+     */
+    unsigned int getJointCount() const;
+
+    /**
+     * Skins a range of vertices by the given matrix palette.
+     *
+     * Only the positions, normals, tangents and binormals of the vertices are written to
+     * vertexData, so the other elements should be initialized with the bind pose vertices
+     * (see getVertexData) before the vertices are first deformed.
+     *
+     * @param matrixPalette The matrix palette, with three rows per joint (see MeshSkin::getMatrixPalette).
+     * @param vertexStart The index of the first vertex to skin.
+     * @param vertexCount The number of vertices to skin.
+     * @param vertexData The vertices to write, in the format of the deformer, starting with vertex zero.
+     * @script{ignore}
+     */
+    void deform(const Vector4* matrixPalette, unsigned int vertexStart, unsigned int vertexCount, float* vertexData) const;
+
+    /**
+     * Computes the bounds of the bind pose vertices that each joint influences.
+     *
+     * Vertices are only included in the bounds of the joints that they have a non-zero
+     * blend weight for. Joints that do not influence any vertex get inverted bounds, with
+     * a minimum that is greater than the maximum.
+     *
+     * @param bounds The array of getJointCount() bounding boxes to write.
+     * @script{ignore}
+     */
+    void computeJointBounds(BoundingBox* bounds) const;
+
+    /**
+     * Computes the bounds of the skinned vertices from the bounds of the bind pose vertices
+     * that each joint influences, without skinning the vertices.
+     *
+     * The bounds of each joint are transformed by its palette matrix, so the result encloses
+     * the skinned vertices but can be larger than their exact bounds.
+     *
+     * @param matrixPalette The matrix palette, with three rows per joint.
+     * @param jointBounds The bounds of the vertices that each joint influences (see computeJointBounds).
+     * @param jointCount The number of joints.
+     * @param dst The bounding box to store the result in.
+     * @script{ignore}
+     */
+    static void computeBounds(const Vector4* matrixPalette, const BoundingBox* jointBounds, unsigned int jointCount, BoundingBox* dst);
+
+private:
+
+    /**
+     * Constructor.
+     */
+    SkinDeformer(const VertexFormat& vertexFormat);
+
+    /**
+     * Destructor.
+     */
+    ~SkinDeformer();
+
+    /**
+     * Hidden copy constructor.
+     */
+    SkinDeformer(const SkinDeformer& copy);
+
+    /**
+     * Hidden copy assignment operator.
+     */
+    SkinDeformer& operator=(const SkinDeformer&);
+
+    const VertexFormat _vertexFormat;
+    unsigned int _vertexCount;
+    float* _vertexData;
+    unsigned int _jointCount;
+    // The size of a vertex and the offsets of its elements, in floats.
+    unsigned int _stride;
+    unsigned int _positionOffset;
+    unsigned int _weightOffset;
+    unsigned int _indexOffset;
+    // The number of joints that influence each vertex.
+    unsigned int _influenceCount;
+    // The offsets of the normal, tangent and binormal elements that are skinned.
+    unsigned int _vectorOffsets[3];
+    unsigned int _vectorCount;
+};
+
+}
+
+#endif
@@ -21,8 +21,6 @@
 namespace gameplay
 {
 
-static Effect* __spriteEffect = NULL;
-
 SpriteBatch::SpriteBatch()
     : _batch(NULL), _sampler(NULL), _textureWidthRatio(0.0f), _textureHeightRatio(0.0f)
 {
@@ -32,18 +30,6 @@ SpriteBatch::~SpriteBatch()
 {
     SAFE_DELETE(_batch);
     SAFE_RELEASE(_sampler);
-    if (!_customEffect)
-    {
-        if (__spriteEffect && __spriteEffect->getRefCount() == 1)
-        {
-            __spriteEffect->release();
-            __spriteEffect = NULL;
-        }
-        else
-        {
-            __spriteEffect->release();
-        }
-    }
 }
 
 SpriteBatch* SpriteBatch::create(const char* texturePath, Effect* effect, unsigned int initialCapacity)
@@ -61,21 +47,12 @@ SpriteBatch* SpriteBatch::create(Texture* texture,  Effect* effect, unsigned int
     bool customEffect = (effect != NULL);
     if (!customEffect)
     {
-        // Create our static sprite effect.
-        if (__spriteEffect == NULL)
-        {
-            __spriteEffect = Effect::createFromFile(SPRITE_VSH, SPRITE_FSH);
-            if (__spriteEffect == NULL)
-            {
-                GP_ERROR("Unable to load sprite effect.");
-                return NULL;
-            }
-            effect = __spriteEffect;
-        }
-        else
+        // Create our sprite effect, which is shared through the effect cache.
+        effect = Effect::createFromFile(SPRITE_VSH, SPRITE_FSH);
+        if (effect == NULL)
         {
-            effect = __spriteEffect;
-            __spriteEffect->addRef();
+            GP_ERROR("Unable to load sprite effect.");
+            return NULL;
         }
     }
 
@@ -99,6 +76,10 @@ SpriteBatch* SpriteBatch::create(Texture* texture,  Effect* effect, unsigned int
 
     // Wrap the effect in a material
     Material* material = Material::create(effect); // +ref effect
+    if (!customEffect)
+    {
+        effect->release();
+    }
 
     // Set initial material state
     material->getStateBlock()->setBlend(true);
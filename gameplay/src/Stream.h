@@ -81,6 +81,21 @@ public:
      * @see canRead()
      */
     virtual char* readLine(char* str, int num) = 0;
+
+    /**
+     * Returns a pointer to the next <code>size</code> bytes of the stream and moves the
+     * file pointer past them, without copying the data.
+     * 
+     * This is only supported by streams whose contents are already in memory, such as
+     * streams opened with FileSystem::MAP. The returned memory is read-only and remains
+     * valid until the stream is closed.
+     * 
+     * @param size The number of bytes to map.
+     * 
+     * @return A pointer to the data, or NULL if the stream does not support mapping or
+     *      fewer than <code>size</code> bytes remain. The file pointer is not moved on failure.
+     */
+    virtual const void* map(size_t /*size*/) { return NULL; }
     
     /**
      * Writes an array of <code>count</code> elements, each of size <code>size</code>.
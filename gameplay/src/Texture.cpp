@@ -2,6 +2,7 @@
 #include "Image.h"
 #include "Texture.h"
 #include "FileSystem.h"
+#include "ResourceManager.h"
 
 // PVRTC (GL_IMG_texture_compression_pvrtc) : Imagination based gpus
 #ifndef GL_COMPRESSED_RGB_PVRTC_2BPPV1_IMG
@@ -42,10 +43,9 @@
 namespace gameplay
 {
 
-static std::vector<Texture*> __textureCache;
 static TextureHandle __currentTextureId;
 
-Texture::Texture() : _handle(0), _format(UNKNOWN), _width(0), _height(0), _mipmapped(false), _cached(false), _compressed(false)
+Texture::Texture() : _handle(0), _format(UNKNOWN), _width(0), _height(0), _mipmapped(false), _compressed(false)
 {
 }
 
@@ -56,80 +56,127 @@ Texture::~Texture()
         GL_ASSERT( glDeleteTextures(1, &_handle) );
         _handle = 0;
     }
+}
 
-    // Remove ourself from the texture cache.
-    if (_cached)
-    {
-        std::vector<Texture*>::iterator itr = std::find(__textureCache.begin(), __textureCache.end(), this);
-        if (itr != __textureCache.end())
-        {
-            __textureCache.erase(itr);
-        }
-    }
+/**
+ * Creates a texture in the background.
+ *
+ * @script{ignore}
+ */
+class TextureAsyncLoad : public AsyncLoad
+{
+public:
+
+    static TextureAsyncLoad* create(const char* path, bool generateMipmaps);
+
+protected:
+
+    TextureAsyncLoad(const char* path, bool generateMipmaps);
+
+    ~TextureAsyncLoad();
+
+    bool loadData();
+
+    State createObjects();
+
+private:
+
+    bool _generateMipmaps;
+    Texture::Data* _data;
+};
+
+TextureAsyncLoad* TextureAsyncLoad::create(const char* path, bool generateMipmaps)
+{
+    TextureAsyncLoad* load = new TextureAsyncLoad(path, generateMipmaps);
+    load->start();
+    return load;
+}
+
+TextureAsyncLoad::TextureAsyncLoad(const char* path, bool generateMipmaps)
+    : AsyncLoad(path), _generateMipmaps(generateMipmaps), _data(new Texture::Data())
+{
+}
+
+TextureAsyncLoad::~TextureAsyncLoad()
+{
+    SAFE_DELETE(_data);
+}
+
+bool TextureAsyncLoad::loadData()
+{
+    return Texture::readData(getPath(), _generateMipmaps, _data);
+}
+
+AsyncLoad::State TextureAsyncLoad::createObjects()
+{
+    _texture = Texture::create(getPath(), _data, _generateMipmaps);
+    SAFE_DELETE(_data);
+    return _texture ? COMPLETE : FAILED;
+}
+
+Texture::Data::Data()
+    : format(UNKNOWN), internalFormat(0), dataFormat(0), compressed(false), image(NULL), buffer(NULL), mipmaps(NULL)
+{
+}
+
+Texture::Data::~Data()
+{
+    SAFE_RELEASE(image);
+    SAFE_DELETE_ARRAY(buffer);
+    SAFE_DELETE_ARRAY(mipmaps);
 }
 
 Texture* Texture::create(const char* path, bool generateMipmaps)
+{
+    return create(path, NULL, generateMipmaps);
+}
+
+AsyncLoad* Texture::createAsync(const char* path, bool generateMipmaps)
+{
+    GP_ASSERT(path);
+
+    return TextureAsyncLoad::create(path, generateMipmaps);
+}
+
+Texture* Texture::create(const char* path, Data* data, bool generateMipmaps)
 {
     GP_ASSERT(path);
 
     // Search texture cache first.
-    for (size_t i = 0, count = __textureCache.size(); i < count; ++i)
+    Texture* t = static_cast<Texture*>(ResourceManager::find(ResourceManager::TEXTURE, path));
+    if (t)
     {
-        Texture* t = __textureCache[i];
-        GP_ASSERT(t);
-        if (t->_path == path)
+        // If 'generateMipmaps' is true, call Texture::generateMipamps() to force the 
+        // texture to generate its mipmap chain if it hasn't already done so.
+        if (generateMipmaps)
         {
-            // If 'generateMipmaps' is true, call Texture::generateMipamps() to force the 
-            // texture to generate its mipmap chain if it hasn't already done so.
-            if (generateMipmaps)
-            {
-                t->generateMipmaps();
-            }
-
-            // Found a match.
-            t->addRef();
-
-            return t;
+            t->generateMipmaps();
         }
+
+        // Found a match.
+        return t;
     }
 
+    // Mipmaps that are not in the file are generated by GL when the data is read here.
     Texture* texture = NULL;
-
-    // Filter loading based on file extension.
-    const char* ext = strrchr(FileSystem::resolvePath(path), '.');
-    if (ext)
+    if (data)
     {
-        switch (strlen(ext))
-        {
-        case 4:
-            if (tolower(ext[1]) == 'p' && tolower(ext[2]) == 'n' && tolower(ext[3]) == 'g')
-            {
-                Image* image = Image::create(path);
-                if (image)
-                    texture = create(image, generateMipmaps);
-                SAFE_RELEASE(image);
-            }
-            else if (tolower(ext[1]) == 'p' && tolower(ext[2]) == 'v' && tolower(ext[3]) == 'r')
-            {
-                // PowerVR Compressed Texture RGBA.
-                texture = createCompressedPVRTC(path);
-            }
-            else if (tolower(ext[1]) == 'd' && tolower(ext[2]) == 'd' && tolower(ext[3]) == 's')
-            {
-                // DDS file format (DXT/S3TC) compressed textures
-                texture = createCompressedDDS(path);
-            }
-            break;
-        }
+        if (!data->levels.empty())
+            texture = create(*data, generateMipmaps);
+    }
+    else
+    {
+        Data fileData;
+        if (readData(path, false, &fileData))
+            texture = create(fileData, generateMipmaps);
     }
 
     if (texture)
     {
         texture->_path = path;
-        texture->_cached = true;
 
         // Add to texture cache.
-        __textureCache.push_back(texture);
+        ResourceManager::add(ResourceManager::TEXTURE, texture->_path, texture, texture->getMemorySize());
 
         return texture;
     }
@@ -138,6 +185,28 @@ Texture* Texture::create(const char* path, bool generateMipmaps)
     return NULL;
 }
 
+size_t Texture::getMemorySize() const
+{
+    // Compressed formats use at most one byte per pixel.
+    size_t bytesPerPixel;
+    switch (_format)
+    {
+    case ALPHA:
+        bytesPerPixel = 1;
+        break;
+    case RGB:
+        bytesPerPixel = 3;
+        break;
+    default:
+        bytesPerPixel = _compressed ? 1 : 4;
+        break;
+    }
+    size_t size = (size_t)_width * _height * bytesPerPixel;
+
+    // A full mipmap chain adds a third to the size of the base level.
+    return _mipmapped ? size + size / 3 : size;
+}
+
 Texture* Texture::create(Image* image, bool generateMipmaps)
 {
     GP_ASSERT(image);
@@ -195,6 +264,187 @@ Texture* Texture::create(TextureHandle handle, int width, int height, Format for
     return texture;
 }
 
+Texture* Texture::create(const Data& data, bool generateMipmaps)
+{
+    GP_ASSERT(!data.levels.empty());
+
+    // Only uncompressed textures can have their mipmaps generated by GL.
+    bool mipmapped = data.levels.size() > 1;
+    generateMipmaps = generateMipmaps && !mipmapped && !data.compressed;
+
+    // Create and load the texture.
+    GLuint textureId;
+    GL_ASSERT( glGenTextures(1, &textureId) );
+    GL_ASSERT( glBindTexture(GL_TEXTURE_2D, textureId) );
+    GL_ASSERT( glPixelStorei(GL_UNPACK_ALIGNMENT, 1) );
+    GL_ASSERT( glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, mipmapped || generateMipmaps ? GL_NEAREST_MIPMAP_LINEAR : GL_LINEAR) );
+
+    for (unsigned int i = 0, count = (unsigned int)data.levels.size(); i < count; ++i)
+    {
+        const Data::Level& level = data.levels[i];
+        if (data.compressed)
+        {
+            GL_ASSERT( glCompressedTexImage2D(GL_TEXTURE_2D, i, data.internalFormat, level.width, level.height, 0, level.size, level.data) );
+        }
+        else
+        {
+            GL_ASSERT( glTexImage2D(GL_TEXTURE_2D, i, data.internalFormat, level.width, level.height, 0, data.dataFormat, GL_UNSIGNED_BYTE, level.data) );
+        }
+    }
+
+    Texture* texture = new Texture();
+    texture->_handle = textureId;
+    texture->_format = data.format;
+    texture->_width = data.levels[0].width;
+    texture->_height = data.levels[0].height;
+    texture->_mipmapped = mipmapped;
+    texture->_compressed = data.compressed;
+    if (generateMipmaps)
+    {
+        texture->generateMipmaps();
+    }
+
+    // Restore the texture id
+    GL_ASSERT( glBindTexture(GL_TEXTURE_2D, __currentTextureId) );
+
+    return texture;
+}
+
+bool Texture::readData(const char* path, bool generateMipmaps, Data* data)
+{
+    GP_ASSERT(path);
+    GP_ASSERT(data);
+
+    // Filter loading based on file extension.
+    const char* ext = strrchr(FileSystem::resolvePath(path), '.');
+    if (ext && strlen(ext) == 4)
+    {
+        if (tolower(ext[1]) == 'p' && tolower(ext[2]) == 'n' && tolower(ext[3]) == 'g')
+        {
+            data->image = Image::create(path);
+            if (data->image == NULL)
+                return false;
+
+            unsigned int bytesPerPixel;
+            switch (data->image->getFormat())
+            {
+            case Image::RGB:
+                data->format = Texture::RGB;
+                bytesPerPixel = 3;
+                break;
+            case Image::RGBA:
+                data->format = Texture::RGBA;
+                bytesPerPixel = 4;
+                break;
+            default:
+                GP_ERROR("Unsupported image format (%d).", data->image->getFormat());
+                return false;
+            }
+            data->internalFormat = data->dataFormat = (GLenum)data->format;
+
+            Data::Level level;
+            level.data = data->image->getData();
+            level.width = data->image->getWidth();
+            level.height = data->image->getHeight();
+            level.size = level.width * level.height * bytesPerPixel;
+            data->levels.push_back(level);
+        }
+        else if (tolower(ext[1]) == 'p' && tolower(ext[2]) == 'v' && tolower(ext[3]) == 'r')
+        {
+            // PowerVR Compressed Texture RGBA.
+            return readCompressedPVRTC(path, data);
+        }
+        else if (tolower(ext[1]) == 'd' && tolower(ext[2]) == 'd' && tolower(ext[3]) == 's')
+        {
+            // DDS file format (DXT/S3TC) compressed textures
+            if (!readCompressedDDS(path, data))
+                return false;
+        }
+        else
+        {
+            return false;
+        }
+
+        if (generateMipmaps)
+        {
+            buildMipmaps(data);
+        }
+        return true;
+    }
+
+    return false;
+}
+
+void Texture::buildMipmaps(Data* data)
+{
+    GP_ASSERT(data);
+
+    if (data->compressed || data->levels.size() != 1)
+        return;
+
+    unsigned int bytesPerPixel;
+    switch (data->format)
+    {
+    case ALPHA:
+        bytesPerPixel = 1;
+        break;
+    case RGB:
+        bytesPerPixel = 3;
+        break;
+    case RGBA:
+        bytesPerPixel = 4;
+        break;
+    default:
+        return;
+    }
+
+    // Compute the size of the levels below the base level.
+    GLsizei width = data->levels[0].width;
+    GLsizei height = data->levels[0].height;
+    size_t size = 0;
+    while (width > 1 || height > 1)
+    {
+        width = std::max(1, width >> 1);
+        height = std::max(1, height >> 1);
+        size += (size_t)width * height * bytesPerPixel;
+    }
+    if (size == 0)
+        return;
+    data->mipmaps = new GLubyte[size];
+
+    // Each level averages 2x2 blocks of the level above it. The last row and column of a
+    // level with an odd size are repeated.
+    GLubyte* dst = data->mipmaps;
+    Data::Level src = data->levels[0];
+    while (src.width > 1 || src.height > 1)
+    {
+        Data::Level level;
+        level.data = dst;
+        level.width = std::max(1, src.width >> 1);
+        level.height = std::max(1, src.height >> 1);
+        level.size = level.width * level.height * bytesPerPixel;
+
+        size_t srcPitch = (size_t)src.width * bytesPerPixel;
+        for (GLsizei y = 0; y < level.height; ++y)
+        {
+            const GLubyte* row0 = src.data + std::min(y * 2, src.height - 1) * srcPitch;
+            const GLubyte* row1 = src.data + std::min(y * 2 + 1, src.height - 1) * srcPitch;
+            for (GLsizei x = 0; x < level.width; ++x)
+            {
+                unsigned int x0 = std::min(x * 2, src.width - 1) * bytesPerPixel;
+                unsigned int x1 = std::min(x * 2 + 1, src.width - 1) * bytesPerPixel;
+                for (unsigned int c = 0; c < bytesPerPixel; ++c)
+                {
+                    *dst++ = (GLubyte)((row0[x0 + c] + row0[x1 + c] + row1[x0 + c] + row1[x1 + c] + 2) >> 2);
+                }
+            }
+        }
+
+        data->levels.push_back(level);
+        src = level;
+    }
+}
+
 // Computes the size of a PVRTC data chunk for a mipmap level of the given size.
 static unsigned int computePVRTCDataSize(int width, int height, int bpp)
 {
@@ -218,13 +468,16 @@ static unsigned int computePVRTCDataSize(int width, int height, int bpp)
     return widthBlocks * heightBlocks * ((blockSize  * bpp) >> 3);
 }
 
-Texture* Texture::createCompressedPVRTC(const char* path)
+bool Texture::readCompressedPVRTC(const char* path, Data* data)
 {
+    GP_ASSERT(path);
+    GP_ASSERT(data);
+
     std::auto_ptr<Stream> stream(FileSystem::open(path));
     if (stream.get() == NULL || !stream->canRead())
     {
         GP_ERROR("Failed to load file '%s'.", path);
-        return NULL;
+        return false;
     }
 
     // Read first 4 bytes to determine PVRTC format.
@@ -234,72 +487,60 @@ Texture* Texture::createCompressedPVRTC(const char* path)
     if (read != 1)
     {
         GP_ERROR("Failed to read PVR version.");
-        return NULL;
+        return false;
     }
 
     // Rewind to start of header.
     if (stream->seek(0, SEEK_SET) == false)
     {
         GP_ERROR("Failed to seek backwards to beginning of file after reading PVR version.");
-        return NULL;
+        return false;
     }
 
     // Read texture data.
     GLsizei width, height;
     GLenum format;
-    GLubyte* data = NULL;
     unsigned int mipMapCount;
 
     if (version == 0x03525650)
     {
         // Modern PVR file format.
-        data = readCompressedPVRTC(path, stream.get(), &width, &height, &format, &mipMapCount);
+        data->buffer = readCompressedPVRTC(path, stream.get(), &width, &height, &format, &mipMapCount);
     }
     else
     {
         // Legacy PVR file format.
-        data = readCompressedPVRTCLegacy(path, stream.get(), &width, &height, &format, &mipMapCount);
+        data->buffer = readCompressedPVRTCLegacy(path, stream.get(), &width, &height, &format, &mipMapCount);
     }
-    if (data == NULL)
+    if (data->buffer == NULL)
     {
         GP_ERROR("Failed to read texture data from PVR file '%s'.", path);
-        return NULL;
+        return false;
     }
     stream->close();
 
     int bpp = (format == GL_COMPRESSED_RGB_PVRTC_2BPPV1_IMG || format == GL_COMPRESSED_RGBA_PVRTC_2BPPV1_IMG) ? 2 : 4;
 
-    // Generate our texture.
-    GLuint textureId;
-    GL_ASSERT( glGenTextures(1, &textureId) );
-    GL_ASSERT( glBindTexture(GL_TEXTURE_2D, textureId) );
-    GL_ASSERT( glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, mipMapCount > 1 ? GL_NEAREST_MIPMAP_LINEAR : GL_LINEAR) );
+    data->internalFormat = data->dataFormat = format;
+    data->compressed = true;
 
-    Texture* texture = new Texture();
-    texture->_handle = textureId;
-    texture->_width = width;
-    texture->_height = height;
-    texture->_mipmapped = mipMapCount > 1;
-    texture->_compressed = true;
-
-    // Load the data for each level.
-    GLubyte* ptr = data;
+    // Find the data of each level.
+    GLubyte* ptr = data->buffer;
     for (unsigned int level = 0; level < mipMapCount; ++level)
     {
-        unsigned int dataSize = computePVRTCDataSize(width, height, bpp);
-
-        // Upload data to GL.
-        GL_ASSERT( glCompressedTexImage2D(GL_TEXTURE_2D, level, format, width, height, 0, dataSize, ptr) );
+        Data::Level mipLevel;
+        mipLevel.data = ptr;
+        mipLevel.width = width;
+        mipLevel.height = height;
+        mipLevel.size = computePVRTCDataSize(width, height, bpp);
+        data->levels.push_back(mipLevel);
 
         width = std::max(width >> 1, 1);
         height = std::max(height >> 1, 1);
-        ptr += dataSize;
+        ptr += mipLevel.size;
     }
 
-    // Free data.
-    SAFE_DELETE_ARRAY(data);
-
-    return texture;
+    return true;
 }
 
 GLubyte* Texture::readCompressedPVRTC(const char* path, Stream* stream, GLsizei* width, GLsizei* height, GLenum* format, unsigned int* mipMapCount)
@@ -494,9 +735,10 @@ int Texture::getMaskByteIndex(unsigned int mask)
     }
 }
 
-Texture* Texture::createCompressedDDS(const char* path)
+bool Texture::readCompressedDDS(const char* path, Data* data)
 {
     GP_ASSERT(path);
+    GP_ASSERT(data);
 
     // DDS file structures.
     struct dds_pixel_format
@@ -529,22 +771,12 @@ Texture* Texture::createCompressedDDS(const char* path)
         unsigned int     dwReserved2;
     };
 
-    struct dds_mip_level
-    {
-        GLubyte* data;
-        GLsizei width;
-        GLsizei height;
-        GLsizei size;
-    };
-
-    Texture* texture = NULL;
-
     // Read DDS file.
     std::auto_ptr<Stream> stream(FileSystem::open(path));
     if (stream.get() == NULL || !stream->canRead())
     {
         GP_ERROR("Failed to open file '%s'.", path);
-        return NULL;
+        return false;
     }
 
     // Validate DDS magic number.
@@ -552,7 +784,7 @@ Texture* Texture::createCompressedDDS(const char* path)
     if (stream->read(code, 1, 4) != 4 || strncmp(code, "DDS ", 4) != 0)
     {
         GP_ERROR("Failed to read DDS file '%s': invalid DDS magic number.", path);
-        return NULL;
+        return false;
     }
 
     // Read DDS header.
@@ -560,7 +792,7 @@ Texture* Texture::createCompressedDDS(const char* path)
     if (stream->read(&header, sizeof(dds_header), 1) != 1)
     {
         GP_ERROR("Failed to read header for DDS file '%s'.", path);
-        return NULL;
+        return false;
     }
 
     if ((header.dwFlags & 0x20000/*DDSD_MIPMAPCOUNT*/) == 0)
@@ -569,21 +801,18 @@ Texture* Texture::createCompressedDDS(const char* path)
         header.dwMipMapCount = 1;
     }
 
-    // Allocate mip level structures.
-    dds_mip_level* mipLevels = new dds_mip_level[header.dwMipMapCount];
-    memset(mipLevels, 0, sizeof(dds_mip_level) * header.dwMipMapCount);
-
     GLenum format = 0;
     GLenum internalFormat = 0;
     bool compressed = false;
-    GLsizei width = header.dwWidth;
-    GLsizei height = header.dwHeight;
+    int bytesPerBlock = 0;
+    int bytesPerPixel = 0;
+    bool colorConvert = false;
+    int ridx = 0, gidx = 0, bidx = 0, aidx = 0;
     Texture::Format textureFormat = Texture::UNKNOWN;
 
     if (header.ddspf.dwFlags & 0x4/*DDPF_FOURCC*/)
     {
         compressed = true;
-        int bytesPerBlock;
 
         // Compressed.
         switch (header.ddspf.dwFourCC)
@@ -614,46 +843,20 @@ Texture* Texture::createCompressedDDS(const char* path)
             break;
         default:
             GP_ERROR("Unsupported compressed texture format (%d) for DDS file '%s'.", header.ddspf.dwFourCC, path);
-            SAFE_DELETE_ARRAY(mipLevels);
-            return NULL;
-        }
-
-        for (unsigned int i = 0; i < header.dwMipMapCount; ++i)
-        {
-            dds_mip_level& level = mipLevels[i];
-
-            level.width = width;
-            level.height = height;
-            level.size =  std::max(1, (width+3) >> 2) * std::max(1, (height+3) >> 2) * bytesPerBlock;
-            level.data = new GLubyte[level.size];
-
-            if (stream->read(level.data, 1, level.size) != (unsigned int)level.size)
-            {
-                GP_ERROR("Failed to load dds compressed texture bytes for texture: %s", path);
-                
-                // Cleanup mip data.
-                for (unsigned int i = 0; i < header.dwMipMapCount; ++i)
-                    SAFE_DELETE_ARRAY(level.data);
-                SAFE_DELETE_ARRAY(mipLevels);
-                return texture;
-            }
-
-            width  = std::max(1, width >> 1);
-            height = std::max(1, height >> 1);
+            return false;
         }
     }
     else if (header.ddspf.dwFlags & 0x40/*DDPF_RGB*/)
     {
         // RGB/RGBA (uncompressed)
-        bool colorConvert = false;
         unsigned int rmask = header.ddspf.dwRBitMask;
         unsigned int gmask = header.ddspf.dwGBitMask;
         unsigned int bmask = header.ddspf.dwBBitMask;
         unsigned int amask = header.ddspf.dwABitMask;
-        int ridx = getMaskByteIndex(rmask);
-        int gidx = getMaskByteIndex(gmask);
-        int bidx = getMaskByteIndex(bmask);
-        int aidx = getMaskByteIndex(amask);
+        ridx = getMaskByteIndex(rmask);
+        gidx = getMaskByteIndex(gmask);
+        bidx = getMaskByteIndex(bmask);
+        aidx = getMaskByteIndex(amask);
 
         if (header.ddspf.dwRGBBitCount == 24)
         {
@@ -684,119 +887,95 @@ Texture* Texture::createCompressedDDS(const char* path)
         if (format == 0)
         {
             GP_ERROR("Failed to create texture from uncompressed DDS file '%s': Unsupported color format (must be one of R8G8B8, A8R8G8B8, A8B8G8R8, X8R8G8B8, X8B8G8R8.", path);
-            SAFE_DELETE_ARRAY(mipLevels);
-            return NULL;
-        }
-
-        // Read data.
-        for (unsigned int i = 0; i < header.dwMipMapCount; ++i)
-        {
-            dds_mip_level& level = mipLevels[i];
-
-            level.width = width;
-            level.height = height;
-            level.size =  width * height * (header.ddspf.dwRGBBitCount >> 3);
-            level.data = new GLubyte[level.size];
-
-            if (stream->read(level.data, 1, level.size) != (unsigned int)level.size)
-            {
-                GP_ERROR("Failed to load bytes for RGB dds texture: %s", path);
-
-                // Cleanup mip data.
-                for (unsigned int i = 0; i < header.dwMipMapCount; ++i)
-                    SAFE_DELETE_ARRAY(level.data);
-                SAFE_DELETE_ARRAY(mipLevels);
-                return texture;
-            }
-
-            width  = std::max(1, width >> 1);
-            height = std::max(1, height >> 1);
-        }
-
-        // Perform color conversion.
-        if (colorConvert)
-        {
-            // Note: While it's possible to use BGRA_EXT texture formats here and avoid CPU color conversion below,
-            // there seems to be different flavors of the BGRA extension, with some vendors requiring an internal
-            // format of RGBA and others requiring an internal format of BGRA.
-            // We could be smarter here later and skip color conversion in favor of GL_BGRA_EXT (for format
-            // and/or internal format) based on which GL extensions are available.
-            // Tip: Using A8B8G8R8 and X8B8G8R8 DDS format maps directly to GL RGBA and requires on no color conversion.
-            GLubyte *pixel, r, g, b, a;
-            if (format == GL_RGB)
-            {
-                for (unsigned int i = 0; i < header.dwMipMapCount; ++i)
-                {
-                    dds_mip_level& level = mipLevels[i];
-                    for (int j = 0; j < level.size; j += 3)
-                    {
-                        pixel = &level.data[j];
-                        r = pixel[ridx]; g = pixel[gidx]; b = pixel[bidx];
-                        pixel[0] = r; pixel[1] = g; pixel[2] = b;
-                    }
-                }
-            }
-            else if (format == GL_RGBA)
-            {
-                for (unsigned int i = 0; i < header.dwMipMapCount; ++i)
-                {
-                    dds_mip_level& level = mipLevels[i];
-                    for (int j = 0; j < level.size; j += 4)
-                    {
-                        pixel = &level.data[j];
-                        r = pixel[ridx]; g = pixel[gidx]; b = pixel[bidx]; a = pixel[aidx];
-                        pixel[0] = r; pixel[1] = g; pixel[2] = b; pixel[3] = a;
-                    }
-                }
-            }
+            return false;
         }
+        bytesPerPixel = header.ddspf.dwRGBBitCount >> 3;
     }
     else
     {
         // Unsupported.
         GP_ERROR("Failed to create texture from DDS file '%s': unsupported flags (%d).", path, header.ddspf.dwFlags);
-        SAFE_DELETE_ARRAY(mipLevels);
-        return NULL;
+        return false;
     }
 
-    // Close file.
-    stream->close();
-
-    // Generate GL texture.
-    GLuint textureId;
-    GL_ASSERT( glGenTextures(1, &textureId) );
-    GL_ASSERT( glBindTexture(GL_TEXTURE_2D, textureId) );
-    GL_ASSERT( glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, header.dwMipMapCount > 1 ? GL_NEAREST_MIPMAP_LINEAR : GL_LINEAR ) );
+    // Compute the size of each level. The levels are stored one after the other.
+    GLsizei width = header.dwWidth;
+    GLsizei height = header.dwHeight;
+    size_t dataSize = 0;
+    for (unsigned int i = 0; i < header.dwMipMapCount; ++i)
+    {
+        Data::Level level;
+        level.data = NULL;
+        level.width = width;
+        level.height = height;
+        if (compressed)
+            level.size = std::max(1, (width+3) >> 2) * std::max(1, (height+3) >> 2) * bytesPerBlock;
+        else
+            level.size = width * height * bytesPerPixel;
+        data->levels.push_back(level);
+        dataSize += level.size;
 
-    // Create gameplay texture.
-    texture = new Texture();
-    texture->_handle = textureId;
-    texture->_width = header.dwWidth;
-    texture->_height = header.dwHeight;
-    texture->_compressed = compressed;
-    texture->_mipmapped = header.dwMipMapCount > 1;
+        width  = std::max(1, width >> 1);
+        height = std::max(1, height >> 1);
+    }
 
-    // Load texture data.
-    for (unsigned int i = 0; i < header.dwMipMapCount; ++i)
+    // Read the data of all levels at once.
+    data->buffer = new GLubyte[dataSize];
+    if (stream->read(data->buffer, 1, dataSize) != dataSize)
     {
-        dds_mip_level& level = mipLevels[i];
         if (compressed)
+            GP_ERROR("Failed to load dds compressed texture bytes for texture: %s", path);
+        else
+            GP_ERROR("Failed to load bytes for RGB dds texture: %s", path);
+        data->levels.clear();
+        return false;
+    }
+    GLubyte* ptr = data->buffer;
+    for (unsigned int i = 0; i < header.dwMipMapCount; ++i)
+    {
+        data->levels[i].data = ptr;
+        ptr += data->levels[i].size;
+    }
+
+    // Perform color conversion.
+    if (colorConvert)
+    {
+        // Note: While it's possible to use BGRA_EXT texture formats here and avoid CPU color conversion below,
+        // there seems to be different flavors of the BGRA extension, with some vendors requiring an internal
+        // format of RGBA and others requiring an internal format of BGRA.
+        // We could be smarter here later and skip color conversion in favor of GL_BGRA_EXT (for format
+        // and/or internal format) based on which GL extensions are available.
+        // Tip: Using A8B8G8R8 and X8B8G8R8 DDS format maps directly to GL RGBA and requires on no color conversion.
+        GLubyte *pixel, r, g, b, a;
+        if (format == GL_RGB)
         {
-            GL_ASSERT( glCompressedTexImage2D(GL_TEXTURE_2D, i, format, level.width, level.height, 0, level.size, level.data) );
+            for (size_t j = 0; j < dataSize; j += 3)
+            {
+                pixel = &data->buffer[j];
+                r = pixel[ridx]; g = pixel[gidx]; b = pixel[bidx];
+                pixel[0] = r; pixel[1] = g; pixel[2] = b;
+            }
         }
-        else
+        else if (format == GL_RGBA)
         {
-            GL_ASSERT( glTexImage2D(GL_TEXTURE_2D, i, internalFormat, level.width, level.height, 0, format, GL_UNSIGNED_BYTE, level.data) );
+            for (size_t j = 0; j < dataSize; j += 4)
+            {
+                pixel = &data->buffer[j];
+                r = pixel[ridx]; g = pixel[gidx]; b = pixel[bidx]; a = pixel[aidx];
+                pixel[0] = r; pixel[1] = g; pixel[2] = b; pixel[3] = a;
+            }
         }
-
-        // Clean up the texture data.
-        SAFE_DELETE_ARRAY(level.data);
     }
 
-    // Clean up mip levels structure.
-    SAFE_DELETE_ARRAY(mipLevels);
+    // Close file.
+    stream->close();
 
-    return texture;
+    data->format = textureFormat;
+    data->internalFormat = internalFormat;
+    data->dataFormat = format;
+    data->compressed = compressed;
+
+    return true;
 }
 
 Texture::Format Texture::getFormat() const
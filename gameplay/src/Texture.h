@@ -3,6 +3,7 @@
 
 #include "Ref.h"
 #include "Stream.h"
+#include "AsyncLoad.h"
 
 namespace gameplay
 {
@@ -15,6 +16,8 @@ class Image;
 class Texture : public Ref
 {
     friend class Sampler;
+    friend class TextureAsyncLoad;
+    friend class TextureBatch;
 
 public:
 
@@ -152,6 +155,26 @@ public:
      */
     static Texture* create(const char* path, bool generateMipmaps = false);
 
+    /**
+     * Starts creating a texture from the given image resource in the background.
+     *
+     * The image is read and decoded on a background thread, along with its mipmap chain
+     * if generateMipmaps is true and the image is not compressed. The texture is then
+     * created on the game thread within the frame budget of asynchronous loads. If the
+     * texture is already loaded, the load completes in the next frame.
+     *
+     * To load many textures at once, use a TextureBatch, which decodes them in parallel.
+     *
+     * @param path The image resource path.
+     * @param generateMipmaps true to auto-generate a full mipmap chain, false otherwise.
+     *
+     * @return A handle to poll for the loaded texture. The handle must be released when
+     *      no longer needed.
+     * @see AsyncLoad
+     * @script{ignore}
+     */
+    static AsyncLoad* createAsync(const char* path, bool generateMipmaps = false);
+
     /**
      * Creates a texture from the given image.
      *
@@ -289,9 +312,71 @@ private:
      */
     Texture& operator=(const Texture&);
 
-    static Texture* createCompressedPVRTC(const char* path);
+    /**
+     * The data of a texture that has been read from an image resource but not yet uploaded to GL.
+     *
+     * Reading texture data does not use GL, so it can be done on any thread.
+     */
+    struct Data
+    {
+        /**
+         * A level of the mipmap chain.
+         */
+        struct Level
+        {
+            const GLubyte* data;
+            GLsizei width;
+            GLsizei height;
+            GLsizei size;
+        };
+
+        Data();
+
+        ~Data();
+
+        Format format;
+        GLenum internalFormat;
+        GLenum dataFormat;
+        bool compressed;
+        std::vector<Level> levels;
+        // The storage of the levels, which is owned by the data.
+        Image* image;
+        GLubyte* buffer;
+        GLubyte* mipmaps;
 
-    static Texture* createCompressedDDS(const char* path);
+    private:
+
+        Data(const Data&);
+
+        Data& operator=(const Data&);
+    };
+
+    /**
+     * Creates a texture from the given image resource, using the given data if it has been read already.
+     */
+    static Texture* create(const char* path, Data* data, bool generateMipmaps);
+
+    /**
+     * Creates a texture from data that has been read already.
+     */
+    static Texture* create(const Data& data, bool generateMipmaps);
+
+    /**
+     * Reads and decodes the texture data of the given image resource. This can be called on any thread.
+     *
+     * @param path The image resource path.
+     * @param generateMipmaps true to also build the mipmap chain of an uncompressed image that has none.
+     * @param data The data to read into.
+     *
+     * @return true if the data was read, false otherwise.
+     */
+    static bool readData(const char* path, bool generateMipmaps, Data* data);
+
+    static void buildMipmaps(Data* data);
+
+    static bool readCompressedPVRTC(const char* path, Data* data);
+
+    static bool readCompressedDDS(const char* path, Data* data);
 
     static GLubyte* readCompressedPVRTC(const char* path, Stream* stream, GLsizei* width, GLsizei* height, GLenum* format, unsigned int* mipMapCount);
 
@@ -299,13 +384,17 @@ private:
 
     static int getMaskByteIndex(unsigned int mask);
 
+    /**
+     * Returns an estimate of the video memory used by the texture, in bytes.
+     */
+    size_t getMemorySize() const;
+
     std::string _path;
     TextureHandle _handle;
     Format _format;
     unsigned int _width;
     unsigned int _height;
     bool _mipmapped;
-    bool _cached;
     bool _compressed;
 };
 
@@ -0,0 +1,188 @@
+#include "Base.h"
+#include "TextureBatch.h"
+#include "Game.h"
+#include "ResourceManager.h"
+
+namespace gameplay
+{
+
+TextureBatch::TextureBatch()
+    : AsyncLoad(NULL), _created(0), _failed(false), _started(false)
+{
+}
+
+TextureBatch::~TextureBatch()
+{
+    for (size_t i = 0, count = _requests.size(); i < count; ++i)
+    {
+        SAFE_RELEASE(_requests[i].texture);
+        SAFE_DELETE(_requests[i].data);
+    }
+}
+
+TextureBatch* TextureBatch::create()
+{
+    return new TextureBatch();
+}
+
+unsigned int TextureBatch::add(const char* path, bool generateMipmaps, int priority)
+{
+    GP_ASSERT(path);
+    GP_ASSERT(!_started);
+
+    Request request;
+    request.path = path;
+    request.generateMipmaps = generateMipmaps;
+    request.priority = priority;
+    request.source = (unsigned int)_requests.size();
+    request.texture = NULL;
+    request.data = NULL;
+    _requests.push_back(request);
+    return request.source;
+}
+
+// Orders the requests that are loaded by decreasing priority.
+struct RequestPriority
+{
+    RequestPriority(const std::vector<int>& priorities) : priorities(priorities)
+    {
+    }
+
+    bool operator()(unsigned int a, unsigned int b) const
+    {
+        return priorities[a] > priorities[b];
+    }
+
+    const std::vector<int>& priorities;
+};
+
+void TextureBatch::load()
+{
+    GP_ASSERT(!_started);
+
+    _started = true;
+
+    // Textures that are already loaded are taken from the cache, and each path is read once,
+    // with the highest priority it was added with.
+    std::map<std::string, unsigned int> sources;
+    std::vector<int> priorities(_requests.size());
+    for (unsigned int i = 0, count = (unsigned int)_requests.size(); i < count; ++i)
+    {
+        Request& request = _requests[i];
+        std::map<std::string, unsigned int>::iterator itr = sources.find(request.path);
+        if (itr != sources.end())
+        {
+            Request& source = _requests[itr->second];
+            request.source = itr->second;
+            priorities[request.source] = std::max(priorities[request.source], request.priority);
+            if (source.texture)
+            {
+                if (request.generateMipmaps)
+                    source.texture->generateMipmaps();
+                request.texture = source.texture;
+                request.texture->addRef();
+            }
+            else
+            {
+                source.generateMipmaps = source.generateMipmaps || request.generateMipmaps;
+            }
+            continue;
+        }
+        sources[request.path] = i;
+        priorities[i] = request.priority;
+
+        request.texture = static_cast<Texture*>(ResourceManager::find(ResourceManager::TEXTURE, request.path.c_str()));
+        if (request.texture)
+        {
+            if (request.generateMipmaps)
+                request.texture->generateMipmaps();
+        }
+        else
+        {
+            request.data = new Texture::Data();
+            _loads.push_back(i);
+        }
+    }
+    std::stable_sort(_loads.begin(), _loads.end(), RequestPriority(priorities));
+
+    start();
+}
+
+unsigned int TextureBatch::getTextureCount() const
+{
+    return (unsigned int)_requests.size();
+}
+
+Texture* TextureBatch::getTexture(unsigned int index) const
+{
+    GP_ASSERT(index < _requests.size());
+
+    return _requests[index].texture;
+}
+
+bool TextureBatch::loadData()
+{
+    Game* game = Game::getInstance();
+    JobSystem* jobSystem = game ? game->getJobSystem() : NULL;
+    if (jobSystem)
+    {
+        jobSystem->parallelFor((unsigned int)_loads.size(), this, &TextureBatch::readRange);
+    }
+    else
+    {
+        readRange(0, (unsigned int)_loads.size());
+    }
+
+    // Textures that fail to read are reported when they are created, so the others still load.
+    return true;
+}
+
+void TextureBatch::readRange(unsigned int start, unsigned int end)
+{
+    for (unsigned int i = start; i < end; ++i)
+    {
+        Request& request = _requests[_loads[i]];
+        if (!Texture::readData(request.path.c_str(), request.generateMipmaps, request.data))
+        {
+            request.data->levels.clear();
+        }
+    }
+}
+
+AsyncLoad::State TextureBatch::createObjects()
+{
+    if (_created == _loads.size())
+        return _failed ? FAILED : COMPLETE;
+
+    unsigned int index = _loads[_created++];
+    Request& request = _requests[index];
+    if (request.data->levels.empty())
+    {
+        GP_WARN("Failed to load texture from file '%s'.", request.path.c_str());
+        _failed = true;
+    }
+    else
+    {
+        request.texture = Texture::create(request.path.c_str(), request.data, request.generateMipmaps);
+        _failed = _failed || request.texture == NULL;
+    }
+    SAFE_DELETE(request.data);
+
+    // Requests for paths that were added more than once share the texture of the first one.
+    if (request.texture)
+    {
+        for (size_t i = index + 1, count = _requests.size(); i < count; ++i)
+        {
+            if (_requests[i].source == index)
+            {
+                _requests[i].texture = request.texture;
+                request.texture->addRef();
+            }
+        }
+    }
+
+    setProgress((float)_created / _loads.size());
+    return _created == _loads.size() ? (_failed ? FAILED : COMPLETE) : LOADING;
+}
+
+}
@@ -0,0 +1,126 @@
+#ifndef TEXTUREBATCH_H_
+#define TEXTUREBATCH_H_
+
+#include "AsyncLoad.h"
+#include "Texture.h"
+
+namespace gameplay
+{
+
+/**
+ * Defines a set of textures that are loaded together in the background.
+ *
+ * The image files of the batch are read and decoded in parallel by the workers of the
+ * job system, which also build the mipmap chains of uncompressed textures that request
+ * them, so that GL does not have to generate them. The textures are then created on the
+ * game thread from the decoded data, one per step within the frame budget of asynchronous
+ * loads, in order of priority.
+ *
+ * Decoding runs as parallel jobs that are started from the background thread. The jobs
+ * are taken by the job system's worker threads; the game thread only decodes them itself
+ * when it is the only worker.
+ *
+ * Textures that are already loaded, and paths that are added more than once, are only
+ * created once. The batch holds a reference to each of its textures until it is released.
+ *
+ * @script{ignore}
+ */
+class TextureBatch : public AsyncLoad
+{
+public:
+
+    /**
+     * Creates an empty texture batch.
+     *
+     * @return The new texture batch.
+     */
+    static TextureBatch* create();
+
+    /**
+     * Adds a texture to the batch. Textures can only be added before the batch is loaded.
+     *
+     * @param path The image resource path.
+     * @param generateMipmaps true to generate a full mipmap chain, false otherwise.
+     * @param priority The priority of the texture. Textures with a higher priority are created first.
+     *
+     * @return The index of the texture in the batch.
+     */
+    unsigned int add(const char* path, bool generateMipmaps = false, int priority = 0);
+
+    /**
+     * Starts loading the textures of the batch.
+     */
+    void load();
+
+    /**
+     * Returns the number of textures in the batch.
+     *
+     * @return The number of textures.
+     */
+    unsigned int getTextureCount() const;
+
+    /**
+     * Returns a texture of the batch.
+     *
+     * Textures are available as soon as they are created, before the whole batch is complete.
+     *
+     * @param index The index of the texture, as returned by add.
+     *
+     * @return The texture, or NULL if it has not been created yet or failed to load.
+     */
+    Texture* getTexture(unsigned int index) const;
+
+protected:
+
+    /**
+     * Constructor.
+     */
+    TextureBatch();
+
+    /**
+     * Destructor.
+     */
+    ~TextureBatch();
+
+    /**
+     * @see AsyncLoad::loadData
+     */
+    bool loadData();
+
+    /**
+     * @see AsyncLoad::createObjects
+     */
+    State createObjects();
+
+private:
+
+    /**
+     * A texture of the batch.
+     */
+    struct Request
+    {
+        std::string path;
+        bool generateMipmaps;
+        int priority;
+        // The index of the request that loads the same path.
+        unsigned int source;
+        Texture* texture;
+        Texture::Data* data;
+    };
+
+    /**
+     * Reads the data of a range of the requests that are loaded, in parallel.
+     */
+    void readRange(unsigned int start, unsigned int end);
+
+    std::vector<Request> _requests;
+    // The indices of the requests that are loaded, from the highest priority to the lowest.
+    std::vector<unsigned int> _loads;
+    unsigned int _created;
+    bool _failed;
+    bool _started;
+};
+
+}
+
+#endif
@@ -1,12 +1,11 @@
 #include "Base.h"
 #include "Theme.h"
 #include "ThemeStyle.h"
+#include "ResourceManager.h"
 
 namespace gameplay
 {
 
-static std::vector<Theme*> __themeCache;
-
 Theme::Theme()
 {
 }
@@ -40,13 +39,6 @@ Theme::~Theme()
 
     SAFE_DELETE(_spriteBatch);
     SAFE_RELEASE(_texture);
-
-    // Remove ourself from the theme cache.
-    std::vector<Theme*>::iterator itr = std::find(__themeCache.begin(), __themeCache.end(), this);
-    if (itr != __themeCache.end())
-    {
-        __themeCache.erase(itr);
-    }
 }
 
 Theme* Theme::create(const char* url)
@@ -54,16 +46,11 @@ Theme* Theme::create(const char* url)
     GP_ASSERT(url);
 
     // Search theme cache first.
-    for (size_t i = 0, count = __themeCache.size(); i < count; ++i)
+    Theme* t = static_cast<Theme*>(ResourceManager::find(ResourceManager::THEME, url));
+    if (t)
     {
-        Theme* t = __themeCache[i];
-        if (t->_url == url)
-        {
-            // Found a match.
-            t->addRef();
-
-            return t;
-        }
+        // Found a match.
+        return t;
     }
 
     // Load theme properties from file path.
@@ -423,8 +410,8 @@ Theme* Theme::create(const char* url)
         space = themeProperties->getNextNamespace();
     }
 
-    // Add this theme to the cache.
-    __themeCache.push_back(theme);
+    // Add this theme to the cache. Its texture is accounted for by the texture cache.
+    ResourceManager::add(ResourceManager::THEME, url, theme, 0);
 
     SAFE_DELETE(properties);
 
@@ -10,7 +10,7 @@ int Transform::_suspendTransformChanged(0);
 std::vector<Transform*> Transform::_transformsChanged;
 
 Transform::Transform()
-    : _matrixDirtyBits(0), _listeners(NULL)
+    : _matrixDirtyBits(0), _listeners(NULL), _poseIndex(POSE_INDEX_NONE)
 {
     _targetType = AnimationTarget::TRANSFORM;
     _scale.set(Vector3::one());
@@ -18,7 +18,7 @@ Transform::Transform()
 }
 
 Transform::Transform(const Vector3& scale, const Quaternion& rotation, const Vector3& translation)
-    : _matrixDirtyBits(0), _listeners(NULL)
+    : _matrixDirtyBits(0), _listeners(NULL), _poseIndex(POSE_INDEX_NONE)
 {
     _targetType = AnimationTarget::TRANSFORM;
     set(scale, rotation, translation);
@@ -26,7 +26,7 @@ Transform::Transform(const Vector3& scale, const Quaternion& rotation, const Vec
 }
 
 Transform::Transform(const Vector3& scale, const Matrix& rotation, const Vector3& translation)
-    : _matrixDirtyBits(0), _listeners(NULL)
+    : _matrixDirtyBits(0), _listeners(NULL), _poseIndex(POSE_INDEX_NONE)
 {
     _targetType = AnimationTarget::TRANSFORM;
     set(scale, rotation, translation);
@@ -34,7 +34,7 @@ Transform::Transform(const Vector3& scale, const Matrix& rotation, const Vector3
 }
 
 Transform::Transform(const Transform& copy)
-    : _matrixDirtyBits(0), _listeners(NULL)
+    : _matrixDirtyBits(0), _listeners(NULL), _poseIndex(POSE_INDEX_NONE)
 {
     _targetType = AnimationTarget::TRANSFORM;
     set(copy);
@@ -31,6 +31,8 @@ class ScriptListener;
  */
 class Transform : public AnimationTarget, public ScriptTarget
 {
+    friend class AnimationPose;
+
 public:
 
     /**
@@ -871,8 +873,18 @@ protected:
 
 private:
    
+    /**
+     * The pose index of a transform that is not in an animation pose.
+     */
+    static const unsigned int POSE_INDEX_NONE = 0xffffffff;
+
     void applyAnimationValueRotation(AnimationValue* value, unsigned int index, float blendWeight);
 
+    /**
+     * The index of the transform in the animation pose being blended, or POSE_INDEX_NONE.
+     */
+    unsigned int _poseIndex;
+
     static int _suspendTransformChanged;
     static std::vector<Transform*> _transformsChanged;
     
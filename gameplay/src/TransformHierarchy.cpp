@@ -0,0 +1,187 @@
+#include "Base.h"
+#include "TransformHierarchy.h"
+#include "Scene.h"
+
+namespace gameplay
+{
+
+TransformHierarchy::TransformHierarchy(Scene* scene)
+    : _scene(scene), _invalid(true)
+{
+}
+
+TransformHierarchy::~TransformHierarchy()
+{
+    invalidate();
+}
+
+unsigned int TransformHierarchy::getNodeCount() const
+{
+    return (unsigned int)_nodes.size();
+}
+
+bool TransformHierarchy::isInvalid() const
+{
+    return _invalid;
+}
+
+void TransformHierarchy::invalidate()
+{
+    // Notify the descendants of changed nodes before they are detached.
+    resolve();
+
+    // Detach the stored nodes so they fall back to resolving their own world matrices
+    // until the layout is rebuilt. Repeated invalidations are free once the arrays are empty.
+    for (size_t i = 0, count = _nodes.size(); i < count; ++i)
+    {
+        _nodes[i]->_transformHierarchy = NULL;
+    }
+    _nodes.clear();
+    _parents.clear();
+    _subtreeEnds.clear();
+    _worldMatrices.clear();
+    _dirty.clear();
+    _dirtyRoots.clear();
+    _invalid = true;
+}
+
+void TransformHierarchy::rebuild()
+{
+    GP_ASSERT(_scene);
+
+    invalidate();
+
+    // Flatten the scene graph in depth first order, so that every subtree is contiguous.
+    std::vector<std::pair<Node*, int> > stack;
+    for (Node* node = _scene->getFirstNode(); node != NULL; node = node->getNextSibling())
+    {
+        stack.push_back(std::make_pair(node, -1));
+    }
+    while (!stack.empty())
+    {
+        Node* node = stack.back().first;
+        int parent = stack.back().second;
+        stack.pop_back();
+
+        int index = (int)_nodes.size();
+        node->_transformHierarchy = this;
+        node->_transformIndex = (unsigned int)index;
+        _nodes.push_back(node);
+        _parents.push_back(parent);
+
+        for (Node* child = node->getFirstChild(); child != NULL; child = child->getNextSibling())
+        {
+            stack.push_back(std::make_pair(child, index));
+        }
+    }
+
+    // Accumulate subtree sizes from the leaves up to compute each subtree's end index.
+    size_t count = _nodes.size();
+    _subtreeEnds.resize(count, 1);
+    for (size_t i = count; i-- > 1;)
+    {
+        if (_parents[i] >= 0)
+            _subtreeEnds[_parents[i]] += _subtreeEnds[i];
+    }
+    for (size_t i = 0; i < count; ++i)
+    {
+        _subtreeEnds[i] += (unsigned int)i;
+    }
+
+    // Every world matrix must be resolved after a rebuild. The nodes were notified of any
+    // changes while they resolved their own world matrices.
+    _worldMatrices.resize(count);
+    _dirty.resize(count, 0);
+    resolveRange(0, (unsigned int)count);
+
+    _invalid = false;
+}
+
+void TransformHierarchy::setDirty(unsigned int index)
+{
+    GP_ASSERT(index < _dirty.size());
+
+    if (!_dirty[index])
+    {
+        _dirty[index] = 1;
+        _dirtyRoots.push_back(index);
+    }
+}
+
+void TransformHierarchy::update()
+{
+    if (_invalid)
+        rebuild();
+
+    if (_dirtyRoots.empty())
+        return;
+
+    // Process dirty subtrees in array order, skipping roots already covered by an ancestor's range.
+    std::sort(_dirtyRoots.begin(), _dirtyRoots.end());
+    std::vector<Node*> movedNodes;
+    unsigned int coveredEnd = 0;
+    for (size_t r = 0, rootCount = _dirtyRoots.size(); r < rootCount; ++r)
+    {
+        unsigned int root = _dirtyRoots[r];
+        if (root < coveredEnd)
+            continue;
+
+        unsigned int end = _subtreeEnds[root];
+        resolveRange(root, end);
+
+        // The root was notified when its transform changed. Its descendants moved with it.
+        for (unsigned int i = root + 1; i < end; ++i)
+        {
+            Node* node = _nodes[i];
+            node->ancestorTransformChanged();
+            if (node->_listeners || !node->_callbacks.empty())
+                movedNodes.push_back(node);
+        }
+        coveredEnd = end;
+    }
+    _dirtyRoots.clear();
+
+    // Listeners are notified once all world matrices are resolved, since they may read
+    // them, change transforms or change the scene graph.
+    for (size_t i = 0, count = movedNodes.size(); i < count; ++i)
+    {
+        movedNodes[i]->Transform::transformChanged();
+    }
+}
+
+void TransformHierarchy::resolve()
+{
+    if (!_dirtyRoots.empty())
+        update();
+}
+
+void TransformHierarchy::resolveRange(unsigned int start, unsigned int end)
+{
+    for (unsigned int i = start; i < end; ++i)
+    {
+        Node* node = _nodes[i];
+        int parent = _parents[i];
+
+        // Simulated (non-kinematic) rigid bodies are positioned in world space by physics.
+        if (parent >= 0 && (!node->_collisionObject || node->_collisionObject->isKinematic()))
+        {
+            Matrix::multiply(_worldMatrices[parent], node->getMatrix(), &_worldMatrices[i]);
+        }
+        else
+        {
+            _worldMatrices[i] = node->getMatrix();
+        }
+        _dirty[i] = 0;
+    }
+}
+
+const Matrix& TransformHierarchy::getWorldMatrix(unsigned int index)
+{
+    GP_ASSERT(!_invalid && index < _worldMatrices.size());
+
+    resolve();
+
+    return _worldMatrices[index];
+}
+
+}
@@ -0,0 +1,133 @@
+#ifndef TRANSFORMHIERARCHY_H_
+#define TRANSFORMHIERARCHY_H_
+
+#include "Matrix.h"
+
+namespace gameplay
+{
+
+class Node;
+class Scene;
+
+/**
+ * Defines a flat, cache-friendly store for the world transforms of a scene.
+ *
+ * The nodes of the scene are kept in parent-before-child (depth first) order,
+ * so that the descendants of any node occupy a contiguous range directly after it.
+ * World matrices, parent indices and dirty flags are stored in parallel arrays,
+ * which allows all pending world matrices to be resolved with a single linear
+ * pass that only visits the subtrees that actually changed.
+ *
+ * A change to a node's transform only marks the node's subtree dirty. The
+ * descendants of the node are marked dirty and their transform listeners are
+ * notified when the subtree is resolved.
+ *
+ * Local matrices continue to be composed and cached by each node's Transform,
+ * so the public API of Node and Transform is unchanged.
+ *
+ * A transform hierarchy is created and owned by a Scene when it is enabled
+ * with Scene::setTransformHierarchyEnabled.
+ */
+class TransformHierarchy
+{
+    friend class Scene;
+    friend class Node;
+
+public:
+
+    /**
+     * Returns the number of nodes currently stored in the hierarchy.
+     *
+     * @return The number of stored nodes.
+     */
+    unsigned int getNodeCount() const;
+
+    /**
+     * Determines if the node layout must be rebuilt before the next update.
+     *
+     * @return true if the hierarchy has been invalidated by a change in the scene graph.
+     */
+    bool isInvalid() const;
+
+    /**
+     * Rebuilds the layout if required and resolves the world matrices of all dirty subtrees,
+     * then notifies the transform listeners of the nodes that moved with a changed ancestor.
+     */
+    void update();
+
+private:
+
+    /**
+     * Constructor.
+     */
+    TransformHierarchy(Scene* scene);
+
+    /**
+     * Destructor.
+     */
+    ~TransformHierarchy();
+
+    /**
+     * Hidden copy constructor.
+     */
+    TransformHierarchy(const TransformHierarchy& copy);
+
+    /**
+     * Hidden copy assignment operator.
+     */
+    TransformHierarchy& operator=(const TransformHierarchy&);
+
+    /**
+     * Detaches all stored nodes and marks the layout for rebuilding.
+     *
+     * This must be called before any stored node leaves the scene graph.
+     */
+    void invalidate();
+
+    /**
+     * Rebuilds the flat node layout from the scene graph.
+     */
+    void rebuild();
+
+    /**
+     * Marks the subtree starting at the given index as requiring a world matrix update.
+     *
+     * @param index The index of the node whose transform changed.
+     */
+    void setDirty(unsigned int index);
+
+    /**
+     * Resolves the dirty subtrees, if there are any.
+     */
+    void resolve();
+
+    /**
+     * Computes the world matrices of the nodes in the given index range, whose parents
+     * are resolved already.
+     */
+    void resolveRange(unsigned int start, unsigned int end);
+
+    /**
+     * Returns the resolved world matrix of the node at the given index.
+     *
+     * Any pending dirty subtrees are resolved before the matrix is returned.
+     *
+     * @param index The index of the node.
+     *
+     * @return The world matrix of the node.
+     */
+    const Matrix& getWorldMatrix(unsigned int index);
+
+    Scene* _scene;
+    std::vector<Node*> _nodes;
+    std::vector<int> _parents;
+    std::vector<unsigned int> _subtreeEnds;
+    std::vector<Matrix> _worldMatrices;
+    std::vector<unsigned char> _dirty;
+    std::vector<unsigned int> _dirtyRoots;
+    bool _invalid;
+};
+
+}
+
+#endif
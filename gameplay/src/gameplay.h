@@ -9,8 +9,11 @@
 #include "Gamepad.h"
 #include "FileSystem.h"
 #include "Bundle.h"
+#include "AsyncLoad.h"
+#include "ResourceManager.h"
 #include "MathUtil.h"
 #include "Logger.h"
+#include "Profiler.h"
 
 // Math
 #include "Rectangle.h"
@@ -29,6 +32,7 @@
 
 // Graphics
 #include "Texture.h"
+#include "TextureBatch.h"
 #include "Image.h"
 #include "Mesh.h"
 #include "MeshPart.h"
@@ -38,6 +42,7 @@
 #include "VertexFormat.h"
 #include "VertexAttributeBinding.h"
 #include "Model.h"
+#include "SkinDeformer.h"
 #include "Camera.h"
 #include "Light.h"
 #include "Scene.h"